@@ -0,0 +1,99 @@
+#include <algorithm>
+#include "AccountCache.h"
+
+AccountCache* AccountCache::instance = nullptr;
+
+AccountCache& AccountCache::getInstance() {
+    static QMutex instanceMutex;
+    QMutexLocker locker(&instanceMutex);
+
+    if (!instance) {
+        instance = new AccountCache();
+    }
+    return *instance;
+}
+
+bool AccountCache::find(int userId, const DatabaseManager::ChangeStamp& stamp, Account& account, quint64& readEpoch) {
+    QMutexLocker locker(&mutex);
+
+    // Written by another process (or by this one outside a transaction) since
+    if (!sameStamp(stamp, synced)) {
+        ++epoch;
+        accounts.clear();
+        synced = stamp;
+    }
+
+    auto found = accounts.constFind(userId);
+    if (found == accounts.constEnd()) {
+        readEpoch = epoch;
+        return false;
+    }
+    account = found.value();
+    return true;
+}
+
+void AccountCache::store(int userId, const Account& account, quint64 readEpoch) {
+    QMutexLocker locker(&mutex);
+    if (readEpoch != epoch) return; // A commit may have landed during the read
+
+    if (accounts.size() >= MAX_ACCOUNTS) accounts.clear();
+    accounts.insert(userId, account);
+}
+
+void AccountCache::changed(const std::vector<int>& userIds, const std::vector<int>& itemIds) {
+    QMutexLocker locker(&mutex);
+    drop(userIds, itemIds);
+}
+
+void AccountCache::committed(const std::vector<int>& userIds, const std::vector<int>& itemIds,
+                             const DatabaseManager::ChangeStamp& begun, const DatabaseManager::ChangeStamp& leaving) {
+    QMutexLocker locker(&mutex);
+
+    // Only this transaction wrote between the two stamps if the cache was current at the first
+    if (begun.isValid() && sameStamp(begun, synced)) {
+        drop(userIds, itemIds);
+    } else {
+        ++epoch;
+        accounts.clear();
+    }
+    synced = leaving;
+}
+
+void AccountCache::drop(const std::vector<int>& userIds, const std::vector<int>& itemIds) {
+    ++epoch;
+
+    for (int userId : userIds) accounts.remove(userId);
+    if (itemIds.empty()) return;
+
+    for (auto it = accounts.begin(); it != accounts.end();) {
+        if (mentions(it.value(), itemIds)) {
+            it = accounts.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void AccountCache::invalidate() {
+    QMutexLocker locker(&mutex);
+    ++epoch;
+    accounts.clear();
+    synced = DatabaseManager::ChangeStamp();
+}
+
+bool AccountCache::sameStamp(const DatabaseManager::ChangeStamp& a, const DatabaseManager::ChangeStamp& b) {
+    return a.catalogue == b.catalogue && a.circulation == b.circulation;
+}
+
+bool AccountCache::mentions(const Account& account, const std::vector<int>& itemIds) {
+    auto listed = [&itemIds](int itemId) {
+        return std::find(itemIds.begin(), itemIds.end(), itemId) != itemIds.end();
+    };
+    for (const Loan& loan : account.loans) {
+        if (listed(loan.row.id)) return true;
+    }
+    for (const Hold& hold : account.holds) {
+        if (listed(hold.row.id)) return true;
+    }
+    return false;
+}
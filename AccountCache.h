@@ -0,0 +1,154 @@
+#ifndef ACCOUNTCACHE_H
+#define ACCOUNTCACHE_H
+
+#include <QMutex>
+#include <QHash>
+#include <QString>
+#include <vector>
+#include "CatalogueSnapshot.h"
+#include "DatabaseManager.h"
+
+/*
+    AccountCache Class:
+    Singleton keeping the last account snapshot read for each patron (see
+    DatabaseManager::getAccountSnapshot()), so refreshing the account panel without
+    an intervening change costs no SQL. Rows are kept as CatalogueSnapshot::ItemRow
+    values; DatabaseManager builds fresh LibraryItem objects from them for every
+    caller, as it does for the mapped catalogue.
+
+    An account goes stale when its own patron borrows, returns, places or cancels a
+    hold, and also when someone else changes one of the items on it (another hold
+    moves the queue or changes the hold count, a copy changes availability).
+    DatabaseManager reports both through committed() right after each COMMIT (and
+    through changed() for writes outside a transaction): the patrons it wrote for,
+    and the items it touched. Every account naming one of those items is dropped.
+
+    Other processes writing the same file report nothing, so every lookup carries
+    the database's change counters (DatabaseManager::getChangeStamp(): catalogue and
+    circulation generations) read just before it. If either moved since the cache
+    was last current, every account is dropped first. A committed transaction
+    reports the counters from its BEGIN and from just before its COMMIT: when the
+    cache was current at the first, only that transaction wrote in between, so
+    dropping the accounts it names is enough; otherwise everything goes.
+
+    A snapshot read from SQL is stored only if no change was reported since the read
+    began (store() compares the epoch find() handed out), so a read that raced a
+    commit is returned to its caller but not cached. Reads inside an open transaction
+    bypass the cache altogether.
+
+    Data Members:
+      - QHash<int, Account> accounts: Cached accounts by user ID
+      - quint64 epoch: Bumped on every reported change
+      - DatabaseManager::ChangeStamp synced: Counters the accounts are current at
+      - QMutex mutex: Guards accounts, epoch and synced
+      - static AccountCache* instance: Singleton instance pointer
+
+    Member Functions:
+      Public:
+        - getInstance(): Provides global access to singleton instance
+        - find(): A patron's cached account, or the epoch to store a fresh one under
+        - store(): Caches an account read at that epoch
+        - changed(): Drops the accounts of changed patrons and items
+        - committed(): The same for a committed transaction, following its counters
+        - invalidate(): Drops every account (another database was opened)
+*/
+class AccountCache {
+public:
+    /*
+        Loan / Hold / Account Structs:
+        One cached account, in the order getAccountSnapshot() returns it
+    */
+    struct Loan {
+        CatalogueSnapshot::ItemRow row;
+        QString checkoutDate;
+        QString dueDate;
+    };
+
+    struct Hold {
+        CatalogueSnapshot::ItemRow row;
+        int position;
+    };
+
+    struct Account {
+        std::vector<Loan> loans;
+        std::vector<Hold> holds;
+    };
+
+    /*
+        Function: getInstance
+        Purpose: Provides global access to the singleton AccountCache instance.
+        Return: AccountCache& - Reference to the singleton instance
+    */
+    static AccountCache& getInstance();
+
+    /*
+        Function: find
+        Purpose: Looks up a patron's cached account, first dropping every account if
+                 the database changed since the cache was last current
+        Parameters:
+          in: int userId - Database ID of the patron
+          in: const DatabaseManager::ChangeStamp& stamp - Counters read just before (valid)
+          out: Account& account - The cached account, if found
+          out: quint64& readEpoch - On a miss, the epoch to pass to store()
+        Return: bool - True if the account was cached
+    */
+    bool find(int userId, const DatabaseManager::ChangeStamp& stamp, Account& account, quint64& readEpoch);
+
+    /*
+        Function: store
+        Purpose: Caches an account read from SQL, unless a change was reported after
+                 find() handed out readEpoch
+        Parameters:
+          in: int userId - Database ID of the patron
+          in: const Account& account - Account as read
+          in: quint64 readEpoch - Epoch from the find() that missed
+    */
+    void store(int userId, const Account& account, quint64 readEpoch);
+
+    /*
+        Function: changed
+        Purpose: Drops the accounts of patrons written for and of patrons with a loan
+                 or hold on a changed item
+        Parameters:
+          in: const std::vector<int>& userIds - Patrons whose loans or holds changed
+          in: const std::vector<int>& itemIds - Items whose row or hold queue changed
+    */
+    void changed(const std::vector<int>& userIds, const std::vector<int>& itemIds);
+
+    /*
+        Function: committed
+        Purpose: Reports a committed transaction: drops the accounts it changed if the
+                 cache was current when it began, every account otherwise, and is
+                 then current at the counters it committed
+        Parameters:
+          in: const std::vector<int>& userIds - Patrons whose loans or holds changed
+          in: const std::vector<int>& itemIds - Items whose row or hold queue changed
+          in: const DatabaseManager::ChangeStamp& begun - Counters at its BEGIN
+          in: const DatabaseManager::ChangeStamp& leaving - Counters before its COMMIT
+    */
+    void committed(const std::vector<int>& userIds, const std::vector<int>& itemIds,
+                   const DatabaseManager::ChangeStamp& begun, const DatabaseManager::ChangeStamp& leaving);
+
+    /*
+        Function: invalidate
+        Purpose: Drops every cached account
+    */
+    void invalidate();
+
+private:
+    static const int MAX_ACCOUNTS = 1000; // Cached accounts kept before starting over
+
+    QHash<int, Account> accounts;
+    quint64 epoch;
+    DatabaseManager::ChangeStamp synced;
+    QMutex mutex;
+    static AccountCache* instance;
+
+    AccountCache() : epoch(0) {} // Private constructor for singleton
+
+    static bool mentions(const Account& account, const std::vector<int>& itemIds);
+    static bool sameStamp(const DatabaseManager::ChangeStamp& a, const DatabaseManager::ChangeStamp& b);
+    void drop(const std::vector<int>& userIds, const std::vector<int>& itemIds);
+};
+
+#endif
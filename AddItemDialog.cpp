@@ -3,6 +3,7 @@
 #include <QMessageBox>
 #include <QDate>
 #include "AddItemDialog.h"
+#include "CatalogueKeys.h"
 
 AddItemDialog::AddItemDialog(QWidget *parent) : QDialog(parent) {
     setupUI();
@@ -38,6 +39,12 @@ void AddItemDialog::setupUI() {
     conditionCombo->addItems({"Excellent", "Good", "Fair", "Poor"});
     formLayout->addRow("Condition:", conditionCombo);
 
+    // Physical copies of this work
+    copiesSpin = new QSpinBox();
+    copiesSpin->setRange(1, 99);
+    copiesSpin->setValue(1);
+    formLayout->addRow("Copies:", copiesSpin);
+
     // Book-specific fields
     deweyDecimalEdit = new QLineEdit();
     deweyDecimalEdit->setPlaceholderText("XXX.XX");
@@ -119,6 +126,17 @@ void AddItemDialog::updateFieldsVisibility() {
     }
 }
 
+void AddItemDialog::accept() {
+    bool isBook = itemTypeCombo->currentText().contains("Book");
+    QString isbn = isbnEdit->text().trimmed();
+    if (isBook && !isbn.isEmpty() && CatalogueKeys::isbnKey(isbn) < 0) {
+        QMessageBox::warning(this, "Invalid ISBN",
+            "The ISBN is not a valid ISBN-10 or ISBN-13. Please check the digits.");
+        return;
+    }
+    QDialog::accept();
+}
+
 // Getters for the entered data
 QString AddItemDialog::getItemType() const { return itemTypeCombo->currentText(); }
 QString AddItemDialog::getTitle() const { return titleEdit->text(); }
@@ -131,3 +149,4 @@ int AddItemDialog::getIssueNumber() const { return issueNumberSpin->value(); }
 QString AddItemDialog::getPublicationDate() const { return publicationDateEdit->text(); }
 int AddItemDialog::getPublicationYear() const { return publicationYearSpin->value(); }
 QString AddItemDialog::getCondition() const { return conditionCombo->currentText(); }
+int AddItemDialog::getCopies() const { return copiesSpin->value(); }
@@ -44,6 +44,7 @@
       - QLineEdit* publicationDateEdit: Publication date (magazines only)
       - QSpinBox* publicationYearSpin: Year of publication
       - QComboBox* conditionCombo: Physical condition assessment
+      - QSpinBox* copiesSpin: Number of physical copies to add
 
     Member Functions:
       Public:
@@ -53,6 +54,9 @@
       Private:
         - setupUI(): Initializes and arranges all form components
         - updateFieldsVisibility(): Dynamically shows/hides fields based on item type
+
+      Protected:
+        - accept(): Rejects ISBNs with a wrong check digit before closing
 */
 class AddItemDialog : public QDialog {
     Q_OBJECT
@@ -146,6 +150,13 @@ public:
     */
     QString getCondition() const;
 
+    /*
+        Function: getCopies
+        Purpose: Retrieves the number of physical copies being added
+        Return: int - Copy count (at least 1)
+    */
+    int getCopies() const;
+
 private:
     // Form Input Components
     QComboBox *itemTypeCombo;
@@ -159,6 +170,7 @@ private:
     QLineEdit *publicationDateEdit;
     QSpinBox *publicationYearSpin;
     QComboBox *conditionCombo;
+    QSpinBox *copiesSpin;
 
     /*
         Function: setupUI
@@ -175,6 +187,15 @@ private:
                  Connected to the itemTypeCombo selection change signal.
     */
     void updateFieldsVisibility();
+
+protected:
+    /*
+        Function: accept
+        Purpose: Closes the dialog only if the entered ISBN (when one is entered for a
+                 book) has a valid check digit; a mistyped ISBN could not be found by
+                 scanning later.
+    */
+    void accept() override;
 };
 
 #endif
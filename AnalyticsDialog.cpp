@@ -0,0 +1,105 @@
+#include <QHeaderView>
+#include <QDialogButtonBox>
+#include "AnalyticsDialog.h"
+
+namespace {
+    QTableWidgetItem* numberItem(double value, int decimals = 0) {
+        QTableWidgetItem* item = new QTableWidgetItem(QString::number(value, 'f', decimals));
+        item->setTextAlignment(Qt::AlignRight);
+        return item;
+    }
+
+    QTableWidget* reportTable(const QStringList& headers, int stretchColumn) {
+        QTableWidget* table = new QTableWidget(0, headers.size());
+        table->setHorizontalHeaderLabels(headers);
+        table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+        table->setSelectionBehavior(QAbstractItemView::SelectRows);
+        table->horizontalHeader()->setSectionResizeMode(stretchColumn, QHeaderView::Stretch);
+        return table;
+    }
+}
+
+AnalyticsDialog::AnalyticsDialog(QWidget *parent) : QDialog(parent) {
+    setWindowTitle("HinLIBS Circulation Analytics");
+    resize(900, 500);
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+
+    summaryLabel = new QLabel();
+    layout->addWidget(summaryLabel);
+
+    topTable = reportTable({"Title", "Author", "Format", "Borrows", "Copies", "Loans per Copy",
+                            "Holds Placed", "In Queue"}, 0);
+    formatTable = reportTable({"Format", "Items", "Copies", "Borrows", "Loans per Copy"}, 0);
+    deweyTable = reportTable({"Dewey Class", "Items", "Copies", "Borrows", "Loans per Copy"}, 0);
+
+    QTabWidget *tabs = new QTabWidget();
+    tabs->addTab(topTable, "Most Borrowed");
+    tabs->addTab(formatTable, "By Format");
+    tabs->addTab(deweyTable, "By Dewey Class");
+    layout->addWidget(tabs);
+
+    QHBoxLayout *buttonLayout = new QHBoxLayout();
+    topSpin = new QSpinBox();
+    topSpin->setRange(5, 500);
+    topSpin->setValue(25);
+    QPushButton *refreshButton = new QPushButton("Refresh");
+    QDialogButtonBox *buttonBox = new QDialogButtonBox(QDialogButtonBox::Close);
+
+    buttonLayout->addWidget(new QLabel("Most borrowed:"));
+    buttonLayout->addWidget(topSpin);
+    buttonLayout->addStretch();
+    buttonLayout->addWidget(refreshButton);
+    buttonLayout->addWidget(buttonBox);
+    layout->addLayout(buttonLayout);
+
+    connect(refreshButton, &QPushButton::clicked, this, &AnalyticsDialog::refreshReport);
+    connect(buttonBox, &QDialogButtonBox::rejected, this, &QDialog::reject);
+
+    refreshReport();
+}
+
+void AnalyticsDialog::refreshReport() {
+    IDataRepository::CirculationReport report =
+        IDataRepository::getInstance().getCirculationReport(topSpin->value());
+
+    summaryLabel->setText(QString("Holds filled: %1 (average wait %2 days)    "
+                                  "Queue length p50 / p90 / p99 / max: %3 / %4 / %5 / %6")
+                              .arg(report.holdsFilled)
+                              .arg(report.averageHoldWaitDays(), 0, 'f', 1)
+                              .arg(report.queueDepthPercentile(50))
+                              .arg(report.queueDepthPercentile(90))
+                              .arg(report.queueDepthPercentile(99))
+                              .arg(report.queueDepthPercentile(100)));
+
+    topTable->setRowCount(int(report.topBorrowed.size()));
+    int row = 0;
+    for (const auto& item : report.topBorrowed) {
+        double perCopy = item.totalCopies > 0 ? double(item.borrowCount) / item.totalCopies : 0.0;
+        topTable->setItem(row, 0, new QTableWidgetItem(item.title));
+        topTable->setItem(row, 1, new QTableWidgetItem(item.author));
+        topTable->setItem(row, 2, new QTableWidgetItem(item.itemType));
+        topTable->setItem(row, 3, numberItem(item.borrowCount));
+        topTable->setItem(row, 4, numberItem(item.totalCopies));
+        topTable->setItem(row, 5, numberItem(perCopy, 1));
+        topTable->setItem(row, 6, numberItem(item.holdsPlaced));
+        topTable->setItem(row, 7, numberItem(item.holdCount));
+        row++;
+    }
+
+    fillTurnover(formatTable, report.byFormat);
+    fillTurnover(deweyTable, report.byDeweyClass);
+}
+
+void AnalyticsDialog::fillTurnover(QTableWidget* table, const std::vector<IDataRepository::GroupTurnover>& rows) {
+    table->setRowCount(int(rows.size()));
+    int row = 0;
+    for (const auto& group : rows) {
+        table->setItem(row, 0, new QTableWidgetItem(group.group));
+        table->setItem(row, 1, numberItem(group.items));
+        table->setItem(row, 2, numberItem(group.copies));
+        table->setItem(row, 3, numberItem(group.borrowCount));
+        table->setItem(row, 4, numberItem(group.turnover(), 2));
+        row++;
+    }
+}
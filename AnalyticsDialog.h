@@ -0,0 +1,68 @@
+#ifndef ANALYTICSDIALOG_H
+#define ANALYTICSDIALOG_H
+
+#include <QDialog>
+#include <QTableWidget>
+#include <QTabWidget>
+#include <QLabel>
+#include <QPushButton>
+#include <QSpinBox>
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include "IDataRepository.h"
+
+/*
+    AnalyticsDialog Class:
+    Librarian dashboard for circulation: which items to buy more copies of, which
+    formats and subjects circulate, how long patrons wait for holds. Everything is
+    read from the per-item aggregates that borrows and holds maintain, so opening it
+    costs the same on a library with ten million loans as on a new one.
+
+    UI Design:
+    - Summary line: holds filled, average hold wait, queue depth p50 / p90 / p99 / max
+    - "Most Borrowed" tab: top N items with borrows, copies, loans per copy, holds placed
+      and current queue length
+    - "By Format" and "By Dewey Class" tabs: items, copies, borrows and turnover per group
+    - Spin box for N and a refresh button
+
+    Data Members:
+      - QLabel* summaryLabel: Hold wait and queue depth figures
+      - QSpinBox* topSpin: Length of the most-borrowed list
+      - QTableWidget* topTable / formatTable / deweyTable: Report tables
+
+    Member Functions:
+      Public:
+        - AnalyticsDialog(): Builds the dialog and loads the report
+
+      Private Slots:
+        - refreshReport(): Reloads the report from the repository
+
+      Private:
+        - fillTurnover(): Fills a turnover table
+*/
+class AnalyticsDialog : public QDialog {
+    Q_OBJECT
+
+public:
+    /*
+        Function: AnalyticsDialog
+        Purpose: Constructs the analytics dialog and fills it with the current report
+        Parameters:
+          in: QWidget* parent - Parent widget for modal behavior (optional)
+    */
+    AnalyticsDialog(QWidget *parent = nullptr);
+
+private slots:
+    void refreshReport();
+
+private:
+    QLabel *summaryLabel;
+    QSpinBox *topSpin;
+    QTableWidget *topTable;
+    QTableWidget *formatTable;
+    QTableWidget *deweyTable;
+
+    static void fillTurnover(QTableWidget* table, const std::vector<IDataRepository::GroupTurnover>& rows);
+};
+
+#endif
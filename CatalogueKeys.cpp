@@ -0,0 +1,106 @@
+#include "CatalogueKeys.h"
+
+namespace {
+    // EAN-13 check digit of the first twelve digits: weights alternate 1 and 3
+    int eanCheckDigit(const QString& digits) {
+        int sum = 0;
+        for (int i = 0; i < 12; ++i) {
+            sum += digits[i].digitValue() * (i % 2 == 0 ? 1 : 3);
+        }
+        return (10 - sum % 10) % 10;
+    }
+}
+
+int CatalogueKeys::deweyKey(const QString& deweyDecimal) {
+    // Segmentation marks ("641.5/973", "641.5'973") are not part of the number's value
+    QString text = deweyDecimal.trimmed();
+    text.remove('/').remove('\'');
+
+    int pos = 0;
+    int whole = 0;
+    while (pos < text.size() && text[pos].isDigit()) {
+        if (pos == 3) return -1; // Classes have at most three digits
+        whole = whole * 10 + text[pos].digitValue();
+        pos++;
+    }
+    if (pos == 0) return -1;
+
+    int fraction = 0;
+    int scale = DEWEY_SCALE;
+    if (pos < text.size() && text[pos] == '.') {
+        pos++;
+        while (pos < text.size() && text[pos].isDigit()) {
+            if (scale > 1) {
+                scale /= 10;
+                fraction += text[pos].digitValue() * scale;
+            }
+            pos++;
+        }
+    }
+
+    // The number must end the text or be followed by a separator (Cutter number etc.)
+    if (pos < text.size() && !text[pos].isSpace()) return -1;
+
+    return whole * DEWEY_SCALE + fraction;
+}
+
+int CatalogueKeys::deweyUpperKey(const QString& deweyDecimal) {
+    int key = deweyKey(deweyDecimal);
+    if (key < 0) return -1;
+
+    // Each decimal typed narrows the range tenfold
+    QString text = deweyDecimal.trimmed();
+    text.remove('/').remove('\'');
+    int point = text.indexOf('.');
+    int decimals = 0;
+    for (int pos = point + 1; point >= 0 && pos < text.size() && text[pos].isDigit(); ++pos) {
+        decimals++;
+    }
+
+    int span = DEWEY_SCALE;
+    for (int i = 0; i < decimals && span > 1; ++i) span /= 10;
+    return key + span - 1;
+}
+
+QString CatalogueKeys::deweyText(int key) {
+    QString text = QString("%1").arg(key / DEWEY_SCALE, 3, 10, QChar('0'));
+    int fraction = key % DEWEY_SCALE;
+    if (fraction == 0) return text;
+
+    QString digits = QString("%1").arg(fraction, 6, 10, QChar('0'));
+    while (digits.endsWith('0')) digits.chop(1);
+    return text + "." + digits;
+}
+
+qint64 CatalogueKeys::isbnKey(const QString& isbn) {
+    QString digits;
+    for (QChar c : isbn) {
+        if (c == '-' || c.isSpace()) continue;
+        digits += c.toUpper();
+    }
+
+    if (digits.size() == 10) {
+        // ISBN-10: weights 10 down to 1, the check digit may be X (ten)
+        int sum = 0;
+        for (int i = 0; i < 10; ++i) {
+            int value;
+            if (digits[i].isDigit()) value = digits[i].digitValue();
+            else if (i == 9 && digits[i] == 'X') value = 10;
+            else return -1;
+            sum += value * (10 - i);
+        }
+        if (sum % 11 != 0) return -1;
+
+        // Same book as 978 + the first nine digits, with its own check digit
+        digits = "978" + digits.left(9);
+        return (digits + QString::number(eanCheckDigit(digits))).toLongLong();
+    }
+
+    if (digits.size() != 13) return -1;
+    for (QChar c : digits) {
+        if (!c.isDigit()) return -1;
+    }
+    if (!digits.startsWith("978") && !digits.startsWith("979")) return -1; // Other EAN-13s are not books
+    if (digits[12].digitValue() != eanCheckDigit(digits)) return -1;
+    return digits.toLongLong();
+}
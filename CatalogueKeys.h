@@ -0,0 +1,79 @@
+#ifndef CATALOGUEKEYS_H
+#define CATALOGUEKEYS_H
+
+#include <QString>
+
+/*
+    CatalogueKeys Class:
+    Turns the identifiers librarians type or scan (Dewey class numbers, ISBNs) into integer keys
+    that SQLite can index and compare. Keys are computed once, when an item is
+    stored, so range queries compare integers instead of parsing strings.
+
+    Dewey keys:
+      A class number "DDD.dddddd" becomes DDD * DEWEY_SCALE + dddddd (fraction
+      padded to six digits), so "500" < "510.5" < "510.52" < "599.999" in key order
+      exactly as on the shelf. Digits past the sixth decimal are ignored (items that
+      share the first six sort by id). Segmentation marks (/ and ') are dropped and
+      anything after the number and a space (a Cutter number, "FIT", ...) is ignored. The largest key, 999999999, fits in an int.
+
+    ISBN keys:
+      The 13 digits of the ISBN-13 as one 64-bit integer, so "978-0-7432-7356-5",
+      "9780743273565" and the ISBN-10 "0-7432-7356-7" all have the key 9780743273565
+      and one index lookup finds the item whichever form was typed or scanned (the
+      EAN-13 barcode on a book is its ISBN-13). Hyphens and spaces are ignored; the
+      check digit must be correct, so a mistyped or misread ISBN has no key rather
+      than the key of some other book.
+
+    Data Members: None (static class with no instance data)
+
+    Member Functions:
+      - deweyKey(): Sort key of a Dewey class number
+      - deweyUpperKey(): Last key of everything a class number covers
+      - deweyText(): Class number of a key, for display
+      - isbnKey(): Lookup key of an ISBN-10 or ISBN-13
+*/
+class CatalogueKeys {
+public:
+    static const int DEWEY_SCALE = 1000000;
+    static const int DEWEY_MAX = 1000 * DEWEY_SCALE - 1;
+
+    /*
+        Function: deweyKey
+        Purpose: Parses a Dewey class number into its shelf-order key
+        Parameters:
+          in: const QString& deweyDecimal - Class number, e.g. "823.914" or "500"
+        Return: int - Key from 0 to DEWEY_MAX, or -1 if the text is not a class number
+    */
+    static int deweyKey(const QString& deweyDecimal);
+
+    /*
+        Function: deweyUpperKey
+        Purpose: Largest key of the numbers a typed class number stands for, as the
+                 inclusive end of a range: "599" covers 599 to 599.999999, "599.9"
+                 covers 599.9 to 599.999999, "510.52" covers 510.52 to 510.529999
+        Parameters:
+          in: const QString& deweyDecimal - Class number
+        Return: int - Key, or -1 if the text is not a class number
+    */
+    static int deweyUpperKey(const QString& deweyDecimal);
+
+    /*
+        Function: deweyText
+        Purpose: Formats a key as a class number without trailing zeros ("510.5")
+        Parameters:
+          in: int key - Key from deweyKey()
+        Return: QString - Class number
+    */
+    static QString deweyText(int key);
+
+    /*
+        Function: isbnKey
+        Purpose: Validates an ISBN and returns its ISBN-13 digits as an integer
+        Parameters:
+          in: const QString& isbn - ISBN-10 or ISBN-13, with or without hyphens
+        Return: qint64 - Key, or -1 if the text is not an ISBN or its check digit is wrong
+    */
+    static qint64 isbnKey(const QString& isbn);
+};
+
+#endif
@@ -0,0 +1,195 @@
+#include <QDebug>
+#include <QFileInfo>
+#include <QHash>
+#include <QSaveFile>
+#include <algorithm>
+#include <cstring>
+#include "CatalogueSnapshot.h"
+
+namespace {
+    const char MAGIC[4] = {'H', 'L', 'C', 'S'};
+    const quint32 BYTE_ORDER_MARK = 0x01020304;
+}
+
+CatalogueSnapshot::CatalogueSnapshot(const QString& path)
+    : file(path), data(nullptr), header(nullptr), records(nullptr), pool(nullptr) {}
+
+QString CatalogueSnapshot::pathFor(const QString& databasePath) {
+    if (databasePath.isEmpty() || databasePath == ":memory:") return QString();
+    return databasePath + ".catalogue";
+}
+
+std::shared_ptr<CatalogueSnapshot> CatalogueSnapshot::open(const QString& path) {
+    if (path.isEmpty() || !QFileInfo::exists(path)) return nullptr;
+
+    std::shared_ptr<CatalogueSnapshot> snapshot(new CatalogueSnapshot(path));
+    if (!snapshot->map()) {
+        qDebug() << "Ignoring catalogue snapshot" << path;
+        return nullptr;
+    }
+    return snapshot;
+}
+
+bool CatalogueSnapshot::map() {
+    if (!file.open(QIODevice::ReadOnly)) return false;
+
+    qint64 size = file.size();
+    if (size < qint64(sizeof(Header))) return false;
+
+    data = file.map(0, size);
+    if (!data) return false;
+
+    header = reinterpret_cast<const Header*>(data);
+    if (std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0 ||
+        header->formatVersion != FORMAT_VERSION ||
+        header->byteOrder != BYTE_ORDER_MARK ||
+        header->recordSize != sizeof(Record)) {
+        return false;
+    }
+
+    // Both sections must lie inside the file, and records must be aligned for in-place reads
+    qint64 recordsEnd = qint64(header->recordsOffset) + qint64(header->itemCount) * qint64(sizeof(Record));
+    qint64 poolEnd = qint64(header->poolOffset) + qint64(header->poolSize);
+    if (header->recordsOffset % alignof(Record) != 0 || recordsEnd > size || poolEnd > size) {
+        return false;
+    }
+
+    records = reinterpret_cast<const Record*>(data + header->recordsOffset);
+    pool = reinterpret_cast<const char*>(data + header->poolOffset);
+    return true;
+}
+
+qint64 CatalogueSnapshot::getDatabaseId() const {
+    return header->databaseId;
+}
+
+qint64 CatalogueSnapshot::getGeneration() const {
+    return header->generation;
+}
+
+qint64 CatalogueSnapshot::getCirculation() const {
+    return header->circulation;
+}
+
+int CatalogueSnapshot::count() const {
+    return int(header->itemCount);
+}
+
+int CatalogueSnapshot::find(int itemId) const {
+    const Record* end = records + header->itemCount;
+    const Record* found = std::lower_bound(records, end, itemId,
+                                           [](const Record& record, int id) { return record.id < id; });
+    if (found == end || found->id != itemId) return -1;
+    return int(found - records);
+}
+
+std::string CatalogueSnapshot::text(const TextRef& ref) const {
+    // Refs are not checked at open(); a damaged one reads as empty rather than past the pool
+    if (quint64(ref.offset) + ref.length > header->poolSize) return std::string();
+    return std::string(pool + ref.offset, ref.length);
+}
+
+void CatalogueSnapshot::row(int index, ItemRow& row) const {
+    const Record& record = records[index];
+
+    row.id = record.id;
+    row.itemType = text(record.itemType);
+    row.title = text(record.title);
+    row.author = text(record.author);
+    row.deweyDecimal = text(record.deweyDecimal);
+    row.isbn = text(record.isbn);
+    row.genre = text(record.genre);
+    row.rating = text(record.rating);
+    row.publicationDate = text(record.publicationDate);
+    row.condition = text(record.condition);
+    row.publicationYear = record.publicationYear;
+    row.issueNumber = record.issueNumber;
+    row.totalCopies = record.totalCopies;
+    row.availableCopies = record.availableCopies;
+    row.holdCount = record.holdCount;
+    row.isAvailable = record.isAvailable != 0;
+}
+
+// === WRITER ===
+
+void CatalogueSnapshot::Writer::add(const ItemRow& row) {
+    rows.push_back(row);
+}
+
+bool CatalogueSnapshot::Writer::save(const QString& path, qint64 databaseId, qint64 generation,
+                                     qint64 circulation) {
+    // Records are kept in ID order: find() binary-searches them
+    std::sort(rows.begin(), rows.end(),
+              [](const ItemRow& a, const ItemRow& b) { return a.id < b.id; });
+
+    QByteArray pool;
+    QHash<QByteArray, quint32> pooled; // Text to its pool offset
+    auto intern = [&pool, &pooled](const std::string& value) {
+        TextRef ref = {0, quint32(value.size())};
+        if (value.empty()) return ref;
+
+        QByteArray bytes(value.data(), int(value.size()));
+        auto existing = pooled.constFind(bytes);
+        if (existing != pooled.constEnd()) {
+            ref.offset = existing.value();
+        } else {
+            ref.offset = quint32(pool.size());
+            pooled.insert(bytes, ref.offset);
+            pool.append(bytes);
+        }
+        return ref;
+    };
+
+    std::vector<Record> records;
+    records.reserve(rows.size());
+    for (const ItemRow& row : rows) {
+        Record record;
+        record.id = row.id;
+        record.publicationYear = row.publicationYear;
+        record.issueNumber = row.issueNumber;
+        record.totalCopies = row.totalCopies;
+        record.availableCopies = row.availableCopies;
+        record.holdCount = row.holdCount;
+        record.isAvailable = row.isAvailable ? 1 : 0;
+        record.itemType = intern(row.itemType);
+        record.title = intern(row.title);
+        record.author = intern(row.author);
+        record.deweyDecimal = intern(row.deweyDecimal);
+        record.isbn = intern(row.isbn);
+        record.genre = intern(row.genre);
+        record.rating = intern(row.rating);
+        record.publicationDate = intern(row.publicationDate);
+        record.condition = intern(row.condition);
+        records.push_back(record);
+    }
+
+    Header header;
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.formatVersion = FORMAT_VERSION;
+    header.byteOrder = BYTE_ORDER_MARK;
+    header.recordSize = sizeof(Record);
+    header.generation = generation;
+    header.circulation = circulation;
+    header.databaseId = databaseId;
+    header.itemCount = quint32(records.size());
+    header.recordsOffset = sizeof(Header);
+    header.poolOffset = quint32(sizeof(Header) + records.size() * sizeof(Record));
+    header.poolSize = quint32(pool.size());
+
+    QSaveFile out(path);
+    if (!out.open(QIODevice::WriteOnly)) {
+        qDebug() << "Cannot write catalogue snapshot" << path << ":" << out.errorString();
+        return false;
+    }
+    out.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+    if (!records.empty()) {
+        out.write(reinterpret_cast<const char*>(records.data()), qint64(records.size() * sizeof(Record)));
+    }
+    out.write(pool);
+
+    if (!out.commit()) {
+        qDebug() << "Cannot write catalogue snapshot" << path << ":" << out.errorString();
+        return false;
+    }
+    return true;
+}
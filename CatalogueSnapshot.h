@@ -0,0 +1,210 @@
+#ifndef CATALOGUESNAPSHOT_H
+#define CATALOGUESNAPSHOT_H
+
+#include <QFile>
+#include <QString>
+#include <memory>
+#include <string>
+#include <vector>
+
+/*
+    CatalogueSnapshot Class:
+    Read-only copy of catalogue_items in a file next to the database
+    (hinlibs.db.catalogue), memory-mapped with QFile::map() and read in place.
+    Lets a launch (and any catalogue read while nothing has changed) skip the
+    SELECT over catalogue_items and the per-row QVariant conversions: items are
+    built straight from the mapped bytes, and an item is found by ID with a binary
+    search over the mapped records.
+
+    File layout (native byte order; a file written on another architecture is
+    rejected, not converted):
+      - Header: magic "HLCS", format version, byte order mark, record size, the
+        database's identity, catalogue and circulation generations, item count, and
+        the offsets of the two sections below
+      - Records: one fixed-width Record per item, in ascending ID order (the ID
+        index), holding the numeric columns and TextRefs into the pool
+      - String pool: UTF-8 text of every string column, each distinct value once
+        (authors, formats, genres and conditions repeat across many items)
+
+    The snapshot is only valid for the catalogue generation it was written at:
+    catalogue_generation is bumped by triggers on every change to what
+    catalogue_items describes, and DatabaseManager compares the two before every
+    read. Generations alone do not tell databases apart (a file rebuilt from
+    scratch, or another file moved into place, soon reaches the same count), so
+    the header also carries the random identity stored next to the generation
+    when the database was created, and both must match. A stale or damaged file is
+    simply not used.
+
+    Copy and hold counters change with every borrow, return and hold, which do not
+    move the catalogue generation. The records carry them as of the circulation
+    generation in the header; DatabaseManager replaces them with the current
+    values of the items logged in circulation_changes since, through the index on
+    that log.
+
+    Data Members:
+      - QFile file: The open snapshot file (keeps the mapping alive)
+      - const uchar* data: Start of the mapping
+      - const Header* header / const Record* records / const char* pool: Sections
+
+    Member Functions:
+      Public:
+        - pathFor(): Snapshot file that belongs to a database file
+        - open(): Maps and validates a snapshot file
+        - getDatabaseId() / getGeneration() / getCirculation() / count(): Header fields
+        - find(): Record index of an item ID
+        - row(): One item's columns
+      Writer (nested class):
+        - add(): Appends one item
+        - save(): Writes the file (atomically replacing the old one)
+*/
+class CatalogueSnapshot {
+public:
+    static const quint32 FORMAT_VERSION = 3;
+
+    /*
+        ItemRow Struct:
+        The catalogue_items columns an item is built from (see
+        DatabaseManager::createItemFromRow()); strings are UTF-8
+    */
+    struct ItemRow {
+        int id = -1;
+        std::string itemType;
+        std::string title;
+        std::string author;
+        std::string deweyDecimal;
+        std::string isbn;
+        std::string genre;
+        std::string rating;
+        std::string publicationDate;
+        std::string condition;
+        int publicationYear = 0;
+        int issueNumber = 0;
+        int totalCopies = 0;
+        int availableCopies = 0;
+        int holdCount = 0;
+        bool isAvailable = true;
+    };
+
+    /*
+        Writer Class:
+        Collects rows and writes a snapshot file
+    */
+    class Writer {
+    public:
+        void add(const ItemRow& row);
+
+        /*
+            Function: save
+            Purpose: Writes the snapshot through QSaveFile, so readers never see a
+                     partly written file
+            Parameters:
+              in: const QString& path - Snapshot file
+              in: qint64 databaseId - Identity of the database the rows were read from
+              in: qint64 generation - Catalogue generation the rows were read at
+              in: qint64 circulation - Circulation generation the rows' counters were read at
+            Return: bool - True if the file was written
+        */
+        bool save(const QString& path, qint64 databaseId, qint64 generation, qint64 circulation);
+
+    private:
+        std::vector<ItemRow> rows;
+    };
+
+    /*
+        Function: pathFor
+        Purpose: Snapshot file of a database file
+        Parameters:
+          in: const QString& databasePath - SQLite file
+        Return: QString - Path of its snapshot (empty for in-memory databases)
+    */
+    static QString pathFor(const QString& databasePath);
+
+    /*
+        Function: open
+        Purpose: Maps a snapshot file and checks its header and section bounds
+        Parameters:
+          in: const QString& path - Snapshot file
+        Return: std::shared_ptr<CatalogueSnapshot> - The snapshot, or nullptr if the file
+                is missing, from another format or architecture, or truncated
+    */
+    static std::shared_ptr<CatalogueSnapshot> open(const QString& path);
+
+    qint64 getDatabaseId() const;
+    qint64 getGeneration() const;
+    qint64 getCirculation() const;
+    int count() const;
+
+    /*
+        Function: find
+        Purpose: Locates an item by ID (binary search over the mapped records)
+        Parameters:
+          in: int itemId - Database ID
+        Return: int - Record index, or -1 if the item is not in the snapshot
+    */
+    int find(int itemId) const;
+
+    /*
+        Function: row
+        Purpose: Reads one item's columns from the mapping
+        Parameters:
+          in: int index - Record index, 0 <= index < count()
+          out: ItemRow& row - Columns
+    */
+    void row(int index, ItemRow& row) const;
+
+private:
+    /*
+        TextRef / Header / Record Structs:
+        On-disk layout (see the class description)
+    */
+    struct TextRef {
+        quint32 offset;
+        quint32 length;
+    };
+
+    struct Header {
+        char magic[4];
+        quint32 formatVersion;
+        quint32 byteOrder;
+        quint32 recordSize;
+        qint64 generation;
+        qint64 circulation;
+        qint64 databaseId;
+        quint32 itemCount;
+        quint32 recordsOffset;
+        quint32 poolOffset;
+        quint32 poolSize;
+    };
+
+    struct Record {
+        qint32 id;
+        qint32 publicationYear;
+        qint32 issueNumber;
+        qint32 totalCopies;
+        qint32 availableCopies;
+        qint32 holdCount;
+        quint32 isAvailable;
+        TextRef itemType;
+        TextRef title;
+        TextRef author;
+        TextRef deweyDecimal;
+        TextRef isbn;
+        TextRef genre;
+        TextRef rating;
+        TextRef publicationDate;
+        TextRef condition;
+    };
+
+    QFile file;
+    const uchar* data;
+    const Header* header;
+    const Record* records;
+    const char* pool;
+
+    explicit CatalogueSnapshot(const QString& path);
+
+    bool map();
+    std::string text(const TextRef& ref) const;
+};
+
+#endif
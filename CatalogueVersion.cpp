@@ -0,0 +1,110 @@
+#include <algorithm>
+#include "CatalogueVersion.h"
+
+std::shared_ptr<const CatalogueVersion> CatalogueVersion::build(std::vector<Item>& items, qint64 generation,
+                                                                qint64 circulation) {
+    std::shared_ptr<CatalogueVersion> version(new CatalogueVersion());
+    version->generation = generation;
+    version->circulation = circulation;
+    version->itemCount = int(items.size());
+
+    for (size_t start = 0; start < items.size(); start += CHUNK_ITEMS) {
+        size_t end = std::min(items.size(), start + size_t(CHUNK_ITEMS));
+        std::shared_ptr<Chunk> chunk(new Chunk());
+        chunk->reserve(end - start);
+        for (size_t i = start; i < end; ++i) chunk->push_back(std::move(items[i]));
+        version->chunks.push_back(chunk);
+    }
+    items.clear();
+    return version;
+}
+
+size_t CatalogueVersion::chunkFor(int itemId) const {
+    // First chunk whose last item is at or past the ID
+    auto found = std::lower_bound(chunks.begin(), chunks.end(), itemId,
+                                  [](const std::shared_ptr<const Chunk>& chunk, int id) {
+                                      return chunk->back()->getId() < id;
+                                  });
+    if (found == chunks.end()) return chunks.empty() ? 0 : chunks.size() - 1;
+    return size_t(found - chunks.begin());
+}
+
+CatalogueVersion::Item CatalogueVersion::find(int itemId) const {
+    if (chunks.empty()) return nullptr;
+
+    const Chunk& chunk = *chunks[chunkFor(itemId)];
+    auto found = std::lower_bound(chunk.begin(), chunk.end(), itemId,
+                                  [](const Item& item, int id) { return item->getId() < id; });
+    if (found == chunk.end() || (*found)->getId() != itemId) return nullptr;
+    return *found;
+}
+
+std::shared_ptr<const CatalogueVersion> CatalogueVersion::withChanges(const std::vector<Item>& changed,
+                                                                      const std::vector<int>& removed,
+                                                                      qint64 generation,
+                                                                      qint64 circulation) const {
+    std::shared_ptr<CatalogueVersion> next(new CatalogueVersion());
+    next->generation = generation;
+    next->circulation = circulation;
+    next->chunks = chunks; // Shares every chunk; touched ones are replaced below
+
+    if (next->chunks.empty() && !changed.empty()) {
+        next->chunks.push_back(std::make_shared<Chunk>());
+    }
+
+    // Copies of the chunks being edited, by chunk index
+    std::vector<std::shared_ptr<Chunk>> copies(next->chunks.size());
+    auto editable = [&next, &copies](size_t index) -> Chunk& {
+        if (!copies[index]) {
+            copies[index] = std::make_shared<Chunk>(*next->chunks[index]);
+        }
+        return *copies[index];
+    };
+    auto position = [](Chunk& chunk, int id) {
+        return std::lower_bound(chunk.begin(), chunk.end(), id,
+                                [](const Item& item, int itemId) { return item->getId() < itemId; });
+    };
+
+    // Chunk boundaries are those of this version, so chunkFor() on it stays valid while editing
+    for (int id : removed) {
+        if (chunks.empty()) break;
+        Chunk& chunk = editable(chunkFor(id));
+        auto found = position(chunk, id);
+        if (found != chunk.end() && (*found)->getId() == id) chunk.erase(found);
+    }
+    for (const Item& item : changed) {
+        size_t index = chunks.empty() ? 0 : chunkFor(item->getId());
+        Chunk& chunk = editable(index);
+        auto found = position(chunk, item->getId());
+        if (found != chunk.end() && (*found)->getId() == item->getId()) {
+            *found = item;
+        } else {
+            chunk.insert(found, item);
+        }
+    }
+
+    // Publish the edited chunks: drop emptied ones, split ones that grew past twice the size
+    std::vector<std::shared_ptr<const Chunk>> merged;
+    merged.reserve(next->chunks.size() + 1);
+    for (size_t i = 0; i < next->chunks.size(); ++i) {
+        if (!copies[i]) {
+            merged.push_back(next->chunks[i]);
+            continue;
+        }
+        Chunk& chunk = *copies[i];
+        if (chunk.size() <= size_t(2 * CHUNK_ITEMS)) {
+            if (!chunk.empty()) merged.push_back(copies[i]);
+            continue;
+        }
+        for (size_t start = 0; start < chunk.size(); start += CHUNK_ITEMS) {
+            size_t end = std::min(chunk.size(), start + size_t(CHUNK_ITEMS));
+            merged.push_back(std::make_shared<Chunk>(chunk.begin() + start, chunk.begin() + end));
+        }
+    }
+    next->chunks.swap(merged);
+
+    for (const std::shared_ptr<const Chunk>& chunk : next->chunks) {
+        next->itemCount += int(chunk->size());
+    }
+    return next;
+}
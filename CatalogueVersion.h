@@ -0,0 +1,112 @@
+#ifndef CATALOGUEVERSION_H
+#define CATALOGUEVERSION_H
+
+#include <QtGlobal>
+#include <memory>
+#include <vector>
+#include "LibraryItem.h"
+
+/*
+    CatalogueVersion Class:
+    Immutable in-memory copy of the catalogue at one catalogue and circulation
+    generation (the latter covers the items' copy and hold counters), shared by
+    every thread that reads it (GUI, reports, server request threads). Nothing in a
+    published version ever changes, so readers need no lock: a reader keeps the
+    std::shared_ptr it was handed and reads that version for as long as it likes,
+    and the version is freed when the last reader lets go of it.
+
+    Items are kept in ID order in chunks of up to CHUNK_ITEMS items. A newer version
+    is made by withChanges(): only the chunks holding changed items are copied; all
+    other chunks, and every unchanged item, are shared with the older version. A
+    borrow therefore costs one chunk copy plus the chunk list, not a catalogue copy.
+
+    DatabaseManager::getCatalogueVersion() builds, refreshes and publishes versions.
+
+    Data Members:
+      - std::vector<std::shared_ptr<const Chunk>> chunks: Items in ID order
+      - qint64 generation: Catalogue generation the version reflects
+      - qint64 circulation: Circulation generation its counters reflect
+      - int itemCount: Items in all chunks
+
+    Member Functions:
+      Public:
+        - build(): Version holding the given items
+        - withChanges(): Newer version with items replaced, added or removed
+        - getGeneration() / getCirculation() / count(): Version properties
+        - find(): Item by ID
+        - forEach(): Visits every item in ID order
+*/
+class CatalogueVersion {
+public:
+    typedef std::shared_ptr<const LibraryItem> Item;
+
+    static const int CHUNK_ITEMS = 1024;
+
+    /*
+        Function: build
+        Purpose: Makes a version from a complete catalogue
+        Parameters:
+          in: std::vector<Item>& items - Every item, in ascending ID order (moved from)
+          in: qint64 generation - Catalogue generation the items were read at
+          in: qint64 circulation - Circulation generation the items were read at
+        Return: std::shared_ptr<const CatalogueVersion> - The version
+    */
+    static std::shared_ptr<const CatalogueVersion> build(std::vector<Item>& items, qint64 generation,
+                                                         qint64 circulation);
+
+    /*
+        Function: withChanges
+        Purpose: Makes the next version, sharing every chunk no change falls into
+        Parameters:
+          in: const std::vector<Item>& changed - Current rows of changed items, in ID
+              order (replacing items with the same ID, or added)
+          in: const std::vector<int>& removed - IDs of removed items, in ascending order
+          in: qint64 generation - Catalogue generation the changes were read at
+          in: qint64 circulation - Circulation generation the changes were read at
+        Return: std::shared_ptr<const CatalogueVersion> - The new version (this one is unchanged)
+    */
+    std::shared_ptr<const CatalogueVersion> withChanges(const std::vector<Item>& changed,
+                                                        const std::vector<int>& removed,
+                                                        qint64 generation, qint64 circulation) const;
+
+    qint64 getGeneration() const { return generation; }
+    qint64 getCirculation() const { return circulation; }
+    int count() const { return itemCount; }
+
+    /*
+        Function: find
+        Purpose: Looks an item up by ID (binary search over the chunks, then within one)
+        Parameters:
+          in: int itemId - Database ID
+        Return: Item - The item, or nullptr if the version has no such item
+    */
+    Item find(int itemId) const;
+
+    /*
+        Function: forEach
+        Purpose: Calls visit(const LibraryItem*) for every item, in ID order
+    */
+    template <class F>
+    void forEach(F visit) const {
+        for (const std::shared_ptr<const Chunk>& chunk : chunks) {
+            for (const Item& item : *chunk) visit(item.get());
+        }
+    }
+
+private:
+    typedef std::vector<Item> Chunk;
+
+    std::vector<std::shared_ptr<const Chunk>> chunks;
+    qint64 generation;
+    qint64 circulation;
+    int itemCount;
+
+    friend class CatalogueVersionTest; // Checks chunk boundaries and sharing
+
+    CatalogueVersion() : generation(-1), circulation(-1), itemCount(0) {}
+
+    // Index of the chunk an item ID belongs in (the last chunk for IDs past the end)
+    size_t chunkFor(int itemId) const;
+};
+
+#endif
@@ -1,27 +1,43 @@
 #include <QDebug>
 #include <QDate>
-#include <QFileInfo>
-#include <QDir>
 #include "DatabaseInitializer.h"
+#include "CatalogueKeys.h"
 
 bool DatabaseInitializer::initializeDatabase(const QString& databasePath) {
-    // Use absolute path to be sure
-    QString absolutePath = QDir::current().absoluteFilePath(databasePath);
-    QFileInfo dbFile(absolutePath);
-    bool databaseExists = dbFile.exists();
+    bool ok = false;
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", "database_initializer");
+        db.setDatabaseName(databasePath);
 
-    // Set up database connection
-    QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE");
-    db.setDatabaseName(databasePath);
+        if (!db.open()) {
+            qDebug() << "Error opening database:" << db.lastError().text();
+        } else {
+            ok = initializeDatabase(db);
+            db.close();
+        }
+    }
+    QSqlDatabase::removeDatabase("database_initializer");
+    return ok;
+}
 
-    if (!db.open()) {
-        qDebug() << "Error opening database:" << db.lastError().text();
+bool DatabaseInitializer::initializeDatabase(QSqlDatabase& db, bool fullCheck) {
+    QSqlQuery query(db);
+    if (!query.exec("PRAGMA user_version") || !query.next()) {
+        qDebug() << "Error reading schema version:" << query.lastError().text();
         return false;
     }
+    int version = query.value(0).toInt();
+    if (version == SCHEMA_VERSION && !fullCheck) {
+        return true; // Set up by this version already
+    }
+
+    // A file SQLite has just created has no tables yet
+    query.exec("SELECT COUNT(*) FROM sqlite_master WHERE type = 'table' AND name = 'users'");
+    bool databaseExists = query.next() && query.value(0).toInt() > 0;
+    query.finish();
 
     // Always create tables (they won't be recreated if they exist)
     if (!createTables(db)) {
-        db.close();
         return false;
     }
 
@@ -29,19 +45,51 @@ bool DatabaseInitializer::initializeDatabase(const QString& databasePath) {
     if (!databaseExists) {
         qDebug() << "New database detected - populating with default data";
         if (!populateDefaultData(db)) {
-            db.close();
             return false;
         }
     } else {
-        qDebug() << "Existing database found - skipping default data population";
+        qDebug() << "Existing database found (schema version" << version << ") - skipping default data population";
+    }
+
+    // Single-copy items from older databases (and the defaults above) become works with one copy
+    if (!createMissingCopies(db)) {
+        return false;
+    }
+
+    // Defaults and items from before dewey_key existed get their shelf keys
+    if (!createMissingKeys(db)) {
+        return false;
     }
 
-    db.close();
+    // Counters of new or migrated databases start out at zero; anything else found here
+    // means a write bypassed DatabaseManager
+    int drifted = checkCounters(db, true);
+    if (drifted < 0) {
+        return false;
+    }
+    if (drifted > 0) {
+        qDebug() << "Rebuilt" << drifted << "hold and loan counters";
+    }
+
+    // Borrow counts of databases from before item_stats are built here once
+    drifted = checkItemStats(db, true);
+    if (drifted < 0) {
+        return false;
+    }
+    if (drifted > 0) {
+        qDebug() << "Rebuilt circulation statistics of" << drifted << "items";
+    }
+
+    // Next startup takes the fast path
+    if (!query.exec(QString("PRAGMA user_version = %1").arg(SCHEMA_VERSION))) {
+        qDebug() << "Error stamping schema version:" << query.lastError().text();
+        return false;
+    }
     return true;
 }
 
 bool DatabaseInitializer::createTables(QSqlDatabase& db) {
-    QSqlQuery query;
+    QSqlQuery query(db);
 
     // Users table
     QString usersTableSQL =
@@ -50,7 +98,9 @@ bool DatabaseInitializer::createTables(QSqlDatabase& db) {
         "username TEXT UNIQUE NOT NULL, "
         "password TEXT DEFAULT '', "
         "role TEXT NOT NULL, "
-        "created_date TEXT DEFAULT CURRENT_TIMESTAMP"
+        "created_date TEXT DEFAULT CURRENT_TIMESTAMP, "
+        "active_loan_count INTEGER NOT NULL DEFAULT 0, "
+        "active_hold_count INTEGER NOT NULL DEFAULT 0"
         ");";
 
     if (!query.exec(usersTableSQL)) {
@@ -58,6 +108,18 @@ bool DatabaseInitializer::createTables(QSqlDatabase& db) {
         return false;
     }
 
+    // Account counters, maintained by loan and hold operations (see checkCounters())
+    if (!addColumnIfMissing(db, "users", "active_loan_count", "INTEGER NOT NULL DEFAULT 0") ||
+        !addColumnIfMissing(db, "users", "active_hold_count", "INTEGER NOT NULL DEFAULT 0")) {
+        return false;
+    }
+
+    // Patron lookups filter on role and range-scan on username
+    if (!query.exec("CREATE INDEX IF NOT EXISTS idx_users_role_username ON users(role, username);")) {
+        qDebug() << "Error creating users role index:" << query.lastError().text();
+        return false;
+    }
+
     // Catalogue items table
     QString catalogueTableSQL =
         "CREATE TABLE IF NOT EXISTS catalogue_items ("
@@ -66,7 +128,9 @@ bool DatabaseInitializer::createTables(QSqlDatabase& db) {
         "author TEXT NOT NULL, "
         "item_type TEXT NOT NULL, "
         "dewey_decimal TEXT, "
+        "dewey_key INTEGER, "
         "isbn TEXT, "
+        "isbn_key INTEGER, "
         "genre TEXT, "
         "rating TEXT, "
         "issue_number INTEGER, "
@@ -74,6 +138,9 @@ bool DatabaseInitializer::createTables(QSqlDatabase& db) {
         "publication_year INTEGER, "
         "condition TEXT DEFAULT 'Good', "
         "is_available BOOLEAN DEFAULT 1,"
+        "total_copies INTEGER NOT NULL DEFAULT 1, "
+        "available_copies INTEGER NOT NULL DEFAULT 1, "
+        "hold_count INTEGER NOT NULL DEFAULT 0, "
         "UNIQUE(title, author, publication_year)"
         ");";
 
@@ -82,6 +149,85 @@ bool DatabaseInitializer::createTables(QSqlDatabase& db) {
         return false;
     }
 
+    // Copy counters, maintained by every borrow and return so the list never counts loans
+    if (!addColumnIfMissing(db, "catalogue_items", "total_copies", "INTEGER NOT NULL DEFAULT 1") ||
+        !addColumnIfMissing(db, "catalogue_items", "available_copies", "INTEGER NOT NULL DEFAULT 1") ||
+        !addColumnIfMissing(db, "catalogue_items", "hold_count", "INTEGER NOT NULL DEFAULT 0")) {
+        return false;
+    }
+
+    // Shelf order: Dewey sort key (see CatalogueKeys), then id; non-fiction only
+    if (!addColumnIfMissing(db, "catalogue_items", "dewey_key", "INTEGER")) {
+        return false;
+    }
+    if (!query.exec("CREATE INDEX IF NOT EXISTS idx_items_dewey ON catalogue_items(dewey_key, id) "
+                    "WHERE dewey_key IS NOT NULL;")) {
+        qDebug() << "Error creating catalogue Dewey index:" << query.lastError().text();
+        return false;
+    }
+
+    // Scanned and typed ISBNs are looked up by their ISBN-13 key (see CatalogueKeys)
+    if (!addColumnIfMissing(db, "catalogue_items", "isbn_key", "INTEGER")) {
+        return false;
+    }
+    if (!query.exec("CREATE INDEX IF NOT EXISTS idx_items_isbn ON catalogue_items(isbn_key) "
+                    "WHERE isbn_key IS NOT NULL;")) {
+        qDebug() << "Error creating catalogue ISBN index:" << query.lastError().text();
+        return false;
+    }
+
+    // Queue depth report reads only the items that have a queue
+    if (!query.exec("CREATE INDEX IF NOT EXISTS idx_items_queued ON catalogue_items(hold_count) WHERE hold_count > 0;")) {
+        qDebug() << "Error creating catalogue queue index:" << query.lastError().text();
+        return false;
+    }
+
+    // Circulation aggregates per item, updated by every borrow and hold (see checkItemStats())
+    QString statsTableSQL =
+        "CREATE TABLE IF NOT EXISTS item_stats ("
+        "item_id INTEGER PRIMARY KEY, "
+        "borrow_count INTEGER NOT NULL DEFAULT 0, "
+        "holds_placed INTEGER NOT NULL DEFAULT 0, "
+        "holds_filled INTEGER NOT NULL DEFAULT 0, "
+        "hold_wait_days REAL NOT NULL DEFAULT 0, "
+        "FOREIGN KEY(item_id) REFERENCES catalogue_items(id)"
+        ");";
+
+    if (!query.exec(statsTableSQL)) {
+        qDebug() << "Error creating item_stats table:" << query.lastError().text();
+        return false;
+    }
+
+    // Most-borrowed list walks this index from the top
+    if (!query.exec("CREATE INDEX IF NOT EXISTS idx_item_stats_borrows ON item_stats(borrow_count);")) {
+        qDebug() << "Error creating item_stats index:" << query.lastError().text();
+        return false;
+    }
+
+    // Item copies table: one row per physical copy of a catalogue item (work).
+    // status is 'available', 'on_loan' or 'held' (on the hold shelf for held_for)
+    QString copiesTableSQL =
+        "CREATE TABLE IF NOT EXISTS item_copies ("
+        "id INTEGER PRIMARY KEY AUTOINCREMENT, "
+        "item_id INTEGER NOT NULL, "
+        "barcode TEXT UNIQUE, "
+        "status TEXT NOT NULL DEFAULT 'available', "
+        "held_for INTEGER, "
+        "FOREIGN KEY(item_id) REFERENCES catalogue_items(id), "
+        "FOREIGN KEY(held_for) REFERENCES users(id)"
+        ");";
+
+    if (!query.exec(copiesTableSQL)) {
+        qDebug() << "Error creating item_copies table:" << query.lastError().text();
+        return false;
+    }
+
+    // Borrowing picks a copy of an item by status
+    if (!query.exec("CREATE INDEX IF NOT EXISTS idx_copies_item ON item_copies(item_id, status);")) {
+        qDebug() << "Error creating item_copies index:" << query.lastError().text();
+        return false;
+    }
+
     // Loans table
     QString loansTableSQL =
         "CREATE TABLE IF NOT EXISTS loans ("
@@ -91,8 +237,10 @@ bool DatabaseInitializer::createTables(QSqlDatabase& db) {
         "checkout_date TEXT NOT NULL, "
         "due_date TEXT NOT NULL, "
         "return_date TEXT, "
+        "copy_id INTEGER, "
         "FOREIGN KEY(user_id) REFERENCES users(id), "
-        "FOREIGN KEY(item_id) REFERENCES catalogue_items(id)"
+        "FOREIGN KEY(item_id) REFERENCES catalogue_items(id), "
+        "FOREIGN KEY(copy_id) REFERENCES item_copies(id)"
         ");";
 
     if (!query.exec(loansTableSQL)) {
@@ -100,6 +248,92 @@ bool DatabaseInitializer::createTables(QSqlDatabase& db) {
         return false;
     }
 
+    // Physical copy the patron took home
+    if (!addColumnIfMissing(db, "loans", "copy_id", "INTEGER REFERENCES item_copies(id)")) {
+        return false;
+    }
+
+    // Returned loans: moved here by returnItem() (and by LoanArchiver for rows returned
+    // before the split), keeping the same id so notices and the all_loans view still match
+    QString historyTableSQL =
+        "CREATE TABLE IF NOT EXISTS loan_history ("
+        "id INTEGER PRIMARY KEY, "
+        "user_id INTEGER NOT NULL, "
+        "item_id INTEGER NOT NULL, "
+        "copy_id INTEGER, "
+        "checkout_date TEXT NOT NULL, "
+        "due_date TEXT NOT NULL, "
+        "return_date TEXT NOT NULL, "
+        "FOREIGN KEY(user_id) REFERENCES users(id), "
+        "FOREIGN KEY(item_id) REFERENCES catalogue_items(id)"
+        ");";
+
+    if (!query.exec(historyTableSQL)) {
+        qDebug() << "Error creating loan_history table:" << query.lastError().text();
+        return false;
+    }
+
+    if (!query.exec("CREATE INDEX IF NOT EXISTS idx_history_user ON loan_history(user_id, return_date);") ||
+        !query.exec("CREATE INDEX IF NOT EXISTS idx_history_item ON loan_history(item_id, return_date);")) {
+        qDebug() << "Error creating loan_history indexes:" << query.lastError().text();
+        return false;
+    }
+
+    // Every loan, active or returned, for history queries
+    if (!query.exec("CREATE VIEW IF NOT EXISTS all_loans AS "
+                    "SELECT id, user_id, item_id, copy_id, checkout_date, due_date, return_date FROM loans "
+                    "UNION ALL "
+                    "SELECT id, user_id, item_id, copy_id, checkout_date, due_date, return_date FROM loan_history;")) {
+        qDebug() << "Error creating all_loans view:" << query.lastError().text();
+        return false;
+    }
+
+    // Account panel loads a user's active loans on every login and refresh
+    if (!query.exec("CREATE INDEX IF NOT EXISTS idx_loans_user ON loans(user_id, return_date);")) {
+        qDebug() << "Error creating loans user index:" << query.lastError().text();
+        return false;
+    }
+
+    // Due-date timeline of active loans only: returned loans leave the index, so overdue
+    // and due-soon scans cost the same however much loan history accumulates
+    if (!query.exec("CREATE INDEX IF NOT EXISTS idx_loans_due_active ON loans(due_date, id) "
+                    "WHERE return_date IS NULL;")) {
+        qDebug() << "Error creating loans due-date index:" << query.lastError().text();
+        return false;
+    }
+
+    // Notices generated by DueDateScanner; one per loan and kind
+    QString noticesTableSQL =
+        "CREATE TABLE IF NOT EXISTS notices ("
+        "id INTEGER PRIMARY KEY AUTOINCREMENT, "
+        "loan_id INTEGER NOT NULL, "
+        "user_id INTEGER NOT NULL, "
+        "item_id INTEGER NOT NULL, "
+        "kind TEXT NOT NULL, "
+        "due_date TEXT NOT NULL, "
+        "created_date TEXT DEFAULT CURRENT_TIMESTAMP, "
+        "UNIQUE(loan_id, kind)"  // loan_id is in loans or, once returned, loan_history
+        ");";
+
+    if (!query.exec(noticesTableSQL)) {
+        qDebug() << "Error creating notices table:" << query.lastError().text();
+        return false;
+    }
+
+    // Where each named scan stopped on the due-date timeline
+    QString checkpointsTableSQL =
+        "CREATE TABLE IF NOT EXISTS scan_checkpoints ("
+        "name TEXT PRIMARY KEY, "
+        "due_date TEXT NOT NULL, "
+        "loan_id INTEGER NOT NULL, "
+        "updated_date TEXT DEFAULT CURRENT_TIMESTAMP"
+        ");";
+
+    if (!query.exec(checkpointsTableSQL)) {
+        qDebug() << "Error creating scan_checkpoints table:" << query.lastError().text();
+        return false;
+    }
+
     // Holds table
     QString holdsTableSQL =
         "CREATE TABLE IF NOT EXISTS holds ("
@@ -117,15 +351,369 @@ bool DatabaseInitializer::createTables(QSqlDatabase& db) {
         return false;
     }
 
+    if (!query.exec("CREATE INDEX IF NOT EXISTS idx_holds_user ON holds(user_id);")) {
+        qDebug() << "Error creating holds user index:" << query.lastError().text();
+        return false;
+    }
+
+    // Hold queue of one item: next position, queue order, and the hold_count check
+    if (!query.exec("CREATE INDEX IF NOT EXISTS idx_holds_item ON holds(item_id, position);")) {
+        qDebug() << "Error creating holds item index:" << query.lastError().text();
+        return false;
+    }
+
+    // Catalogue generation: bumped by every change to what catalogue_items describes, so a
+    // CatalogueSnapshot written at one generation is known to be stale at the next.
+    // Copy and hold counters move with circulation instead (see circulation_changes).
+    // database_id is drawn once, when the row is created, so a snapshot of another
+    // database that happens to be at the same generation is not taken for this one.
+    QString generationTableSQL =
+        "CREATE TABLE IF NOT EXISTS catalogue_generation ("
+        "id INTEGER PRIMARY KEY CHECK (id = 1), "
+        "generation INTEGER NOT NULL, "
+        "database_id INTEGER NOT NULL DEFAULT 0"
+        ");";
+
+    if (!query.exec(generationTableSQL) ||
+        !addColumnIfMissing(db, "catalogue_generation", "database_id", "INTEGER NOT NULL DEFAULT 0") ||
+        !query.exec("INSERT OR IGNORE INTO catalogue_generation (id, generation) VALUES (1, 0);") ||
+        !query.exec("UPDATE catalogue_generation SET database_id = random() WHERE id = 1 AND database_id = 0;")) {
+        qDebug() << "Error creating catalogue_generation table:" << query.lastError().text();
+        return false;
+    }
+
+    // Last generation at which each item changed (or was removed), so a CatalogueVersion
+    // can re-read just the items changed since it was built
+    QString changesTableSQL =
+        "CREATE TABLE IF NOT EXISTS catalogue_changes ("
+        "item_id INTEGER PRIMARY KEY, "
+        "generation INTEGER NOT NULL"
+        ");";
+
+    if (!query.exec(changesTableSQL) ||
+        !query.exec("CREATE INDEX IF NOT EXISTS idx_catalogue_changes_generation ON catalogue_changes(generation);")) {
+        qDebug() << "Error creating catalogue_changes table:" << query.lastError().text();
+        return false;
+    }
+
+    const char* generationEvents[] = {"INSERT", "UPDATE", "DELETE"};
+    for (const char* event : generationEvents) {
+        QString name = QString(event).toLower();
+        QString row = QString(event) == "DELETE" ? "OLD" : "NEW";
+
+        // Superseded by trg_catalogue_change_*, which also logs the item
+        query.exec(QString("DROP TRIGGER IF EXISTS trg_catalogue_generation_%1;").arg(name));
+
+        // Updates count only when they touch a described column; a borrow, return or hold
+        // leaves the catalogue (and its snapshot) as it was. Older versions fired on any column.
+        QString trigger = event;
+        if (trigger == "UPDATE") {
+            query.exec("DROP TRIGGER IF EXISTS trg_catalogue_change_update;");
+            trigger = "UPDATE OF title, author, item_type, dewey_decimal, dewey_key, isbn, isbn_key, genre, "
+                      "rating, issue_number, publication_date, publication_year, condition, total_copies";
+        }
+
+        QString triggerSQL = QString("CREATE TRIGGER IF NOT EXISTS trg_catalogue_change_%1 "
+                                     "AFTER %2 ON catalogue_items BEGIN "
+                                     "UPDATE catalogue_generation SET generation = generation + 1 WHERE id = 1; "
+                                     "INSERT OR REPLACE INTO catalogue_changes (item_id, generation) "
+                                     "SELECT %3.id, generation FROM catalogue_generation WHERE id = 1; "
+                                     "END;").arg(name, trigger, row);
+        if (!query.exec(triggerSQL)) {
+            qDebug() << "Error creating catalogue change trigger:" << query.lastError().text();
+            return false;
+        }
+    }
+
+    // Circulation generation: bumped by every change to loans and holds, by whichever
+    // process makes it, so a queue or account kept in memory can tell it is stale
+    QString circulationTableSQL =
+        "CREATE TABLE IF NOT EXISTS circulation_generation ("
+        "id INTEGER PRIMARY KEY CHECK (id = 1), "
+        "generation INTEGER NOT NULL"
+        ");";
+
+    if (!query.exec(circulationTableSQL) ||
+        !query.exec("INSERT OR IGNORE INTO circulation_generation (id, generation) VALUES (1, 0);")) {
+        qDebug() << "Error creating circulation_generation table:" << query.lastError().text();
+        return false;
+    }
+
+    const char* circulationTables[] = {"loans", "holds"};
+    for (const char* table : circulationTables) {
+        for (const char* event : generationEvents) {
+            QString triggerSQL = QString("CREATE TRIGGER IF NOT EXISTS trg_circulation_%1_%2 "
+                                         "AFTER %3 ON %1 BEGIN "
+                                         "UPDATE circulation_generation SET generation = generation + 1 WHERE id = 1; "
+                                         "END;").arg(table, QString(event).toLower(), event);
+            if (!query.exec(triggerSQL)) {
+                qDebug() << "Error creating circulation trigger:" << query.lastError().text();
+                return false;
+            }
+        }
+    }
+
+    // Last circulation generation at which each item's copy or hold counters moved, so a
+    // snapshot or CatalogueVersion can bring just those counters up to date
+    QString circulationChangesTableSQL =
+        "CREATE TABLE IF NOT EXISTS circulation_changes ("
+        "item_id INTEGER PRIMARY KEY, "
+        "generation INTEGER NOT NULL"
+        ");";
+
+    if (!query.exec(circulationChangesTableSQL) ||
+        !query.exec("CREATE INDEX IF NOT EXISTS idx_circulation_changes_generation "
+                    "ON circulation_changes(generation);")) {
+        qDebug() << "Error creating circulation_changes table:" << query.lastError().text();
+        return false;
+    }
+
+    QString countersTriggerSQL =
+        "CREATE TRIGGER IF NOT EXISTS trg_circulation_items_update "
+        "AFTER UPDATE OF available_copies, is_available, hold_count ON catalogue_items BEGIN "
+        "UPDATE circulation_generation SET generation = generation + 1 WHERE id = 1; "
+        "INSERT OR REPLACE INTO circulation_changes (item_id, generation) "
+        "SELECT NEW.id, generation FROM circulation_generation WHERE id = 1; "
+        "END;";
+
+    if (!query.exec(countersTriggerSQL)) {
+        qDebug() << "Error creating circulation counters trigger:" << query.lastError().text();
+        return false;
+    }
+
+    return true;
+}
+
+bool DatabaseInitializer::addColumnIfMissing(QSqlDatabase& db, const QString& table, const QString& column,
+                                             const QString& definition) {
+    QSqlQuery query(db);
+    if (!query.exec(QString("PRAGMA table_info(%1)").arg(table))) {
+        qDebug() << "Error reading columns of" << table << ":" << query.lastError().text();
+        return false;
+    }
+    while (query.next()) {
+        if (query.value("name").toString() == column) return true;
+    }
+
+    if (!query.exec(QString("ALTER TABLE %1 ADD COLUMN %2 %3").arg(table, column, definition))) {
+        qDebug() << "Error adding column" << column << "to" << table << ":" << query.lastError().text();
+        return false;
+    }
+    qDebug() << "Added column" << column << "to" << table;
+    return true;
+}
+
+bool DatabaseInitializer::createMissingCopies(QSqlDatabase& db) {
+    QSqlQuery query(db);
+
+    query.exec("SELECT COALESCE(MAX(id), 0) FROM item_copies");
+    qint64 lastCopyId = query.next() ? query.value(0).toLongLong() : 0;
+
+    if (!db.transaction()) {
+        qDebug() << "Error starting copy migration:" << db.lastError().text();
+        return false;
+    }
+
+    // One copy per uncopied item, on loan if the item was checked out
+    bool ok = query.exec(
+        "INSERT INTO item_copies (item_id, status) "
+        "SELECT id, CASE WHEN is_available THEN 'available' ELSE 'on_loan' END "
+        "FROM catalogue_items ci "
+        "WHERE NOT EXISTS (SELECT 1 FROM item_copies c WHERE c.item_id = ci.id)");
+    int created = ok ? query.numRowsAffected() : 0;
+
+    if (ok && created > 0) {
+        QSqlQuery step(db);
+        step.prepare("UPDATE item_copies SET barcode = printf('HL%08d', id) WHERE id > ? AND barcode IS NULL");
+        step.addBindValue(lastCopyId);
+        ok = step.exec();
+
+        // Open and past loans of those items were all of their single copy
+        if (ok) {
+            step.prepare("UPDATE loans SET copy_id = (SELECT c.id FROM item_copies c WHERE c.item_id = loans.item_id) "
+                         "WHERE copy_id IS NULL AND item_id IN (SELECT item_id FROM item_copies WHERE id > ?)");
+            step.addBindValue(lastCopyId);
+            ok = step.exec();
+        }
+        if (ok) {
+            step.prepare("UPDATE catalogue_items SET total_copies = 1, available_copies = CASE WHEN is_available THEN 1 ELSE 0 END "
+                         "WHERE id IN (SELECT item_id FROM item_copies WHERE id > ?)");
+            step.addBindValue(lastCopyId);
+            ok = step.exec();
+        }
+        if (!ok) qDebug() << "Error migrating items to copies:" << step.lastError().text();
+    } else if (!ok) {
+        qDebug() << "Error creating item copies:" << query.lastError().text();
+    }
+
+    if (!ok) {
+        db.rollback();
+        return false;
+    }
+    if (!db.commit()) {
+        qDebug() << "Error committing copy migration:" << db.lastError().text();
+        return false;
+    }
+    if (created > 0) {
+        qDebug() << "Created copy records for" << created << "catalogue items";
+    }
     return true;
 }
 
+bool DatabaseInitializer::createMissingKeys(QSqlDatabase& db) {
+    QSqlQuery query(db);
+    if (!query.exec("SELECT id, dewey_decimal, isbn FROM catalogue_items "
+                    "WHERE (dewey_key IS NULL AND dewey_decimal <> '') OR (isbn_key IS NULL AND isbn <> '')")) {
+        qDebug() << "Error reading Dewey numbers and ISBNs:" << query.lastError().text();
+        return false;
+    }
+
+    // Text that does not parse keeps a NULL key and stays out of that index
+    QVariantList ids, deweyKeys, isbnKeys;
+    while (query.next()) {
+        int deweyKey = CatalogueKeys::deweyKey(query.value(1).toString());
+        qint64 isbnKey = CatalogueKeys::isbnKey(query.value(2).toString());
+        if (deweyKey < 0 && isbnKey < 0) continue;
+        ids << query.value(0);
+        deweyKeys << (deweyKey < 0 ? QVariant() : QVariant(deweyKey));
+        isbnKeys << (isbnKey < 0 ? QVariant() : QVariant(isbnKey));
+    }
+    if (ids.isEmpty()) return true;
+
+    if (!db.transaction()) {
+        qDebug() << "Error starting key migration:" << db.lastError().text();
+        return false;
+    }
+    query.prepare("UPDATE catalogue_items SET dewey_key = ?, isbn_key = ? WHERE id = ?");
+    query.addBindValue(deweyKeys);
+    query.addBindValue(isbnKeys);
+    query.addBindValue(ids);
+    if (!query.execBatch()) {
+        qDebug() << "Error storing catalogue keys:" << query.lastError().text();
+        db.rollback();
+        return false;
+    }
+    if (!db.commit()) {
+        qDebug() << "Error committing catalogue keys:" << db.lastError().text();
+        return false;
+    }
+
+    qDebug() << "Indexed Dewey numbers and ISBNs of" << ids.size() << "catalogue items";
+    return true;
+}
+
+int DatabaseInitializer::checkCounters(QSqlDatabase& db, bool repair) {
+    // Each counter with the count it caches; every subquery is an index lookup
+    struct Counter {
+        const char* table;
+        const char* column;
+        const char* actual;
+    };
+    const Counter counters[] = {
+        {"catalogue_items", "hold_count", "SELECT COUNT(*) FROM holds h WHERE h.item_id = catalogue_items.id"},
+        {"users", "active_hold_count", "SELECT COUNT(*) FROM holds h WHERE h.user_id = users.id"},
+        {"users", "active_loan_count",
+         "SELECT COUNT(*) FROM loans l WHERE l.user_id = users.id AND l.return_date IS NULL"}
+    };
+
+    QSqlQuery query(db);
+    int drifted = 0;
+
+    for (const Counter& counter : counters) {
+        QString sql = repair
+            ? QString("UPDATE %1 SET %2 = (%3) WHERE %2 <> (%3)")
+            : QString("SELECT COUNT(*) FROM %1 WHERE %2 <> (%3)");
+        if (!query.exec(sql.arg(counter.table, counter.column, counter.actual))) {
+            qDebug() << "Error checking" << counter.table << counter.column << ":" << query.lastError().text();
+            return -1;
+        }
+        if (repair) {
+            drifted += query.numRowsAffected();
+        } else if (query.next()) {
+            drifted += query.value(0).toInt();
+        }
+    }
+    return drifted;
+}
+
+int DatabaseInitializer::checkItemStats(QSqlDatabase& db, bool repair) {
+    QSqlQuery query(db);
+
+    // Active loans per item: few rows, kept in a keyed temp table so the pass below can
+    // look each history group up instead of sorting both tables together
+    query.exec("DROP TABLE IF EXISTS temp.active_borrows");
+    bool ok = query.exec("CREATE TEMP TABLE active_borrows (item_id INTEGER PRIMARY KEY, n INTEGER NOT NULL)") &&
+              query.exec("INSERT INTO active_borrows SELECT item_id, COUNT(*) FROM loans GROUP BY item_id");
+    if (!ok) {
+        qDebug() << "Error counting active loans:" << query.lastError().text();
+        query.exec("DROP TABLE IF EXISTS temp.active_borrows");
+        return -1;
+    }
+
+    // Loans per item: one ordered pass over the loan_history item index (already grouped,
+    // no temp B-tree), plus the items whose only loans are active
+    const QString totals =
+        "WITH history AS (SELECT item_id, COUNT(*) AS n FROM loan_history GROUP BY item_id), "
+        "totals AS ("
+        "SELECT h.item_id, h.n + COALESCE(a.n, 0) AS borrows FROM history h "
+        "LEFT JOIN active_borrows a ON a.item_id = h.item_id "
+        "UNION ALL "
+        "SELECT a.item_id, a.n FROM active_borrows a "
+        "WHERE NOT EXISTS (SELECT 1 FROM loan_history h WHERE h.item_id = a.item_id)) ";
+    const QString differs =
+        "COALESCE(s.borrow_count, 0) <> t.borrows";
+    const QString listed =
+        "EXISTS (SELECT 1 FROM catalogue_items ci WHERE ci.id = t.item_id)";
+
+    // The same pass counts the non-zero stats it matched; any other non-zero row is an
+    // item whose loans are gone, so orphans need no probe per item_stats row
+    int drifted = -1;
+    int orphaned = -1;
+    if (query.exec(totals +
+                   "SELECT COALESCE(SUM(CASE WHEN " + differs + " THEN " + listed + " ELSE 0 END), 0), "
+                   "COALESCE(SUM(COALESCE(s.borrow_count, 0) <> 0), 0) "
+                   "FROM totals t LEFT JOIN item_stats s ON s.item_id = t.item_id") && query.next()) {
+        drifted = query.value(0).toInt();
+        int matched = query.value(1).toInt();
+        if (query.exec("SELECT COUNT(*) FROM item_stats WHERE borrow_count <> 0") && query.next()) {
+            orphaned = query.value(0).toInt() - matched;
+        }
+    }
+    if (drifted < 0 || orphaned < 0) {
+        qDebug() << "Error checking item statistics:" << query.lastError().text();
+        query.exec("DROP TABLE IF EXISTS temp.active_borrows");
+        return -1;
+    }
+
+    // Rewrites only when something differs; a consistent database is checked in one pass.
+    // Hold columns cannot be recounted (filled holds are deleted), so they are carried over.
+    ok = true;
+    if (repair && drifted > 0) {
+        ok = query.exec(totals +
+            "INSERT OR REPLACE INTO item_stats (item_id, borrow_count, holds_placed, holds_filled, hold_wait_days) "
+            "SELECT t.item_id, t.borrows, COALESCE(s.holds_placed, 0), COALESCE(s.holds_filled, 0), "
+            "COALESCE(s.hold_wait_days, 0) "
+            "FROM totals t LEFT JOIN item_stats s ON s.item_id = t.item_id "
+            "WHERE " + differs + " AND " + listed);
+    }
+    if (ok && repair && orphaned > 0) {
+        ok = query.exec("UPDATE item_stats SET borrow_count = 0 WHERE borrow_count <> 0 "
+                        "AND item_id NOT IN (SELECT item_id FROM active_borrows) "
+                        "AND item_id NOT IN (SELECT item_id FROM loan_history)");
+    }
+    if (!ok) {
+        qDebug() << "Error rebuilding item statistics:" << query.lastError().text();
+    }
+    query.exec("DROP TABLE IF EXISTS temp.active_borrows");
+    return ok ? drifted + orphaned : -1;
+}
+
 bool DatabaseInitializer::populateDefaultData(QSqlDatabase& db) {
     return addDefaultUsers(db) && addDefaultCatalogue(db);
 }
 
 bool DatabaseInitializer::addDefaultUsers(QSqlDatabase& db) {
-    QSqlQuery query;
+    QSqlQuery query(db);
     QString insertUsersSQL =
         "INSERT OR IGNORE INTO users (username, role) VALUES "
         "('alice_p', 'patron'), "
@@ -168,7 +756,7 @@ bool DatabaseInitializer::addDefaultCatalogue(QSqlDatabase& db) {
 
         // Non-Fiction Books
         "('Sapiens', 'Yuval Noah Harari', 'nonfiction', '909.04', '978-0-06-231609-7', NULL, NULL, NULL, NULL, 2011, 'Excellent'), "
-        "('Cosmos', 'Carl Sagan', 'nonfiction', '520.92', '978-0-375-50832-3', NULL, NULL, NULL, NULL, 1980, 'Good'), "
+        "('Cosmos', 'Carl Sagan', 'nonfiction', '520.92', '978-0-375-50832-5', NULL, NULL, NULL, NULL, 1980, 'Good'), "
         "('A Brief History of Time', 'Stephen Hawking', 'nonfiction', '523.01', '978-0-553-05340-1', NULL, NULL, NULL, NULL, 1988, 'Excellent'), "
         "('The Selfish Gene', 'Richard Dawkins', 'nonfiction', '576.82', '978-0-19-286092-7', NULL, NULL, NULL, NULL, 1976, 'Good'), "
         "('Silent Spring', 'Rachel Carson', 'nonfiction', '632.95', '978-0-618-24906-0', NULL, NULL, NULL, NULL, 1962, 'Fair'), "
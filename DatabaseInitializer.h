@@ -12,45 +12,168 @@
     Handles database schema creation and initial data population for the HinLIBS system.
     Implements intelligent initialization that only populates data for new databases.
 
+    Startup fast path: a database that has been through the full setup is stamped
+    with PRAGMA user_version = SCHEMA_VERSION. When the stamp matches, startup costs
+    that one pragma; the CREATE ... IF NOT EXISTS statements, column migrations,
+    copy/key backfills and counter checks only run for new, older or unstamped
+    databases (or when a full check is requested). Bump SCHEMA_VERSION whenever
+    createTables() or one of those startup migrations changes.
+
     Data Members: None (static class with no instance data)
 
     Member Functions:
       Public:
         - initializeDatabase(): Main method that orchestrates complete database setup
+          (on a given connection, or on its own connection to a file)
+        - createMissingCopies(): Gives every catalogue item without copy rows its copy
+        - createMissingKeys(): Computes the Dewey and ISBN keys items are stored without
+        - checkCounters(): Verifies (and optionally rebuilds) the hold and loan counters
+        - checkItemStats(): Verifies (and optionally rebuilds) the per-item borrow counts
 
       Private:
         - createTables(): Defines and creates all database tables with proper schemas
+        - addColumnIfMissing(): Adds a column to a table created by an older version
         - populateDefaultData(): Populates database with default users and catalogue items
         - addDefaultUsers(): Inserts predefined user accounts
         - addDefaultCatalogue(): Inserts default library items with realistic metadata
 */
 class DatabaseInitializer {
 public:
+    static const int SCHEMA_VERSION = 6;
+
     /*
         Function: initializeDatabase
-        Purpose: Main initialization method that orchestrates complete database setup.
-                 Creates all tables and populates with default data only for new databases.
+        Purpose: Main initialization method that orchestrates complete database setup on
+                 an open connection. Returns after one PRAGMA user_version read when the
+                 database is already at SCHEMA_VERSION; otherwise creates all tables,
+                 populates default data only for new databases, runs the migrations and
+                 counter checks and stamps the version.
+        Parameters:
+          in: QSqlDatabase& db - Open connection (the application passes DatabaseManager's own)
+          in: bool fullCheck - Run the migrations and counter checks even if the version matches
+        Return: bool - true if initialization successful, false on any error
+    */
+    static bool initializeDatabase(QSqlDatabase& db, bool fullCheck = false);
+
+    /*
+        Function: initializeDatabase
+        Purpose: Same, on a connection of its own that is closed again afterwards (the
+                 server and the tools, which open DatabaseManager on the file later)
         Parameters:
           in: const QString& databasePath - File path for the SQLite database file
         Return: bool - true if initialization successful, false on any error
     */
     static bool initializeDatabase(const QString& databasePath);
 
+    /*
+        Function: createMissingCopies
+        Purpose: Creates one item_copies row for every catalogue item that has none
+                 (databases from before the work/copy split, bulk-loaded libraries),
+                 carries over its availability, points its loans at that copy and sets
+                 the item's copy counters. Does nothing when every item has copies.
+        Parameters:
+          in: QSqlDatabase& db - Reference to active database connection
+        Return: bool - true on success, false on any error
+    */
+    static bool createMissingCopies(QSqlDatabase& db);
+
+    /*
+        Function: createMissingKeys
+        Purpose: Sets catalogue_items.dewey_key and isbn_key (see CatalogueKeys) for items
+                 that have a Dewey number or ISBN but no key: the default catalogue, bulk
+                 loads and databases from before the columns existed. Numbers that do not
+                 parse (or ISBNs with a wrong check digit) are left without a key and stay
+                 out of shelf browsing and ISBN lookup.
+        Parameters:
+          in: QSqlDatabase& db - Reference to active database connection
+        Return: bool - true on success, false on any error
+    */
+    static bool createMissingKeys(QSqlDatabase& db);
+
+    /*
+        Function: checkCounters
+        Purpose: Compares the denormalized counters (catalogue_items.hold_count,
+                 users.active_hold_count, users.active_loan_count) with the holds and
+                 loans they count, and with repair set rewrites the ones that differ.
+                 DatabaseManager keeps them current inside each write's transaction;
+                 this is for databases written by other means (bulk loads, older
+                 versions, manual edits).
+        Parameters:
+          in: QSqlDatabase& db - Reference to active database connection
+          in: bool repair - Rewrite counters that differ instead of only counting them
+        Return: int - Number of counters that differed, or -1 on error
+    */
+    static int checkCounters(QSqlDatabase& db, bool repair);
+
+    /*
+        Function: checkItemStats
+        Purpose: Compares item_stats.borrow_count with the loans (active and returned)
+                 of each catalogue item, and with repair set rewrites the ones that
+                 differ. A full recount is one ordered pass over the loan_history
+                 item index, with active loans counted into a small temp table first;
+                 the same pass finds orphaned rows. Only differing rows are written.
+                 Hold statistics are kept as they are: filled and cancelled holds leave
+                 nothing to recount.
+        Parameters:
+          in: QSqlDatabase& db - Reference to active database connection
+          in: bool repair - Rewrite rows that differ instead of only counting them
+        Return: int - Number of items whose statistics differed, or -1 on error
+    */
+    static int checkItemStats(QSqlDatabase& db, bool repair);
+
 private:
     /*
         Function: createTables
         Purpose: Creates all database tables with proper schema definitions and constraints.
         Tables Created:
-          - users: id, username, role, created_date
-          - catalogue_items: id, title, author, item_type, plus type-specific fields
-          - loans: id, user_id, item_id, checkout_date, due_date, return_date
-          - holds: id, user_id, item_id, position, created_date
+          - users: id, username, role, created_date, active_loan_count, active_hold_count
+            (indexed on role, username)
+          - catalogue_items: id, title, author, item_type, plus type-specific fields; one row
+            per work, with total_copies / available_copies / hold_count counters (queued items
+            indexed on hold_count), dewey_key (indexed with id, in shelf order) and isbn_key (indexed)
+          - item_copies: id, item_id, barcode (unique), status, held_for; one row per physical copy
+          - loans: id, user_id, item_id, copy_id, checkout_date, due_date, return_date (indexed on
+            user, and on due date for active loans only)
+          - loan_history: returned loans, same columns and ids as loans (indexed on user
+            and on item); view all_loans is the union of both
+          - item_stats: item_id, borrow_count, holds_placed, holds_filled, hold_wait_days
+            (indexed on borrow_count)
+          - notices: id, loan_id, user_id, item_id, kind, due_date, created_date
+          - scan_checkpoints: name, due_date, loan_id, updated_date
+          - holds: id, user_id, item_id, position (queue ticket, never renumbered), created_date
+            (indexed on user and on item)
+          - catalogue_generation: one row, bumped by triggers on every insert and delete of
+            catalogue_items and every update of a column other than the copy and hold
+            counters (checked by CatalogueSnapshot readers and FacetIndex), and database_id,
+            a random identity drawn when the row is created
+          - catalogue_changes: item_id, generation of its last change, written by the same
+            triggers (indexed on generation; read by CatalogueVersion and FacetIndex refreshes)
+          - circulation_generation: one row, bumped by triggers on every insert, update and
+            delete of loans and holds and every update of an item's copy or hold counters
+            (checked by HoldQueueIndex)
+          - circulation_changes: item_id, circulation generation at which its counters last
+            moved (indexed on generation; overlaid on CatalogueSnapshot rows, read by
+            CatalogueVersion and FacetIndex refreshes)
         Parameters:
           in: QSqlDatabase& db - Reference to active database connection
         Return: bool - true if all tables created successfully, false on any error
     */
     static bool createTables(QSqlDatabase& db);
 
+    /*
+        Function: addColumnIfMissing
+        Purpose: Adds a column to an existing table unless it is already there, so
+                 databases created by older versions pick up new columns in place.
+        Parameters:
+          in: QSqlDatabase& db - Reference to active database connection
+          in: const QString& table - Table to alter
+          in: const QString& column - Column name
+          in: const QString& definition - Column type and constraints
+        Return: bool - true if the column exists afterwards, false on any error
+    */
+    static bool addColumnIfMissing(QSqlDatabase& db, const QString& table, const QString& column,
+                                   const QString& definition);
+
     /*
         Function: populateDefaultData
         Purpose: Orchestrates population of all default data into the database;
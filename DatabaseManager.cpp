@@ -1,19 +1,225 @@
 #include <QDebug>
 #include <QDate>
+#include <QThread>
 #include "DatabaseManager.h"
+#include "PerformanceMonitor.h"
+#include "TraceRecorder.h"
+#include "CatalogueKeys.h"
+#include "FacetIndex.h"
+#include "HoldQueueIndex.h"
+#include "AccountCache.h"
+#include "DatabaseInitializer.h"
 
 DatabaseManager* DatabaseManager::instance = nullptr;
+thread_local bool DatabaseManager::transactionOpen = false;
+thread_local DatabaseManager::ChangeStamp DatabaseManager::transactionStamp;
+thread_local std::vector<DatabaseManager::FacetChange> DatabaseManager::touchedItems;
+thread_local std::vector<DatabaseManager::HoldChange> DatabaseManager::holdChanges;
+thread_local std::vector<int> DatabaseManager::touchedAccounts;
 
-DatabaseManager::DatabaseManager() {
+DatabaseManager::DatabaseManager() : ownerThread(QThread::currentThread()) {
     db = QSqlDatabase::addDatabase("QSQLITE", "library_connection");
-    db.setDatabaseName("hinlibs.db");
+    openDatabase("hinlibs.db");
+}
+
+bool DatabaseManager::openDatabase(const QString& path) {
+    QMutexLocker locker(&connectionMutex);
+
+    if (db.isOpen()) {
+        db.close();
+    }
+    db.setDatabaseName(path);
+    FacetIndex::getInstance().invalidate(); // Built for the old file
+    HoldQueueIndex::getInstance().invalidate();
+    AccountCache::getInstance().invalidate();
+
+    {
+        // Mapped now; whether it is still current is checked on every read
+        QMutexLocker snapshotLocker(&snapshotMutex);
+        snapshot = CatalogueSnapshot::open(CatalogueSnapshot::pathFor(path));
+    }
+    {
+        QMutexLocker versionLocker(&catalogueVersionMutex);
+        std::atomic_store(&catalogueVersion, std::shared_ptr<const CatalogueVersion>());
+    }
 
     if (!db.open()) {
         qDebug() << "Error opening database:" << db.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+qint64 DatabaseManager::catalogueGeneration(QSqlDatabase& conn, qint64* databaseId) {
+    QSqlQuery query(conn);
+    const char* sql = "SELECT generation, database_id FROM catalogue_generation WHERE id = 1";
+    query.prepare(sql);
+    if (!execQuery(query, sql) || !query.next()) return -1; // Not prepared yet
+    if (databaseId) *databaseId = query.value(1).toLongLong();
+    return query.value(0).toLongLong();
+}
+
+bool DatabaseManager::readChangeStamp(QSqlDatabase& conn, ChangeStamp& stamp) {
+    stamp = ChangeStamp();
+
+    QSqlQuery query(conn);
+    const char* sql = "SELECT c.generation, l.generation FROM catalogue_generation c, circulation_generation l "
+                      "WHERE c.id = 1 AND l.id = 1";
+    query.prepare(sql);
+    if (!execQuery(query, sql) || !query.next()) {
+        qDebug() << "Error reading change counters:" << query.lastError().text();
+        return false;
+    }
+    stamp.catalogue = query.value(0).toLongLong();
+    stamp.circulation = query.value(1).toLongLong();
+    return true;
+}
+
+DatabaseManager::ChangeStamp DatabaseManager::getChangeStamp() {
+    ChangeStamp stamp;
+    QSqlDatabase conn = connection();
+    if (!conn.isOpen() || transactionOpen) return stamp;
+
+    readChangeStamp(conn, stamp);
+    return stamp;
+}
+
+std::shared_ptr<CatalogueSnapshot> DatabaseManager::currentSnapshot(QSqlDatabase& conn) {
+    std::shared_ptr<CatalogueSnapshot> mapped;
+    {
+        QMutexLocker locker(&snapshotMutex);
+        mapped = snapshot;
+    }
+    if (!mapped) return nullptr;
+
+    // Inside a write the triggers have already moved the generation on, so the
+    // writer reads its own changes through SQL. Another database at the same
+    // generation has a different identity.
+    qint64 databaseId = 0;
+    if (catalogueGeneration(conn, &databaseId) != mapped->getGeneration() ||
+        databaseId != mapped->getDatabaseId()) {
+        return nullptr;
+    }
+    return mapped;
+}
+
+bool DatabaseManager::readMovedCounters(QSqlDatabase& conn, qint64 sinceCirculation, int itemId,
+                                        QHash<int, ItemCounters>& moved) {
+    QSqlQuery query(conn);
+    const char* sql = itemId == -1
+        ? "SELECT i.id, i.available_copies, i.hold_count, i.is_available "
+          "FROM circulation_changes c JOIN catalogue_items i ON i.id = c.item_id "
+          "WHERE c.generation > ?"
+        : "SELECT i.id, i.available_copies, i.hold_count, i.is_available "
+          "FROM circulation_changes c JOIN catalogue_items i ON i.id = c.item_id "
+          "WHERE c.item_id = ? AND c.generation > ?";
+    query.prepare(sql);
+    if (itemId != -1) query.addBindValue(itemId);
+    query.addBindValue(sinceCirculation);
+    if (!execQuery(query, sql)) {
+        qDebug() << "Error reading moved counters:" << query.lastError().text();
+        return false;
+    }
+
+    while (query.next()) {
+        ItemCounters counters;
+        counters.availableCopies = query.value(1).toInt();
+        counters.holdCount = query.value(2).toInt();
+        counters.isAvailable = query.value(3).toBool();
+        moved.insert(query.value(0).toInt(), counters);
+    }
+    return true;
+}
+
+void DatabaseManager::overlayCounters(const QHash<int, ItemCounters>& moved, CatalogueSnapshot::ItemRow& row) {
+    auto counters = moved.constFind(row.id);
+    if (counters == moved.constEnd()) return;
+    row.availableCopies = counters->availableCopies;
+    row.holdCount = counters->holdCount;
+    row.isAvailable = counters->isAvailable;
+}
+
+bool DatabaseManager::saveCatalogueSnapshot() {
+    ScopedTimer timer("saveCatalogueSnapshot");
+
+    QSqlDatabase conn = connection();
+    if (!conn.isOpen() || transactionOpen) return false;
+
+    QString path = CatalogueSnapshot::pathFor(conn.databaseName());
+    if (path.isEmpty()) return false;
+
+    // Nothing described changed since it was written; counters are overlaid until too many moved
+    if (std::shared_ptr<CatalogueSnapshot> current = currentSnapshot(conn)) {
+        QSqlQuery moved(conn);
+        const char* sql = "SELECT COUNT(*) FROM circulation_changes WHERE generation > ?";
+        moved.prepare(sql);
+        moved.addBindValue(current->getCirculation());
+        if (execQuery(moved, sql) && moved.next() && moved.value(0).toInt() <= current->count() / 4) {
+            return true;
+        }
+    }
+
+    // Generation and rows from one read transaction, so they describe the same catalogue
+    QSqlQuery query(conn);
+    if (!query.exec("BEGIN")) {
+        qDebug() << "Error starting snapshot read:" << query.lastError().text();
+        timer.fail();
+        return false;
+    }
+
+    qint64 databaseId = 0;
+    qint64 generation = catalogueGeneration(conn, &databaseId);
+    ChangeStamp stamp;
+    CatalogueSnapshot::Writer writer;
+    const char* sql = "SELECT * FROM catalogue_items ORDER BY id";
+    query.prepare(sql);
+    bool read = generation >= 0 && readChangeStamp(conn, stamp) && execQuery(query, sql);
+    if (read) {
+        CatalogueSnapshot::ItemRow row;
+        while (query.next()) {
+            readItemRow(query, row);
+            writer.add(row);
+        }
+    } else {
+        qDebug() << "Error reading catalogue for snapshot:" << query.lastError().text();
+    }
+    query.finish();
+
+    QSqlQuery end(conn);
+    end.exec(read ? "COMMIT" : "ROLLBACK");
+    if (!read) {
+        timer.fail();
+        return false;
     }
+
+    {
+        // Let go of the old mapping first: a mapped file cannot be replaced on Windows
+        QMutexLocker locker(&snapshotMutex);
+        snapshot.reset();
+    }
+    if (!writer.save(path, databaseId, generation, stamp.circulation)) {
+        timer.fail();
+        return false;
+    }
+
+    std::shared_ptr<CatalogueSnapshot> written = CatalogueSnapshot::open(path);
+    QMutexLocker locker(&snapshotMutex);
+    snapshot = written;
+    return written != nullptr;
+}
+
+bool DatabaseManager::prepareDatabase(bool fullCheck) {
+    ScopedTimer timer("prepareDatabase");
+    QMutexLocker locker(&connectionMutex);
+
+    if (!db.isOpen()) return false;
+    return DatabaseInitializer::initializeDatabase(db, fullCheck);
 }
 
 DatabaseManager& DatabaseManager::getInstance() {
+    static QMutex instanceMutex;
+    QMutexLocker locker(&instanceMutex);
+
     if (!instance) {
         instance = new DatabaseManager();
     }
@@ -26,27 +232,215 @@ DatabaseManager::~DatabaseManager() {
     }
 }
 
-bool DatabaseManager::isDatabaseOpen() const {
-    return db.isOpen();
+bool DatabaseManager::isDatabaseOpen() {
+    return connection().isOpen();
+}
+
+QSqlDatabase DatabaseManager::connection() {
+    // The thread that created the manager (the GUI thread) uses the main connection
+    if (QThread::currentThread() == ownerThread) {
+        return db;
+    }
+
+    // Other threads get their own clone; SQLite handles may not be shared across threads
+    QString name = threadConnectionName();
+    QMutexLocker locker(&connectionMutex);
+
+    QSqlDatabase conn = QSqlDatabase::contains(name)
+                        ? QSqlDatabase::database(name, false)
+                        : QSqlDatabase::cloneDatabase(db, name);
+
+    // Follow openDatabase() if the main connection was switched to another file
+    if (conn.databaseName() != db.databaseName()) {
+        conn.close();
+        conn.setDatabaseName(db.databaseName());
+    }
+    if (!conn.isOpen() && !conn.open()) {
+        qDebug() << "Error opening thread connection:" << conn.lastError().text();
+    }
+    return conn;
+}
+
+void DatabaseManager::releaseThreadConnection() {
+    if (QThread::currentThread() == ownerThread) return;
+
+    QString name = threadConnectionName();
+    QMutexLocker locker(&connectionMutex);
+    if (!QSqlDatabase::contains(name)) return;
+
+    {
+        QSqlDatabase conn = QSqlDatabase::database(name, false);
+        conn.close();
+    }
+    QSqlDatabase::removeDatabase(name);
+}
+
+bool DatabaseManager::beginTransaction() {
+    QSqlDatabase conn = connection();
+    if (!conn.isOpen()) return false;
+
+    QSqlQuery query(conn);
+    if (!query.exec("BEGIN IMMEDIATE")) {
+        qDebug() << "Error starting transaction:" << query.lastError().text();
+        return false;
+    }
+    transactionOpen = true;
+
+    // Under the write lock already: whatever moves the counters from here to COMMIT is ours
+    readChangeStamp(conn, transactionStamp);
+    return true;
+}
+
+bool DatabaseManager::commitTransaction() {
+    QSqlDatabase conn = connection();
+    QSqlQuery query(conn);
+
+    // Counters as this transaction leaves them; an index that was current at
+    // transactionStamp applies the changes and is then current at these
+    ChangeStamp leaving;
+    readChangeStamp(conn, leaving);
+
+    auto commit = [&query, &leaving]() {
+        if (!query.exec("COMMIT")) {
+            qDebug() << "Error committing transaction:" << query.lastError().text();
+            return false;
+        }
+        reportAccountChanges(leaving); // Before a reader can cache the old rows again
+        return true;
+    };
+
+    // Changed items and holds reach FacetIndex and HoldQueueIndex together with the
+    // COMMIT, so both see successive transactions' changes in commit order. Every
+    // transaction goes through both and AccountCache, which follow the counters it moves.
+    auto commitHolds = [&commit, &leaving]() {
+        return HoldQueueIndex::getInstance().publish(holdChanges, transactionStamp, leaving, commit);
+    };
+    bool committed = FacetIndex::getInstance().publish(touchedItems, transactionStamp, leaving, commitHolds);
+    if (!committed) return false; // The caller rolls back, which drops the changes
+
+    transactionOpen = false;
+    touchedItems.clear();
+    holdChanges.clear();
+    touchedAccounts.clear();
+    return true;
+}
+
+bool DatabaseManager::rollbackTransaction() {
+    transactionOpen = false;
+    touchedItems.clear();
+    holdChanges.clear();
+    touchedAccounts.clear();
+
+    QSqlQuery query(connection());
+    if (!query.exec("ROLLBACK")) {
+        qDebug() << "Error rolling back transaction:" << query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+DatabaseManager::WriteUnit::WriteUnit(DatabaseManager& manager, const QString& name)
+    : manager(manager), name(name), nested(transactionOpen), open(false) {
+    open = nested ? manager.setSavepoint(name) : manager.beginTransaction();
+}
+
+DatabaseManager::WriteUnit::~WriteUnit() {
+    if (!open) return;
+    if (nested) {
+        manager.rollbackToSavepoint(name);
+    } else {
+        manager.rollbackTransaction();
+    }
+}
+
+bool DatabaseManager::WriteUnit::commit() {
+    if (!open) return false;
+    bool committed = nested ? manager.releaseSavepoint(name) : manager.commitTransaction();
+    if (committed) open = false; // Otherwise the destructor rolls back
+    return committed;
+}
+
+bool DatabaseManager::setSavepoint(const QString& name) {
+    QSqlQuery query(connection());
+    if (!query.exec(QString("SAVEPOINT %1").arg(name))) {
+        qDebug() << "Error setting savepoint:" << query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+bool DatabaseManager::releaseSavepoint(const QString& name) {
+    QSqlQuery query(connection());
+    if (!query.exec(QString("RELEASE SAVEPOINT %1").arg(name))) {
+        qDebug() << "Error releasing savepoint:" << query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+bool DatabaseManager::rollbackToSavepoint(const QString& name) {
+    QSqlQuery query(connection());
+
+    // ROLLBACK TO keeps the savepoint on the stack; release it as well
+    if (!query.exec(QString("ROLLBACK TO SAVEPOINT %1").arg(name))) {
+        qDebug() << "Error rolling back to savepoint:" << query.lastError().text();
+        return false;
+    }
+
+    // Availability flips recorded inside the savepoint may have been undone; re-read those items
+    for (FacetChange& change : touchedItems) change.available = -1;
+    for (HoldChange& change : holdChanges) change.queued = -1; // Likewise hold queues
+    return releaseSavepoint(name);
+}
+
+QString DatabaseManager::threadConnectionName() {
+    return QString("library_connection_%1").arg(quintptr(QThread::currentThreadId()));
+}
+
+bool DatabaseManager::isBusyError(const QSqlError& error) {
+    // Primary result code lives in the low byte of SQLite's extended codes
+    int code = error.nativeErrorCode().toInt() & 0xFF;
+    return code == 5 || code == 6; // SQLITE_BUSY, SQLITE_LOCKED
+}
+
+bool DatabaseManager::execQuery(QSqlQuery& query, const char* sql) {
+    // Statement-level timer nested under the calling operation's timer
+    ScopedTimer timer(ScopedTimer::statementKey(sql));
+
+    if (query.exec()) return true;
+
+    timer.fail(isBusyError(query.lastError()));
+    return false;
+}
+
+bool DatabaseManager::execQuery(QSqlQuery& query) {
+    ScopedTimer timer(ScopedTimer::statementKey(query.lastQuery()));
+
+    if (query.exec()) return true;
+
+    timer.fail(isBusyError(query.lastError()));
+    return false;
 }
 
 
 User* DatabaseManager::findUser(const QString& username) {
-    if (!db.isOpen()) {
+    ScopedTimer timer("findUser");
+    if (TraceRecorder::isRecording()) TraceRecorder::getInstance().record("findUser", {username});
+
+    QSqlDatabase conn = connection();
+    if (!conn.isOpen()) {
         qDebug() << "Database not open!";
         return nullptr;
     }
 
-    QSqlQuery query(db);
-    query.prepare("SELECT id, username, role FROM users WHERE username = ?");
+    QSqlQuery query(conn);
+    const char* sql = "SELECT id, username, role, active_loan_count, active_hold_count FROM users WHERE username = ?";
+    query.prepare(sql);
     query.addBindValue(username);
 
-    if (query.exec()) {
+    if (execQuery(query, sql)) {
         if (query.next()) {
-            int id = query.value("id").toInt();
-            QString foundUsername = query.value("username").toString();
-            QString role = query.value("role").toString();
-            return new User(id, foundUsername.toStdString(), role.toStdString());
+            return createUserFromQuery(query);
         } else {
             qDebug() << "No user found with username:" << username;
         }
@@ -59,186 +453,748 @@ User* DatabaseManager::findUser(const QString& username) {
 
 
 std::vector<User*> DatabaseManager::getAllUsers() {
+    ScopedTimer timer("getAllUsers");
+
     std::vector<User*> users;
 
-    if (!db.isOpen()) return users;
+    QSqlDatabase conn = connection();
+    if (!conn.isOpen()) return users;
 
-    QSqlQuery query("SELECT id, username, role FROM users", db);
+    QSqlQuery query(conn);
+    const char* sql = "SELECT id, username, role, active_loan_count, active_hold_count FROM users";
+    query.prepare(sql);
+    if (!execQuery(query, sql)) {
+        qDebug() << "Error getting users:" << query.lastError().text();
+        return users;
+    }
 
     while (query.next()) {
-        int id = query.value("id").toInt();
-        QString username = query.value("username").toString();
-        QString role = query.value("role").toString();
-        users.push_back(new User(id, username.toStdString(), role.toStdString()));
+        users.push_back(createUserFromQuery(query));
     }
 
     return users;
 }
 
+std::vector<User*> DatabaseManager::searchPatrons(const QString& filter, const QString& afterUsername, int limit) {
+    ScopedTimer timer("searchPatrons");
+    if (TraceRecorder::isRecording()) TraceRecorder::getInstance().record("searchPatrons", {filter, afterUsername, limit});
+
+    std::vector<User*> patrons;
+
+    QSqlDatabase conn = connection();
+    if (!conn.isOpen() || limit <= 0) return patrons;
+
+    QSqlQuery query(conn);
+
+    // A numeric filter is also treated as a card number: exact primary key lookup,
+    // shown ahead of the username matches on the first page only, and left out of
+    // the username matches on every page
+    bool isCardNumber = false;
+    int cardNumber = filter.toInt(&isCardNumber);
+    if (isCardNumber && afterUsername.isEmpty()) {
+        const char* sql = "SELECT id, username, role, active_loan_count, active_hold_count FROM users "
+                          "WHERE id = ? AND role = 'patron'";
+        query.prepare(sql);
+        query.addBindValue(cardNumber);
+
+        if (execQuery(query, sql) && query.next()) {
+            patrons.push_back(createUserFromQuery(query));
+        }
+    }
+
+    // Prefix match as a half-open range so SQLite can walk idx_users_role_username
+    // (LIKE 'abc%' would not use the index under the default case-insensitive LIKE)
+    const char* sql =
+        "SELECT id, username, role, active_loan_count, active_hold_count FROM users "
+        "WHERE role = 'patron' AND username >= ? AND username < ? AND username > ? AND id <> ? "
+        "ORDER BY username LIMIT ?";
+    query.prepare(sql);
+    query.addBindValue(filter);
+    query.addBindValue(filter + QChar(0xFFFF));
+    query.addBindValue(afterUsername);
+    query.addBindValue(isCardNumber ? cardNumber : -1);
+    query.addBindValue(limit);
+
+    if (!execQuery(query, sql)) {
+        qDebug() << "Error searching patrons:" << query.lastError().text();
+        return patrons;
+    }
+
+    while (query.next()) {
+        patrons.push_back(createUserFromQuery(query));
+    }
+
+    return patrons;
+}
+
 std::vector<LibraryItem*> DatabaseManager::getAllCatalogueItems() {
+    ScopedTimer timer("getAllCatalogueItems");
+    if (TraceRecorder::isRecording()) TraceRecorder::getInstance().record("getAllCatalogueItems", {});
+
     std::vector<LibraryItem*> items;
 
-    if (!db.isOpen()) {
+    QSqlDatabase conn = connection();
+    if (!conn.isOpen()) {
         qDebug() << "Database not open!";
         return items;
     }
 
-    QSqlQuery query("SELECT * FROM catalogue_items", db);
+    loadCatalogueItems(conn, items);
+    return items;
+}
+
+bool DatabaseManager::loadCatalogueItems(QSqlDatabase& conn, std::vector<LibraryItem*>& items) {
+    // Unchanged since the snapshot was written: build the items from the mapped file,
+    // with the counters circulation has moved since
+    std::shared_ptr<CatalogueSnapshot> current = currentSnapshot(conn);
+    QHash<int, ItemCounters> moved;
+    if (current && readMovedCounters(conn, current->getCirculation(), -1, moved)) {
+        CatalogueSnapshot::ItemRow row;
+        items.reserve(current->count());
+        for (int i = 0; i < current->count(); ++i) {
+            current->row(i, row);
+            overlayCounters(moved, row);
+            LibraryItem* item = createItemFromRow(row);
+            if (item) items.push_back(item);
+        }
+        return true;
+    }
+
+    // ORDER BY id is the rowid order of the table scan, so it costs no sort
+    QSqlQuery query(conn);
+    const char* sql = "SELECT * FROM catalogue_items ORDER BY id";
+    query.prepare(sql);
+    if (!execQuery(query, sql)) {
+        qDebug() << "Error getting catalogue items:" << query.lastError().text();
+        return false;
+    }
 
-    int count = 0;
     while (query.next()) {
         LibraryItem* item = createItemFromQuery(query);
         if (item) {
             items.push_back(item);
-            count++;
         }
     }
+    return true;
+}
 
-    return items;
+std::shared_ptr<const CatalogueVersion> DatabaseManager::getPublishedCatalogueVersion() const {
+    return std::atomic_load(&catalogueVersion);
+}
+
+std::shared_ptr<const CatalogueVersion> DatabaseManager::getCatalogueVersion() {
+    ScopedTimer timer("getCatalogueVersion");
+
+    QSqlDatabase conn = connection();
+
+    // Inside a transaction this connection sees uncommitted rows, which must not be published
+    if (!conn.isOpen() || transactionOpen) return getPublishedCatalogueVersion();
+
+    // One refresh at a time; readers of the published version never wait on it
+    QMutexLocker locker(&catalogueVersionMutex);
+    std::shared_ptr<const CatalogueVersion> published = getPublishedCatalogueVersion();
+
+    // Generation and rows from one read transaction, so they describe the same catalogue
+    QSqlQuery query(conn);
+    if (!query.exec("BEGIN")) {
+        qDebug() << "Error starting catalogue read:" << query.lastError().text();
+        timer.fail();
+        return published;
+    }
+    std::shared_ptr<const CatalogueVersion> next = readCatalogueVersion(conn, published);
+    query.exec("COMMIT");
+
+    if (!next) {
+        timer.fail();
+        return published;
+    }
+    if (next != published) std::atomic_store(&catalogueVersion, next);
+    return next;
+}
+
+std::shared_ptr<const CatalogueVersion> DatabaseManager::readCatalogueVersion(
+        QSqlDatabase& conn, const std::shared_ptr<const CatalogueVersion>& published) {
+    ChangeStamp stamp;
+    if (!readChangeStamp(conn, stamp)) return nullptr;
+    if (published && published->getGeneration() == stamp.catalogue &&
+        published->getCirculation() == stamp.circulation) {
+        return published;
+    }
+
+    if (published) {
+        // Items changed (or removed), or whose counters moved, since the published version was read
+        std::vector<int> changedIds;
+        QSqlQuery changes(conn);
+        const char* sql = "SELECT item_id FROM catalogue_changes WHERE generation > ? "
+                          "UNION SELECT item_id FROM circulation_changes WHERE generation > ? ORDER BY item_id";
+        changes.prepare(sql);
+        changes.addBindValue(published->getGeneration());
+        changes.addBindValue(published->getCirculation());
+        if (!execQuery(changes, sql)) {
+            qDebug() << "Error reading catalogue changes:" << changes.lastError().text();
+            return nullptr;
+        }
+        while (changes.next()) changedIds.push_back(changes.value(0).toInt());
+
+        // Past a quarter of the catalogue, one scan is cheaper than that many lookups
+        if (changedIds.size() <= size_t(published->count() / 4)) {
+            std::vector<CatalogueVersion::Item> changed;
+            std::vector<int> removed;
+            const int batchSize = 500; // Stays under SQLite's bound-parameter limit
+
+            for (size_t start = 0; start < changedIds.size(); start += batchSize) {
+                size_t end = qMin(changedIds.size(), start + size_t(batchSize));
+                QStringList placeholders;
+                for (size_t i = start; i < end; ++i) placeholders << "?";
+
+                QSqlQuery rows(conn);
+                rows.prepare(QString("SELECT * FROM catalogue_items WHERE id IN (%1) ORDER BY id")
+                             .arg(placeholders.join(", ")));
+                for (size_t i = start; i < end; ++i) rows.addBindValue(changedIds[i]);
+                if (!execQuery(rows)) {
+                    qDebug() << "Error reading changed catalogue items:" << rows.lastError().text();
+                    return nullptr;
+                }
+
+                // Both lists are in ID order: IDs with no row were removed
+                size_t next = start;
+                while (rows.next()) {
+                    int itemId = rows.value("id").toInt();
+                    while (next < end && changedIds[next] < itemId) removed.push_back(changedIds[next++]);
+                    if (next < end && changedIds[next] == itemId) next++;
+
+                    LibraryItem* item = createItemFromQuery(rows);
+                    if (item) changed.push_back(CatalogueVersion::Item(item));
+                }
+                while (next < end) removed.push_back(changedIds[next++]);
+            }
+            return published->withChanges(changed, removed, stamp.catalogue, stamp.circulation);
+        }
+    }
+
+    std::vector<LibraryItem*> loaded;
+    if (!loadCatalogueItems(conn, loaded)) return nullptr;
+
+    std::vector<CatalogueVersion::Item> items;
+    items.reserve(loaded.size());
+    for (LibraryItem* item : loaded) items.push_back(CatalogueVersion::Item(item));
+    return CatalogueVersion::build(items, stamp.catalogue, stamp.circulation);
+}
+
+User* DatabaseManager::createUserFromQuery(const QSqlQuery& query) {
+    User* user = new User(query.value("id").toInt(),
+                          query.value("username").toString().toStdString(),
+                          query.value("role").toString().toStdString());
+    user->activeLoanCount = query.value("active_loan_count").toInt();
+    user->activeHoldCount = query.value("active_hold_count").toInt();
+    return user;
 }
 
 LibraryItem* DatabaseManager::createItemFromQuery(const QSqlQuery& query) {
-    QString itemType = query.value("item_type").toString();
-    QString title = query.value("title").toString();
-    QString author = query.value("author").toString();
-    bool isAvailable = query.value("is_available").toBool();
-    int publicationYear = query.value("publication_year").toInt();
-    QString condition = query.value("condition").toString();
-    QString isbn = query.value("isbn").toString();
-    QString deweyDecimal = query.value("dewey_decimal").toString();
-    QString genre = query.value("genre").toString();
-    QString rating = query.value("rating").toString();
-    int issueNumber = query.value("issue_number").toInt();
-    QString publicationDate = query.value("publication_date").toString();
+    CatalogueSnapshot::ItemRow row;
+    readItemRow(query, row);
+    return createItemFromRow(row);
+}
 
+void DatabaseManager::readItemRow(const QSqlQuery& query, CatalogueSnapshot::ItemRow& row) {
+    row.id = query.value("id").toInt();
+    row.itemType = query.value("item_type").toString().toStdString();
+    row.title = query.value("title").toString().toStdString();
+    row.author = query.value("author").toString().toStdString();
+    row.deweyDecimal = query.value("dewey_decimal").toString().toStdString();
+    row.isbn = query.value("isbn").toString().toStdString();
+    row.genre = query.value("genre").toString().toStdString();
+    row.rating = query.value("rating").toString().toStdString();
+    row.publicationDate = query.value("publication_date").toString().toStdString();
+    row.condition = query.value("condition").toString().toStdString();
+    row.publicationYear = query.value("publication_year").toInt();
+    row.issueNumber = query.value("issue_number").toInt();
+    row.totalCopies = query.value("total_copies").toInt();
+    row.availableCopies = query.value("available_copies").toInt();
+    row.holdCount = query.value("hold_count").toInt();
+    row.isAvailable = query.value("is_available").toBool();
+}
+
+LibraryItem* DatabaseManager::createItemFromRow(const CatalogueSnapshot::ItemRow& row) {
     LibraryItem* item = nullptr;
 
-    if (itemType == "fiction") {
-        item = new FictionBook(title.toStdString(), author.toStdString(),
-                              publicationYear, condition.toStdString(),
-                              isbn.toStdString());
+    if (row.itemType == "fiction") {
+        item = new FictionBook(row.title, row.author, row.publicationYear, row.condition, row.isbn);
     }
-    else if (itemType == "nonfiction") {
-        item = new NonFictionBook(title.toStdString(), author.toStdString(),
-                                 deweyDecimal.toStdString(), publicationYear,
-                                 condition.toStdString(), isbn.toStdString());
+    else if (row.itemType == "nonfiction") {
+        item = new NonFictionBook(row.title, row.author, row.deweyDecimal, row.publicationYear,
+                                  row.condition, row.isbn);
     }
-    else if (itemType == "magazine") {
-        item = new Magazine(title.toStdString(), author.toStdString(),
-                           issueNumber, publicationDate.toStdString(),
-                           publicationYear, condition.toStdString());
+    else if (row.itemType == "magazine") {
+        item = new Magazine(row.title, row.author, row.issueNumber, row.publicationDate,
+                            row.publicationYear, row.condition);
     }
-    else if (itemType == "movie") {
-        item = new Movie(title.toStdString(), author.toStdString(),
-                        genre.toStdString(), rating.toStdString(),
-                        publicationYear, condition.toStdString());
+    else if (row.itemType == "movie") {
+        item = new Movie(row.title, row.author, row.genre, row.rating,
+                         row.publicationYear, row.condition);
     }
-    else if (itemType == "videogame") {
-        item = new VideoGame(title.toStdString(), author.toStdString(),
-                            genre.toStdString(), rating.toStdString(),
-                            publicationYear, condition.toStdString());
+    else if (row.itemType == "videogame") {
+        item = new VideoGame(row.title, row.author, row.genre, row.rating,
+                             row.publicationYear, row.condition);
     }
 
     if (item) {
-        item->setAvailable(isAvailable);
+        item->setId(row.id);
+        item->setCopies(row.availableCopies, row.totalCopies);
+        item->setAvailable(row.isAvailable);
+        item->setHoldCount(row.holdCount);
     }
 
     return item;
 }
 
-
 int DatabaseManager::getItemId(LibraryItem* item) {
-    if (!db.isOpen() || !item) return -1;
+    ScopedTimer timer("getItemId");
 
-    QSqlQuery query(db);
-    query.prepare("SELECT id FROM catalogue_items WHERE title = ? AND author = ?");
+    QSqlDatabase conn = connection();
+    if (!conn.isOpen() || !item) return -1;
+
+    QSqlQuery query(conn);
+    const char* sql = "SELECT id FROM catalogue_items WHERE title = ? AND author = ?";
+    query.prepare(sql);
     query.addBindValue(QString::fromStdString(item->getTitle()));
     query.addBindValue(QString::fromStdString(item->getAuthor()));
 
-    if (query.exec() && query.next()) {
+    if (execQuery(query, sql) && query.next()) {
         return query.value("id").toInt();
     }
 
     return -1;
 }
 
+int DatabaseManager::findByIsbn(const QString& isbn) {
+    ScopedTimer timer("findByIsbn");
+
+    int itemId = -1;
+    findIsbn(isbn, itemId);
+    return itemId;
+}
+
+bool DatabaseManager::findIsbn(const QString& isbn, int& itemId) {
+    itemId = -1;
+    qint64 key = CatalogueKeys::isbnKey(isbn);
+    if (key < 0) return true; // Not an ISBN, so no item has it
+
+    QSqlDatabase conn = connection();
+    if (!conn.isOpen()) return false;
+
+    QSqlQuery query(conn);
+    const char* sql = "SELECT id FROM catalogue_items WHERE isbn_key = ? ORDER BY id LIMIT 1";
+    query.prepare(sql);
+    query.addBindValue(key);
+
+    if (!execQuery(query, sql)) return false;
+    if (query.next()) itemId = query.value("id").toInt();
+    return true;
+}
+
+int DatabaseManager::findByBarcode(const QString& barcode) {
+    ScopedTimer timer("findByBarcode");
+
+    int copyId = -1;
+    int itemId = -1;
+    findCopy(barcode, copyId, itemId);
+    return itemId;
+}
+
+bool DatabaseManager::findCopy(const QString& barcode, int& copyId, int& itemId) {
+    copyId = -1;
+    itemId = -1;
+
+    QSqlDatabase conn = connection();
+    if (!conn.isOpen()) return false;
+
+    // Scanners send what is printed on the label; barcodes are stored in upper case
+    QSqlQuery query(conn);
+    const char* sql = "SELECT id, item_id FROM item_copies WHERE barcode = ?";
+    query.prepare(sql);
+    query.addBindValue(barcode.trimmed().toUpper());
+
+    if (!execQuery(query, sql)) return false;
+    if (query.next()) {
+        copyId = query.value("id").toInt();
+        itemId = query.value("item_id").toInt();
+    }
+    return true;
+}
+
+DatabaseManager::WriteResult DatabaseManager::tryBorrowScanned(int userId, const QString& code, int& itemId) {
+    ScopedTimer timer("borrowScanned");
+    itemId = -1;
+
+    QSqlDatabase conn = connection();
+    if (!conn.isOpen()) return WriteFailed;
+
+    // Lookup and loan share one transaction, so the copy found is the copy lent
+    WriteUnit unit(*this, "borrow_scanned");
+    if (!unit.isOpen()) {
+        timer.fail();
+        return WriteFailed;
+    }
+
+    // A valid ISBN is never a copy barcode: labels carry letters, ISBNs a check digit
+    int copyId = -1;
+    bool looked = CatalogueKeys::isbnKey(code) >= 0 ? findIsbn(code, itemId) : findCopy(code, copyId, itemId);
+    if (!looked) {
+        timer.fail();
+        return WriteFailed;
+    }
+    if (itemId == -1) return WriteNotFound;
+
+    if (TraceRecorder::isRecording()) TraceRecorder::getInstance().record("borrowItem", {userId, itemId});
+
+    WriteResult result = borrowCopy(userId, itemId, copyId);
+    if (result != WriteOk) return result;
+    return unit.commit() ? WriteOk : WriteFailed;
+}
+
 bool DatabaseManager::borrowItem(int userId, int itemId) {
-    if (!db.isOpen()) {
+    return tryBorrowItem(userId, itemId) == WriteOk;
+}
+
+DatabaseManager::WriteResult DatabaseManager::tryBorrowItem(int userId, int itemId) {
+    ScopedTimer timer("borrowItem");
+    if (TraceRecorder::isRecording()) TraceRecorder::getInstance().record("borrowItem", {userId, itemId});
+
+    WriteResult result = borrowCopy(userId, itemId, -1);
+    if (result == WriteFailed) timer.fail();
+    return result;
+}
+
+DatabaseManager::WriteResult DatabaseManager::borrowCopy(int userId, int itemId, int copyId) {
+    QSqlDatabase conn = connection();
+    if (!conn.isOpen()) {
         qDebug() << "Database not open for borrowing!";
+        return WriteFailed;
+    }
+
+    WriteUnit unit(*this, "borrow_item");
+    if (!unit.isOpen()) return WriteFailed;
+
+    QSqlQuery query(conn);
+    int wantedCopy = copyId;
+
+    // 1. A copy waiting on the hold shelf for this user is theirs to take
+    const char* sql = "SELECT id FROM item_copies WHERE item_id = ? AND held_for = ? AND (? = -1 OR id = ?) LIMIT 1";
+    query.prepare(sql);
+    query.addBindValue(itemId);
+    query.addBindValue(userId);
+    query.addBindValue(wantedCopy);
+    query.addBindValue(wantedCopy);
+    if (!execQuery(query, sql)) {
+        qDebug() << "Error looking up held copy:" << query.lastError().text();
+        return WriteFailed;
+    }
+    copyId = query.next() ? query.value("id").toInt() : -1;
+
+    if (copyId == -1) {
+        // 2. Otherwise take a copy off the shelf. The counter update is conditional, so of
+        //    two concurrent borrows of the last copy (or two in one group commit) exactly one wins
+        sql = "UPDATE catalogue_items SET available_copies = available_copies - 1, "
+              "is_available = (available_copies > 1) WHERE id = ? AND available_copies > 0";
+        query.prepare(sql);
+        query.addBindValue(itemId);
+
+        if (!execQuery(query, sql)) {
+            qDebug() << "Error updating item availability:" << query.lastError().text();
+            return WriteFailed;
+        }
+        if (query.numRowsAffected() == 0) {
+            // Lost the race, unless the item does not exist at all
+            sql = "SELECT 1 FROM catalogue_items WHERE id = ?";
+            query.prepare(sql);
+            query.addBindValue(itemId);
+            bool exists = execQuery(query, sql) && query.next();
+            return exists ? WriteConflict : WriteFailed;
+        }
+
+        // A scanned copy must itself be on the shelf; held for someone else or on loan, it is taken.
+        // The item's remaining count comes along for FacetIndex
+        sql = "SELECT c.id, i.available_copies FROM item_copies c JOIN catalogue_items i ON i.id = c.item_id "
+              "WHERE c.item_id = ? AND c.status = 'available' AND (? = -1 OR c.id = ?) LIMIT 1";
+        query.prepare(sql);
+        query.addBindValue(itemId);
+        query.addBindValue(wantedCopy);
+        query.addBindValue(wantedCopy);
+        if (!execQuery(query, sql)) return WriteFailed;
+        if (!query.next()) {
+            if (wantedCopy != -1) return WriteConflict;
+            qDebug() << "No available copy row for item" << itemId << "- copy counters out of date";
+            return WriteFailed;
+        }
+        copyId = query.value(0).toInt();
+        markAvailability(itemId, query.value(1).toInt() > 0); // The last copy on the shelf may have gone
+    }
+
+    sql = "UPDATE item_copies SET status = 'on_loan', held_for = NULL WHERE id = ?";
+    query.prepare(sql);
+    query.addBindValue(copyId);
+    if (!execQuery(query, sql)) {
+        qDebug() << "Error updating copy status:" << query.lastError().text();
+        return WriteFailed;
+    }
+
+    // 3. Circulation statistics; a hold ended by this borrow adds its wait
+    if (!updateItemStats(itemId,
+                         "borrow_count = borrow_count + 1, "
+                         "holds_filled = holds_filled + (SELECT COUNT(*) FROM holds WHERE user_id = ? AND item_id = ?), "
+                         "hold_wait_days = hold_wait_days + COALESCE((SELECT julianday('now') - julianday(created_date) "
+                         "FROM holds WHERE user_id = ? AND item_id = ?), 0)",
+                         {userId, itemId, userId, itemId})) {
+        return WriteFailed;
+    }
+
+    // 4. Borrowing fulfils the user's hold on the item, if any
+    if (!deleteHold(userId, itemId)) return WriteFailed;
+
+    // 5. Create loan record in loans table
+    QDate checkoutDate = QDate::currentDate();
+    QDate dueDate = checkoutDate.addDays(14);
+
+    sql = "INSERT INTO loans (user_id, item_id, copy_id, checkout_date, due_date) VALUES (?, ?, ?, ?, ?)";
+    query.prepare(sql);
+    query.addBindValue(userId);
+    query.addBindValue(itemId);
+    query.addBindValue(copyId);
+    query.addBindValue(checkoutDate.toString("yyyy-MM-dd"));
+    query.addBindValue(dueDate.toString("yyyy-MM-dd"));
+
+    if (!execQuery(query, sql)) {
+        qDebug() << "Error creating loan record:" << query.lastError().text();
+        return WriteFailed;
+    }
+
+    if (!adjustCounter("users", "active_loan_count", userId, 1)) return WriteFailed;
+    touchAccount(userId);
+
+    return unit.commit() ? WriteOk : WriteFailed;
+}
+
+bool DatabaseManager::returnItem(int userId, int itemId) {
+    return tryReturnItem(userId, itemId) == WriteOk;
+}
+
+DatabaseManager::WriteResult DatabaseManager::tryReturnItem(int userId, int itemId) {
+    ScopedTimer timer("returnItem");
+    if (TraceRecorder::isRecording()) TraceRecorder::getInstance().record("returnItem", {userId, itemId});
+
+    QSqlDatabase conn = connection();
+    if (!conn.isOpen()) return WriteFailed;
+
+    WriteUnit unit(*this, "return_item");
+    if (!unit.isOpen()) return WriteFailed;
+
+    QSqlQuery query(conn);
+
+    // 1. Find the open loan; without one there is nothing to return (e.g. already returned at another desk)
+    const char* sql = "SELECT id, copy_id FROM loans WHERE user_id = ? AND item_id = ? AND return_date IS NULL LIMIT 1";
+    query.prepare(sql);
+    query.addBindValue(userId);
+    query.addBindValue(itemId);
+    if (!execQuery(query, sql)) {
+        qDebug() << "Error finding loan:" << query.lastError().text();
+        return WriteFailed;
+    }
+    if (!query.next()) {
+        return WriteConflict;
+    }
+    int loanId = query.value("id").toInt();
+    int copyId = query.value("copy_id").isNull() ? -1 : query.value("copy_id").toInt();
+
+    // 2. Move the loan to the history with its return date; loans keeps active loans only
+    sql = "INSERT INTO loan_history (id, user_id, item_id, copy_id, checkout_date, due_date, return_date) "
+          "SELECT id, user_id, item_id, copy_id, checkout_date, due_date, ? FROM loans WHERE id = ?";
+    query.prepare(sql);
+    query.addBindValue(QDate::currentDate().toString("yyyy-MM-dd"));
+    query.addBindValue(loanId);
+
+    if (!execQuery(query, sql)) {
+        qDebug() << "Error archiving loan:" << query.lastError().text();
+        return WriteFailed;
+    }
+
+    sql = "DELETE FROM loans WHERE id = ?";
+    query.prepare(sql);
+    query.addBindValue(loanId);
+
+    if (!execQuery(query, sql)) {
+        qDebug() << "Error removing returned loan:" << query.lastError().text();
+        return WriteFailed;
+    }
+
+    if (!adjustCounter("users", "active_loan_count", userId, -1)) return WriteFailed;
+    touchAccount(userId);
+
+    // Loans recorded before copies existed: any copy of the item that is out will do
+    if (copyId == -1) {
+        sql = "SELECT id FROM item_copies WHERE item_id = ? AND status = 'on_loan' LIMIT 1";
+        query.prepare(sql);
+        query.addBindValue(itemId);
+        if (execQuery(query, sql) && query.next()) {
+            copyId = query.value("id").toInt();
+        }
+    }
+
+    // 3. The copy goes to the next hold in line, or back on the shelf
+    if (copyId != -1 && !shelveCopy(copyId, itemId)) {
+        return WriteFailed;
+    }
+
+    return unit.commit() ? WriteOk : WriteFailed;
+}
+
+bool DatabaseManager::adjustCounter(const char* table, const char* column, int id, int delta) {
+    QSqlQuery query(connection());
+    query.prepare(QString("UPDATE %1 SET %2 = %2 + ? WHERE id = ?").arg(table, column));
+    query.addBindValue(delta);
+    query.addBindValue(id);
+
+    if (!execQuery(query)) {
+        qDebug() << "Error updating" << table << column << ":" << query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+bool DatabaseManager::updateItemStats(int itemId, const QString& assignments, const QVariantList& values) {
+    QSqlQuery query(connection());
+    const char* sql = "INSERT OR IGNORE INTO item_stats (item_id) VALUES (?)";
+    query.prepare(sql);
+    query.addBindValue(itemId);
+
+    if (!execQuery(query, sql)) {
+        qDebug() << "Error creating item statistics:" << query.lastError().text();
+        return false;
+    }
+
+    query.prepare(QString("UPDATE item_stats SET %1 WHERE item_id = ?").arg(assignments));
+    for (const QVariant& value : values) query.addBindValue(value);
+    query.addBindValue(itemId);
+
+    if (!execQuery(query)) {
+        qDebug() << "Error updating item statistics:" << query.lastError().text();
         return false;
     }
+    return true;
+}
+
+void DatabaseManager::touchItem(int itemId) {
+    if (transactionOpen) {
+        touchedItems.push_back({itemId, -1});
+    } else {
+        FacetIndex::getInstance().itemsChanged({itemId});
+        AccountCache::getInstance().changed({}, {itemId});
+    }
+}
+
+void DatabaseManager::recordHoldChange(int itemId, int userId, bool queued) {
+    if (transactionOpen) {
+        holdChanges.push_back({itemId, userId, queued ? 1 : 0});
+    } else {
+        HoldQueueIndex::getInstance().itemsChanged({itemId});
+        AccountCache::getInstance().changed({userId}, {itemId});
+    }
+}
 
-    QSqlQuery query(db);
+void DatabaseManager::markAvailability(int itemId, bool available) {
+    if (transactionOpen) {
+        touchedItems.push_back({itemId, available ? 1 : 0});
+    } else {
+        // Already committed, so not ordered against other writers; re-read instead
+        FacetIndex::getInstance().itemsChanged({itemId});
+        AccountCache::getInstance().changed({}, {itemId});
+    }
+}
 
-    // 1. Update item availability in catalogue_items
-    query.prepare("UPDATE catalogue_items SET is_available = 0 WHERE id = ?");
-    query.addBindValue(itemId);
+void DatabaseManager::touchAccount(int userId) {
+    if (transactionOpen) {
+        touchedAccounts.push_back(userId);
+    } else {
+        AccountCache::getInstance().changed({userId}, {});
+    }
+}
 
-    if (!query.exec()) {
-        qDebug() << "Error updating item availability:" << query.lastError().text();
-        return false;
+void DatabaseManager::reportAccountChanges(const ChangeStamp& leaving) {
+    std::vector<int> userIds = touchedAccounts;
+    std::vector<int> itemIds;
+    for (const FacetChange& change : touchedItems) itemIds.push_back(change.itemId);
+    for (const HoldChange& change : holdChanges) {
+        userIds.push_back(change.userId);
+        itemIds.push_back(change.itemId);
     }
+    AccountCache::getInstance().committed(userIds, itemIds, transactionStamp, leaving);
+}
 
-    // 2. Create loan record in loans table
-    QDate checkoutDate = QDate::currentDate();
-    QDate dueDate = checkoutDate.addDays(14);
+bool DatabaseManager::shelveCopy(int copyId, int itemId) {
+    QSqlQuery query(connection());
 
-    query.prepare("INSERT INTO loans (user_id, item_id, checkout_date, due_date) VALUES (?, ?, ?, ?)");
-    query.addBindValue(userId);
+    // First hold in the queue that is not already waiting on a copy
+    const char* sql =
+        "SELECT h.user_id FROM holds h WHERE h.item_id = ? AND NOT EXISTS "
+        "(SELECT 1 FROM item_copies c WHERE c.item_id = h.item_id AND c.held_for = h.user_id) "
+        "ORDER BY h.position LIMIT 1";
+    query.prepare(sql);
     query.addBindValue(itemId);
-    query.addBindValue(checkoutDate.toString("yyyy-MM-dd"));
-    query.addBindValue(dueDate.toString("yyyy-MM-dd"));
-
-    if (!query.exec()) {
-        qDebug() << "Error creating loan record:" << query.lastError().text();
+    if (!execQuery(query, sql)) {
+        qDebug() << "Error reading hold queue:" << query.lastError().text();
         return false;
     }
 
-    return true;
-}
-
-bool DatabaseManager::returnItem(int userId, int itemId) {
-    if (!db.isOpen()) return false;
-
-    QSqlQuery query(db);
-
-    // 1. Update item availability back to available
-    query.prepare("UPDATE catalogue_items SET is_available = 1 WHERE id = ?");
-    query.addBindValue(itemId);
+    if (query.next()) {
+        int holderId = query.value("user_id").toInt();
+        sql = "UPDATE item_copies SET status = 'held', held_for = ? WHERE id = ?";
+        query.prepare(sql);
+        query.addBindValue(holderId);
+        query.addBindValue(copyId);
+        if (!execQuery(query, sql)) {
+            qDebug() << "Error placing copy on hold shelf:" << query.lastError().text();
+            return false;
+        }
+        return true;
+    }
 
-    if (!query.exec()) {
-        qDebug() << "Error updating item availability on return:" << query.lastError().text();
+    sql = "UPDATE item_copies SET status = 'available', held_for = NULL WHERE id = ?";
+    query.prepare(sql);
+    query.addBindValue(copyId);
+    if (!execQuery(query, sql)) {
+        qDebug() << "Error updating copy status:" << query.lastError().text();
         return false;
     }
 
-    // 2. Update loan record with return date
-    query.prepare("UPDATE loans SET return_date = ? WHERE user_id = ? AND item_id = ? AND return_date IS NULL");
-    query.addBindValue(QDate::currentDate().toString("yyyy-MM-dd"));
-    query.addBindValue(userId);
+    sql = "UPDATE catalogue_items SET available_copies = available_copies + 1, is_available = 1 WHERE id = ?";
+    query.prepare(sql);
     query.addBindValue(itemId);
-
-    if (!query.exec()) {
-        qDebug() << "Error updating loan return date:" << query.lastError().text();
+    if (!execQuery(query, sql)) {
+        qDebug() << "Error updating item availability on return:" << query.lastError().text();
         return false;
     }
-
+    markAvailability(itemId, true);
     return true;
 }
 
 std::vector<LibraryItem*> DatabaseManager::getUserBorrowedItems(int userId) {
+    ScopedTimer timer("getUserBorrowedItems");
+    if (TraceRecorder::isRecording()) TraceRecorder::getInstance().record("getUserBorrowedItems", {userId});
+
     std::vector<LibraryItem*> items;
 
-    if (!db.isOpen()) return items;
+    QSqlDatabase conn = connection();
+    if (!conn.isOpen()) return items;
 
-    QSqlQuery query(db);
-    query.prepare(
+    QSqlQuery query(conn);
+    const char* sql =
         "SELECT ci.* FROM catalogue_items ci "
         "JOIN loans l ON ci.id = l.item_id "
-        "WHERE l.user_id = ? AND l.return_date IS NULL"
-    );
+        "WHERE l.user_id = ? AND l.return_date IS NULL";
+    query.prepare(sql);
     query.addBindValue(userId);
 
-    if (query.exec()) {
+    if (execQuery(query, sql)) {
         while (query.next()) {
             LibraryItem* item = createItemFromQuery(query);
             if (item) {
@@ -254,64 +1210,99 @@ std::vector<LibraryItem*> DatabaseManager::getUserBorrowedItems(int userId) {
 
 
 bool DatabaseManager::placeHold(int userId, int itemId) {
-    if (!db.isOpen()) return false;
+    ScopedTimer timer("placeHold");
+    if (TraceRecorder::isRecording()) TraceRecorder::getInstance().record("placeHold", {userId, itemId});
+
+    QSqlDatabase conn = connection();
+    if (!conn.isOpen()) return false;
 
-    QSqlQuery query(db);
+    WriteUnit unit(*this, "place_hold");
+    if (!unit.isOpen()) return false;
 
-    // Get current highest position in hold queue for this item
-    query.prepare("SELECT COALESCE(MAX(position), 0) + 1 as new_position FROM holds WHERE item_id = ?");
+    QSqlQuery query(conn);
+
+    // Next ticket in the item's queue (tickets are never renumbered; see HoldQueueIndex)
+    const char* sql = "SELECT COALESCE(MAX(position), 0) + 1 as new_position FROM holds WHERE item_id = ?";
+    query.prepare(sql);
     query.addBindValue(itemId);
 
     int position = 1;
-    if (query.exec() && query.next()) {
+    if (execQuery(query, sql) && query.next()) {
         position = query.value("new_position").toInt();
     }
 
     // Insert the hold
-    query.prepare("INSERT INTO holds (user_id, item_id, position) VALUES (?, ?, ?)");
+    sql = "INSERT INTO holds (user_id, item_id, position) VALUES (?, ?, ?)";
+    query.prepare(sql);
     query.addBindValue(userId);
     query.addBindValue(itemId);
     query.addBindValue(position);
 
-    if (!query.exec()) {
+    if (!execQuery(query, sql)) {
         qDebug() << "Error placing hold:" << query.lastError().text();
         return false;
     }
+    recordHoldChange(itemId, userId, true);
 
-    return true;
+    if (!adjustCounter("catalogue_items", "hold_count", itemId, 1) ||
+        !adjustCounter("users", "active_hold_count", userId, 1) ||
+        !updateItemStats(itemId, "holds_placed = holds_placed + 1", QVariantList())) {
+        return false;
+    }
+
+    return unit.commit();
 }
 
 bool DatabaseManager::cancelHold(int userId, int itemId) {
-    if (!db.isOpen()) return false;
+    ScopedTimer timer("cancelHold");
+    if (TraceRecorder::isRecording()) TraceRecorder::getInstance().record("cancelHold", {userId, itemId});
 
-    QSqlQuery query(db);
+    QSqlDatabase conn = connection();
+    if (!conn.isOpen()) return false;
 
-    // Get the position of the hold being cancelled
-    query.prepare("SELECT position FROM holds WHERE user_id = ? AND item_id = ?");
-    query.addBindValue(userId);
+    WriteUnit unit(*this, "cancel_hold");
+    if (!unit.isOpen()) return false;
+
+    QSqlQuery query(conn);
+
+    // A copy already waiting on the hold shelf for this user passes to the next in line
+    const char* sql = "SELECT id FROM item_copies WHERE item_id = ? AND held_for = ? LIMIT 1";
+    query.prepare(sql);
     query.addBindValue(itemId);
+    query.addBindValue(userId);
+    int heldCopyId = (execQuery(query, sql) && query.next()) ? query.value("id").toInt() : -1;
 
-    int cancelledPosition = -1;
-    if (query.exec() && query.next()) {
-        cancelledPosition = query.value("position").toInt();
+    if (!deleteHold(userId, itemId)) return false;
+
+    if (heldCopyId != -1 && !shelveCopy(heldCopyId, itemId)) {
+        return false;
     }
 
-    // Delete the hold
-    query.prepare("DELETE FROM holds WHERE user_id = ? AND item_id = ?");
+    return unit.commit();
+}
+
+bool DatabaseManager::deleteHold(int userId, int itemId) {
+    QSqlQuery query(connection());
+
+    // Delete the hold; the holds behind it keep their tickets, so nothing is renumbered
+    const char* sql = "DELETE FROM holds WHERE user_id = ? AND item_id = ?";
+    query.prepare(sql);
     query.addBindValue(userId);
     query.addBindValue(itemId);
 
-    if (!query.exec()) {
+    if (!execQuery(query, sql)) {
         qDebug() << "Error cancelling hold:" << query.lastError().text();
         return false;
     }
 
-    // Update positions for remaining holds (decrement positions above the cancelled one)
-    if (cancelledPosition != -1) {
-        query.prepare("UPDATE holds SET position = position - 1 WHERE item_id = ? AND position > ?");
-        query.addBindValue(itemId);
-        query.addBindValue(cancelledPosition);
-        query.exec(); // We don't care too much if this fails
+    // Borrowing calls this whether or not the borrower had a hold
+    int removed = query.numRowsAffected();
+    if (removed > 0) {
+        if (!adjustCounter("catalogue_items", "hold_count", itemId, -removed) ||
+            !adjustCounter("users", "active_hold_count", userId, -removed)) {
+            return false;
+        }
+        recordHoldChange(itemId, userId, false);
     }
 
     return true;
@@ -319,19 +1310,23 @@ bool DatabaseManager::cancelHold(int userId, int itemId) {
 
 
 std::vector<LibraryItem*> DatabaseManager::getUserHolds(int userId) {
+    ScopedTimer timer("getUserHolds");
+    if (TraceRecorder::isRecording()) TraceRecorder::getInstance().record("getUserHolds", {userId});
+
     std::vector<LibraryItem*> items;
 
-    if (!db.isOpen()) return items;
+    QSqlDatabase conn = connection();
+    if (!conn.isOpen()) return items;
 
-    QSqlQuery query(db);
-    query.prepare(
+    QSqlQuery query(conn);
+    const char* sql =
         "SELECT ci.*, h.position FROM catalogue_items ci "
         "JOIN holds h ON ci.id = h.item_id "
-        "WHERE h.user_id = ? ORDER BY h.position"
-    );
+        "WHERE h.user_id = ? ORDER BY h.position";
+    query.prepare(sql);
     query.addBindValue(userId);
 
-    if (query.exec()) {
+    if (execQuery(query, sql)) {
         while (query.next()) {
             LibraryItem* item = createItemFromQuery(query);
             if (item) {
@@ -348,63 +1343,169 @@ std::vector<LibraryItem*> DatabaseManager::getUserHolds(int userId) {
 }
 
 LibraryItem* DatabaseManager::getItemById(int id) {
-    if (!db.isOpen()) return nullptr;
+    ScopedTimer timer("getItemById");
+    if (TraceRecorder::isRecording()) TraceRecorder::getInstance().record("getItemById", {id});
+
+    QSqlDatabase conn = connection();
+    if (!conn.isOpen()) return nullptr;
+
+    std::shared_ptr<CatalogueSnapshot> current = currentSnapshot(conn);
+    QHash<int, ItemCounters> moved;
+    if (current && readMovedCounters(conn, current->getCirculation(), id, moved)) {
+        int index = current->find(id);
+        if (index < 0) return nullptr;
+
+        CatalogueSnapshot::ItemRow row;
+        current->row(index, row);
+        overlayCounters(moved, row);
+        return createItemFromRow(row);
+    }
 
-    QSqlQuery query(db);
-    query.prepare("SELECT * FROM catalogue_items WHERE id = ?");
+    QSqlQuery query(conn);
+    const char* sql = "SELECT * FROM catalogue_items WHERE id = ?";
+    query.prepare(sql);
     query.addBindValue(id);
 
-    if (query.exec() && query.next()) {
+    if (execQuery(query, sql) && query.next()) {
         return createItemFromQuery(query);
     }
 
     return nullptr;
 }
 
+std::vector<DatabaseManager::ShelfEntry> DatabaseManager::browseShelf(int fromKey, int toKey, int afterKey,
+                                                                     int afterId, int limit) {
+    ScopedTimer timer("browseShelf");
+
+    std::vector<ShelfEntry> shelf;
+    QSqlDatabase conn = connection();
+    if (!conn.isOpen()) return shelf;
+
+    // Starts at the later of the range start and the last position shown
+    QSqlQuery query(conn);
+    const char* sql = "SELECT * FROM catalogue_items "
+                      "WHERE dewey_key >= ? AND dewey_key <= ? AND (dewey_key > ? OR id > ?) "
+                      "ORDER BY dewey_key, id LIMIT ?";
+    query.prepare(sql);
+    query.addBindValue(qMax(fromKey, afterKey));
+    query.addBindValue(toKey);
+    query.addBindValue(afterKey);
+    query.addBindValue(afterId);
+    query.addBindValue(limit);
+
+    if (!execQuery(query, sql)) {
+        qDebug() << "Error browsing shelf:" << query.lastError().text();
+        return shelf;
+    }
+    while (query.next()) {
+        LibraryItem* item = createItemFromQuery(query);
+        if (!item) continue;
+        shelf.push_back({item, query.value("id").toInt(), query.value("dewey_key").toInt()});
+    }
+    return shelf;
+}
+
 int DatabaseManager::getHoldCountForItem(int itemId) {
-    if (!db.isOpen()) return 0;
+    ScopedTimer timer("getHoldCountForItem");
+    if (TraceRecorder::isRecording()) TraceRecorder::getInstance().record("getHoldCountForItem", {itemId});
 
-    QSqlQuery query(db);
-    query.prepare("SELECT COUNT(*) as count FROM holds WHERE item_id = ?");
+    QSqlDatabase conn = connection();
+    if (!conn.isOpen()) return 0;
+
+    QSqlQuery query(conn);
+    const char* sql = "SELECT hold_count FROM catalogue_items WHERE id = ?";
+    query.prepare(sql);
     query.addBindValue(itemId);
 
-    if (query.exec() && query.next()) {
-        return query.value("count").toInt();
+    if (execQuery(query, sql) && query.next()) {
+        return query.value("hold_count").toInt();
     }
 
     return 0;
 }
 
 int DatabaseManager::getHoldPosition(int userId, int itemId) {
-    if (!db.isOpen()) return -1;
+    ScopedTimer timer("getHoldPosition");
+    if (TraceRecorder::isRecording()) TraceRecorder::getInstance().record("getHoldPosition", {userId, itemId});
+
+    QSqlDatabase conn = connection();
+    if (!conn.isOpen()) return -1;
 
-    QSqlQuery query(db);
-    query.prepare("SELECT position FROM holds WHERE user_id = ? AND item_id = ?");
+    // Committed queues are answered from memory; a transaction sees its own holds only in SQL
+    int position = -1;
+    if (!transactionOpen && HoldQueueIndex::getInstance().position(itemId, userId, position)) {
+        return position;
+    }
+
+    // Holds with a ticket up to the user's: a range of idx_holds_item
+    QSqlQuery query(conn);
+    const char* sql = "SELECT COUNT(*) FROM holds q JOIN holds h ON q.item_id = h.item_id AND q.position <= h.position "
+                      "WHERE h.user_id = ? AND h.item_id = ?";
+    query.prepare(sql);
     query.addBindValue(userId);
     query.addBindValue(itemId);
 
-    if (query.exec() && query.next()) {
-        return query.value("position").toInt();
+    if (execQuery(query, sql) && query.next() && query.value(0).toInt() > 0) {
+        return query.value(0).toInt();
     }
 
     return -1;
 }
 
+bool DatabaseManager::getHoldQueue(int itemId, std::vector<int>& userIds) {
+    ScopedTimer timer("getHoldQueue");
+
+    QSqlDatabase conn = connection();
+    if (!conn.isOpen()) return false;
+
+    QSqlQuery query(conn);
+    const char* sql = "SELECT user_id FROM holds WHERE item_id = ? ORDER BY position";
+    query.prepare(sql);
+    query.addBindValue(itemId);
+    if (!execQuery(query, sql)) {
+        qDebug() << "Error reading hold queue:" << query.lastError().text();
+        return false;
+    }
+
+    while (query.next()) userIds.push_back(query.value(0).toInt());
+    return true;
+}
+
+bool DatabaseManager::placeHoldAndGetPosition(int userId, int itemId, int& position) {
+    ScopedTimer timer("placeHoldAndGetPosition");
+
+    WriteUnit unit(*this, "place_hold_position");
+    if (!unit.isOpen() || !placeHold(userId, itemId)) return false;
+
+    position = getHoldPosition(userId, itemId);
+    return unit.commit();
+}
+
 bool DatabaseManager::addItemToCatalogue(const QString& title, const QString& author,
                                         const QString& itemType, const QString& deweyDecimal,
                                         const QString& isbn, const QString& genre,
                                         const QString& rating, int issueNumber,
                                         const QString& publicationDate, int publicationYear,
-                                        const QString& condition) {
-    if (!db.isOpen()) return false;
+                                        const QString& condition, int copies) {
+    ScopedTimer timer("addItemToCatalogue");
 
-    QSqlQuery query(db);
-    query.prepare(
+    QSqlDatabase conn = connection();
+    if (!conn.isOpen() || copies <= 0) return false;
+
+    WriteUnit unit(*this, "add_item");
+    if (!unit.isOpen()) return false;
+
+    QSqlQuery query(conn);
+    const char* sql =
         "INSERT INTO catalogue_items "
-        "(title, author, item_type, dewey_decimal, isbn, genre, rating, "
+        "(title, author, item_type, dewey_decimal, dewey_key, isbn, isbn_key, genre, rating, "
         "issue_number, publication_date, publication_year, condition, is_available) "
-        "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, 1)"
-    );
+        "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, 1)";
+    query.prepare(sql);
+
+    // Shelf position and ISBN key are computed once here; browsing and scanning compare integers
+    int deweyKey = CatalogueKeys::deweyKey(deweyDecimal);
+    qint64 isbnKey = CatalogueKeys::isbnKey(isbn);
 
     // Convert item type to database format
     QString dbItemType;
@@ -419,7 +1520,9 @@ bool DatabaseManager::addItemToCatalogue(const QString& title, const QString& au
     query.addBindValue(author);
     query.addBindValue(dbItemType);
     query.addBindValue(deweyDecimal.isEmpty() ? QVariant() : deweyDecimal);
+    query.addBindValue(deweyKey < 0 ? QVariant() : deweyKey);
     query.addBindValue(isbn.isEmpty() ? QVariant() : isbn);
+    query.addBindValue(isbnKey < 0 ? QVariant() : QVariant(isbnKey));
     query.addBindValue(genre.isEmpty() ? QVariant() : genre);
     query.addBindValue(rating.isEmpty() ? QVariant() : rating);
     query.addBindValue(issueNumber == 0 ? QVariant() : issueNumber);
@@ -427,74 +1530,174 @@ bool DatabaseManager::addItemToCatalogue(const QString& title, const QString& au
     query.addBindValue(publicationYear);
     query.addBindValue(condition);
 
-    if (!query.exec()) {
+    if (!execQuery(query, sql)) {
         qDebug() << "Error adding item to catalogue:" << query.lastError().text();
         return false;
     }
+    int itemId = query.lastInsertId().toInt();
+    touchItem(itemId);
 
-    return true;
+    // The first copy is shelved with the work; addCopies() adds the rest in the same transaction
+    sql = "INSERT INTO item_copies (item_id, status) VALUES (?, 'available')";
+    query.prepare(sql);
+    query.addBindValue(itemId);
+    if (!execQuery(query, sql)) {
+        qDebug() << "Error adding first copy:" << query.lastError().text();
+        return false;
+    }
+    QVariant copyId = query.lastInsertId();
+    sql = "UPDATE item_copies SET barcode = printf('HL%08d', id) WHERE id = ?";
+    query.prepare(sql);
+    query.addBindValue(copyId);
+    if (!execQuery(query, sql)) {
+        qDebug() << "Error assigning barcode:" << query.lastError().text();
+        return false;
+    }
+    if (copies > 1 && !addCopies(itemId, copies - 1)) return false;
+
+    return unit.commit();
 }
 
-bool DatabaseManager::removeItemFromCatalogue(int itemId) {
-    if (!db.isOpen()) return false;
+bool DatabaseManager::addCopies(int itemId, int count) {
+    ScopedTimer timer("addCopies");
 
-    QSqlQuery query(db);
+    QSqlDatabase conn = connection();
+    if (!conn.isOpen() || count <= 0) return false;
 
-    // First check if item is currently borrowed
-    query.prepare("SELECT COUNT(*) as count FROM loans WHERE item_id = ? AND return_date IS NULL");
+    WriteUnit unit(*this, "add_copies");
+    if (!unit.isOpen()) return false;
+
+    QSqlQuery query(conn);
+    const char* sql = "UPDATE catalogue_items SET total_copies = total_copies + ? WHERE id = ?";
+    query.prepare(sql);
+    query.addBindValue(count);
     query.addBindValue(itemId);
+    if (!execQuery(query, sql) || query.numRowsAffected() == 0) {
+        qDebug() << "Error adding copies to item" << itemId << ":" << query.lastError().text();
+        return false;
+    }
 
-    if (query.exec() && query.next()) {
-        int activeLoans = query.value("count").toInt();
-        if (activeLoans > 0) {
-            qDebug() << "Cannot remove item - it is currently borrowed";
+    for (int i = 0; i < count; ++i) {
+        // Inserted as out, then shelved like a returned copy so waiting holds are served first
+        sql = "INSERT INTO item_copies (item_id, status) VALUES (?, 'on_loan')";
+        query.prepare(sql);
+        query.addBindValue(itemId);
+        if (!execQuery(query, sql)) {
+            qDebug() << "Error adding copy:" << query.lastError().text();
+            return false;
+        }
+        int copyId = query.lastInsertId().toInt();
+
+        sql = "UPDATE item_copies SET barcode = printf('HL%08d', id) WHERE id = ?";
+        query.prepare(sql);
+        query.addBindValue(copyId);
+        if (!execQuery(query, sql) || !shelveCopy(copyId, itemId)) {
+            qDebug() << "Error shelving new copy:" << query.lastError().text();
             return false;
         }
     }
 
+    return unit.commit();
+}
+
+bool DatabaseManager::removeItemFromCatalogue(int itemId) {
+    ScopedTimer timer("removeItemFromCatalogue");
+
+    QSqlDatabase conn = connection();
+    if (!conn.isOpen()) return false;
+
+    // The checks run inside the write transaction, so no borrow or hold can land between
+    // them and the deletes (BEGIN IMMEDIATE holds the write lock from the start)
+    WriteUnit unit(*this, "remove_item");
+    if (!unit.isOpen()) return false;
+
+    QSqlQuery query(conn);
+
+    // First check if item is currently borrowed
+    const char* sql = "SELECT COUNT(*) as count FROM loans WHERE item_id = ? AND return_date IS NULL";
+    query.prepare(sql);
+    query.addBindValue(itemId);
+
+    if (!execQuery(query, sql) || !query.next()) {
+        qDebug() << "Error checking loans of item:" << query.lastError().text();
+        return false;
+    }
+    if (query.value("count").toInt() > 0) {
+        qDebug() << "Cannot remove item - it is currently borrowed";
+        return false;
+    }
+
     // Also check if there are active holds
-    query.prepare("SELECT COUNT(*) as count FROM holds WHERE item_id = ?");
+    sql = "SELECT COUNT(*) as count FROM holds WHERE item_id = ?";
+    query.prepare(sql);
     query.addBindValue(itemId);
 
-    if (query.exec() && query.next()) {
-        int activeHolds = query.value("count").toInt();
-        if (activeHolds > 0) {
-            qDebug() << "Cannot remove item - there are active holds";
-            return false;
-        }
+    if (!execQuery(query, sql) || !query.next()) {
+        qDebug() << "Error checking holds on item:" << query.lastError().text();
+        return false;
+    }
+    if (query.value("count").toInt() > 0) {
+        qDebug() << "Cannot remove item - there are active holds";
+        return false;
+    }
+    query.finish();
+
+    // Safe to remove - delete the copies and statistics, then the catalogue entry
+    sql = "DELETE FROM item_copies WHERE item_id = ?";
+    query.prepare(sql);
+    query.addBindValue(itemId);
+
+    if (!execQuery(query, sql)) {
+        qDebug() << "Error removing item copies:" << query.lastError().text();
+        return false;
+    }
+
+    sql = "DELETE FROM item_stats WHERE item_id = ?";
+    query.prepare(sql);
+    query.addBindValue(itemId);
+
+    if (!execQuery(query, sql)) {
+        qDebug() << "Error removing item statistics:" << query.lastError().text();
+        return false;
     }
 
-    // Safe to remove - delete from catalogue
-    query.prepare("DELETE FROM catalogue_items WHERE id = ?");
+    sql = "DELETE FROM catalogue_items WHERE id = ?";
+    query.prepare(sql);
     query.addBindValue(itemId);
 
-    if (!query.exec()) {
+    if (!execQuery(query, sql)) {
         qDebug() << "Error removing item from catalogue:" << query.lastError().text();
         return false;
     }
+    touchItem(itemId);
 
-    return true;
+    return unit.commit();
 }
 
 std::vector<DatabaseManager::LoanInfo> DatabaseManager::getUserLoansWithDates(int userId) {
+    ScopedTimer timer("getUserLoansWithDates");
+    if (TraceRecorder::isRecording()) TraceRecorder::getInstance().record("getUserLoansWithDates", {userId});
+
     std::vector<LoanInfo> loans;
 
-    if (!db.isOpen()) return loans;
+    QSqlDatabase conn = connection();
+    if (!conn.isOpen()) return loans;
 
-    QSqlQuery query(db);
-    query.prepare(
+    QSqlQuery query(conn);
+    const char* sql =
         "SELECT ci.*, l.checkout_date, l.due_date FROM catalogue_items ci "
         "JOIN loans l ON ci.id = l.item_id "
-        "WHERE l.user_id = ? AND l.return_date IS NULL"
-    );
+        "WHERE l.user_id = ? AND l.return_date IS NULL";
+    query.prepare(sql);
     query.addBindValue(userId);
 
-    if (query.exec()) {
+    if (execQuery(query, sql)) {
         while (query.next()) {
             LibraryItem* item = createItemFromQuery(query);
             if (item) {
                 LoanInfo loan;
                 loan.item = item;
+                loan.itemId = query.value("id").toInt();
                 loan.checkoutDate = query.value("checkout_date").toString();
                 loan.dueDate = query.value("due_date").toString();
                 loans.push_back(loan);
@@ -506,3 +1709,440 @@ std::vector<DatabaseManager::LoanInfo> DatabaseManager::getUserLoansWithDates(in
 
     return loans;
 }
+
+DatabaseManager::AccountSnapshot DatabaseManager::getAccountSnapshot(int userId) {
+    ScopedTimer timer("getAccountSnapshot");
+    if (TraceRecorder::isRecording()) TraceRecorder::getInstance().record("getAccountSnapshot", {userId});
+
+    AccountSnapshot snapshot;
+    AccountCache::Account account;
+    quint64 readEpoch = 0;
+
+    // Unchanged since the last read: rebuild the items from the cached rows. Reads
+    // inside a transaction may see its uncommitted writes, so they neither use nor fill
+    // the cache (getChangeStamp() returns no counters there); the counters tell whether
+    // another process has written since
+    ChangeStamp stamp = getChangeStamp();
+    bool cacheable = stamp.isValid();
+    if (cacheable && AccountCache::getInstance().find(userId, stamp, account, readEpoch)) {
+        for (const auto& cached : account.loans) {
+            LibraryItem* item = createItemFromRow(cached.row);
+            if (item) snapshot.loans.push_back({item, cached.row.id, cached.checkoutDate, cached.dueDate});
+        }
+        for (const auto& cached : account.holds) {
+            LibraryItem* item = createItemFromRow(cached.row);
+            if (item) snapshot.holds.push_back({item, cached.row.id, cached.position});
+        }
+        return snapshot;
+    }
+
+    QSqlDatabase conn = connection();
+    if (!conn.isOpen()) return snapshot;
+
+    // Loans sort before holds ('loan' > 'hold'); loans in checkout order, holds by ticket.
+    // A hold's place in line is the holds on its item with a ticket up to its own
+    QSqlQuery query(conn);
+    const char* sql =
+        "SELECT 'loan' AS kind, l.id AS seq, ci.*, l.checkout_date, l.due_date, NULL AS position "
+        "FROM catalogue_items ci JOIN loans l ON ci.id = l.item_id "
+        "WHERE l.user_id = ? AND l.return_date IS NULL "
+        "UNION ALL "
+        "SELECT 'hold' AS kind, h.position AS seq, ci.*, NULL, NULL, "
+        "(SELECT COUNT(*) FROM holds q WHERE q.item_id = h.item_id AND q.position <= h.position) "
+        "FROM catalogue_items ci JOIN holds h ON ci.id = h.item_id "
+        "WHERE h.user_id = ? "
+        "ORDER BY kind DESC, seq";
+    query.prepare(sql);
+    query.addBindValue(userId);
+    query.addBindValue(userId);
+
+    if (!execQuery(query, sql)) {
+        qDebug() << "Error loading account snapshot:" << query.lastError().text();
+        return snapshot;
+    }
+
+    while (query.next()) {
+        CatalogueSnapshot::ItemRow row;
+        readItemRow(query, row);
+        LibraryItem* item = createItemFromRow(row);
+        if (!item) continue;
+
+        if (query.value("kind").toString() == "loan") {
+            LoanInfo loan;
+            loan.item = item;
+            loan.itemId = row.id;
+            loan.checkoutDate = query.value("checkout_date").toString();
+            loan.dueDate = query.value("due_date").toString();
+            snapshot.loans.push_back(loan);
+            account.loans.push_back({row, loan.checkoutDate, loan.dueDate});
+        } else {
+            HoldInfo hold;
+            hold.item = item;
+            hold.itemId = row.id;
+            hold.position = query.value("position").toInt();
+            snapshot.holds.push_back(hold);
+            account.holds.push_back({row, hold.position});
+        }
+    }
+
+    if (cacheable) AccountCache::getInstance().store(userId, account, readEpoch);
+    return snapshot;
+}
+
+// === CIRCULATION REPORTS ===
+
+DatabaseManager::CirculationReport DatabaseManager::getCirculationReport(int topN) {
+    ScopedTimer timer("getCirculationReport");
+
+    CirculationReport report;
+    QSqlDatabase conn = connection();
+    if (!conn.isOpen()) return report;
+
+    QSqlQuery query(conn);
+
+    // Most borrowed: the first topN entries of the borrow_count index, highest first
+    const char* sql = "SELECT s.item_id, s.borrow_count, s.holds_placed, ci.title, ci.author, ci.item_type, "
+                      "ci.total_copies, ci.hold_count "
+                      "FROM item_stats s JOIN catalogue_items ci ON ci.id = s.item_id "
+                      "WHERE s.borrow_count > 0 ORDER BY s.borrow_count DESC LIMIT ?";
+    query.prepare(sql);
+    query.addBindValue(topN);
+    if (!execQuery(query, sql)) {
+        qDebug() << "Error reading most borrowed items:" << query.lastError().text();
+        return report;
+    }
+    while (query.next()) {
+        ItemCirculation item;
+        item.itemId = query.value("item_id").toInt();
+        item.title = query.value("title").toString();
+        item.author = query.value("author").toString();
+        item.itemType = query.value("item_type").toString();
+        item.borrowCount = query.value("borrow_count").toInt();
+        item.holdsPlaced = query.value("holds_placed").toInt();
+        item.totalCopies = query.value("total_copies").toInt();
+        item.holdCount = query.value("hold_count").toInt();
+        report.topBorrowed.push_back(item);
+    }
+
+    // Turnover per format and per Dewey hundred (non-fiction with a class number)
+    struct Grouping {
+        const char* key;
+        const char* filter;
+        std::vector<GroupTurnover>* rows;
+    };
+    const Grouping groupings[] = {
+        {"ci.item_type", "1", &report.byFormat},
+        {"substr(ci.dewey_decimal, 1, 1) || '00'", "ci.dewey_decimal GLOB '[0-9]*'", &report.byDeweyClass}
+    };
+    for (const Grouping& grouping : groupings) {
+        query.prepare(QString("SELECT %1 AS grp, COUNT(*) AS items, SUM(ci.total_copies) AS copies, "
+                              "COALESCE(SUM(s.borrow_count), 0) AS borrows "
+                              "FROM catalogue_items ci LEFT JOIN item_stats s ON s.item_id = ci.id "
+                              "WHERE %2 GROUP BY grp ORDER BY grp").arg(grouping.key, grouping.filter));
+        if (!execQuery(query)) {
+            qDebug() << "Error reading turnover:" << query.lastError().text();
+            return report;
+        }
+        while (query.next()) {
+            GroupTurnover row;
+            row.group = query.value("grp").toString();
+            row.items = query.value("items").toInt();
+            row.copies = query.value("copies").toInt();
+            row.borrowCount = query.value("borrows").toInt();
+            grouping.rows->push_back(row);
+        }
+    }
+
+    sql = "SELECT COALESCE(SUM(holds_filled), 0), COALESCE(SUM(hold_wait_days), 0) FROM item_stats";
+    query.prepare(sql);
+    if (execQuery(query, sql) && query.next()) {
+        report.holdsFilled = query.value(0).toInt();
+        report.holdWaitDays = query.value(1).toDouble();
+    }
+
+    // Queue depths: reads only the partial index of items that have holds
+    sql = "SELECT hold_count, COUNT(*) AS items FROM catalogue_items WHERE hold_count > 0 "
+          "GROUP BY hold_count ORDER BY hold_count";
+    query.prepare(sql);
+    if (!execQuery(query, sql)) {
+        qDebug() << "Error reading queue depths:" << query.lastError().text();
+        return report;
+    }
+    while (query.next()) {
+        QueueDepth row;
+        row.depth = query.value("hold_count").toInt();
+        row.items = query.value("items").toInt();
+        report.queueDepths.push_back(row);
+    }
+
+    return report;
+}
+
+// === DUE-DATE TIMELINE ===
+
+std::vector<DatabaseManager::DueLoan> DatabaseManager::getLoansDue(const QDate& until, const DueLoan& after,
+                                                                   int limit) {
+    ScopedTimer timer("getLoansDue");
+
+    std::vector<DueLoan> loans;
+
+    QSqlDatabase conn = connection();
+    if (!conn.isOpen() || limit <= 0) return loans;
+
+    // "return_date IS NULL" lets SQLite use the partial index; the range on due_date plus the
+    // tie-break on id continues exactly after the given position
+    QSqlQuery query(conn);
+    const char* sql =
+        "SELECT id, user_id, item_id, due_date FROM loans "
+        "WHERE return_date IS NULL AND due_date >= ? AND due_date <= ? AND (due_date > ? OR id > ?) "
+        "ORDER BY due_date, id LIMIT ?";
+    query.prepare(sql);
+    query.addBindValue(after.dueDate);
+    query.addBindValue(until.toString("yyyy-MM-dd"));
+    query.addBindValue(after.dueDate);
+    query.addBindValue(after.loanId);
+    query.addBindValue(limit);
+
+    if (!execQuery(query, sql)) {
+        qDebug() << "Error reading due-date timeline:" << query.lastError().text();
+        return loans;
+    }
+
+    loans.reserve(limit);
+    while (query.next()) {
+        DueLoan loan;
+        loan.loanId = query.value("id").toInt();
+        loan.userId = query.value("user_id").toInt();
+        loan.itemId = query.value("item_id").toInt();
+        loan.dueDate = query.value("due_date").toString();
+        loans.push_back(loan);
+    }
+    return loans;
+}
+
+bool DatabaseManager::getScanCheckpoint(const QString& name, DueLoan& position) {
+    ScopedTimer timer("getScanCheckpoint");
+
+    position = DueLoan();
+
+    QSqlDatabase conn = connection();
+    if (!conn.isOpen()) return false;
+
+    QSqlQuery query(conn);
+    const char* sql = "SELECT due_date, loan_id FROM scan_checkpoints WHERE name = ?";
+    query.prepare(sql);
+    query.addBindValue(name);
+
+    if (!execQuery(query, sql)) {
+        qDebug() << "Error reading scan checkpoint:" << query.lastError().text();
+        return false;
+    }
+    if (query.next()) {
+        position.dueDate = query.value("due_date").toString();
+        position.loanId = query.value("loan_id").toInt();
+    }
+    return true;
+}
+
+bool DatabaseManager::setScanCheckpoint(const QString& name, const DueLoan& position) {
+    ScopedTimer timer("setScanCheckpoint");
+
+    QSqlDatabase conn = connection();
+    if (!conn.isOpen()) return false;
+
+    QSqlQuery query(conn);
+    const char* sql = "INSERT OR REPLACE INTO scan_checkpoints (name, due_date, loan_id, updated_date) "
+                      "VALUES (?, ?, ?, CURRENT_TIMESTAMP)";
+    query.prepare(sql);
+    query.addBindValue(name);
+    query.addBindValue(position.dueDate);
+    query.addBindValue(position.loanId);
+
+    if (!execQuery(query, sql)) {
+        qDebug() << "Error saving scan checkpoint:" << query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+int DatabaseManager::recordNotices(const QString& kind, const std::vector<DueLoan>& loans) {
+    ScopedTimer timer("recordNotices");
+
+    QSqlDatabase conn = connection();
+    if (!conn.isOpen()) return -1;
+    if (loans.empty()) return 0;
+
+    WriteUnit unit(*this, "record_notices");
+    if (!unit.isOpen()) return -1;
+
+    QSqlQuery query(conn);
+    const char* sql = "INSERT OR IGNORE INTO notices (loan_id, user_id, item_id, kind, due_date) VALUES (?, ?, ?, ?, ?)";
+    query.prepare(sql);
+
+    int created = 0;
+    for (const DueLoan& loan : loans) {
+        // Prepared once, rebound per loan
+        query.bindValue(0, loan.loanId);
+        query.bindValue(1, loan.userId);
+        query.bindValue(2, loan.itemId);
+        query.bindValue(3, kind);
+        query.bindValue(4, loan.dueDate);
+
+        if (!execQuery(query, sql)) {
+            qDebug() << "Error recording notice:" << query.lastError().text();
+            return -1;
+        }
+        created += query.numRowsAffected();
+    }
+
+    if (!setScanCheckpoint(kind, loans.back())) return -1;
+
+    return unit.commit() ? created : -1;
+}
+
+int DatabaseManager::archiveReturnedLoans(int limit) {
+    ScopedTimer timer("archiveLoans");
+
+    QSqlDatabase conn = connection();
+    if (!conn.isOpen()) return -1;
+
+    WriteUnit unit(*this, "archive_loans");
+    if (!unit.isOpen()) return -1;
+
+    QSqlQuery query(conn);
+
+    // Highest id in this batch, so the copy and the delete cover exactly the same rows
+    const char* sql = "SELECT MAX(id) FROM (SELECT id FROM loans WHERE return_date IS NOT NULL ORDER BY id LIMIT ?)";
+    query.prepare(sql);
+    query.addBindValue(limit);
+    if (!execQuery(query, sql) || !query.next()) {
+        qDebug() << "Error finding returned loans:" << query.lastError().text();
+        return -1;
+    }
+    if (query.value(0).isNull()) return 0; // Nothing left to archive
+    int lastId = query.value(0).toInt();
+
+    sql = "INSERT OR IGNORE INTO loan_history (id, user_id, item_id, copy_id, checkout_date, due_date, return_date) "
+          "SELECT id, user_id, item_id, copy_id, checkout_date, due_date, return_date FROM loans "
+          "WHERE return_date IS NOT NULL AND id <= ?";
+    query.prepare(sql);
+    query.addBindValue(lastId);
+    if (!execQuery(query, sql)) {
+        qDebug() << "Error copying loans to history:" << query.lastError().text();
+        return -1;
+    }
+
+    sql = "DELETE FROM loans WHERE return_date IS NOT NULL AND id <= ?";
+    query.prepare(sql);
+    query.addBindValue(lastId);
+    if (!execQuery(query, sql)) {
+        qDebug() << "Error removing archived loans:" << query.lastError().text();
+        return -1;
+    }
+    int moved = query.numRowsAffected();
+
+    return unit.commit() ? moved : -1;
+}
+
+DatabaseManager::FacetResult DatabaseManager::getFacets(const FacetFilter& filter) {
+    ScopedTimer timer("getFacets");
+    return FacetIndex::getInstance().query(filter);
+}
+
+namespace {
+    const char* FACET_COLUMNS = "SELECT id, item_type, genre, rating, condition, is_available, publication_year "
+                                "FROM catalogue_items ";
+
+    DatabaseManager::ItemFacets readFacets(const QSqlQuery& query) {
+        DatabaseManager::ItemFacets row;
+        row.itemId = query.value(0).toInt();
+        row.values[IDataRepository::FacetFormat] = query.value(1).toString();
+        row.values[IDataRepository::FacetGenre] = query.value(2).toString();
+        row.values[IDataRepository::FacetRating] = query.value(3).toString();
+        row.values[IDataRepository::FacetCondition] = query.value(4).toString();
+        row.values[IDataRepository::FacetAvailability] = query.value(5).toBool() ? "available" : "checked out";
+        row.year = query.value(6).toInt();
+        return row;
+    }
+}
+
+bool DatabaseManager::getItemFacets(int afterId, int limit, std::vector<ItemFacets>& rows) {
+    ScopedTimer timer("getItemFacets");
+
+    QSqlDatabase conn = connection();
+    if (!conn.isOpen()) return false;
+
+    QSqlQuery query(conn);
+    query.prepare(QString(FACET_COLUMNS) + "WHERE id > ? ORDER BY id LIMIT ?");
+    query.addBindValue(afterId);
+    query.addBindValue(limit);
+
+    if (!execQuery(query)) {
+        qDebug() << "Error reading catalogue facets:" << query.lastError().text();
+        return false;
+    }
+    while (query.next()) {
+        rows.push_back(readFacets(query));
+    }
+    return true;
+}
+
+bool DatabaseManager::getItemFacets(const std::vector<int>& itemIds, std::vector<ItemFacets>& rows) {
+    ScopedTimer timer("getItemFacets");
+
+    QSqlDatabase conn = connection();
+    if (!conn.isOpen()) return false;
+
+    // Primary key lookups, a bounded number of IDs per statement
+    const size_t CHUNK = 500;
+    QSqlQuery query(conn);
+    for (size_t start = 0; start < itemIds.size(); start += CHUNK) {
+        size_t end = qMin(itemIds.size(), start + CHUNK);
+        QStringList marks;
+        for (size_t i = start; i < end; ++i) marks << "?";
+
+        query.prepare(QString(FACET_COLUMNS) + "WHERE id IN (" + marks.join(", ") + ") ORDER BY id");
+        for (size_t i = start; i < end; ++i) query.addBindValue(itemIds[i]);
+
+        if (!execQuery(query)) {
+            qDebug() << "Error reading changed catalogue facets:" << query.lastError().text();
+            return false;
+        }
+        while (query.next()) {
+            rows.push_back(readFacets(query));
+        }
+    }
+    return true;
+}
+
+bool DatabaseManager::getCatalogueChanges(const ChangeStamp& since, ChangeStamp& stamp, std::vector<int>& itemIds) {
+    ScopedTimer timer("getCatalogueChanges");
+
+    QSqlDatabase conn = connection();
+    if (!conn.isOpen() || transactionOpen) return false;
+
+    if (!readChangeStamp(conn, stamp)) {
+        timer.fail();
+        return false;
+    }
+    if (!since.isValid() || (stamp.catalogue == since.catalogue && stamp.circulation == since.circulation)) {
+        return true;
+    }
+
+    // Read after the counters, so nothing changed up to them is missed
+    QSqlQuery query(conn);
+    const char* sql = "SELECT item_id FROM catalogue_changes WHERE generation > ? "
+                      "UNION SELECT item_id FROM circulation_changes WHERE generation > ?";
+    query.prepare(sql);
+    query.addBindValue(since.catalogue);
+    query.addBindValue(since.circulation);
+    if (!execQuery(query, sql)) {
+        qDebug() << "Error reading catalogue changes:" << query.lastError().text();
+        timer.fail();
+        return false;
+    }
+    while (query.next()) {
+        itemIds.push_back(query.value(0).toInt());
+    }
+    return true;
+}
@@ -2,13 +2,21 @@
 #define DATABASEMANAGER_H
 
 #include <QString>
+#include <QDate>
 #include <QSqlDatabase>
 #include <QSqlQuery>
 #include <QSqlError>
+#include <QMutex>
+#include <QHash>
+#include <memory>
 #include <vector>
 #include "User.h"
 #include "LibraryItem.h"
-#include "AddItemDialog.h"
+#include "IDataRepository.h"
+#include "CatalogueSnapshot.h"
+#include "CatalogueVersion.h"
+
+class QThread;
 
 /*
     DatabaseManager Class:
@@ -25,33 +33,74 @@
     - Handle all CRUD operations for library business entities
 
     Database Schema Management:
-    - Users table: Patron, librarian, and administrator accounts
-    - Catalogue_items table: Library collection with type-specific metadata
-    - Loans table: Active borrowing records with due dates
-    - Holds table: Hold queue management with position tracking
+    - Users table: Patron, librarian, and administrator accounts, carrying
+      active_loan_count / active_hold_count counters
+    - Catalogue_items table: Library collection with type-specific metadata; one row
+      per work, carrying total_copies / available_copies / hold_count counters and the
+      integer dewey_key / isbn_key lookup keys (see CatalogueKeys)
+    - Every counter is updated in the same transaction as the rows it counts;
+      DatabaseInitializer::checkCounters() verifies and rebuilds them
+    - Item_copies table: Physical copies of each work with barcodes and status
+      ('available', 'on_loan', or 'held' on the hold shelf for the next patron in line)
+    - Loans table: Active borrowing records with due dates and the copy lent
+    - Holds table: Hold queues; position is a queue ticket (never renumbered), and a
+      patron's place in line is answered by HoldQueueIndex
+    - Notices / Scan_checkpoints tables: Overdue and due-soon notices and where the
+      scans that generate them stopped (see DueDateScanner)
 
     Data Members:
-      - QSqlDatabase db: SQLite database connection instance
+      - QSqlDatabase db: SQLite database connection instance (owner thread)
+      - QThread* ownerThread: Thread that created the manager and owns db
+      - QMutex connectionMutex: Guards connection switching and per-thread clones
+      - std::shared_ptr<CatalogueSnapshot> snapshot: Mapped catalogue snapshot of the
+        open file, if there is one (used only while its generation is current)
+      - QMutex snapshotMutex: Guards swapping snapshot
+      - std::shared_ptr<const CatalogueVersion> catalogueVersion: Latest published
+        in-memory catalogue; read and replaced only with std::atomic_load/atomic_store
+      - QMutex catalogueVersionMutex: Serializes catalogue version refreshes (never
+        taken by readers of the published version)
       - static DatabaseManager* instance: Singleton instance pointer
 
+    Threading:
+      The manager may be used from several threads (e.g. the load generator). Each
+      thread other than the owner gets its own cloned connection, since SQLite
+      handles must not be shared across threads.
+
     Member Functions:
       Public:
         - getInstance(): Provides global access to singleton instance
         - ~DatabaseManager(): Cleans up database connection
+        - openDatabase(): Switches the connection to another database file
+        - prepareDatabase(): Runs DatabaseInitializer on the main connection
+        - saveCatalogueSnapshot(): Rewrites the catalogue snapshot file if it is stale
+        - releaseThreadConnection(): Drops a worker thread's connection before it exits
+        - beginTransaction() / commitTransaction() / rollbackTransaction(): Explicit
+          transaction on the calling thread's connection
+        - setSavepoint() / releaseSavepoint() / rollbackToSavepoint(): Savepoints
+          within that transaction
 
         User Operations:
         - findUser(): Authenticates users by username
         - getAllUsers(): Retrieves all system users
+        - searchPatrons(): Indexed, paginated patron lookup by username prefix or card number
 
         Catalogue Operations:
-        - getAllCatalogueItems(): Retrieves complete library collection
+        - getAllCatalogueItems(): Retrieves complete library collection (from the
+          catalogue snapshot when it is current)
+        - getCatalogueVersion(): Brings the shared in-memory catalogue up to date
+        - getPublishedCatalogueVersion(): The shared in-memory catalogue, without waiting
+        - browseShelf(): Pages through a Dewey range in shelf order
         - getItemById(): Fetches specific item by database ID
+        - findByIsbn() / findByBarcode(): Indexed lookup of a typed or scanned code
         - addItemToCatalogue(): Adds new items to library collection
+        - addCopies(): Adds physical copies to an existing item
         - removeItemFromCatalogue(): Removes items with safety checks
 
         Loan Operations:
         - borrowItem(): Processes book borrowing with status updates
         - returnItem(): Handles book returns and availability updates
+        - tryBorrowItem() / tryReturnItem(): Same, distinguishing conflicts from failures
+        - tryBorrowScanned(): Borrows the item (or the very copy) a scanned code names
         - getUserBorrowedItems(): Retrieves user's active loans
 
         Hold Operations:
@@ -59,21 +108,73 @@
         - cancelHold(): Removes holds and updates queue positions
         - getUserHolds(): Retrieves user's active hold requests
         - getHoldCountForItem(): Counts active holds for an item
-        - getHoldPosition(): Gets user's position in hold queue
+        - getHoldPosition(): Gets user's position in hold queue (from HoldQueueIndex)
+        - getHoldQueue(): Reads an item's queue, for HoldQueueIndex
+        - placeHoldAndGetPosition(): Places a hold and reads its position atomically
+
+        Due-Date Timeline:
+        - getLoansDue(): Pages through active loans in due order
+        - getScanCheckpoint() / setScanCheckpoint(): Resumable scan positions
+        - recordNotices(): Stores a batch of notices and advances its scan's checkpoint
+        - archiveReturnedLoans(): Moves a batch of returned legacy loans to loan_history
 
         Utility Methods:
         - isDatabaseOpen(): Verifies database connection status
         - getItemId(): Resolves LibraryItem to database ID
         - getUserLoansWithDates(): Gets detaiils of a user's loans
+        - getAccountSnapshot(): Loads a user's loans and holds in a single query (cached in AccountCache)
+        - getCirculationReport(): Librarian dashboard figures from the item_stats aggregates
+        - getFacets(): Filters the catalogue through FacetIndex, with counts per facet value
+        - getItemFacets(): Facet values of catalogue rows, for building FacetIndex
+        - getCatalogueChanges(): Items changed since a change stamp, for FacetIndex
+        - getChangeStamp(): Change counters, for indexes checking they are current
+        - isBusyError(): Classifies SQLITE_BUSY / SQLITE_LOCKED contention errors
+
+      Instrumentation:
+        - Every public operation is timed by a ScopedTimer and every statement runs
+          through execQuery(), so PerformanceMonitor sees per-operation and
+          per-statement counts, errors and latency histograms. Fixed SQL is a string
+          literal handed to both prepare() and execQuery(), so each statement's timer
+          key is cached by the literal's address, as operation timers are.
 
       Private:
         - DatabaseManager(): Private constructor for singleton pattern
         - createItemFromQuery(): Factory method for LibraryItem objects
+        - readItemRow() / createItemFromRow(): Its two halves, shared with CatalogueSnapshot
+        - catalogueGeneration(): Reads the catalogue generation counter
+        - readChangeStamp(): Reads the catalogue and circulation counters
+        - currentSnapshot(): The mapped snapshot, if it matches that database and generation
+        - readMovedCounters() / overlayCounters(): Copy and hold counters that moved since a snapshot
+        - loadCatalogueItems(): Body of getAllCatalogueItems()
+        - readCatalogueVersion(): Reads the changes since a version and makes the next one
+        - createUserFromQuery(): Factory method for User objects
+        - execQuery(): Executes a prepared statement under a statement-level timer
+        - connection(): Returns the calling thread's connection
+        - threadConnectionName(): Connection name for the calling thread
+        - WriteUnit: Makes one multi-statement write atomic
+        - borrowCopy(): Lends a copy of an item, optionally a specific one
+        - findIsbn(): Resolves an ISBN to its item
+        - findCopy(): Resolves a copy barcode to the copy and its item
+        - shelveCopy(): Sends a returned copy to the next hold or back to the shelf
+        - deleteHold(): Removes a hold and closes the gap in its queue
+        - adjustCounter(): Updates a hold or loan counter inside the current write
+        - updateItemStats(): Updates an item's circulation aggregates inside the current write
+        - touchItem(): Reports an item to FacetIndex once the current write commits
+        - markAvailability(): Reports an item's new availability the same way
+        - recordHoldChange(): Reports a hold placed or removed to HoldQueueIndex at commit
+        - touchAccount(): Reports a patron whose loans changed to AccountCache at commit
+        - reportAccountChanges(): Hands the committed write's patrons and items to AccountCache
 
 */
-class DatabaseManager {
+class DatabaseManager : public IDataRepository {
 private:
     QSqlDatabase db;
+    QThread* ownerThread;
+    QMutex connectionMutex;
+    std::shared_ptr<CatalogueSnapshot> snapshot;
+    QMutex snapshotMutex;
+    std::shared_ptr<const CatalogueVersion> catalogueVersion;
+    QMutex catalogueVersionMutex;
     static DatabaseManager* instance;
 
     DatabaseManager(); // Private constructor for singleton
@@ -89,6 +190,76 @@ public:
 
     ~DatabaseManager();
 
+    /*
+        Function: openDatabase
+        Purpose: Closes the current connection and opens another SQLite file in its
+                 place. The application uses the default hinlibs.db; tools such as the
+                 benchmark suite use this to point the data layer at generated libraries.
+        Parameters:
+          in: const QString& path - SQLite database file to open
+        Return: bool - True if the database was opened successfully
+    */
+    bool openDatabase(const QString& path);
+
+    /*
+        Function: prepareDatabase
+        Purpose: Brings the open database up to the current schema through
+                 DatabaseInitializer, on the manager's own connection rather than a
+                 separate one (one PRAGMA when it is up to date). Must be called on the
+                 thread that created the manager, before other threads use it.
+        Parameters:
+          in: bool fullCheck - Run the migrations and counter checks even if up to date
+        Return: bool - True if the database is ready
+    */
+    bool prepareDatabase(bool fullCheck = false);
+
+    /*
+        Function: saveCatalogueSnapshot
+        Purpose: Writes catalogue_items to the CatalogueSnapshot file next to the
+                 database and maps it, unless the mapped one is still current and fewer
+                 than a quarter of its items have had their counters move since. Later
+                 catalogue reads are served from the mapping until the catalogue changes.
+                 Called off the GUI thread at login and again at exit, so the next launch
+                 starts from a current file.
+        Return: bool - True if a current snapshot is mapped afterwards (false inside a
+                transaction, for in-memory databases and on write errors)
+    */
+    bool saveCatalogueSnapshot();
+
+    /*
+        Function: releaseThreadConnection
+        Purpose: Closes and removes the calling thread's connection. Worker threads
+                 must call this before they exit; the owner thread's connection is
+                 left alone.
+    */
+    void releaseThreadConnection();
+
+    /*
+        Function: beginTransaction / commitTransaction / rollbackTransaction
+        Purpose: Groups the calling thread's following operations into one SQLite
+                 transaction. BEGIN IMMEDIATE takes the write lock up front so a
+                 transaction that reads and then writes cannot deadlock with another
+                 writer. Used by the server to run a client's batch atomically.
+        Return: bool - True if the statement succeeded
+    */
+    bool beginTransaction();
+    bool commitTransaction();
+    bool rollbackTransaction();
+
+    /*
+        Function: setSavepoint / releaseSavepoint / rollbackToSavepoint
+        Purpose: Nested rollback points inside a transaction. rollbackToSavepoint()
+                 undoes everything since setSavepoint() and then releases it, so one
+                 failed operation can be discarded without losing the rest of the
+                 transaction. Used by WriteCoalescer for per-operation results.
+        Parameters:
+          in: const QString& name - Savepoint name (an SQL identifier)
+        Return: bool - True if the statement succeeded
+    */
+    bool setSavepoint(const QString& name);
+    bool releaseSavepoint(const QString& name);
+    bool rollbackToSavepoint(const QString& name);
+
     // User operations
     /*
         Function: findUser
@@ -98,7 +269,7 @@ public:
           in: const QString& username - Username to search for
         Return: User* - Pointer to User object if found, nullptr otherwise
     */
-    User* findUser(const QString& username);
+    User* findUser(const QString& username) override;
 
     /*
         Function: getAllUsers
@@ -106,7 +277,23 @@ public:
                  for librarian administrative functions and patron selection.
         Return: std::vector<User*> - Vector of all user objects
     */
-    std::vector<User*> getAllUsers();
+    std::vector<User*> getAllUsers() override;
+
+    /*
+        Function: searchPatrons
+        Purpose: Retrieves one page of patron accounts ordered by username. Matches on a
+                 username prefix, or on the library card number (user ID) when the filter
+                 is numeric. Uses the (role, username) index with keyset pagination so
+                 each page costs the same regardless of how many patrons exist. A card
+                 number match leads the first page and is kept out of the username
+                 matches of every page, so it is listed once.
+        Parameters:
+          in: const QString& filter - Username prefix or card number (empty matches all patrons)
+          in: const QString& afterUsername - Last username of the previous page (empty for first page)
+          in: int limit - Maximum number of patrons to return
+        Return: std::vector<User*> - Caller-owned patrons for this page
+    */
+    std::vector<User*> searchPatrons(const QString& filter, const QString& afterUsername, int limit) override;
 
     // Catalogue operations
     /*
@@ -115,7 +302,7 @@ public:
                  status. Used to populate the main catalogue display.
         Return: std::vector<LibraryItem*> - Vector of all catalogue items
     */
-    std::vector<LibraryItem*> getAllCatalogueItems();
+    std::vector<LibraryItem*> getAllCatalogueItems() override;
 
     /*
         Function: getItemById
@@ -125,30 +312,140 @@ public:
           in: int id - Database ID of the item to retrieve
         Return: LibraryItem* - Pointer to item if found, nullptr otherwise
     */
-    LibraryItem* getItemById(int id);
+    LibraryItem* getItemById(int id) override;
+
+    /*
+        Function: getCatalogueVersion
+        Purpose: Returns the shared in-memory catalogue as of now, publishing a new
+                 CatalogueVersion first if the catalogue changed since the last one. The
+                 new version re-reads only the items logged in catalogue_changes or
+                 circulation_changes since then and shares everything else with the old one (a full read the first
+                 time, or when more than a quarter of the items changed). Refreshes from
+                 several threads run one at a time; readers still holding older versions
+                 are unaffected. Inside a transaction it returns the published version
+                 unchanged, which does not include the transaction's own writes.
+        Return: std::shared_ptr<const CatalogueVersion> - Current version, or the last
+                published one (nullptr if none) on database error
+    */
+    std::shared_ptr<const CatalogueVersion> getCatalogueVersion();
+
+    /*
+        Function: getPublishedCatalogueVersion
+        Purpose: Returns the most recently published CatalogueVersion without touching the
+                 database or waiting for a refresh in progress (an atomic load)
+        Return: std::shared_ptr<const CatalogueVersion> - Latest version, possibly older than
+                the database, or nullptr before the first getCatalogueVersion()
+    */
+    std::shared_ptr<const CatalogueVersion> getPublishedCatalogueVersion() const;
+
+    /*
+        Function: browseShelf
+        Purpose: Returns the next page of items in a Dewey range in shelf order
+                 ((dewey_key, id) order), starting after a position. Keyset paging over
+                 the partial index idx_items_dewey: each page is one index range read,
+                 O(log N + page), however deep into the range it is.
+        Parameters:
+          in: int fromKey / int toKey - Inclusive range of Dewey keys (see CatalogueKeys)
+          in: int afterKey / int afterId - Position of the last entry already shown
+                                           (-1 / 0 for the first page)
+          in: int limit - Page size
+        Return: std::vector<ShelfEntry> - Up to limit entries; caller owns the items
+    */
+    std::vector<ShelfEntry> browseShelf(int fromKey, int toKey, int afterKey, int afterId, int limit) override;
+
+    /*
+        Function: findByIsbn
+        Purpose: Finds the item with an ISBN through the isbn_key index. The ISBN may be
+                 an ISBN-10 or ISBN-13, hyphenated or not (see CatalogueKeys::isbnKey).
+        Parameters:
+          in: const QString& isbn - ISBN as typed or scanned
+        Return: int - Database ID of the item (the oldest, if several editions share the
+                      ISBN), or -1 if none or the check digit is wrong
+    */
+    int findByIsbn(const QString& isbn) override;
+
+    /*
+        Function: findByBarcode
+        Purpose: Finds the item a copy label belongs to through the unique barcode index
+        Parameters:
+          in: const QString& barcode - Copy barcode, e.g. "HL00000042"
+        Return: int - Database ID of the item, or -1 if no copy has the barcode
+    */
+    int findByBarcode(const QString& barcode) override;
 
     // Loan operations
     /*
         Function: borrowItem
-        Purpose: Processes book borrowing operation. Updates item availability and
-                 creates loan record with due date calculation (14 days).
+        Purpose: Processes book borrowing operation. Lends the copy waiting on the
+                 hold shelf for this user, or else one available copy, and creates
+                 a loan record with due date calculation (14 days). The copy counter
+                 update is conditional, so the last copy is never loaned twice.
+                 Consumes the user's hold on the item, if any.
         Parameters:
           in: int userId - Database ID of the borrowing user
           in: int itemId - Database ID of the item being borrowed
-        Return: bool - True if operation succeeded, false on error
+        Return: bool - True if operation succeeded, false if unavailable or on error
     */
-    bool borrowItem(int userId, int itemId);
+    bool borrowItem(int userId, int itemId) override;
+
+    /*
+        Function: tryBorrowItem
+        Purpose: borrowItem() with the reason for a refusal. The counter update
+                 runs as "UPDATE ... WHERE id = ? AND available_copies > 0"; if it
+                 changes no row, other desks took the last copy first. No lock is held between a
+                 screen reading the item and the borrow, so any number of desks can
+                 write concurrently and only the losing side of a real race pays for
+                 one extra lookup.
+        Parameters:
+          in: int userId - Database ID of the borrowing user
+          in: int itemId - Database ID of the item being borrowed
+        Return: WriteResult - WriteOk, WriteConflict if no copy is available,
+                              WriteFailed if the item does not exist or on error
+    */
+    WriteResult tryBorrowItem(int userId, int itemId) override;
+
+    /*
+        Function: tryBorrowScanned
+        Purpose: Scan-to-borrow at the desk: resolves a copy barcode or an ISBN and
+                 borrows it in one transaction (two index lookups and the borrow's own
+                 statements, no catalogue read). A copy barcode lends that very copy,
+                 which must be on the shelf or on the hold shelf for this user; an ISBN
+                 lends any copy of the item, as tryBorrowItem() does.
+        Parameters:
+          in: int userId - Database ID of the borrowing user
+          in: const QString& code - Copy barcode or ISBN, as scanned
+          out: int& itemId - Database ID of the item the code names, or -1 if none
+        Return: WriteResult - WriteOk, WriteConflict if the copy (or every copy) is
+                              taken, WriteNotFound if the code names no item,
+                              WriteFailed on a database error
+    */
+    WriteResult tryBorrowScanned(int userId, const QString& code, int& itemId) override;
 
     /*
         Function: returnItem
-        Purpose: Processes book return operation. Updates item availability and
-                 marks loan record as returned. Enables hold fulfillment.
+        Purpose: Processes book return operation. Marks loan record as returned and
+                 sends the copy to the hold shelf for the next hold in line, or back
+                 to the shelf (available_copies + 1).
         Parameters:
           in: int userId - Database ID of the returning user
           in: int itemId - Database ID of the item being returned
-        Return: bool - True if operation succeeded, false on error
+        Return: bool - True if operation succeeded, false if the user has no open
+                       loan on the item or on error
     */
-    bool returnItem(int userId, int itemId);
+    bool returnItem(int userId, int itemId) override;
+
+    /*
+        Function: tryReturnItem
+        Purpose: returnItem() with the reason for a refusal. Closing the loan is
+                 conditional on it still being open, so two desks returning the same
+                 item cannot both succeed.
+        Parameters:
+          in: int userId - Database ID of the returning user
+          in: int itemId - Database ID of the item being returned
+        Return: WriteResult - WriteOk, WriteConflict if the user has no open loan on
+                              the item (e.g. already returned), WriteFailed on error
+    */
+    WriteResult tryReturnItem(int userId, int itemId) override;
 
     /*
         Function: getUserBorrowedItems
@@ -158,30 +455,32 @@ public:
           in: int userId - Database ID of the user
         Return: std::vector<LibraryItem*> - Vector of user's borrowed items
     */
-    std::vector<LibraryItem*> getUserBorrowedItems(int userId);
+    std::vector<LibraryItem*> getUserBorrowedItems(int userId) override;
 
     // Hold operations
     /*
         Function: placeHold
         Purpose: Adds a user to an item's hold queue. Calculates and assigns
-                 position based on first-come-first-served ordering.
+                 position based on first-come-first-served ordering. Holds are on
+                 the work, so whichever copy comes back first serves the queue.
         Parameters:
           in: int userId - Database ID of the user placing hold
           in: int itemId - Database ID of the item being held
         Return: bool - True if hold placed successfully, false on error
     */
-    bool placeHold(int userId, int itemId);
+    bool placeHold(int userId, int itemId) override;
 
     /*
         Function: cancelHold
         Purpose: Removes a user from an item's hold queue and updates positions
-                 of remaining users in the queue.
+                 of remaining users in the queue. A copy waiting on the hold shelf for
+                 the user passes to the next hold, or back to the shelf.
         Parameters:
           in: int userId - Database ID of the user canceling hold
           in: int itemId - Database ID of the held item
         Return: bool - True if hold canceled successfully, false on error
     */
-    bool cancelHold(int userId, int itemId);
+    bool cancelHold(int userId, int itemId) override;
 
     /*
         Function: getUserHolds
@@ -191,7 +490,7 @@ public:
           in: int userId - Database ID of the user
         Return: std::vector<LibraryItem*> - Vector of user's hold items in position order
     */
-    std::vector<LibraryItem*> getUserHolds(int userId);
+    std::vector<LibraryItem*> getUserHolds(int userId) override;
 
     // Utility methods
     /*
@@ -200,7 +499,18 @@ public:
                  Used for error checking before database operations.
         Return: bool - True if database connection is open and valid
     */
-    bool isDatabaseOpen() const;
+    bool isDatabaseOpen();
+
+    /*
+        Function: isBusyError
+        Purpose: Determines whether a failed statement lost a lock race (SQLITE_BUSY or
+                 SQLITE_LOCKED) rather than failing outright. Used by metrics and callers
+                 that may retry.
+        Parameters:
+          in: const QSqlError& error - Error reported by the failed statement
+        Return: bool - True for lock contention errors
+    */
+    static bool isBusyError(const QSqlError& error);
 
     /*
         Function: getItemId
@@ -210,28 +520,53 @@ public:
           in: LibraryItem* item - Pointer to the LibraryItem object
         Return: int - Database ID of the item, or -1 if not found
     */
-    int getItemId(LibraryItem* item);
+    int getItemId(LibraryItem* item) override;
 
     /*
         Function: getHoldCountForItem
-        Purpose: Counts the number of active holds for a specific item.
-                 Used for display purposes and position calculation.
+        Purpose: Reads the number of active holds for a specific item from its
+                 hold_count column (kept current by placeHold / cancelHold / borrow),
+                 so the catalogue badge is a primary key lookup, not a COUNT(*).
         Parameters:
           in: int itemId - Database ID of the item
         Return: int - Number of active holds for the item
     */
-    int getHoldCountForItem(int itemId);
+    int getHoldCountForItem(int itemId) override;
 
     /*
         Function: getHoldPosition
         Purpose: Retrieves a user's specific position in an item's hold queue.
-                 Used for displaying accurate position information to users.
+                 Used for displaying accurate position information to users. Answered
+                 by HoldQueueIndex without SQL once the item's queue is loaded; inside a
+                 transaction (which may have changed the queue) by counting tickets.
         Parameters:
           in: int userId - Database ID of the user
           in: int itemId - Database ID of the item
         Return: int - User's position in queue (1-based), or -1 if not found
     */
-    int getHoldPosition(int userId, int itemId);
+    int getHoldPosition(int userId, int itemId) override;
+
+    /*
+        Function: getHoldQueue
+        Purpose: Reads the patrons holding an item, front of the queue first, for
+                 HoldQueueIndex to load the queue
+        Parameters:
+          in: int itemId - Database ID of the item
+          out: std::vector<int>& userIds - Patron IDs in ticket order are appended
+        Return: bool - False on database error
+    */
+    bool getHoldQueue(int itemId, std::vector<int>& userIds);
+
+    /*
+        Function: placeHoldAndGetPosition
+        Purpose: Places a hold and reads back its queue position inside one transaction
+        Parameters:
+          in: int userId - Database ID of the user placing hold
+          in: int itemId - Database ID of the item being held
+          out: int& position - Queue position of the new hold
+        Return: bool - True if the hold was placed
+    */
+    bool placeHoldAndGetPosition(int userId, int itemId, int& position) override;
 
     // Catalogue management operations
     /*
@@ -250,22 +585,36 @@ public:
           in: const QString& publicationDate - Publication date (magazines)
           in: int publicationYear - Year of publication
           in: const QString& condition - Physical condition of item
+          in: int copies - Number of physical copies (at least 1), created with the
+              item in one write transaction
         Return: bool - True if item added successfully, false on error
     */
     bool addItemToCatalogue(const QString& title, const QString& author, const QString& itemType,
                            const QString& deweyDecimal, const QString& isbn, const QString& genre,
                            const QString& rating, int issueNumber, const QString& publicationDate,
-                           int publicationYear, const QString& condition);
+                           int publicationYear, const QString& condition, int copies) override;
 
     /*
         Function: removeItemFromCatalogue
         Purpose: Removes an item from the catalogue with comprehensive safety checks.
-                 Prevents removal of borrowed items or items with active holds.
+                 Prevents removal of borrowed items or items with active holds; the
+                 checks and the deletes run in one write transaction.
         Parameters:
           in: int itemId - Database ID of the item to remove
         Return: bool - True if item removed successfully, false if prevented by safety checks
     */
-    bool removeItemFromCatalogue(int itemId);
+    bool removeItemFromCatalogue(int itemId) override;
+
+    /*
+        Function: addCopies
+        Purpose: Adds physical copies of an existing item, each with a generated
+                 barcode. New copies serve waiting holds first, like returned ones.
+        Parameters:
+          in: int itemId - Database ID of the item
+          in: int count - Number of copies to add (at least 1)
+        Return: bool - True if the copies were added
+    */
+    bool addCopies(int itemId, int count) override;
 
 
     /*
@@ -275,13 +624,196 @@ public:
           in: int userId
         Return: LoanInfo - an array with the loan details
     */
-    struct LoanInfo {
-        LibraryItem* item;
-        QString checkoutDate;
+    std::vector<LoanInfo> getUserLoansWithDates(int userId) override;
+
+    /*
+        Function: getAccountSnapshot
+        Purpose: Loads everything the account panel needs for one user - active loans
+                 with dates and holds with queue positions - in a single round trip
+                 (one UNION ALL query) instead of one query per list plus one per hold.
+                 The rows are kept in AccountCache until a commit changes this user's
+                 loans or holds or one of the items on them; until then the snapshot is
+                 rebuilt from memory with no SQL.
+        Parameters:
+          in: int userId - Database ID of the user
+        Return: AccountSnapshot - Caller-owned items; release with freeAccountSnapshot()
+    */
+    AccountSnapshot getAccountSnapshot(int userId) override;
+
+    /*
+        Function: getCirculationReport
+        Purpose: Builds the circulation dashboard from the aggregates that borrows and
+                 holds keep in item_stats: the most borrowed items (read down the
+                 borrow_count index), turnover per format and per Dewey class, the
+                 average hold wait and the current queue depth histogram (read from the
+                 index of queued items). No loan or hold rows are scanned.
+        Parameters:
+          in: int topN - Length of the most-borrowed list
+        Return: CirculationReport - Report contents (empty lists on database error)
+    */
+    CirculationReport getCirculationReport(int topN) override;
+
+    // Due-date timeline
+    /*
+        DueLoan Struct:
+        One active loan on the due-date timeline. Also used as a scan position:
+        (dueDate, loanId) of the last loan processed; a default DueLoan is the start.
+    */
+    struct DueLoan {
+        int loanId = 0;
+        int userId = 0;
+        int itemId = 0;
         QString dueDate;
     };
-    std::vector<LoanInfo> getUserLoansWithDates(int userId);
 
+    /*
+        Function: getLoansDue
+        Purpose: Returns the next page of active loans due on or before a date, in
+                 (due_date, id) order, starting after a position. Keyset paging over
+                 the partial index idx_loans_due_active: each page is one index range
+                 read, whatever the page number and however many returned loans exist.
+        Parameters:
+          in: const QDate& until - Last due date to include
+          in: const DueLoan& after - Position to continue from (default: start)
+          in: int limit - Page size
+        Return: std::vector<DueLoan> - Up to limit loans; fewer at the end
+    */
+    std::vector<DueLoan> getLoansDue(const QDate& until, const DueLoan& after, int limit);
+
+    /*
+        Function: getScanCheckpoint / setScanCheckpoint
+        Purpose: Read and overwrite the position a named scan has reached
+        Parameters:
+          in: const QString& name - Scan name
+          in/out: DueLoan& position - Position (default DueLoan if the scan never ran)
+        Return: bool - False on database error
+    */
+    bool getScanCheckpoint(const QString& name, DueLoan& position);
+    bool setScanCheckpoint(const QString& name, const DueLoan& position);
+
+    /*
+        Function: recordNotices
+        Purpose: Inserts one notice per loan and moves the scan's checkpoint to the
+                 last loan, in one transaction: a scan interrupted between batches
+                 resumes after the last batch it recorded, and a loan never gets two
+                 notices of the same kind.
+        Parameters:
+          in: const QString& kind - Notice kind ("overdue", "due_soon"), also the scan name
+          in: const std::vector<DueLoan>& loans - Loans in timeline order
+        Return: int - Notices created (loans already noticed are skipped), or -1 on error
+    */
+    int recordNotices(const QString& kind, const std::vector<DueLoan>& loans);
+
+    // Loan history
+    /*
+        Function: archiveReturnedLoans
+        Purpose: Moves up to limit returned loans still in the loans table (rows returned
+                 before returns moved them to loan_history themselves) into loan_history,
+                 oldest first, in one transaction. Called repeatedly by LoanArchiver.
+        Parameters:
+          in: int limit - Most loans to move
+        Return: int - Loans moved (0 once none are left), or -1 on error
+    */
+    int archiveReturnedLoans(int limit);
+
+    // Catalogue filtering
+    /*
+        Function: getFacets
+        Purpose: Filters the catalogue by format, genre, rating, condition, availability
+                 and year range, with a count for every facet value, from the in-memory
+                 facet bitmaps (see FacetIndex) rather than GROUP BY queries
+        Parameters:
+          in: const FacetFilter& filter - Selected values
+        Return: FacetResult - Matching total, counts and item IDs
+    */
+    FacetResult getFacets(const FacetFilter& filter) override;
+
+    /*
+        ItemFacets Struct:
+        Facet values of one catalogue row (empty where the item has none)
+    */
+    struct ItemFacets {
+        int itemId = 0;
+        QString values[FacetCount];
+        int year = 0;
+    };
+
+    /*
+        FacetChange Struct:
+        One item changed by a write, for FacetIndex: available is 1 or 0 when the
+        write knows the item's new availability (borrow, return), -1 when the row
+        must be re-read (added, removed)
+    */
+    struct FacetChange {
+        int itemId;
+        int available;
+    };
+
+    /*
+        HoldChange Struct:
+        One hold placed (queued 1) or removed (queued 0) by a write, for
+        HoldQueueIndex; queued -1 when the item's queue must be reloaded
+    */
+    struct HoldChange {
+        int itemId;
+        int userId;
+        int queued;
+    };
+
+    /*
+        ChangeStamp Struct:
+        The database's change counters at one moment, bumped by triggers whichever
+        process writes: catalogue_generation (what catalogue_items describes) and
+        circulation_generation (loans, holds and items' copy and hold counters); -1
+        when not known
+    */
+    struct ChangeStamp {
+        qint64 catalogue;
+        qint64 circulation;
+
+        ChangeStamp() : catalogue(-1), circulation(-1) {}
+        bool isValid() const { return catalogue >= 0 && circulation >= 0; }
+    };
+
+    /*
+        Function: getChangeStamp
+        Purpose: Reads the change counters, so an index kept in memory can tell
+                 whether any process has written since it was filled (one primary-key
+                 read of each counter)
+        Return: ChangeStamp - Current counters; not valid inside a transaction, whose
+                own uncommitted writes have moved them, or on database error
+    */
+    ChangeStamp getChangeStamp();
+
+    /*
+        Function: getItemFacets
+        Purpose: Reads the facet values of catalogue rows, either the next page in id
+                 order (for a full build) or the rows with the given IDs (to refresh
+                 items changed since). IDs with no row are items that were removed.
+        Parameters:
+          in: int afterId / int limit - Page start (exclusive) and size
+          in: const std::vector<int>& itemIds - Rows to read
+          out: std::vector<ItemFacets>& rows - Rows found are appended, in id order
+        Return: bool - False on database error
+    */
+    bool getItemFacets(int afterId, int limit, std::vector<ItemFacets>& rows);
+    bool getItemFacets(const std::vector<int>& itemIds, std::vector<ItemFacets>& rows);
+
+    /*
+        Function: getCatalogueChanges
+        Purpose: Reads the change counters and the items changed after an earlier
+                 stamp, by this process or any other (see catalogue_changes and
+                 circulation_changes), so an index kept in memory can catch up before it
+                 answers. Reads nothing inside an open transaction, whose own uncommitted
+                 changes would be counted.
+        Parameters:
+          in: const ChangeStamp& since - Counters the caller is current at; an invalid
+              stamp reads only the counters
+          out: ChangeStamp& stamp - Current counters
+          out: std::vector<int>& itemIds - Items changed since are appended
+        Return: bool - False on database error or inside a transaction
+    */
+    bool getCatalogueChanges(const ChangeStamp& since, ChangeStamp& stamp, std::vector<int>& itemIds);
 
 private:
     /*
@@ -293,6 +825,319 @@ private:
         Return: LibraryItem* - Appropriately typed LibraryItem instance, or nullptr on error
     */
     LibraryItem* createItemFromQuery(const QSqlQuery& query);
+
+    /*
+        Function: readItemRow / createItemFromRow
+        Purpose: Copy a catalogue_items row out of a query, and build the LibraryItem
+                 subclass for a row (from a query or from CatalogueSnapshot::row())
+        Parameters:
+          in: const QSqlQuery& query - Positioned on a catalogue_items row
+          in/out: CatalogueSnapshot::ItemRow& row - The row's columns
+        Return: LibraryItem* - Caller-owned item, or nullptr for an unknown item type
+    */
+    static void readItemRow(const QSqlQuery& query, CatalogueSnapshot::ItemRow& row);
+    static LibraryItem* createItemFromRow(const CatalogueSnapshot::ItemRow& row);
+
+    /*
+        Function: catalogueGeneration
+        Purpose: Reads the counter the catalogue_items triggers bump on every change,
+                 and optionally the database's identity stored beside it
+        Parameters:
+          in: QSqlDatabase& conn - Calling thread's connection
+          out: qint64* databaseId - Identity of the database (optional)
+        Return: qint64 - Generation, or -1 if it cannot be read
+    */
+    qint64 catalogueGeneration(QSqlDatabase& conn, qint64* databaseId = nullptr);
+
+    /*
+        Function: readChangeStamp
+        Purpose: Reads both change counters in one statement
+        Parameters:
+          in: QSqlDatabase& conn - Calling thread's connection
+          out: ChangeStamp& stamp - Counters (left invalid on error)
+        Return: bool - False on database error
+    */
+    bool readChangeStamp(QSqlDatabase& conn, ChangeStamp& stamp);
+
+    /*
+        Function: currentSnapshot
+        Purpose: Returns the mapped snapshot if it was written from this database at
+                 the generation the calling thread's connection sees now (one
+                 primary-key read)
+        Parameters:
+          in: QSqlDatabase& conn - Calling thread's connection
+        Return: std::shared_ptr<CatalogueSnapshot> - Snapshot to read, or nullptr to use SQL
+    */
+    std::shared_ptr<CatalogueSnapshot> currentSnapshot(QSqlDatabase& conn);
+
+    /*
+        ItemCounters Struct:
+        An item's copy and hold counters, which circulation moves without changing
+        the catalogue generation
+    */
+    struct ItemCounters {
+        int availableCopies;
+        int holdCount;
+        bool isAvailable;
+    };
+
+    /*
+        Function: readMovedCounters
+        Purpose: Reads the current counters of the items logged in circulation_changes
+                 after a circulation generation, through the index on that log
+        Parameters:
+          in: QSqlDatabase& conn - Calling thread's connection
+          in: qint64 sinceCirculation - Generation a snapshot's counters were read at
+          in: int itemId - Only this item, or -1 for all
+          out: QHash<int, ItemCounters>& moved - Counters by item ID
+        Return: bool - False on database error
+    */
+    bool readMovedCounters(QSqlDatabase& conn, qint64 sinceCirculation, int itemId,
+                           QHash<int, ItemCounters>& moved);
+
+    /*
+        Function: overlayCounters
+        Purpose: Replaces a snapshot row's counters with the moved ones, if it has any
+        Parameters:
+          in: const QHash<int, ItemCounters>& moved - Result of readMovedCounters()
+          in/out: CatalogueSnapshot::ItemRow& row - Row read from the snapshot
+    */
+    static void overlayCounters(const QHash<int, ItemCounters>& moved, CatalogueSnapshot::ItemRow& row);
+
+    /*
+        Function: loadCatalogueItems
+        Purpose: Reads every catalogue item in ID order, from the mapped snapshot (with the
+                 counters that moved since overlaid) when it is current and from
+                 catalogue_items otherwise
+        Parameters:
+          in: QSqlDatabase& conn - Calling thread's connection
+          out: std::vector<LibraryItem*>& items - Caller-owned items are appended
+        Return: bool - False on database error
+    */
+    bool loadCatalogueItems(QSqlDatabase& conn, std::vector<LibraryItem*>& items);
+
+    /*
+        Function: readCatalogueVersion
+        Purpose: Makes the CatalogueVersion for the connection's current catalogue and
+                 circulation generations. Must run inside a read transaction, under
+                 catalogueVersionMutex.
+        Parameters:
+          in: QSqlDatabase& conn - Calling thread's connection
+          in: const std::shared_ptr<const CatalogueVersion>& published - Version to start from (may be nullptr)
+        Return: std::shared_ptr<const CatalogueVersion> - published itself if nothing changed,
+                a new version otherwise, or nullptr on database error
+    */
+    std::shared_ptr<const CatalogueVersion> readCatalogueVersion(
+            QSqlDatabase& conn, const std::shared_ptr<const CatalogueVersion>& published);
+
+    /*
+        Function: createUserFromQuery
+        Purpose: Creates a User, with its loan and hold counters, from a users row
+        Parameters:
+          in: const QSqlQuery& query - SQL query result containing user data
+        Return: User* - Caller-owned user
+    */
+    User* createUserFromQuery(const QSqlQuery& query);
+
+    /*
+        Function: execQuery
+        Purpose: Executes a prepared query under a ScopedTimer keyed by the enclosing
+                 operation and the statement. Failures are counted as errors (and
+                 as contention when SQLITE_BUSY/LOCKED) for the enclosing operation too.
+        Parameters:
+          in/out: QSqlQuery& query - Prepared query with bound values
+          in: const char* sql - The string literal the query was prepared from; without
+              it (SQL built at run time) the statement is keyed by its text
+        Return: bool - Result of QSqlQuery::exec()
+    */
+    bool execQuery(QSqlQuery& query, const char* sql);
+    bool execQuery(QSqlQuery& query);
+
+    /*
+        Function: connection
+        Purpose: Returns the connection for the calling thread. The thread that created
+                 the manager uses the main connection; any other thread gets a clone of
+                 it, opened on first use and kept until releaseThreadConnection().
+        Return: QSqlDatabase - Open connection usable from the calling thread
+    */
+    QSqlDatabase connection();
+
+    static QString threadConnectionName();
+
+    /*
+        WriteUnit Class:
+        Makes a multi-statement write (borrow, return, hold changes) atomic. Opens a
+        transaction of its own with BEGIN IMMEDIATE, or a savepoint when the calling
+        thread already has a transaction open (a server batch, a group commit).
+        Rolls back on destruction unless commit() was called.
+    */
+    class WriteUnit {
+    public:
+        WriteUnit(DatabaseManager& manager, const QString& name);
+        ~WriteUnit();
+
+        bool isOpen() const { return open; }
+        bool commit();
+
+    private:
+        DatabaseManager& manager;
+        QString name;
+        bool nested;
+        bool open;
+    };
+
+    // Whether the calling thread is inside beginTransaction() ... commit/rollback
+    static thread_local bool transactionOpen;
+
+    // Change counters when the calling thread's open transaction began; no other writer
+    // can move them before its COMMIT
+    static thread_local ChangeStamp transactionStamp;
+
+    // Items changed by the calling thread's open transaction, for FacetIndex at commit
+    static thread_local std::vector<FacetChange> touchedItems;
+
+    // Holds placed and removed by the calling thread's open transaction, for HoldQueueIndex
+    static thread_local std::vector<HoldChange> holdChanges;
+
+    // Patrons whose loans the calling thread's open transaction changed, for AccountCache
+    static thread_local std::vector<int> touchedAccounts;
+
+    /*
+        Function: shelveCopy
+        Purpose: Puts a copy that just came back (or was just added) where it is needed:
+                 on the hold shelf for the first hold on the item that has no copy
+                 waiting yet, otherwise back on the shelf with available_copies + 1.
+                 Must run inside a WriteUnit.
+        Parameters:
+          in: int copyId - Copy to place
+          in: int itemId - Item the copy belongs to
+        Return: bool - False on database error
+    */
+    bool shelveCopy(int copyId, int itemId);
+
+    /*
+        Function: borrowCopy
+        Purpose: Body of tryBorrowItem() and tryBorrowScanned(). With copyId -1 it lends
+                 the copy held for the user or any copy on the shelf; otherwise only that
+                 copy, and only if it is held for the user or on the shelf.
+        Parameters:
+          in: int userId - Borrowing user
+          in: int itemId - Item being borrowed
+          in: int copyId - Copy to lend, or -1 for any
+        Return: WriteResult - As tryBorrowItem()
+    */
+    WriteResult borrowCopy(int userId, int itemId, int copyId);
+
+    /*
+        Function: findIsbn
+        Purpose: Body of findByIsbn() that tells a missing ISBN from a failed lookup
+        Parameters:
+          in: const QString& isbn - ISBN as typed or scanned
+          out: int& itemId - The item with the ISBN, or -1 if none
+        Return: bool - False only on a database error
+    */
+    bool findIsbn(const QString& isbn, int& itemId);
+
+    /*
+        Function: findCopy
+        Purpose: Looks up a copy by barcode (case-insensitive, surrounding spaces ignored)
+        Parameters:
+          in: const QString& barcode - Copy barcode
+          out: int& copyId / int& itemId - The copy and the item it belongs to, or -1 if
+                                           no copy has the barcode
+        Return: bool - False only on a database error
+    */
+    bool findCopy(const QString& barcode, int& copyId, int& itemId);
+
+    /*
+        Function: deleteHold
+        Purpose: Deletes a user's hold on an item and moves later holds up one place
+        Parameters:
+          in: int userId - Holder
+          in: int itemId - Held item
+        Return: bool - False on database error
+    */
+    bool deleteHold(int userId, int itemId);
+
+    /*
+        Function: adjustCounter
+        Purpose: Adds delta to one denormalized counter (hold_count, active_loan_count,
+                 active_hold_count). Callers run it in the same WriteUnit as the change
+                 being counted, so the counter commits or rolls back with it.
+        Parameters:
+          in: const char* table - catalogue_items or users
+          in: const char* column - Counter column
+          in: int id - Row id
+          in: int delta - Amount to add (negative to subtract)
+        Return: bool - False on database error
+    */
+    bool adjustCounter(const char* table, const char* column, int id, int delta);
+
+    /*
+        Function: updateItemStats
+        Purpose: Applies assignments to an item's item_stats row, creating the row on
+                 its first event. Runs in the caller's WriteUnit, like adjustCounter().
+        Parameters:
+          in: int itemId - Item the event concerns
+          in: const QString& assignments - SET clause, e.g. "borrow_count = borrow_count + 1"
+          in: const QVariantList& values - Values for the placeholders in assignments
+        Return: bool - False on database error
+    */
+    bool updateItemStats(int itemId, const QString& assignments, const QVariantList& values);
+
+    /*
+        Function: touchItem
+        Purpose: Records that a write added or removed an item. The IDs are handed to
+                 FacetIndex when the transaction commits and dropped if it rolls back,
+                 so the index never sees uncommitted state; the index re-reads the rows.
+        Parameters:
+          in: int itemId - Changed item
+    */
+    void touchItem(int itemId);
+
+    /*
+        Function: markAvailability
+        Purpose: Records an item's availability after a borrow or return, handed over
+                 like touchItem() but applied to the index as a single bit flip, with
+                 no re-read. A savepoint rolled back after it turns it into a re-read.
+        Parameters:
+          in: int itemId - Changed item
+          in: bool available - Whether a copy is on the shelf after the write
+    */
+    void markAvailability(int itemId, bool available);
+
+    /*
+        Function: recordHoldChange
+        Purpose: Records a hold placed or removed inside the current write, applied to
+                 HoldQueueIndex at commit. A savepoint rolled back after it turns it into
+                 a reload of the item's queue.
+        Parameters:
+          in: int itemId - Item whose queue changed
+          in: int userId - Patron whose hold it is
+          in: bool queued - True for a hold placed, false for one removed
+    */
+    void recordHoldChange(int itemId, int userId, bool queued);
+
+    /*
+        Function: touchAccount
+        Purpose: Records that a write borrowed or returned for a patron; the patron's
+                 cached account is dropped when the transaction commits. Hold changes
+                 and changed items reach AccountCache through holdChanges and
+                 touchedItems and need no separate call.
+        Parameters:
+          in: int userId - Patron whose loans changed
+    */
+    void touchAccount(int userId);
+
+    /*
+        Function: reportAccountChanges
+        Purpose: Drops the cached accounts the calling thread's transaction made stale;
+                 called right after its COMMIT succeeds, for every transaction, so
+                 AccountCache can follow the change counters it moved
+        Parameters:
+          in: const ChangeStamp& leaving - Counters read just before the COMMIT
+    */
+    static void reportAccountChanges(const ChangeStamp& leaving);
 };
 
 #endif
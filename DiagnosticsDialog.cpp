@@ -0,0 +1,132 @@
+#include <QHeaderView>
+#include <QMessageBox>
+#include <QDialogButtonBox>
+#include "DiagnosticsDialog.h"
+#include "PerformanceMonitor.h"
+#include "RefreshScheduler.h"
+
+namespace {
+    // Nanoseconds to a millisecond table cell
+    QTableWidgetItem* msItem(qint64 nanos) {
+        QTableWidgetItem* item = new QTableWidgetItem(QString::number(nanos / 1e6, 'f', 3));
+        item->setTextAlignment(Qt::AlignRight);
+        return item;
+    }
+
+    QTableWidgetItem* countItem(quint64 value) {
+        QTableWidgetItem* item = new QTableWidgetItem(QString::number(value));
+        item->setTextAlignment(Qt::AlignRight);
+        return item;
+    }
+}
+
+DiagnosticsDialog::DiagnosticsDialog(QWidget *parent, const RefreshScheduler* refreshes)
+    : QDialog(parent), refreshes(refreshes) {
+    setWindowTitle("HinLIBS Diagnostics");
+    resize(1000, 500);
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+
+    QLabel *label = new QLabel("Data layer timings (milliseconds):");
+    layout->addWidget(label);
+
+    statsTable = new QTableWidget(0, 10);
+    statsTable->setHorizontalHeaderLabels({"Operation", "Statement", "Count", "Errors", "Busy",
+                                           "Mean", "p50", "p99", "p99.9", "Max"});
+    statsTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    statsTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+    statsTable->horizontalHeader()->setSectionResizeMode(1, QHeaderView::Stretch);
+    layout->addWidget(statsTable);
+
+    dumpLabel = new QLabel();
+    layout->addWidget(dumpLabel);
+
+    refreshLabel = new QLabel();
+    layout->addWidget(refreshLabel);
+
+    QHBoxLayout *buttonLayout = new QHBoxLayout();
+    enabledCheck = new QCheckBox("Recording enabled");
+    enabledCheck->setChecked(PerformanceMonitor::getInstance().isEnabled());
+    QPushButton *refreshButton = new QPushButton("Refresh");
+    QPushButton *resetButton = new QPushButton("Reset");
+    QPushButton *dumpButton = new QPushButton("Write JSON Now");
+    QDialogButtonBox *buttonBox = new QDialogButtonBox(QDialogButtonBox::Close);
+
+    buttonLayout->addWidget(enabledCheck);
+    buttonLayout->addStretch();
+    buttonLayout->addWidget(refreshButton);
+    buttonLayout->addWidget(resetButton);
+    buttonLayout->addWidget(dumpButton);
+    buttonLayout->addWidget(buttonBox);
+    layout->addLayout(buttonLayout);
+
+    connect(refreshButton, &QPushButton::clicked, this, &DiagnosticsDialog::refreshStats);
+    connect(resetButton, &QPushButton::clicked, this, &DiagnosticsDialog::resetStats);
+    connect(dumpButton, &QPushButton::clicked, this, &DiagnosticsDialog::dumpNow);
+    connect(enabledCheck, &QCheckBox::toggled, this, &DiagnosticsDialog::toggleEnabled);
+    connect(buttonBox, &QDialogButtonBox::rejected, this, &QDialog::reject);
+
+    refreshStats();
+}
+
+void DiagnosticsDialog::refreshStats() {
+    auto summaries = PerformanceMonitor::getInstance().getSummaries();
+
+    statsTable->setSortingEnabled(false);
+    statsTable->setRowCount(int(summaries.size()));
+
+    int row = 0;
+    for (const auto& s : summaries) {
+        statsTable->setItem(row, 0, new QTableWidgetItem(s.operation));
+        statsTable->setItem(row, 1, new QTableWidgetItem(s.statement.isEmpty() ? "(total)" : s.statement));
+        statsTable->setItem(row, 2, countItem(s.count));
+        statsTable->setItem(row, 3, countItem(s.errors));
+        statsTable->setItem(row, 4, countItem(s.busyErrors));
+        statsTable->setItem(row, 5, msItem(s.mean));
+        statsTable->setItem(row, 6, msItem(s.p50));
+        statsTable->setItem(row, 7, msItem(s.p99));
+        statsTable->setItem(row, 8, msItem(s.p999));
+        statsTable->setItem(row, 9, msItem(s.max));
+        row++;
+    }
+
+    QString dumpPath = PerformanceMonitor::getInstance().getDumpPath();
+    dumpLabel->setText(dumpPath.isEmpty() ? "Periodic JSON dump: off"
+                                          : QString("Periodic JSON dump: %1").arg(dumpPath));
+
+    // Requested / run per pane; the difference was merged into another update
+    if (refreshes) {
+        auto pane = [this](const char* name, RefreshScheduler::Pane p) {
+            return QString("%1 %2 of %3").arg(name).arg(refreshes->getRefreshCount(p)).arg(refreshes->getRequestCount(p));
+        };
+        quint64 saved = refreshes->getSavedCount(RefreshScheduler::Catalogue) +
+                        refreshes->getSavedCount(RefreshScheduler::Account) +
+                        refreshes->getSavedCount(RefreshScheduler::Selection);
+        refreshLabel->setText(QString("Window updates (run of requested): %1, %2, %3; %4 saved over %5 frames")
+                              .arg(pane("catalogue", RefreshScheduler::Catalogue),
+                                   pane("account", RefreshScheduler::Account),
+                                   pane("buttons", RefreshScheduler::Selection))
+                              .arg(saved).arg(refreshes->getFrameCount()));
+    }
+    refreshLabel->setVisible(refreshes != nullptr);
+}
+
+void DiagnosticsDialog::resetStats() {
+    PerformanceMonitor::getInstance().reset();
+    refreshStats();
+}
+
+void DiagnosticsDialog::dumpNow() {
+    QString dumpPath = PerformanceMonitor::getInstance().getDumpPath();
+    if (dumpPath.isEmpty()) dumpPath = "hinlibs_metrics.json";
+
+    if (PerformanceMonitor::getInstance().writeJson(dumpPath)) {
+        QMessageBox::information(this, "Diagnostics", QString("Statistics written to %1").arg(dumpPath));
+    } else {
+        QMessageBox::warning(this, "Diagnostics", "Failed to write statistics file.");
+    }
+}
+
+void DiagnosticsDialog::toggleEnabled(bool on) {
+    PerformanceMonitor::getInstance().setEnabled(on);
+}
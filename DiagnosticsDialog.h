@@ -0,0 +1,71 @@
+#ifndef DIAGNOSTICSDIALOG_H
+#define DIAGNOSTICSDIALOG_H
+
+#include <QDialog>
+#include <QTableWidget>
+#include <QLabel>
+#include <QPushButton>
+#include <QCheckBox>
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+
+class RefreshScheduler;
+
+/*
+    DiagnosticsDialog Class:
+    Read-only view of the data layer statistics collected by PerformanceMonitor.
+    Lets librarians and developers see where time goes without attaching a profiler.
+
+    UI Design:
+    - Table with one row per (operation, statement): count, errors, contention,
+      mean, p50, p99, p99.9 and max latency in milliseconds
+    - Operation totals are listed with statement "(total)"
+    - Buttons to refresh, reset statistics and write the JSON dump immediately
+    - Checkbox to turn recording on or off
+    - Main window refresh counters: updates requested, run and saved by coalescing
+
+    Data Members:
+      - QTableWidget* statsTable: Per-operation/statement statistics
+      - QLabel* dumpLabel: Shows where the periodic JSON dump is written
+      - QLabel* refreshLabel: Shows the main window's refresh counters
+      - const RefreshScheduler* refreshes: The main window's scheduler (may be null)
+      - QCheckBox* enabledCheck: Toggles PerformanceMonitor recording
+
+    Member Functions:
+      Public:
+        - DiagnosticsDialog(): Builds the dialog and loads current statistics
+
+      Private Slots:
+        - refreshStats(): Reloads the table from PerformanceMonitor
+        - resetStats(): Clears all statistics
+        - dumpNow(): Writes the JSON dump file immediately
+        - toggleEnabled(): Turns recording on or off
+*/
+class DiagnosticsDialog : public QDialog {
+    Q_OBJECT
+
+public:
+    /*
+        Function: DiagnosticsDialog
+        Purpose: Constructs the diagnostics dialog and fills it with current statistics
+        Parameters:
+          in: QWidget* parent - Parent widget for modal behavior (optional)
+          in: const RefreshScheduler* refreshes - Scheduler whose counters to show (optional)
+    */
+    DiagnosticsDialog(QWidget *parent = nullptr, const RefreshScheduler* refreshes = nullptr);
+
+private slots:
+    void refreshStats();
+    void resetStats();
+    void dumpNow();
+    void toggleEnabled(bool on);
+
+private:
+    QTableWidget *statsTable;
+    QLabel *dumpLabel;
+    QLabel *refreshLabel;
+    const RefreshScheduler* refreshes;
+    QCheckBox *enabledCheck;
+};
+
+#endif
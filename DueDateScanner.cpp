@@ -0,0 +1,60 @@
+#include <QDebug>
+#include "DueDateScanner.h"
+#include "PerformanceMonitor.h"
+
+QString DueDateScanner::kindName(NoticeKind kind) {
+    return kind == Overdue ? "overdue" : "due_soon";
+}
+
+bool DueDateScanner::scan(const QDate& until, const DatabaseManager::DueLoan& after, int batchSize,
+                          const BatchSink& sink) {
+    DatabaseManager& dbm = DatabaseManager::getInstance();
+    batchSize = qMax(1, batchSize);
+
+    DatabaseManager::DueLoan position = after;
+    for (;;) {
+        std::vector<DatabaseManager::DueLoan> batch = dbm.getLoansDue(until, position, batchSize);
+        if (batch.empty()) return true;
+
+        if (!sink(batch)) return false;
+        if (int(batch.size()) < batchSize) return true;
+        position = batch.back();
+    }
+}
+
+int DueDateScanner::generateNotices(NoticeKind kind, const QDate& today, int batchSize) {
+    ScopedTimer timer(kind == Overdue ? "overdueNotices" : "dueSoonNotices");
+    DatabaseManager& dbm = DatabaseManager::getInstance();
+    QString name = kindName(kind);
+
+    DatabaseManager::DueLoan checkpoint;
+    if (!dbm.getScanCheckpoint(name, checkpoint)) {
+        timer.fail();
+        return -1;
+    }
+
+    QDate horizon = kind == Overdue ? today.addDays(-1) : today.addDays(DUE_SOON_DAYS);
+    int created = 0;
+    bool failed = false;
+
+    scan(horizon, checkpoint, batchSize, [&](const std::vector<DatabaseManager::DueLoan>& batch) {
+        int recorded = dbm.recordNotices(name, batch);
+        if (recorded < 0) {
+            failed = true;
+            return false;
+        }
+        created += recorded;
+        return true;
+    });
+
+    if (failed) {
+        qDebug() << "Notice run" << name << "stopped after" << created << "notices";
+        timer.fail();
+        return -1;
+    }
+    return created;
+}
+
+bool DueDateScanner::resetCheckpoint(NoticeKind kind) {
+    return DatabaseManager::getInstance().setScanCheckpoint(kindName(kind), DatabaseManager::DueLoan());
+}
@@ -0,0 +1,84 @@
+#ifndef DUEDATESCANNER_H
+#define DUEDATESCANNER_H
+
+#include <QString>
+#include <QDate>
+#include <functional>
+#include <vector>
+#include "DatabaseManager.h"
+
+/*
+    DueDateScanner Class:
+    Acts on loan due dates: finds overdue loans and loans due soon by walking the
+    due-date timeline of active loans (the partial index idx_loans_due_active) in
+    due order, a batch at a time, and turns them into notices.
+
+    Notices are incremental. Each kind keeps a checkpoint, the last (due date,
+    loan id) it has noticed, and a run only walks the timeline from there up to its
+    horizon: yesterday for overdue loans, today + DUE_SOON_DAYS for due-soon loans.
+    Loans are always created due in the future, so nothing new appears behind a
+    checkpoint, and a run costs the loans that crossed the horizon since the last
+    run, not the number of active loans or the size of the loan history. A run that
+    stops part way resumes after the last batch it recorded.
+
+    Data Members: None (static class with no instance data)
+
+    Member Functions:
+      - scan(): Streams active loans due by a date to a callback, in due order
+      - generateNotices(): Creates the notices that are due for one kind
+      - resetCheckpoint(): Makes the next run of a kind start from the beginning
+      - kindName(): Notice kind as stored in the notices table
+*/
+class DueDateScanner {
+public:
+    enum NoticeKind {
+        Overdue,
+        DueSoon
+    };
+
+    static const int DEFAULT_BATCH = 500;
+    static const int DUE_SOON_DAYS = 2;   // "Within 48 hours" at day granularity
+
+    typedef std::function<bool(const std::vector<DatabaseManager::DueLoan>&)> BatchSink;
+
+    /*
+        Function: scan
+        Purpose: Streams every active loan due on or before a date, in (due date,
+                 loan id) order, in batches
+        Parameters:
+          in: const QDate& until - Last due date to include
+          in: const DatabaseManager::DueLoan& after - Position to start after (default: start)
+          in: int batchSize - Loans per batch
+          in: const BatchSink& sink - Receives each batch; returning false stops the scan
+        Return: bool - True if the scan reached the end, false if stopped or on error
+    */
+    static bool scan(const QDate& until, const DatabaseManager::DueLoan& after, int batchSize,
+                     const BatchSink& sink);
+
+    /*
+        Function: generateNotices
+        Purpose: Creates a notice for every loan of one kind reached since the last run
+                 (overdue: due before today; due soon: due by today + DUE_SOON_DAYS),
+                 one transaction and checkpoint per batch
+        Parameters:
+          in: NoticeKind kind - Overdue or DueSoon
+          in: const QDate& today - Date the run is for
+          in: int batchSize - Notices per transaction
+        Return: int - Notices created, or -1 on error (batches before the error are kept)
+    */
+    static int generateNotices(NoticeKind kind, const QDate& today, int batchSize = DEFAULT_BATCH);
+
+    /*
+        Function: resetCheckpoint
+        Purpose: Makes the next run of a kind walk the whole timeline again (loans
+                 already noticed are still not noticed twice)
+        Parameters:
+          in: NoticeKind kind - Checkpoint to reset
+        Return: bool - False on database error
+    */
+    static bool resetCheckpoint(NoticeKind kind);
+
+    static QString kindName(NoticeKind kind);
+};
+
+#endif
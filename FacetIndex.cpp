@@ -0,0 +1,245 @@
+#include <QDebug>
+#include <algorithm>
+#include <climits>
+#include "FacetIndex.h"
+
+FacetIndex* FacetIndex::instance = nullptr;
+
+FacetIndex::FacetIndex() : built(false) {}
+
+FacetIndex& FacetIndex::getInstance() {
+    static QMutex instanceMutex;
+    QMutexLocker locker(&instanceMutex);
+
+    if (!instance) {
+        instance = new FacetIndex();
+    }
+    return *instance;
+}
+
+bool FacetIndex::publish(const std::vector<DatabaseManager::FacetChange>& changes,
+                         const DatabaseManager::ChangeStamp& begun, const DatabaseManager::ChangeStamp& leaving,
+                         const std::function<bool()>& commit) {
+    QMutexLocker locker(&mutex);
+    if (!commit()) return false;
+    if (!built) return true; // The build will read them as they are now
+
+    for (const auto& change : changes) {
+        if (change.available < 0) {
+            dirty.push_back(change.itemId);
+        } else {
+            setAvailable(change.itemId, change.available == 1);
+        }
+    }
+
+    // Nobody else wrote in between: the counters this transaction moved are accounted for
+    if (synced.isValid() && leaving.isValid() &&
+        synced.catalogue == begun.catalogue && synced.circulation == begun.circulation) {
+        synced = leaving;
+    }
+    return true;
+}
+
+void FacetIndex::itemsChanged(const std::vector<int>& itemIds) {
+    QMutexLocker locker(&mutex);
+    if (!built) return; // The build will read them as they are now
+    dirty.insert(dirty.end(), itemIds.begin(), itemIds.end());
+}
+
+void FacetIndex::invalidate() {
+    QMutexLocker locker(&mutex);
+    clear();
+}
+
+void FacetIndex::clear() {
+    for (int f = 0; f < IDataRepository::FacetCount; ++f) {
+        names[f].clear();
+        codes[f].clear();
+        bitmaps[f].clear();
+    }
+    years.clear();
+    all = ItemBitmap();
+    entries.clear();
+    dirty.clear();
+    built = false;
+    synced = DatabaseManager::ChangeStamp();
+}
+
+bool FacetIndex::build(DatabaseManager& dbm) {
+    clear();
+
+    std::vector<DatabaseManager::ItemFacets> rows;
+    int afterId = 0;
+    do {
+        rows.clear();
+        if (!dbm.getItemFacets(afterId, BUILD_PAGE, rows)) {
+            clear();
+            return false;
+        }
+        for (const auto& row : rows) insert(row);
+        if (!rows.empty()) afterId = rows.back().itemId;
+    } while (int(rows.size()) == BUILD_PAGE);
+
+    built = true;
+    return true;
+}
+
+void FacetIndex::sync(DatabaseManager& dbm) {
+    DatabaseManager::ChangeStamp stamp;
+    std::vector<int> changed;
+    if (!dbm.getCatalogueChanges(built ? synced : DatabaseManager::ChangeStamp(), stamp, changed)) {
+        return; // Inside a transaction
+    }
+
+    // Built while the counters could not be read: nothing to catch up from
+    if (built && !synced.isValid()) clear();
+
+    if (!built) {
+        // Counters read first, so the build covers at least the changes up to them
+        if (!build(dbm)) return;
+    } else {
+        dirty.insert(dirty.end(), changed.begin(), changed.end());
+    }
+    synced = stamp;
+}
+
+bool FacetIndex::refresh(DatabaseManager& dbm) {
+    if (dirty.empty()) return true;
+
+    std::sort(dirty.begin(), dirty.end());
+    dirty.erase(std::unique(dirty.begin(), dirty.end()), dirty.end());
+
+    std::vector<DatabaseManager::ItemFacets> rows;
+    if (!dbm.getItemFacets(dirty, rows)) return false; // Kept for the next query
+
+    // Rows that are gone were removed from the catalogue
+    for (int itemId : dirty) erase(itemId);
+    for (const auto& row : rows) insert(row);
+    dirty.clear();
+    return true;
+}
+
+int FacetIndex::codeFor(int facet, const QString& value) {
+    int code = codes[facet].value(value, 0);
+    if (code == 0) {
+        names[facet].push_back(value);
+        bitmaps[facet].push_back(ItemBitmap());
+        code = int(names[facet].size());
+        codes[facet].insert(value, code);
+    }
+    return code;
+}
+
+void FacetIndex::insert(const DatabaseManager::ItemFacets& row) {
+    if (row.itemId < 0) return;
+    if (size_t(row.itemId) >= entries.size()) entries.resize(row.itemId + 1);
+
+    Entry& entry = entries[row.itemId];
+    for (int f = 0; f < IDataRepository::FacetCount; ++f) {
+        const QString& value = row.values[f];
+        int code = 0;
+        if (!value.isEmpty()) {
+            code = codeFor(f, value);
+            bitmaps[f][code - 1].set(row.itemId);
+        }
+        entry.codes[f] = code;
+    }
+
+    entry.year = row.year;
+    if (row.year > 0) years[row.year].set(row.itemId);
+    all.set(row.itemId);
+}
+
+void FacetIndex::erase(int itemId) {
+    if (!all.test(itemId)) return;
+
+    const Entry& entry = entries[itemId];
+    for (int f = 0; f < IDataRepository::FacetCount; ++f) {
+        if (entry.codes[f] > 0) bitmaps[f][entry.codes[f] - 1].reset(itemId);
+    }
+    if (entry.year > 0) years[entry.year].reset(itemId);
+    all.reset(itemId);
+}
+
+void FacetIndex::setAvailable(int itemId, bool available) {
+    if (!all.test(itemId)) return; // Added in the same transaction; its re-read covers it
+
+    // Values as DatabaseManager::getItemFacets() reports them
+    const int facet = IDataRepository::FacetAvailability;
+    int code = codeFor(facet, available ? "available" : "checked out");
+    int& current = entries[itemId].codes[facet];
+    if (current == code) return;
+
+    if (current > 0) bitmaps[facet][current - 1].reset(itemId);
+    bitmaps[facet][code - 1].set(itemId);
+    current = code;
+}
+
+IDataRepository::FacetResult FacetIndex::query(const IDataRepository::FacetFilter& filter) {
+    IDataRepository::FacetResult result;
+    DatabaseManager& dbm = DatabaseManager::getInstance();
+
+    QMutexLocker locker(&mutex);
+    sync(dbm);
+    if (!built && !build(dbm)) {
+        qDebug() << "Facet index could not be built";
+        return result;
+    }
+    if (!refresh(dbm)) {
+        qDebug() << "Facet index answering without" << dirty.size() << "changed items";
+    }
+
+    // Selected value of each facet; a value no item has selects nothing
+    ItemBitmap none;
+    const ItemBitmap* selected[IDataRepository::FacetCount] = {};
+    for (int f = 0; f < IDataRepository::FacetCount; ++f) {
+        if (filter.values[f].isEmpty()) continue;
+        int code = codes[f].value(filter.values[f], 0);
+        selected[f] = code > 0 ? &bitmaps[f][code - 1] : &none;
+    }
+
+    bool byYear = filter.fromYear != 0 || filter.toYear != 0;
+    ItemBitmap inYears;
+    if (byYear) {
+        int last = filter.toYear != 0 ? filter.toYear : INT_MAX;
+        for (auto it = years.lower_bound(filter.fromYear); it != years.end() && it->first <= last; ++it) {
+            inYears |= it->second;
+        }
+    }
+
+    // Items passing every selection except the one being counted
+    auto restrictExcept = [&](int skipped) {
+        ItemBitmap items = all;
+        if (byYear) items &= inYears;
+        for (int f = 0; f < IDataRepository::FacetCount; ++f) {
+            if (f != skipped && selected[f]) items &= *selected[f];
+        }
+        return items;
+    };
+
+    ItemBitmap matching = restrictExcept(-1);
+    result.total = matching.count();
+
+    for (int f = 0; f < IDataRepository::FacetCount; ++f) {
+        ItemBitmap base = restrictExcept(f);
+        for (size_t c = 0; c < names[f].size(); ++c) {
+            int count = ItemBitmap::andCount(base, bitmaps[f][c]);
+            if (count > 0 || names[f][c] == filter.values[f]) {
+                result.counts[f].push_back({names[f][c], count});
+            }
+        }
+        std::sort(result.counts[f].begin(), result.counts[f].end(),
+                  [](const IDataRepository::FacetValue& a, const IDataRepository::FacetValue& b) {
+                      return a.value < b.value;
+                  });
+    }
+
+    if (filter.isActive()) result.itemIds = matching.ids();
+
+    int availableCode = codes[IDataRepository::FacetAvailability].value("available", 0);
+    if (availableCode > 0) {
+        matching &= bitmaps[IDataRepository::FacetAvailability][availableCode - 1];
+        result.availableIds = matching.ids();
+    }
+    return result;
+}
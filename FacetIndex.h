@@ -0,0 +1,158 @@
+#ifndef FACETINDEX_H
+#define FACETINDEX_H
+
+#include <QMutex>
+#include <QHash>
+#include <functional>
+#include <map>
+#include <vector>
+#include "ItemBitmap.h"
+#include "DatabaseManager.h"
+
+/*
+    FacetIndex Class:
+    Singleton holding one ItemBitmap per facet value (every format, genre, rating,
+    condition and availability state, and every publication year) over the
+    catalogue. A filter is the AND of the selected values' bitmaps; the count next
+    to each value is the popcount of that value's bitmap ANDed with the other
+    facets' selections. A query touches SQLite only to read the catalogue
+    generation and pick up changed items.
+
+    Built on first use with one pass over catalogue_items in id order, then kept
+    current incrementally. DatabaseManager hands over the items each transaction
+    changed through publish(), which runs the COMMIT itself under the index lock:
+      - a borrow or return carries the item's new availability and is applied at
+        once by moving the item between the two availability bitmaps (two bit
+        operations, no SQL)
+      - an added or removed item is re-read by primary key before the next query
+    Writers are serialized by SQLite, and each one holds the index lock from COMMIT
+    until its flips are applied, so flips arrive in commit order; a re-read can
+    only observe state the flips after it will correct. Writes that roll back are
+    never reported.
+
+    Other processes writing the same file (a second desk, the server) report
+    nothing, so each query outside a transaction first reads the change counters;
+    if they moved since the index was last checked, the items logged in
+    catalogue_changes and circulation_changes (availability) since then are re-read
+    as well. publish() is handed the counters the transaction began and ended at:
+    if the index had caught up with the first, everything in between was this
+    transaction's own and has just been applied, so the index is caught up with the
+    second and its own writes are not read back. Every transaction is published,
+    holds included, so the counters it moves never leave the index behind.
+
+    Data Members:
+      - std::vector<QString> names[FacetCount]: Values seen per facet; value code c is names[c - 1]
+      - QHash<QString, int> codes[FacetCount]: Value to code
+      - std::vector<ItemBitmap> bitmaps[FacetCount]: Items with each value, by code - 1
+      - std::map<int, ItemBitmap> years: Items per publication year
+      - ItemBitmap all: Every indexed item
+      - std::vector<Entry> entries: Each item's current codes, by item ID, so a change
+        can clear the old bits
+      - std::vector<int> dirty: Items changed since the last query
+      - bool built: Whether the index has been built for the open database
+      - DatabaseManager::ChangeStamp synced: Counters the index has caught up with (invalid if unknown)
+      - QMutex mutex: Guards all of the above
+      - static FacetIndex* instance: Singleton instance pointer
+
+    Member Functions:
+      Public:
+        - getInstance(): Provides global access to singleton instance
+        - query(): Applies a filter and counts every facet value
+        - publish(): Commits a transaction and applies its item changes
+        - itemsChanged(): Marks items for re-reading
+        - invalidate(): Drops the index; the next query rebuilds it
+      Private:
+        - build(): Reads the whole catalogue
+        - sync(): Marks items other writers changed for re-reading
+        - refresh(): Re-reads the changed items
+        - insert() / erase(): Sets and clears one item's bits
+        - setAvailable(): Moves one item between the availability bitmaps
+        - codeFor(): Value code, allocating a bitmap for a new value
+*/
+class FacetIndex {
+public:
+    /*
+        Function: getInstance
+        Purpose: Provides global access to the singleton FacetIndex instance.
+        Return: FacetIndex& - Reference to the singleton instance
+    */
+    static FacetIndex& getInstance();
+
+    /*
+        Function: query
+        Purpose: Filters the catalogue and counts every facet value under the filter
+                 (see IDataRepository::FacetResult). Builds the index on first use.
+        Parameters:
+          in: const IDataRepository::FacetFilter& filter - Selected values
+        Return: IDataRepository::FacetResult - Total, counts and matching item IDs
+                (empty if the catalogue cannot be read)
+    */
+    IDataRepository::FacetResult query(const IDataRepository::FacetFilter& filter);
+
+    /*
+        Function: publish
+        Purpose: Runs a transaction's COMMIT and, if it succeeds, applies the items it
+                 changed (see DatabaseManager::FacetChange) before another writer can
+        Parameters:
+          in: const std::vector<DatabaseManager::FacetChange>& changes - Changed items
+          in: const DatabaseManager::ChangeStamp& begun - Counters when the transaction began
+          in: const DatabaseManager::ChangeStamp& leaving - Counters the transaction commits
+          in: const std::function<bool()>& commit - Executes COMMIT
+        Return: bool - Result of commit
+    */
+    bool publish(const std::vector<DatabaseManager::FacetChange>& changes, const DatabaseManager::ChangeStamp& begun,
+                 const DatabaseManager::ChangeStamp& leaving, const std::function<bool()>& commit);
+
+    /*
+        Function: itemsChanged
+        Purpose: Records items whose catalogue rows were changed by a committed write
+                 outside publish(); they are re-read before the next query
+        Parameters:
+          in: const std::vector<int>& itemIds - Changed items
+    */
+    void itemsChanged(const std::vector<int>& itemIds);
+
+    /*
+        Function: invalidate
+        Purpose: Discards the index (another database was opened, or the catalogue
+                 was rewritten in bulk); the next query rebuilds it
+    */
+    void invalidate();
+
+private:
+    static const int BUILD_PAGE = 10000;
+
+    /*
+        Entry Struct:
+        One item's value codes (0 = no value) and publication year (0 = unknown)
+    */
+    struct Entry {
+        int codes[IDataRepository::FacetCount];
+        int year;
+    };
+
+    std::vector<QString> names[IDataRepository::FacetCount];
+    QHash<QString, int> codes[IDataRepository::FacetCount];
+    std::vector<ItemBitmap> bitmaps[IDataRepository::FacetCount];
+    std::map<int, ItemBitmap> years;
+    ItemBitmap all;
+    std::vector<Entry> entries;
+    std::vector<int> dirty;
+    bool built;
+    DatabaseManager::ChangeStamp synced;
+    QMutex mutex;
+    static FacetIndex* instance;
+
+    FacetIndex(); // Private constructor for singleton
+
+    bool build(DatabaseManager& dbm);
+    void sync(DatabaseManager& dbm);
+    bool refresh(DatabaseManager& dbm);
+    void insert(const DatabaseManager::ItemFacets& row);
+    void erase(int itemId);
+    void setAvailable(int itemId, bool available);
+    int codeFor(int facet, const QString& value);
+    void clear();
+};
+
+#endif
@@ -0,0 +1,157 @@
+#include <QDebug>
+#include <algorithm>
+#include "HoldQueueIndex.h"
+
+HoldQueueIndex* HoldQueueIndex::instance = nullptr;
+
+HoldQueueIndex& HoldQueueIndex::getInstance() {
+    static QMutex instanceMutex;
+    QMutexLocker locker(&instanceMutex);
+
+    if (!instance) {
+        instance = new HoldQueueIndex();
+    }
+    return *instance;
+}
+
+bool HoldQueueIndex::position(int itemId, int userId, int& position) {
+    QMutexLocker locker(&mutex);
+
+    // Holds written by another process are not reported; start over whenever there were any
+    qint64 circulation = DatabaseManager::getInstance().getChangeStamp().circulation;
+    if (circulation < 0) return false;
+    if (circulation != synced) {
+        queues.clear();
+        synced = circulation;
+    }
+
+    Queue* queue = queueFor(itemId);
+    if (!queue) return false;
+
+    position = queue->position(userId);
+    return true;
+}
+
+bool HoldQueueIndex::publish(const std::vector<DatabaseManager::HoldChange>& changes,
+                             const DatabaseManager::ChangeStamp& begun,
+                             const DatabaseManager::ChangeStamp& committed,
+                             const std::function<bool()>& commit) {
+    QMutexLocker locker(&mutex);
+    if (!commit()) return false;
+
+    // Someone else wrote since the queues were last current (or a counter was not read)
+    if (synced < 0 || begun.circulation != synced || committed.circulation < 0) {
+        queues.clear();
+        synced = committed.circulation;
+        return true;
+    }
+    synced = committed.circulation;
+
+    for (const auto& change : changes) {
+        auto found = queues.find(change.itemId);
+        if (found == queues.end()) continue; // Loaded as it is now when next needed
+
+        if (change.queued == 1) {
+            found.value().enqueue(change.userId);
+        } else if (change.queued == 0) {
+            found.value().remove(change.userId);
+        } else {
+            queues.erase(found);
+        }
+    }
+    return true;
+}
+
+void HoldQueueIndex::itemsChanged(const std::vector<int>& itemIds) {
+    QMutexLocker locker(&mutex);
+    for (int itemId : itemIds) queues.remove(itemId);
+}
+
+void HoldQueueIndex::invalidate() {
+    QMutexLocker locker(&mutex);
+    queues.clear();
+    synced = -1;
+}
+
+HoldQueueIndex::Queue* HoldQueueIndex::queueFor(int itemId) {
+    auto found = queues.find(itemId);
+    if (found != queues.end()) return &found.value();
+
+    // Read under the lock, so no commit can change the queue between the read and the insert
+    std::vector<int> userIds;
+    if (!DatabaseManager::getInstance().getHoldQueue(itemId, userIds)) return nullptr;
+
+    if (queues.size() >= MAX_QUEUES) queues.clear();
+    return &queues.insert(itemId, Queue(userIds)).value();
+}
+
+// === QUEUE ===
+
+HoldQueueIndex::Queue::Queue(const std::vector<int>& userIds) : slotUsers(userIds), head(0), live(0) {
+    compact(int(userIds.size()));
+}
+
+void HoldQueueIndex::Queue::compact(int capacity) {
+    std::vector<int> kept;
+    kept.reserve(std::max(capacity, 16));
+    for (size_t slot = head; slot < slotUsers.size(); ++slot) {
+        if (slotUsers[slot] != -1) kept.push_back(slotUsers[slot]);
+    }
+
+    slotUsers.swap(kept);
+    slotOf.clear();
+    for (size_t slot = 0; slot < slotUsers.size(); ++slot) slotOf.insert(slotUsers[slot], int(slot));
+
+    // Nothing is removed after a compaction; slots not used yet count as not removed
+    removedTree.assign(slotUsers.capacity() + 1, 0);
+    head = 0;
+    live = int(slotUsers.size());
+}
+
+void HoldQueueIndex::Queue::enqueue(int userId) {
+    if (slotOf.contains(userId)) return; // One hold per patron and item
+
+    // The tree covers slotUsers.capacity() slots; make room (and drop dead slots) when full
+    if (slotUsers.size() == slotUsers.capacity()) compact(std::max(16, 2 * (live + 1)));
+
+    slotOf.insert(userId, int(slotUsers.size()));
+    slotUsers.push_back(userId);
+    live++;
+}
+
+void HoldQueueIndex::Queue::remove(int userId) {
+    auto found = slotOf.find(userId);
+    if (found == slotOf.end()) return;
+
+    int slot = found.value();
+    slotOf.erase(found);
+    slotUsers[slot] = -1;
+    live--;
+
+    if (slot == head) {
+        while (head < int(slotUsers.size()) && slotUsers[head] == -1) head++;
+        if (head > 64 && head > int(slotUsers.size()) / 2) compact(int(slotUsers.capacity()));
+        return;
+    }
+
+    for (int i = slot + 1; i < int(removedTree.size()); i += i & -i) {
+        removedTree[i]++;
+    }
+}
+
+int HoldQueueIndex::Queue::removedThrough(int slot) const {
+    int removed = 0;
+    for (int i = slot + 1; i > 0; i -= i & -i) {
+        removed += removedTree[i];
+    }
+    return removed;
+}
+
+int HoldQueueIndex::Queue::position(int userId) const {
+    auto found = slotOf.constFind(userId);
+    if (found == slotOf.constEnd()) return -1;
+
+    // Live holds in [head, slot]: slots there minus those removed behind the head
+    int slot = found.value();
+    return (slot - head + 1) - (removedThrough(slot) - removedThrough(head - 1));
+}
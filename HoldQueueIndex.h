@@ -0,0 +1,154 @@
+#ifndef HOLDQUEUEINDEX_H
+#define HOLDQUEUEINDEX_H
+
+#include <QMutex>
+#include <QHash>
+#include <functional>
+#include <vector>
+#include "DatabaseManager.h"
+
+/*
+    HoldQueueIndex Class:
+    Singleton keeping the hold queues of items in memory, keyed by item ID, so a
+    patron's place in a queue is answered without SQL. The holds table stays the
+    record: holds.position is a queue ticket (the next one is MAX + 1 for the item)
+    that is never renumbered, and a patron's place in line is the number of holds on
+    the item with a ticket up to theirs. A queue is loaded from the table the first
+    time one of its positions is asked for and kept current from then on.
+
+    Per queue (see Queue):
+      - enqueue: O(1) amortized (append)
+      - removing the head (a hold filled or cancelled at the front): O(1) amortized
+      - removing any other hold: O(log n)
+      - a patron's position: O(log n), one hash lookup and two Fenwick prefix sums
+
+    DatabaseManager hands over each transaction's hold changes through publish(),
+    which runs the COMMIT itself under the index lock, the same way FacetIndex does:
+    writers are serialized by SQLite and each one holds the lock from COMMIT until its
+    changes are applied, so queues see enqueues and removals in commit order. Changes
+    that are not known exactly (inside a savepoint that was rolled back, or written
+    outside a transaction) drop the item's queue; the next lookup reloads it.
+
+    Other processes writing the same file report nothing, so every lookup first
+    reads circulation_generation (see DatabaseManager::getChangeStamp()), which the
+    loans and holds triggers (and those on item copy and hold counters) bump, and drops every queue if it moved since the
+    index was last current. Each transaction's publish() carries the counter from
+    its BEGIN and from just before its COMMIT: when the index was current at the
+    first, only that transaction wrote in between, so its changes are applied and
+    the index is current at the second; otherwise the queues are dropped.
+
+    Data Members:
+      - QHash<int, Queue> queues: Loaded queues by item ID
+      - qint64 synced: circulation_generation the queues are current at (-1 unknown)
+      - QMutex mutex: Guards queues and synced
+      - static HoldQueueIndex* instance: Singleton instance pointer
+
+    Member Functions:
+      Public:
+        - getInstance(): Provides global access to singleton instance
+        - position(): A patron's place in an item's queue
+        - publish(): Commits a transaction and applies its hold changes
+        - itemsChanged(): Drops queues changed outside publish()
+        - invalidate(): Drops every queue (another database was opened)
+      Private:
+        - queueFor(): The loaded queue of an item, loading it if needed
+*/
+class HoldQueueIndex {
+public:
+    /*
+        Function: getInstance
+        Purpose: Provides global access to the singleton HoldQueueIndex instance.
+        Return: HoldQueueIndex& - Reference to the singleton instance
+    */
+    static HoldQueueIndex& getInstance();
+
+    /*
+        Function: position
+        Purpose: Finds a patron's place in an item's hold queue. Must not be called
+                 inside a transaction.
+        Parameters:
+          in: int itemId - Database ID of the item
+          in: int userId - Database ID of the patron
+          out: int& position - 1 for the front of the queue, -1 if the patron has no hold
+        Return: bool - False if the change counter or the queue could not be read
+    */
+    bool position(int itemId, int userId, int& position);
+
+    /*
+        Function: publish
+        Purpose: Runs a transaction's COMMIT and, if it succeeds, applies the hold
+                 changes it made (see DatabaseManager::HoldChange) before another writer can
+        Parameters:
+          in: const std::vector<DatabaseManager::HoldChange>& changes - Hold changes in order
+          in: const DatabaseManager::ChangeStamp& begun - Counters at the transaction's BEGIN
+          in: const DatabaseManager::ChangeStamp& committed - Counters before its COMMIT
+          in: const std::function<bool()>& commit - Executes COMMIT
+        Return: bool - Result of commit
+    */
+    bool publish(const std::vector<DatabaseManager::HoldChange>& changes,
+                 const DatabaseManager::ChangeStamp& begun,
+                 const DatabaseManager::ChangeStamp& committed,
+                 const std::function<bool()>& commit);
+
+    /*
+        Function: itemsChanged
+        Purpose: Drops the queues of items whose holds changed outside publish()
+        Parameters:
+          in: const std::vector<int>& itemIds - Changed items
+    */
+    void itemsChanged(const std::vector<int>& itemIds);
+
+    /*
+        Function: invalidate
+        Purpose: Drops every loaded queue
+    */
+    void invalidate();
+
+private:
+    static const int MAX_QUEUES = 10000; // Loaded queues kept before starting over
+
+    /*
+        Queue Class:
+        One item's holds in queue order. Each hold gets the next slot; removed holds
+        leave their slot empty (-1). head is the first slot that may still be live, so
+        removals at the front only move head. A removal further back is counted in a
+        Fenwick tree over the slots, which gives the removed holds between head and
+        any slot in O(log n). Slots are compacted, and the tree rebuilt, when they
+        run out or when more than half of them lie before head (O(1) amortized).
+    */
+    class Queue {
+        friend class HoldQueueIndexTest; // Checks slots around compaction
+
+    public:
+        Queue() : head(0), live(0) {}
+        explicit Queue(const std::vector<int>& userIds);
+
+        void enqueue(int userId);
+        void remove(int userId);
+        int position(int userId) const; // 1-based, or -1
+        int size() const { return live; }
+
+    private:
+        std::vector<int> slotUsers;     // User ID per slot, -1 once removed
+        std::vector<int> removedTree; // Fenwick tree (1-based) of removed slots after head
+        QHash<int, int> slotOf;       // User ID to slot
+        int head;
+        int live;
+
+        void compact(int capacity);
+        int removedThrough(int slot) const;
+    };
+
+    QHash<int, Queue> queues;
+    qint64 synced;
+    QMutex mutex;
+    static HoldQueueIndex* instance;
+
+    friend class HoldQueueIndexTest; // Drives Queue directly
+
+    HoldQueueIndex() : synced(-1) {} // Private constructor for singleton
+
+    Queue* queueFor(int itemId);
+};
+
+#endif
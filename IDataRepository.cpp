@@ -0,0 +1,73 @@
+#include <cmath>
+#include "IDataRepository.h"
+#include "DatabaseManager.h"
+
+IDataRepository* IDataRepository::active = nullptr;
+
+IDataRepository& IDataRepository::getInstance() {
+    if (active) {
+        return *active;
+    }
+    return DatabaseManager::getInstance();
+}
+
+void IDataRepository::setInstance(IDataRepository* repository) {
+    active = repository;
+}
+
+void IDataRepository::freeAccountSnapshot(AccountSnapshot& snapshot) {
+    for (auto& loan : snapshot.loans) {
+        delete loan.item;
+    }
+    for (auto& hold : snapshot.holds) {
+        delete hold.item;
+    }
+    snapshot.loans.clear();
+    snapshot.holds.clear();
+}
+
+int IDataRepository::CirculationReport::queueDepthPercentile(double percentile) const {
+    qint64 queued = 0;
+    for (const QueueDepth& row : queueDepths) queued += row.items;
+    if (queued == 0) return 0;
+
+    // Nearest rank over the histogram
+    qint64 rank = qMax<qint64>(1, qint64(std::ceil(percentile / 100.0 * queued)));
+    qint64 seen = 0;
+    for (const QueueDepth& row : queueDepths) {
+        seen += row.items;
+        if (seen >= rank) return row.depth;
+    }
+    return queueDepths.back().depth;
+}
+
+bool IDataRepository::FacetFilter::isActive() const {
+    for (const QString& value : values) {
+        if (!value.isEmpty()) return true;
+    }
+    return fromYear != 0 || toYear != 0;
+}
+
+std::vector<int> IDataRepository::getItemIds(const std::vector<LibraryItem*>& items) {
+    std::vector<int> ids;
+    ids.reserve(items.size());
+    for (LibraryItem* item : items) {
+        ids.push_back(getItemId(item));
+    }
+    return ids;
+}
+
+std::vector<int> IDataRepository::getHoldCountsForItems(const std::vector<int>& itemIds) {
+    std::vector<int> counts;
+    counts.reserve(itemIds.size());
+    for (int itemId : itemIds) {
+        counts.push_back(itemId == -1 ? 0 : getHoldCountForItem(itemId));
+    }
+    return counts;
+}
+
+bool IDataRepository::placeHoldAndGetPosition(int userId, int itemId, int& position) {
+    if (!placeHold(userId, itemId)) return false;
+    position = getHoldPosition(userId, itemId);
+    return true;
+}
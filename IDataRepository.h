@@ -1,22 +1,322 @@
 #ifndef IDATAREPOSITORY_H
 #define IDATAREPOSITORY_H
 
+#include <QString>
+#include <vector>
 #include "User.h"
 #include "LibraryItem.h"
-#include <vector>
 
+/*
+    IDataRepository Class:
+    Abstract interface for everything the user interface needs from the data layer.
+    DatabaseManager implements it directly against SQLite; RemoteRepository implements
+    it by forwarding each call to a HinLIBS server, which lets MainWindow run as a thin
+    client that shares one library with other desks.
+
+    All returned LibraryItem and User objects are owned by the caller.
+
+    Member Functions:
+      - getInstance(): Repository the application is currently using
+      - setInstance(): Installs a different repository (e.g. a remote one)
+      - freeAccountSnapshot(): Releases the items owned by an AccountSnapshot
+      - Pure virtual data operations mirroring DatabaseManager (see DatabaseManager.h
+        for the behaviour of each)
+      - getItemIds() / getHoldCountsForItems() / placeHoldAndGetPosition(): Bulk forms
+        that a remote repository can answer in one round trip
+
+    Concurrency:
+      Several desks (or server workers) may change the same rows at once. Nothing is
+      locked while a screen shows an item; instead every availability change is a
+      conditional update that only applies if the row is still in the state the
+      caller expects. tryBorrowItem() / tryReturnItem() report a lost race as
+      WriteConflict so the screen can refresh and tell the user, rather than a
+      generic failure.
+*/
 class IDataRepository {
 public:
+    /*
+        LoanInfo Struct:
+        One active loan with its dates
+    */
+    struct LoanInfo {
+        LibraryItem* item;
+        int itemId;
+        QString checkoutDate;
+        QString dueDate;
+    };
+
+    /*
+        HoldInfo Struct:
+        One hold with its queue position
+    */
+    struct HoldInfo {
+        LibraryItem* item;
+        int itemId;
+        int position;
+    };
+
+    /*
+        AccountSnapshot Struct:
+        Everything the account panel shows for one user
+    */
+    struct AccountSnapshot {
+        std::vector<LoanInfo> loans;
+        std::vector<HoldInfo> holds;
+    };
+
+    /*
+        ShelfEntry Struct:
+        One item in shelf (Dewey) order. (deweyKey, itemId) of the last entry of a
+        page is where the next page starts.
+    */
+    struct ShelfEntry {
+        LibraryItem* item;
+        int itemId;
+        int deweyKey;
+    };
+
+    /*
+        ItemCirculation Struct:
+        One item in a circulation report
+    */
+    struct ItemCirculation {
+        int itemId;
+        QString title;
+        QString author;
+        QString itemType;
+        int borrowCount;
+        int holdsPlaced;
+        int totalCopies;
+        int holdCount;
+    };
+
+    /*
+        GroupTurnover Struct:
+        Circulation of one group of items (a format or a Dewey class). Turnover is
+        loans per copy over the library's recorded history.
+    */
+    struct GroupTurnover {
+        QString group;
+        int items;
+        int copies;
+        int borrowCount;
+
+        double turnover() const { return copies > 0 ? double(borrowCount) / copies : 0.0; }
+    };
+
+    /*
+        QueueDepth Struct:
+        Number of items whose hold queue has a given length
+    */
+    struct QueueDepth {
+        int depth;
+        int items;
+    };
+
+    /*
+        CirculationReport Struct:
+        Librarian dashboard contents, read from the per-item circulation aggregates
+          - topBorrowed: Most borrowed items, most first
+          - byFormat / byDeweyClass: Turnover per item type and per Dewey hundred
+          - holdsFilled / holdWaitDays: Holds ended by a borrow and their total wait
+          - queueDepths: Histogram of current queue lengths (queued items only), ascending
+    */
+    struct CirculationReport {
+        std::vector<ItemCirculation> topBorrowed;
+        std::vector<GroupTurnover> byFormat;
+        std::vector<GroupTurnover> byDeweyClass;
+        int holdsFilled = 0;
+        double holdWaitDays = 0.0;
+        std::vector<QueueDepth> queueDepths;
+
+        double averageHoldWaitDays() const { return holdsFilled > 0 ? holdWaitDays / holdsFilled : 0.0; }
+
+        /*
+            Function: queueDepthPercentile
+            Purpose: Queue length at a percentile of the items that have a queue
+            Parameters:
+              in: double percentile - 0 to 100
+            Return: int - Queue length (0 if no item has holds)
+        */
+        int queueDepthPercentile(double percentile) const;
+    };
+
+    /*
+        Facet Enum:
+        Catalogue properties patrons can filter on. Values are the stored ones:
+        item_type ("fiction", "nonfiction", "magazine", "movie", "videogame"), genre,
+        rating, condition and availability ("available", "checked out").
+    */
+    enum Facet {
+        FacetFormat,
+        FacetGenre,
+        FacetRating,
+        FacetCondition,
+        FacetAvailability,
+        FacetCount
+    };
+
+    /*
+        FacetFilter Struct:
+        Catalogue filter; an empty value or a year of 0 means "any"
+    */
+    struct FacetFilter {
+        QString values[FacetCount];
+        int fromYear = 0;
+        int toYear = 0;
+
+        bool isActive() const;
+    };
+
+    /*
+        FacetValue Struct:
+        One facet value and the number of items it would leave
+    */
+    struct FacetValue {
+        QString value;
+        int count;
+    };
+
+    /*
+        FacetResult Struct:
+        Result of a filter
+          - total: Items matching the whole filter
+          - counts: Per facet, every value with the items matching the filter if that
+            facet's selection were changed to the value (the other facets stay applied),
+            by value name
+          - itemIds: Matching item IDs, ascending; only filled for an active filter
+          - availableIds: Matching items with a copy on the shelf, ascending (always
+            filled; the catalogue list tags availability from it)
+    */
+    struct FacetResult {
+        int total = 0;
+        std::vector<FacetValue> counts[FacetCount];
+        std::vector<int> itemIds;
+        std::vector<int> availableIds;
+    };
+
+    /*
+        WriteResult Enum:
+        Outcome of a conditional write
+          - WriteOk: Applied
+          - WriteConflict: The row changed since the caller looked (item already
+            checked out, loan already returned); nothing was applied
+          - WriteFailed: Unknown row or database error
+          - WriteNotFound: A scanned code names no item (tryBorrowScanned() only);
+            nothing was applied
+    */
+    enum WriteResult {
+        WriteOk,
+        WriteConflict,
+        WriteFailed,
+        WriteNotFound
+    };
+
     virtual ~IDataRepository() = default;
 
-    // Core methods your DataManager already has
-    virtual User* findUser(const std::string& username) = 0;
-    virtual std::vector<LibraryItem*>& getCatalogue() = 0;
+    /*
+        Function: getInstance
+        Purpose: Returns the repository the application is using: the local
+                 DatabaseManager unless setInstance() installed another one.
+        Return: IDataRepository& - Active repository
+    */
+    static IDataRepository& getInstance();
 
-    // Methods we'll add for librarian features
-    virtual bool addItemToCatalogue(LibraryItem* item) = 0;
-    virtual bool removeItemFromCatalogue(int itemId) = 0;
+    /*
+        Function: setInstance
+        Purpose: Installs the repository returned by getInstance()
+        Parameters:
+          in: IDataRepository* repository - Repository to use, or nullptr for DatabaseManager
+    */
+    static void setInstance(IDataRepository* repository);
+
+    /*
+        Function: freeAccountSnapshot
+        Purpose: Deletes the LibraryItem objects owned by a snapshot and empties it.
+        Parameters:
+          in/out: AccountSnapshot& snapshot - Snapshot to release
+    */
+    static void freeAccountSnapshot(AccountSnapshot& snapshot);
+
+    // User operations
+    virtual User* findUser(const QString& username) = 0;
     virtual std::vector<User*> getAllUsers() = 0;
+    virtual std::vector<User*> searchPatrons(const QString& filter, const QString& afterUsername, int limit) = 0;
+
+    // Catalogue operations
+    virtual std::vector<LibraryItem*> getAllCatalogueItems() = 0;
+    virtual LibraryItem* getItemById(int id) = 0;
+    virtual int getItemId(LibraryItem* item) = 0;
+    virtual std::vector<ShelfEntry> browseShelf(int fromKey, int toKey, int afterKey, int afterId, int limit) = 0;
+    virtual int findByIsbn(const QString& isbn) = 0;
+    virtual int findByBarcode(const QString& barcode) = 0;
+    virtual bool addItemToCatalogue(const QString& title, const QString& author, const QString& itemType,
+                                    const QString& deweyDecimal, const QString& isbn, const QString& genre,
+                                    const QString& rating, int issueNumber, const QString& publicationDate,
+                                    int publicationYear, const QString& condition, int copies) = 0;
+    virtual bool removeItemFromCatalogue(int itemId) = 0;
+    virtual bool addCopies(int itemId, int count) = 0;
+
+    // Loan operations
+    virtual bool borrowItem(int userId, int itemId) = 0;
+    virtual bool returnItem(int userId, int itemId) = 0;
+    virtual WriteResult tryBorrowItem(int userId, int itemId) = 0;
+    virtual WriteResult tryReturnItem(int userId, int itemId) = 0;
+    virtual WriteResult tryBorrowScanned(int userId, const QString& code, int& itemId) = 0;
+    virtual std::vector<LibraryItem*> getUserBorrowedItems(int userId) = 0;
+    virtual std::vector<LoanInfo> getUserLoansWithDates(int userId) = 0;
+
+    // Hold operations
+    virtual bool placeHold(int userId, int itemId) = 0;
+    virtual bool cancelHold(int userId, int itemId) = 0;
+    virtual std::vector<LibraryItem*> getUserHolds(int userId) = 0;
+    virtual int getHoldCountForItem(int itemId) = 0;
+    virtual int getHoldPosition(int userId, int itemId) = 0;
+
+    // Account
+    virtual AccountSnapshot getAccountSnapshot(int userId) = 0;
+
+    // Reports
+    virtual CirculationReport getCirculationReport(int topN) = 0;
+
+    // Catalogue filtering
+    virtual FacetResult getFacets(const FacetFilter& filter) = 0;
+
+    // Bulk forms used by the screens. The defaults loop over the single operations
+    // above; RemoteRepository sends each one to the server as a single batch.
+
+    /*
+        Function: getItemIds
+        Purpose: Resolves many items to their database ids at once
+        Parameters:
+          in: const std::vector<LibraryItem*>& items - Items to resolve
+        Return: std::vector<int> - Id per item, in order (-1 where not found)
+    */
+    virtual std::vector<int> getItemIds(const std::vector<LibraryItem*>& items);
+
+    /*
+        Function: getHoldCountsForItems
+        Purpose: Counts the holds on many items at once
+        Parameters:
+          in: const std::vector<int>& itemIds - Items to count
+        Return: std::vector<int> - Hold count per item, in order
+    */
+    virtual std::vector<int> getHoldCountsForItems(const std::vector<int>& itemIds);
+
+    /*
+        Function: placeHoldAndGetPosition
+        Purpose: Places a hold and reports the user's resulting queue position as one
+                 atomic step (no other hold can slip in between)
+        Parameters:
+          in: int userId - User placing the hold
+          in: int itemId - Item to hold
+          out: int& position - Queue position of the new hold
+        Return: bool - True if the hold was placed
+    */
+    virtual bool placeHoldAndGetPosition(int userId, int itemId, int& position);
+
+private:
+    static IDataRepository* active;
 };
 
 #endif
@@ -0,0 +1,249 @@
+#include <algorithm>
+#include <iterator>
+#include "ItemBitmap.h"
+
+int ItemBitmap::popcount(quint64 word) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(word);
+#else
+    int bits = 0;
+    for (; word; word &= word - 1) bits++;
+    return bits;
+#endif
+}
+
+int ItemBitmap::lowestBit(quint64 word) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(word);
+#else
+    int bit = 0;
+    while (!((word >> bit) & 1)) bit++;
+    return bit;
+#endif
+}
+
+// === CHUNKS ===
+
+ItemBitmap::Chunk* ItemBitmap::find(quint16 key) {
+    auto it = std::lower_bound(chunks.begin(), chunks.end(), key,
+                               [](const Chunk& chunk, quint16 k) { return chunk.key < k; });
+    return it != chunks.end() && it->key == key ? &*it : nullptr;
+}
+
+const ItemBitmap::Chunk* ItemBitmap::find(quint16 key) const {
+    return const_cast<ItemBitmap*>(this)->find(key);
+}
+
+void ItemBitmap::makeDense(Chunk& chunk) {
+    chunk.words.assign(CHUNK_WORDS, 0);
+    for (quint16 low : chunk.values) chunk.words[low >> 6] |= quint64(1) << (low & 63);
+    std::vector<quint16>().swap(chunk.values);
+}
+
+void ItemBitmap::makeSparse(Chunk& chunk) {
+    chunk.values.clear();
+    chunk.values.reserve(chunk.cardinality);
+    for (int w = 0; w < CHUNK_WORDS; ++w) {
+        for (quint64 word = chunk.words[w]; word; word &= word - 1) {
+            chunk.values.push_back(quint16(w * 64 + lowestBit(word)));
+        }
+    }
+    std::vector<quint64>().swap(chunk.words);
+}
+
+int ItemBitmap::intersectCount(const Chunk& a, const Chunk& b) {
+    int total = 0;
+    if (a.isDense() && b.isDense()) {
+        for (int w = 0; w < CHUNK_WORDS; ++w) total += popcount(a.words[w] & b.words[w]);
+    } else if (a.isDense() || b.isDense()) {
+        const Chunk& dense = a.isDense() ? a : b;
+        const Chunk& sparse = a.isDense() ? b : a;
+        for (quint16 low : sparse.values) total += int((dense.words[low >> 6] >> (low & 63)) & 1);
+    } else {
+        auto i = a.values.begin(), j = b.values.begin();
+        while (i != a.values.end() && j != b.values.end()) {
+            if (*i < *j) ++i;
+            else if (*j < *i) ++j;
+            else { ++total; ++i; ++j; }
+        }
+    }
+    return total;
+}
+
+ItemBitmap::Chunk ItemBitmap::intersect(const Chunk& a, const Chunk& b) {
+    Chunk result = {a.key, 0, std::vector<quint16>(), std::vector<quint64>()};
+    if (a.isDense() && b.isDense()) {
+        result.words.resize(CHUNK_WORDS);
+        for (int w = 0; w < CHUNK_WORDS; ++w) result.words[w] = a.words[w] & b.words[w];
+        for (int w = 0; w < CHUNK_WORDS; ++w) result.cardinality += popcount(result.words[w]);
+        if (result.cardinality <= ARRAY_LIMIT) makeSparse(result);
+    } else if (a.isDense() || b.isDense()) {
+        const Chunk& dense = a.isDense() ? a : b;
+        const Chunk& sparse = a.isDense() ? b : a;
+        for (quint16 low : sparse.values) {
+            if ((dense.words[low >> 6] >> (low & 63)) & 1) result.values.push_back(low);
+        }
+        result.cardinality = int(result.values.size());
+    } else {
+        std::set_intersection(a.values.begin(), a.values.end(), b.values.begin(), b.values.end(),
+                              std::back_inserter(result.values));
+        result.cardinality = int(result.values.size());
+    }
+    return result;
+}
+
+ItemBitmap::Chunk ItemBitmap::unite(const Chunk& a, const Chunk& b) {
+    Chunk result = {a.key, 0, std::vector<quint16>(), std::vector<quint64>()};
+    if (!a.isDense() && !b.isDense()) {
+        std::set_union(a.values.begin(), a.values.end(), b.values.begin(), b.values.end(),
+                       std::back_inserter(result.values));
+        result.cardinality = int(result.values.size());
+        if (result.cardinality > ARRAY_LIMIT) makeDense(result);
+        return result;
+    }
+
+    const Chunk& dense = a.isDense() ? a : b;
+    const Chunk& other = a.isDense() ? b : a;
+    result.words = dense.words;
+    if (other.isDense()) {
+        for (int w = 0; w < CHUNK_WORDS; ++w) result.words[w] |= other.words[w];
+    } else {
+        for (quint16 low : other.values) result.words[low >> 6] |= quint64(1) << (low & 63);
+    }
+    for (int w = 0; w < CHUNK_WORDS; ++w) result.cardinality += popcount(result.words[w]);
+    return result;
+}
+
+// === SINGLE ITEMS ===
+
+void ItemBitmap::set(int itemId) {
+    if (itemId < 0) return;
+    quint16 key = quint16(itemId >> 16);
+    quint16 low = quint16(itemId & 0xFFFF);
+
+    auto it = std::lower_bound(chunks.begin(), chunks.end(), key,
+                               [](const Chunk& chunk, quint16 k) { return chunk.key < k; });
+    if (it == chunks.end() || it->key != key) {
+        it = chunks.insert(it, Chunk{key, 0, std::vector<quint16>(), std::vector<quint64>()});
+    }
+    Chunk& chunk = *it;
+
+    if (!chunk.isDense()) {
+        auto pos = std::lower_bound(chunk.values.begin(), chunk.values.end(), low);
+        if (pos != chunk.values.end() && *pos == low) return;
+        if (chunk.cardinality < ARRAY_LIMIT) {
+            chunk.values.insert(pos, low);
+            chunk.cardinality++;
+            return;
+        }
+        makeDense(chunk);
+    }
+
+    quint64 bit = quint64(1) << (low & 63);
+    if (!(chunk.words[low >> 6] & bit)) {
+        chunk.words[low >> 6] |= bit;
+        chunk.cardinality++;
+    }
+}
+
+void ItemBitmap::reset(int itemId) {
+    if (itemId < 0) return;
+    quint16 low = quint16(itemId & 0xFFFF);
+    Chunk* chunk = find(quint16(itemId >> 16));
+    if (!chunk) return;
+
+    if (chunk->isDense()) {
+        quint64 bit = quint64(1) << (low & 63);
+        if (!(chunk->words[low >> 6] & bit)) return;
+        chunk->words[low >> 6] &= ~bit;
+        chunk->cardinality--;
+        if (chunk->cardinality <= ARRAY_LIMIT / 2) makeSparse(*chunk);
+    } else {
+        auto pos = std::lower_bound(chunk->values.begin(), chunk->values.end(), low);
+        if (pos == chunk->values.end() || *pos != low) return;
+        chunk->values.erase(pos);
+        chunk->cardinality--;
+    }
+
+    if (chunk->cardinality == 0) chunks.erase(chunks.begin() + (chunk - chunks.data()));
+}
+
+bool ItemBitmap::test(int itemId) const {
+    if (itemId < 0) return false;
+    quint16 low = quint16(itemId & 0xFFFF);
+    const Chunk* chunk = find(quint16(itemId >> 16));
+    if (!chunk) return false;
+    if (chunk->isDense()) return (chunk->words[low >> 6] >> (low & 63)) & 1;
+    return std::binary_search(chunk->values.begin(), chunk->values.end(), low);
+}
+
+// === WHOLE SETS ===
+
+int ItemBitmap::count() const {
+    int total = 0;
+    for (const Chunk& chunk : chunks) total += chunk.cardinality;
+    return total;
+}
+
+int ItemBitmap::andCount(const ItemBitmap& a, const ItemBitmap& b) {
+    int total = 0;
+    auto i = a.chunks.begin(), j = b.chunks.begin();
+    while (i != a.chunks.end() && j != b.chunks.end()) {
+        if (i->key < j->key) ++i;
+        else if (j->key < i->key) ++j;
+        else total += intersectCount(*i++, *j++);
+    }
+    return total;
+}
+
+ItemBitmap& ItemBitmap::operator&=(const ItemBitmap& other) {
+    std::vector<Chunk> result;
+    auto i = chunks.begin();
+    auto j = other.chunks.begin();
+    while (i != chunks.end() && j != other.chunks.end()) {
+        if (i->key < j->key) ++i;
+        else if (j->key < i->key) ++j;
+        else {
+            Chunk chunk = intersect(*i++, *j++);
+            if (chunk.cardinality > 0) result.push_back(std::move(chunk));
+        }
+    }
+    chunks.swap(result);
+    return *this;
+}
+
+ItemBitmap& ItemBitmap::operator|=(const ItemBitmap& other) {
+    std::vector<Chunk> result;
+    result.reserve(chunks.size() + other.chunks.size());
+    auto i = chunks.begin();
+    auto j = other.chunks.begin();
+    while (i != chunks.end() || j != other.chunks.end()) {
+        if (j == other.chunks.end() || (i != chunks.end() && i->key < j->key)) {
+            result.push_back(std::move(*i++));
+        } else if (i == chunks.end() || j->key < i->key) {
+            result.push_back(*j++);
+        } else {
+            result.push_back(unite(*i++, *j++));
+        }
+    }
+    chunks.swap(result);
+    return *this;
+}
+
+std::vector<int> ItemBitmap::ids() const {
+    std::vector<int> result;
+    result.reserve(count());
+    for (const Chunk& chunk : chunks) {
+        int base = int(chunk.key) << 16;
+        if (!chunk.isDense()) {
+            for (quint16 low : chunk.values) result.push_back(base | low);
+            continue;
+        }
+        for (int w = 0; w < CHUNK_WORDS; ++w) {
+            for (quint64 word = chunk.words[w]; word; word &= word - 1) {
+                result.push_back(base + w * 64 + lowestBit(word));
+            }
+        }
+    }
+    return result;
+}
@@ -0,0 +1,111 @@
+#ifndef ITEMBITMAP_H
+#define ITEMBITMAP_H
+
+#include <QtGlobal>
+#include <vector>
+
+/*
+    ItemBitmap Class:
+    Compressed set of catalogue item IDs. Used by FacetIndex for the items that have
+    one facet value (all movies, all items in Good condition, everything on the
+    shelf, ...), so that a filter is the AND of a few bitmaps and a facet count is a
+    popcount instead of a GROUP BY over the catalogue.
+
+    IDs are split into chunks of 65536 by their high 16 bits, and each chunk is
+    stored in whichever form is smaller for its population:
+      - sparse: sorted array of the low 16 bits, while the chunk has at most
+        ARRAY_LIMIT items (2 bytes per item; a rare genre, one publication year)
+      - dense: 1024 64-bit words, one bit per ID (8 KB; availability, common formats)
+    A sparse chunk that outgrows ARRAY_LIMIT turns dense; a dense one turns sparse
+    again only below half of it, so an item flipping back and forth at the boundary
+    does not convert the chunk every time. Setting or clearing an item in a dense
+    chunk is a single bit operation.
+
+    AND, OR and counting work chunk by chunk and pick the loop for the pair of
+    forms: word-wise AND/OR plus popcount for two dense chunks (plain loops over
+    64-bit words, which the compiler vectorizes; popcount is the CPU instruction
+    where the target has one), bit probes for sparse against dense, and a merge
+    for two sparse chunks.
+
+    Data Members:
+      - std::vector<Chunk> chunks: Non-empty chunks in ascending key order
+
+    Member Functions:
+      Public:
+        - set() / reset() / test(): Single-item updates and lookups
+        - count(): Items in the set
+        - andCount(): Size of the intersection of two sets, without building it
+        - operator&= / operator|=: Intersection and union in place
+        - ids(): Item IDs in ascending order
+      Private:
+        - find(): Chunk holding a key
+        - makeDense() / makeSparse(): Convert a chunk between forms
+        - intersect() / intersectCount() / unite(): Chunk-level set operations
+*/
+class ItemBitmap {
+public:
+    void set(int itemId);
+    void reset(int itemId);
+    bool test(int itemId) const;
+    bool isEmpty() const { return chunks.empty(); }
+
+    /*
+        Function: count
+        Purpose: Number of items in the set
+        Return: int - Population count
+    */
+    int count() const;
+
+    /*
+        Function: andCount
+        Purpose: Number of items in both sets
+        Parameters:
+          in: const ItemBitmap& a / const ItemBitmap& b - Sets to intersect
+        Return: int - Size of the intersection
+    */
+    static int andCount(const ItemBitmap& a, const ItemBitmap& b);
+
+    ItemBitmap& operator&=(const ItemBitmap& other);
+    ItemBitmap& operator|=(const ItemBitmap& other);
+
+    /*
+        Function: ids
+        Purpose: Lists the items in the set
+        Return: std::vector<int> - Item IDs, ascending
+    */
+    std::vector<int> ids() const;
+
+private:
+    static const int ARRAY_LIMIT = 4096;  // Items a sparse chunk may hold (8 KB either way)
+    static const int CHUNK_WORDS = 1024;  // 65536 bits
+
+    /*
+        Chunk Struct:
+        The items whose IDs share the high 16 bits key; exactly one of values
+        (sparse) and words (dense) is in use
+    */
+    struct Chunk {
+        quint16 key;
+        int cardinality;
+        std::vector<quint16> values;
+        std::vector<quint64> words;
+
+        bool isDense() const { return !words.empty(); }
+    };
+
+    std::vector<Chunk> chunks;
+
+    friend class ItemBitmapTest; // Checks chunk forms at the conversion boundaries
+
+    Chunk* find(quint16 key);
+    const Chunk* find(quint16 key) const;
+    static void makeDense(Chunk& chunk);
+    static void makeSparse(Chunk& chunk);
+    static int intersectCount(const Chunk& a, const Chunk& b);
+    static Chunk intersect(const Chunk& a, const Chunk& b);
+    static Chunk unite(const Chunk& a, const Chunk& b);
+    static int popcount(quint64 word);
+    static int lowestBit(quint64 word); // Word must not be zero
+};
+
+#endif
@@ -0,0 +1,179 @@
+#include <QDebug>
+#include <QTcpSocket>
+#include <QLocalSocket>
+#include "LibraryClient.h"
+#include "PerformanceMonitor.h"
+
+LibraryClient::LibraryClient() : socket(nullptr), nextId(1), roundTrips(0) {}
+
+LibraryClient::~LibraryClient() {
+    disconnectFromServer();
+}
+
+bool LibraryClient::connectTo(const QString& address, int timeoutMs) {
+    disconnectFromServer();
+
+    bool tcp = false;
+    QString host;
+    quint16 port = 0;
+    if (!LibraryProtocol::parseAddress(address, tcp, host, port)) {
+        lastError = QString("Invalid server address: %1").arg(address);
+        return false;
+    }
+
+    if (tcp) {
+        QTcpSocket* tcpSocket = new QTcpSocket();
+        tcpSocket->setSocketOption(QAbstractSocket::LowDelayOption, 1); // Small request frames
+        tcpSocket->connectToHost(host, port);
+        socket = tcpSocket;
+        if (!tcpSocket->waitForConnected(timeoutMs)) {
+            lastError = tcpSocket->errorString();
+            disconnectFromServer();
+            return false;
+        }
+    } else {
+        QLocalSocket* localSocket = new QLocalSocket();
+        localSocket->connectToServer(host);
+        socket = localSocket;
+        if (!localSocket->waitForConnected(timeoutMs)) {
+            lastError = localSocket->errorString();
+            disconnectFromServer();
+            return false;
+        }
+    }
+
+    buffer.clear();
+    return true;
+}
+
+void LibraryClient::disconnectFromServer() {
+    if (!socket) return;
+
+    socket->close();
+    delete socket;
+    socket = nullptr;
+    buffer.clear();
+}
+
+bool LibraryClient::isConnected() const {
+    return socket && socket->isOpen();
+}
+
+quint32 LibraryClient::send(quint8 opcode, const QByteArray& args) {
+    if (!isConnected()) {
+        lastError = "Not connected to server";
+        return 0;
+    }
+
+    quint32 id = nextId++;
+    QByteArray payload;
+    payload.reserve(1 + args.size());
+    payload.append(char(opcode));
+    payload.append(args);
+
+    socket->write(LibraryProtocol::encodeFrame(LibraryProtocol::Request, id, payload));
+    return id;
+}
+
+quint32 LibraryClient::sendBatch(const std::vector<BatchEntry>& entries, bool atomic) {
+    if (!isConnected()) {
+        lastError = "Not connected to server";
+        return 0;
+    }
+
+    quint32 id = nextId++;
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    LibraryProtocol::prepareStream(out);
+    out << quint8(atomic ? LibraryProtocol::Atomic : 0) << quint16(entries.size());
+    for (const BatchEntry& entry : entries) {
+        out << entry.opcode;
+        out.writeRawData(entry.args.constData(), entry.args.size());
+    }
+
+    socket->write(LibraryProtocol::encodeFrame(LibraryProtocol::Batch, id, payload));
+    return id;
+}
+
+bool LibraryClient::receive(LibraryProtocol::Frame& frame, int timeoutMs) {
+    if (!isConnected()) {
+        lastError = "Not connected to server";
+        return false;
+    }
+
+    while (true) {
+        bool corrupt = false;
+        if (LibraryProtocol::takeFrame(buffer, frame, corrupt)) {
+            return true;
+        }
+        if (corrupt) {
+            lastError = "Corrupt response from server";
+            disconnectFromServer();
+            return false;
+        }
+
+        // Push out anything still queued before blocking on the answer
+        if (socket->bytesToWrite() > 0) {
+            socket->waitForBytesWritten(timeoutMs);
+        }
+        if (!socket->waitForReadyRead(timeoutMs)) {
+            lastError = socket->errorString();
+            disconnectFromServer();
+            return false;
+        }
+        buffer.append(socket->readAll());
+    }
+}
+
+bool LibraryClient::awaitResult(quint32 id, const ResultReader& read) {
+    LibraryProtocol::Frame frame;
+    while (receive(frame)) {
+        if (frame.id != id) {
+            continue; // Answer to an earlier pipelined request nobody is waiting for
+        }
+
+        QDataStream in(frame.payload);
+        LibraryProtocol::prepareStream(in);
+
+        if (frame.type == LibraryProtocol::ResponseChunk) {
+            read(in); // Part of a streamed list; the Response frame follows
+            continue;
+        }
+
+        quint8 status = LibraryProtocol::Failed;
+        in >> status;
+        if (status != LibraryProtocol::Ok) {
+            lastError = LibraryProtocol::readText(in);
+            return false;
+        }
+        read(in);
+        roundTrips++;
+        return true;
+    }
+    return false;
+}
+
+bool LibraryClient::call(quint8 opcode, const QByteArray& args, const ResultReader& read) {
+    QString operation = LibraryProtocol::opcodeName(opcode);
+    ScopedTimer timer(LibraryProtocol::opcodeLabel(opcode), "remote");
+
+    quint32 id = send(opcode, args);
+    if (id == 0 || !awaitResult(id, read)) {
+        qDebug() << "Server request" << operation << "failed:" << lastError;
+        timer.fail();
+        return false;
+    }
+    return true;
+}
+
+bool LibraryClient::callBatch(const std::vector<BatchEntry>& entries, bool atomic, const ResultReader& read) {
+    ScopedTimer timer("batch", "remote");
+
+    quint32 id = sendBatch(entries, atomic);
+    if (id == 0 || !awaitResult(id, read)) {
+        qDebug() << "Server batch of" << entries.size() << "operations failed:" << lastError;
+        timer.fail();
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,137 @@
+#ifndef LIBRARYCLIENT_H
+#define LIBRARYCLIENT_H
+
+#include <QByteArray>
+#include <QDataStream>
+#include <QIODevice>
+#include <QString>
+#include <functional>
+#include <vector>
+#include "LibraryProtocol.h"
+
+/*
+    LibraryClient Class:
+    Blocking client for one connection to a HinLIBS server. call() sends one request
+    and waits for its answer; callBatch() sends several operations as one Batch frame
+    and waits for all their results (one round trip). send() and receive() expose the
+    pipelined form, where many requests are written before any answer is read
+    (answers arrive in request order). A client must only be used from the thread
+    that connected it.
+
+    Results are handed to a ResultReader positioned at the result bytes. For a large
+    list result the reader is called once per streamed frame, so rows can be decoded
+    while the server is still sending the rest.
+
+    Data Members:
+      - QIODevice* socket: QTcpSocket or QLocalSocket, depending on the address
+      - QByteArray buffer: Received bytes not yet decoded
+      - quint32 nextId: Id for the next request
+      - quint64 roundTrips: Completed call() / callBatch() round trips
+      - QString lastError: Description of the last failure
+
+    Member Functions:
+      - connectTo() / disconnectFromServer() / isConnected(): Connection lifecycle
+      - send() / sendBatch(): Write one request without waiting
+      - receive(): Reads the next frame
+      - call() / callBatch(): One round trip
+      - getRoundTrips(): Round trips made so far
+      - getLastError(): Description of the last failure
+*/
+class LibraryClient {
+public:
+    /*
+        BatchEntry Struct:
+        One operation of a batch: opcode plus encoded arguments
+    */
+    struct BatchEntry {
+        quint8 opcode;
+        QByteArray args;
+    };
+
+    typedef std::function<void(QDataStream&)> ResultReader;
+
+    LibraryClient();
+    ~LibraryClient();
+
+    /*
+        Function: connectTo
+        Purpose: Connects to a server ("tcp:host:port" or "local:name")
+        Parameters:
+          in: const QString& address - Server address
+          in: int timeoutMs - Connection timeout
+        Return: bool - True if connected
+    */
+    bool connectTo(const QString& address, int timeoutMs = 3000);
+
+    void disconnectFromServer();
+    bool isConnected() const;
+
+    /*
+        Function: send
+        Purpose: Writes one request without waiting for the answer
+        Parameters:
+          in: quint8 opcode - LibraryProtocol::Opcode
+          in: const QByteArray& args - Arguments from LibraryProtocol::encodeArgs()
+        Return: quint32 - Request id echoed in the response (0 if not connected)
+    */
+    quint32 send(quint8 opcode, const QByteArray& args);
+
+    /*
+        Function: sendBatch
+        Purpose: Writes several operations as one Batch request without waiting
+        Parameters:
+          in: const std::vector<BatchEntry>& entries - Operations, executed in order
+          in: bool atomic - Execute in a single server-side transaction
+        Return: quint32 - Request id (0 if not connected)
+    */
+    quint32 sendBatch(const std::vector<BatchEntry>& entries, bool atomic);
+
+    /*
+        Function: receive
+        Purpose: Reads the next frame from the connection
+        Parameters:
+          out: LibraryProtocol::Frame& frame - Response or ResponseChunk frame
+          in: int timeoutMs - How long to wait
+        Return: bool - True if a frame arrived
+    */
+    bool receive(LibraryProtocol::Frame& frame, int timeoutMs = 30000);
+
+    /*
+        Function: call
+        Purpose: Sends one request and reads its result
+        Parameters:
+          in: quint8 opcode - LibraryProtocol::Opcode
+          in: const QByteArray& args - Encoded arguments
+          in: const ResultReader& read - Decodes the result (once per streamed frame)
+        Return: bool - True if the server executed the request
+    */
+    bool call(quint8 opcode, const QByteArray& args, const ResultReader& read);
+
+    /*
+        Function: callBatch
+        Purpose: Sends several operations in one round trip and reads their results
+        Parameters:
+          in: const std::vector<BatchEntry>& entries - Operations, executed in order
+          in: bool atomic - Execute in a single server-side transaction
+          in: const ResultReader& read - Decodes every result, in order, from one stream
+        Return: bool - True if the server executed the batch
+    */
+    bool callBatch(const std::vector<BatchEntry>& entries, bool atomic, const ResultReader& read);
+
+    quint64 getRoundTrips() const { return roundTrips; }
+    QString getLastError() const { return lastError; }
+
+private:
+    QIODevice* socket;
+    QByteArray buffer;
+    quint32 nextId;
+    quint64 roundTrips;
+    QString lastError;
+
+    bool awaitResult(quint32 id, const ResultReader& read);
+
+    LibraryClient(const LibraryClient&) = delete;
+    LibraryClient& operator=(const LibraryClient&) = delete;
+};
+
+#endif
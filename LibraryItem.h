@@ -32,10 +32,14 @@ using namespace std;
        - Compatible with SQLite catalogue_items table structure
 
     Data Members (LibraryItem base):
+      - int id: Database ID of the item (-1 for items not read from the database)
       - string title: The title of the library item
       - string author: The author or creator of the item
       - string format: The type/format of item (e.g., "Fiction Book", "Movie")
       - bool isAvailable: Current circulation status (true if available for borrowing)
+      - int totalCopies: Physical copies of this work the library owns
+      - int availableCopies: Copies on the shelf (not on loan or waiting for a hold)
+      - int holdCount: Holds on the item, as stored with it in the database
       - vector<string> holdQueue: FIFO queue of usernames waiting for this item
       - int publicationYear: The year the item was published
       - string condition: Physical condition of the item (Excellent/Good/Fair/Poor)
@@ -51,10 +55,14 @@ using namespace std;
 
 class LibraryItem {
 protected:
+    int id;
     string title;
     string author;
     string format;
     bool isAvailable;
+    int totalCopies;
+    int availableCopies;
+    int holdCount;
     vector<string> holdQueue;
     int publicationYear;
     string condition;
@@ -71,11 +79,19 @@ public:
           in: string cond - Physical condition
     */
     LibraryItem(string t, string a, string f, int year, string cond)
-        : title(t), author(a), format(f), isAvailable(true),
-          publicationYear(year), condition(cond) {}
+        : id(-1), title(t), author(a), format(f), isAvailable(true), totalCopies(1), availableCopies(1),
+          holdCount(0), publicationYear(year), condition(cond) {}
 
     virtual ~LibraryItem() {}
 
+    /*
+        Function: getId / setId
+        Purpose: Database ID of the item, set when the item is read from the database
+        Return: int - Item ID, or -1 if the item was built in memory
+    */
+    int getId() const { return id; }
+    void setId(int itemId) { id = itemId; }
+
     /*
         Function: getTitle
         Purpose: Retrieves the title of the library item
@@ -112,6 +128,36 @@ public:
     */
     void setAvailable(bool available) { isAvailable = available; }
 
+    /*
+        Function: setCopies
+        Purpose: Updates the copy counts; the item is available while any copy is
+        Parameters:
+          in: int available - Copies on the shelf
+          in: int total - Copies owned
+    */
+    void setCopies(int available, int total) {
+        availableCopies = available;
+        totalCopies = total;
+        isAvailable = available > 0;
+    }
+
+    /*
+        Function: getAvailableCopies / getTotalCopies
+        Purpose: Retrieve the copy counts shown in the catalogue ("3 of 12 available")
+        Return: int - Copies on the shelf / copies owned
+    */
+    int getAvailableCopies() const { return availableCopies; }
+    int getTotalCopies() const { return totalCopies; }
+
+    /*
+        Function: getHoldCount / setHoldCount
+        Purpose: Number of holds on the item, read with the item so the catalogue
+                 badge needs no query of its own
+        Return: int - Holds on the item
+    */
+    int getHoldCount() const { return holdCount; }
+    void setHoldCount(int count) { holdCount = count; }
+
     /*
         Function: getPublicationYear
         Purpose: Retrieves the publication year of the item
@@ -228,6 +274,13 @@ public:
     FictionBook(string t, string a, int year, string cond, string isbn)
         : LibraryItem(t, a, "Fiction Book", year, cond), isbn(isbn) {}
 
+    /*
+        Function: getIsbn
+        Purpose: Gets the ISBN number
+        Return: string - ISBN number
+    */
+    string getIsbn() const { return isbn; }
+
     /*
         Function: getDetailedInfo
         Purpose: Provides comprehensive fiction book information including ISBN
@@ -271,6 +324,20 @@ public:
         : LibraryItem(t, a, "Non-Fiction Book", year, cond),
           deweyDecimal(dewey), isbn(isbn) {}
 
+    /*
+        Function: getDeweyDecimal
+        Purpose: Gets the Dewey Decimal classification
+        Return: string - Dewey Decimal classification
+    */
+    string getDeweyDecimal() const { return deweyDecimal; }
+
+    /*
+        Function: getIsbn
+        Purpose: Gets the ISBN number
+        Return: string - ISBN number
+    */
+    string getIsbn() const { return isbn; }
+
     /*
         Function: getDetailedInfo
         Purpose: Provides comprehensive non-fiction book information including
@@ -316,6 +383,20 @@ public:
         : LibraryItem(t, a, "Magazine", year, cond),
           issueNumber(issue), publicationDate(pubDate) {}
 
+    /*
+        Function: getIssueNumber
+        Purpose: Gets the issue number
+        Return: int - Issue number
+    */
+    int getIssueNumber() const { return issueNumber; }
+
+    /*
+        Function: getPublicationDate
+        Purpose: Gets the publication date
+        Return: string - Publication date
+    */
+    string getPublicationDate() const { return publicationDate; }
+
     /*
         Function: getDetailedInfo
         Purpose: Provides comprehensive magazine information including
@@ -361,6 +442,20 @@ public:
         : LibraryItem(t, a, "Movie", year, cond),
           genre(genre), rating(rating) {}
 
+    /*
+        Function: getGenre
+        Purpose: Gets the genre
+        Return: string - Genre
+    */
+    string getGenre() const { return genre; }
+
+    /*
+        Function: getRating
+        Purpose: Gets the content rating
+        Return: string - Content rating
+    */
+    string getRating() const { return rating; }
+
     /*
         Function: getDetailedInfo
         Purpose: Provides comprehensive movie information including genre and rating
@@ -405,6 +500,20 @@ public:
         : LibraryItem(t, a, "Video Game", year, cond),
           genre(genre), rating(rating) {}
 
+    /*
+        Function: getGenre
+        Purpose: Gets the genre
+        Return: string - Genre
+    */
+    string getGenre() const { return genre; }
+
+    /*
+        Function: getRating
+        Purpose: Gets the content rating
+        Return: string - Content rating
+    */
+    string getRating() const { return rating; }
+
     /*
         Function: getDetailedInfo
         Purpose: Provides comprehensive video game information including genre and rating
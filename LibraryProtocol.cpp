@@ -0,0 +1,456 @@
+#include <QtEndian>
+#include "LibraryProtocol.h"
+
+// === FRAMING ===
+
+QByteArray LibraryProtocol::encodeFrame(quint8 type, quint32 id, const QByteArray& payload) {
+    QByteArray frame(HEADER_BYTES, '\0');
+    uchar* header = reinterpret_cast<uchar*>(frame.data());
+    qToBigEndian(quint32(1 + 4 + payload.size()), header);
+    header[4] = type;
+    qToBigEndian(id, header + 5);
+    frame.append(payload);
+    return frame;
+}
+
+bool LibraryProtocol::takeFrame(QByteArray& buffer, Frame& frame, bool& error) {
+    error = false;
+    if (buffer.size() < 4) return false;
+
+    const uchar* header = reinterpret_cast<const uchar*>(buffer.constData());
+    quint32 length = qFromBigEndian<quint32>(header);
+    if (length < 5 || length > quint32(MAX_FRAME_BYTES)) {
+        error = true;
+        return false;
+    }
+    if (quint32(buffer.size()) < 4 + length) return false;
+
+    frame.type = header[4];
+    frame.id = qFromBigEndian<quint32>(header + 5);
+    frame.payload = buffer.mid(HEADER_BYTES, int(length) - 5);
+    buffer.remove(0, int(4 + length));
+    return true;
+}
+
+bool LibraryProtocol::parseAddress(const QString& address, bool& tcp, QString& host, quint16& port) {
+    if (address.startsWith("tcp:")) {
+        QString rest = address.mid(4);
+        int colon = rest.lastIndexOf(':');
+        tcp = true;
+        host = colon > 0 ? rest.left(colon) : QString("127.0.0.1");
+        bool ok = true;
+        port = colon >= 0 ? rest.mid(colon + 1).toUShort(&ok) : DEFAULT_PORT;
+        return ok && port != 0;
+    }
+
+    tcp = false;
+    host = address.startsWith("local:") ? address.mid(6) : address;
+    port = 0;
+    return !host.isEmpty();
+}
+
+void LibraryProtocol::prepareStream(QDataStream& stream) {
+    stream.setVersion(QDataStream::Qt_5_6);
+}
+
+
+// === OPERATION NAMES ===
+
+namespace {
+    // Indexed by opcode; names match the repository functions
+    const char* const OPCODE_NAMES[LibraryProtocol::OpcodeCount] = {
+        "",
+        "ping",
+        "stats",
+        "findUser",
+        "getAllUsers",
+        "searchPatrons",
+        "getAllCatalogueItems",
+        "getItemById",
+        "getItemId",
+        "addItemToCatalogue",
+        "removeItemFromCatalogue",
+        "borrowItem",
+        "returnItem",
+        "getUserBorrowedItems",
+        "getUserLoansWithDates",
+        "placeHold",
+        "cancelHold",
+        "getUserHolds",
+        "getHoldCountForItem",
+        "getHoldPosition",
+        "getAccountSnapshot",
+        "tryBorrowItem",
+        "tryReturnItem",
+        "addCopies",
+        "getCirculationReport",
+        "browseShelf",
+        "findByIsbn",
+        "findByBarcode",
+        "tryBorrowScanned",
+        "getFacets"
+    };
+}
+
+QString LibraryProtocol::opcodeName(quint8 opcode) {
+    if (opcode == 0 || opcode >= OpcodeCount) {
+        return QString("opcode_%1").arg(opcode);
+    }
+    return QString(OPCODE_NAMES[opcode]);
+}
+
+const char* LibraryProtocol::opcodeLabel(quint8 opcode) {
+    if (opcode == 0 || opcode >= OpcodeCount) return "unknown";
+    return OPCODE_NAMES[opcode];
+}
+
+quint8 LibraryProtocol::opcodeFromName(const QString& name) {
+    for (int opcode = 1; opcode < OpcodeCount; ++opcode) {
+        if (name == OPCODE_NAMES[opcode]) return quint8(opcode);
+    }
+    return 0;
+}
+
+
+// === VALUES ===
+
+void LibraryProtocol::writeText(QDataStream& out, const QString& text) {
+    out << text.toUtf8();
+}
+
+QString LibraryProtocol::readText(QDataStream& in) {
+    QByteArray bytes;
+    in >> bytes;
+    return QString::fromUtf8(bytes);
+}
+
+namespace {
+    // Same type codes for both directions; names match catalogue_items.item_type
+    enum ItemType : quint8 { NoItem = 0, Fiction, NonFiction, MagazineItem, MovieItem, VideoGameItem };
+
+    void writeString(QDataStream& out, const string& text) {
+        out << QByteArray::fromStdString(text);
+    }
+
+    string readString(QDataStream& in) {
+        QByteArray bytes;
+        in >> bytes;
+        return bytes.toStdString();
+    }
+}
+
+void LibraryProtocol::writeItem(QDataStream& out, const LibraryItem* item) {
+    quint8 type = NoItem;
+    if (dynamic_cast<const FictionBook*>(item)) type = Fiction;
+    else if (dynamic_cast<const NonFictionBook*>(item)) type = NonFiction;
+    else if (dynamic_cast<const Magazine*>(item)) type = MagazineItem;
+    else if (dynamic_cast<const Movie*>(item)) type = MovieItem;
+    else if (dynamic_cast<const VideoGame*>(item)) type = VideoGameItem;
+
+    out << type;
+    if (type == NoItem) return;
+
+    writeString(out, item->getTitle());
+    writeString(out, item->getAuthor());
+    out << qint32(item->getPublicationYear());
+    writeString(out, item->getCondition());
+    out << item->getAvailability() << qint32(item->getAvailableCopies()) << qint32(item->getTotalCopies())
+        << qint32(item->getHoldCount()) << qint32(item->getId());
+
+    switch (type) {
+    case Fiction:
+        writeString(out, static_cast<const FictionBook*>(item)->getIsbn());
+        break;
+    case NonFiction: {
+        auto book = static_cast<const NonFictionBook*>(item);
+        writeString(out, book->getDeweyDecimal());
+        writeString(out, book->getIsbn());
+        break;
+    }
+    case MagazineItem: {
+        auto magazine = static_cast<const Magazine*>(item);
+        out << qint32(magazine->getIssueNumber());
+        writeString(out, magazine->getPublicationDate());
+        break;
+    }
+    case MovieItem: {
+        auto movie = static_cast<const Movie*>(item);
+        writeString(out, movie->getGenre());
+        writeString(out, movie->getRating());
+        break;
+    }
+    case VideoGameItem: {
+        auto game = static_cast<const VideoGame*>(item);
+        writeString(out, game->getGenre());
+        writeString(out, game->getRating());
+        break;
+    }
+    }
+}
+
+LibraryItem* LibraryProtocol::readItem(QDataStream& in) {
+    quint8 type = NoItem;
+    in >> type;
+    if (type == NoItem) return nullptr;
+
+    string title = readString(in);
+    string author = readString(in);
+    qint32 year = 0;
+    in >> year;
+    string condition = readString(in);
+    bool available = false;
+    qint32 availableCopies = 0, totalCopies = 0, holdCount = 0, id = -1;
+    in >> available >> availableCopies >> totalCopies >> holdCount >> id;
+
+    LibraryItem* item = nullptr;
+    switch (type) {
+    case Fiction:
+        item = new FictionBook(title, author, year, condition, readString(in));
+        break;
+    case NonFiction: {
+        string dewey = readString(in);
+        item = new NonFictionBook(title, author, dewey, year, condition, readString(in));
+        break;
+    }
+    case MagazineItem: {
+        qint32 issue = 0;
+        in >> issue;
+        item = new Magazine(title, author, issue, readString(in), year, condition);
+        break;
+    }
+    case MovieItem: {
+        string genre = readString(in);
+        item = new Movie(title, author, genre, readString(in), year, condition);
+        break;
+    }
+    case VideoGameItem: {
+        string genre = readString(in);
+        item = new VideoGame(title, author, genre, readString(in), year, condition);
+        break;
+    }
+    default:
+        in.setStatus(QDataStream::ReadCorruptData);
+        return nullptr;
+    }
+
+    item->setCopies(availableCopies, totalCopies);
+    item->setAvailable(available);
+    item->setHoldCount(holdCount);
+    item->setId(id);
+    return item;
+}
+
+void LibraryProtocol::writeUser(QDataStream& out, const User* user) {
+    out << bool(user);
+    if (!user) return;
+
+    out << qint32(user->id);
+    writeString(out, user->name);
+    writeString(out, user->role);
+    out << qint32(user->activeLoanCount) << qint32(user->activeHoldCount);
+}
+
+User* LibraryProtocol::readUser(QDataStream& in) {
+    bool present = false;
+    in >> present;
+    if (!present) return nullptr;
+
+    qint32 id = 0;
+    in >> id;
+    string name = readString(in);
+    string role = readString(in);
+    qint32 loans = 0, holds = 0;
+    in >> loans >> holds;
+
+    User* user = new User(id, name, role);
+    user->activeLoanCount = loans;
+    user->activeHoldCount = holds;
+    return user;
+}
+
+
+// === ACCOUNT ROWS ===
+
+void LibraryProtocol::writeLoan(QDataStream& out, const IDataRepository::LoanInfo& loan) {
+    writeItem(out, loan.item);
+    out << qint32(loan.itemId);
+    writeText(out, loan.checkoutDate);
+    writeText(out, loan.dueDate);
+}
+
+IDataRepository::LoanInfo LibraryProtocol::readLoan(QDataStream& in) {
+    IDataRepository::LoanInfo loan;
+    loan.item = readItem(in);
+    qint32 itemId = 0;
+    in >> itemId;
+    loan.itemId = itemId;
+    loan.checkoutDate = readText(in);
+    loan.dueDate = readText(in);
+    return loan;
+}
+
+void LibraryProtocol::writeHold(QDataStream& out, const IDataRepository::HoldInfo& hold) {
+    writeItem(out, hold.item);
+    out << qint32(hold.itemId) << qint32(hold.position);
+}
+
+IDataRepository::HoldInfo LibraryProtocol::readHold(QDataStream& in) {
+    IDataRepository::HoldInfo hold;
+    hold.item = readItem(in);
+    qint32 itemId = 0, position = 0;
+    in >> itemId >> position;
+    hold.itemId = itemId;
+    hold.position = position;
+    return hold;
+}
+
+void LibraryProtocol::writeShelfEntry(QDataStream& out, const IDataRepository::ShelfEntry& entry) {
+    writeItem(out, entry.item);
+    out << qint32(entry.itemId) << qint32(entry.deweyKey);
+}
+
+IDataRepository::ShelfEntry LibraryProtocol::readShelfEntry(QDataStream& in) {
+    IDataRepository::ShelfEntry entry;
+    entry.item = readItem(in);
+    qint32 itemId = 0, deweyKey = 0;
+    in >> itemId >> deweyKey;
+    entry.itemId = itemId;
+    entry.deweyKey = deweyKey;
+    return entry;
+}
+
+void LibraryProtocol::writeSnapshot(QDataStream& out, const IDataRepository::AccountSnapshot& snapshot) {
+    writeList(out, snapshot.loans, writeLoan);
+    writeList(out, snapshot.holds, writeHold);
+}
+
+IDataRepository::AccountSnapshot LibraryProtocol::readSnapshot(QDataStream& in) {
+    IDataRepository::AccountSnapshot snapshot;
+    readList(in, snapshot.loans, readLoan);
+    readList(in, snapshot.holds, readHold);
+    return snapshot;
+}
+
+// === REPORTS ===
+
+namespace {
+    void writeCirculation(QDataStream& out, const IDataRepository::ItemCirculation& item) {
+        out << qint32(item.itemId);
+        LibraryProtocol::writeText(out, item.title);
+        LibraryProtocol::writeText(out, item.author);
+        LibraryProtocol::writeText(out, item.itemType);
+        out << qint32(item.borrowCount) << qint32(item.holdsPlaced) << qint32(item.totalCopies)
+            << qint32(item.holdCount);
+    }
+
+    IDataRepository::ItemCirculation readCirculation(QDataStream& in) {
+        IDataRepository::ItemCirculation item;
+        qint32 itemId = 0, borrows = 0, placed = 0, copies = 0, holds = 0;
+        in >> itemId;
+        item.title = LibraryProtocol::readText(in);
+        item.author = LibraryProtocol::readText(in);
+        item.itemType = LibraryProtocol::readText(in);
+        in >> borrows >> placed >> copies >> holds;
+        item.itemId = itemId;
+        item.borrowCount = borrows;
+        item.holdsPlaced = placed;
+        item.totalCopies = copies;
+        item.holdCount = holds;
+        return item;
+    }
+
+    void writeTurnover(QDataStream& out, const IDataRepository::GroupTurnover& row) {
+        LibraryProtocol::writeText(out, row.group);
+        out << qint32(row.items) << qint32(row.copies) << qint32(row.borrowCount);
+    }
+
+    IDataRepository::GroupTurnover readTurnover(QDataStream& in) {
+        IDataRepository::GroupTurnover row;
+        row.group = LibraryProtocol::readText(in);
+        qint32 items = 0, copies = 0, borrows = 0;
+        in >> items >> copies >> borrows;
+        row.items = items;
+        row.copies = copies;
+        row.borrowCount = borrows;
+        return row;
+    }
+
+    void writeQueueDepth(QDataStream& out, const IDataRepository::QueueDepth& row) {
+        out << qint32(row.depth) << qint32(row.items);
+    }
+
+    IDataRepository::QueueDepth readQueueDepth(QDataStream& in) {
+        qint32 depth = 0, items = 0;
+        in >> depth >> items;
+        IDataRepository::QueueDepth row;
+        row.depth = depth;
+        row.items = items;
+        return row;
+    }
+
+    void writeFacetValue(QDataStream& out, const IDataRepository::FacetValue& row) {
+        LibraryProtocol::writeText(out, row.value);
+        out << qint32(row.count);
+    }
+
+    IDataRepository::FacetValue readFacetValue(QDataStream& in) {
+        IDataRepository::FacetValue row;
+        row.value = LibraryProtocol::readText(in);
+        qint32 count = 0;
+        in >> count;
+        row.count = count;
+        return row;
+    }
+
+    void writeId(QDataStream& out, int id) {
+        out << qint32(id);
+    }
+
+    int readId(QDataStream& in) {
+        qint32 id = 0;
+        in >> id;
+        return id;
+    }
+}
+
+void LibraryProtocol::writeReport(QDataStream& out, const IDataRepository::CirculationReport& report) {
+    writeList(out, report.topBorrowed, writeCirculation);
+    writeList(out, report.byFormat, writeTurnover);
+    writeList(out, report.byDeweyClass, writeTurnover);
+    out << qint32(report.holdsFilled) << report.holdWaitDays;
+    writeList(out, report.queueDepths, writeQueueDepth);
+}
+
+IDataRepository::CirculationReport LibraryProtocol::readReport(QDataStream& in) {
+    IDataRepository::CirculationReport report;
+    readList(in, report.topBorrowed, readCirculation);
+    readList(in, report.byFormat, readTurnover);
+    readList(in, report.byDeweyClass, readTurnover);
+    qint32 filled = 0;
+    in >> filled >> report.holdWaitDays;
+    report.holdsFilled = filled;
+    readList(in, report.queueDepths, readQueueDepth);
+    return report;
+}
+
+void LibraryProtocol::writeFacets(QDataStream& out, const IDataRepository::FacetResult& result) {
+    out << qint32(result.total);
+    for (int f = 0; f < IDataRepository::FacetCount; ++f) {
+        writeList(out, result.counts[f], writeFacetValue);
+    }
+    writeList(out, result.itemIds, writeId);
+    writeList(out, result.availableIds, writeId);
+}
+
+IDataRepository::FacetResult LibraryProtocol::readFacets(QDataStream& in) {
+    IDataRepository::FacetResult result;
+    qint32 total = 0;
+    in >> total;
+    result.total = total;
+    for (int f = 0; f < IDataRepository::FacetCount; ++f) {
+        readList(in, result.counts[f], readFacetValue);
+    }
+    readList(in, result.itemIds, readId);
+    readList(in, result.availableIds, readId);
+    return result;
+}
@@ -0,0 +1,292 @@
+#ifndef LIBRARYPROTOCOL_H
+#define LIBRARYPROTOCOL_H
+
+#include <QByteArray>
+#include <QDataStream>
+#include <QString>
+#include <vector>
+#include "User.h"
+#include "LibraryItem.h"
+#include "IDataRepository.h"
+
+/*
+    LibraryProtocol Class:
+    Binary wire format shared by the HinLIBS server and its clients (static class
+    with no instance data). All values are written with QDataStream at a fixed
+    stream version; strings travel as UTF-8.
+
+    Framing:
+      [quint32 length][quint8 frame type][quint32 id][payload]
+      The length covers everything after itself. The id is chosen by the client and
+      echoed on every response frame, so a client may pipeline many requests on one
+      connection; the server answers them in the order they were sent.
+
+    Frame types:
+      - Request:       [quint8 opcode][arguments]
+      - Batch:         [quint8 flags][quint16 count] then count x [quint8 opcode][arguments]
+                       Executed in order as one request. With the Atomic flag the server
+                       runs the whole batch in a single database transaction.
+      - Response:      [quint8 status] then the result (the results of every operation,
+                       in order, for a batch) or an error text if the status is Failed.
+      - ResponseChunk: Part of a large list result, sent ahead of its Response frame.
+
+    Lists:
+      A list is a sequence of segments, each [quint32 count][count rows], ended by a
+      segment with count 0. The server sends the segments of a large single-request
+      result as separate ResponseChunk frames (streamed while it is still encoding),
+      with the terminating 0 in the final Response. readList() accepts both forms.
+
+    Addresses:
+      "tcp:host:port" for TCP, "local:name" (or just "name") for a local socket
+      (Unix domain socket / Windows named pipe).
+
+    Member Functions:
+      - encodeFrame() / takeFrame(): Framing
+      - parseAddress(): Splits an address into transport and location
+      - opcodeName() / opcodeLabel() / opcodeFromName(): Operation names (metrics, tools)
+      - encodeArgs(): Packs request arguments
+      - writeText() / readText(): UTF-8 strings
+      - writeItem() / readItem(): LibraryItem codec (all five formats, with item ID, copy and hold counts)
+      - writeUser() / readUser(): User codec (with loan and hold counts)
+      - writeLoan() / readLoan(), writeHold() / readHold(): Account rows
+      - writeShelfEntry() / readShelfEntry(): Shelf browsing rows
+      - writeList() / readList() / encodeSegments(): Segmented lists
+      - writeSnapshot() / readSnapshot(): AccountSnapshot codec
+      - writeReport() / readReport(): CirculationReport codec
+      - writeFacets() / readFacets(): FacetResult codec
+*/
+class LibraryProtocol {
+public:
+    static const quint16 DEFAULT_PORT = 7878;
+    static const int MAX_FRAME_BYTES = 64 * 1024 * 1024;  // Large lists are streamed, never one frame
+    static const int SEGMENT_ROWS = 512;                  // Rows per streamed list segment
+    static const int HEADER_BYTES = 4 + 1 + 4;
+
+    enum FrameType : quint8 {
+        Request = 1,
+        Batch = 2,
+        Response = 3,
+        ResponseChunk = 4
+    };
+
+    enum BatchFlags : quint8 {
+        Atomic = 0x01
+    };
+
+    enum Status : quint8 {
+        Ok = 0,
+        Failed = 1
+    };
+
+    // One opcode per repository operation, plus server utilities. Values are part of
+    // the wire format: append new operations, never renumber.
+    enum Opcode : quint8 {
+        Ping = 1,
+        Stats,
+        FindUser,
+        GetAllUsers,
+        SearchPatrons,
+        GetAllCatalogueItems,
+        GetItemById,
+        GetItemId,
+        AddItemToCatalogue,
+        RemoveItemFromCatalogue,
+        BorrowItem,
+        ReturnItem,
+        GetUserBorrowedItems,
+        GetUserLoansWithDates,
+        PlaceHold,
+        CancelHold,
+        GetUserHolds,
+        GetHoldCountForItem,
+        GetHoldPosition,
+        GetAccountSnapshot,
+        TryBorrowItem,      // Result is a quint8 IDataRepository::WriteResult
+        TryReturnItem,
+        AddCopies,
+        GetCirculationReport,
+        BrowseShelf,
+        FindByIsbn,
+        FindByBarcode,
+        TryBorrowScanned,   // Result is a quint8 WriteResult and the qint32 item id
+        GetFacets,
+        OpcodeCount
+    };
+
+    /*
+        Frame Struct:
+        One decoded frame (header fields plus raw payload)
+    */
+    struct Frame {
+        quint8 type = 0;
+        quint32 id = 0;
+        QByteArray payload;
+    };
+
+    static QString defaultAddress() { return "local:hinlibs"; }
+
+    /*
+        Function: encodeFrame
+        Purpose: Builds one frame with its length prefix
+        Parameters:
+          in: quint8 type - FrameType
+          in: quint32 id - Request id
+          in: const QByteArray& payload - Frame body
+        Return: QByteArray - Bytes to write to the socket
+    */
+    static QByteArray encodeFrame(quint8 type, quint32 id, const QByteArray& payload);
+
+    /*
+        Function: takeFrame
+        Purpose: Removes the first complete frame from a receive buffer
+        Parameters:
+          in/out: QByteArray& buffer - Bytes received so far
+          out: Frame& frame - Decoded frame
+          out: bool& error - Set if the stream is corrupt (oversized or truncated frame)
+        Return: bool - True if a frame was taken; false if more bytes are needed
+    */
+    static bool takeFrame(QByteArray& buffer, Frame& frame, bool& error);
+
+    /*
+        Function: parseAddress
+        Purpose: Splits "tcp:host:port" / "local:name" into its parts
+        Parameters:
+          in: const QString& address - Address string
+          out: bool& tcp - True for TCP, false for a local socket
+          out: QString& host - Host name (TCP) or socket name (local)
+          out: quint16& port - TCP port
+        Return: bool - True if the address is valid
+    */
+    static bool parseAddress(const QString& address, bool& tcp, QString& host, quint16& port);
+
+    static QString opcodeName(quint8 opcode);
+    static const char* opcodeLabel(quint8 opcode); // opcodeName() as a literal ("unknown" if invalid), for timers
+    static quint8 opcodeFromName(const QString& name); // 0 if unknown
+
+    /*
+        Function: prepareStream
+        Purpose: Fixes the stream version so both ends agree on the encoding
+        Parameters:
+          in/out: QDataStream& stream - Stream to configure
+    */
+    static void prepareStream(QDataStream& stream);
+
+    /*
+        Function: encodeArgs
+        Purpose: Packs request arguments (int, bool, QString) in order
+        Parameters:
+          in: const A&... values - Arguments of the operation
+        Return: QByteArray - Encoded arguments
+    */
+    template <class... A>
+    static QByteArray encodeArgs(const A&... values) {
+        QByteArray bytes;
+        QDataStream out(&bytes, QIODevice::WriteOnly);
+        prepareStream(out);
+        int expand[] = {0, (writeValue(out, values), 0)...};
+        Q_UNUSED(expand);
+        return bytes;
+    }
+
+    static void writeText(QDataStream& out, const QString& text);
+    static QString readText(QDataStream& in);
+
+    static void writeItem(QDataStream& out, const LibraryItem* item);
+    static LibraryItem* readItem(QDataStream& in);
+
+    static void writeUser(QDataStream& out, const User* user);
+    static User* readUser(QDataStream& in);
+
+    static void writeLoan(QDataStream& out, const IDataRepository::LoanInfo& loan);
+    static IDataRepository::LoanInfo readLoan(QDataStream& in);
+
+    static void writeHold(QDataStream& out, const IDataRepository::HoldInfo& hold);
+    static IDataRepository::HoldInfo readHold(QDataStream& in);
+
+    static void writeShelfEntry(QDataStream& out, const IDataRepository::ShelfEntry& entry);
+    static IDataRepository::ShelfEntry readShelfEntry(QDataStream& in);
+
+    /*
+        Function: writeList
+        Purpose: Writes a whole list inline (one segment plus the terminator)
+        Parameters:
+          in/out: QDataStream& out - Destination
+          in: const std::vector<T>& rows - Rows to write
+          in: W writeRow - Writes one row: writeRow(out, row)
+    */
+    template <class T, class W>
+    static void writeList(QDataStream& out, const std::vector<T>& rows, W writeRow) {
+        if (!rows.empty()) {
+            out << quint32(rows.size());
+            for (const T& row : rows) writeRow(out, row);
+        }
+        out << quint32(0);
+    }
+
+    /*
+        Function: encodeSegments
+        Purpose: Encodes a list as separately sendable segments (no terminator), handing
+                 each one over as soon as it is encoded, before the next is started
+        Parameters:
+          in: const std::vector<T>& rows - Rows to encode
+          in: W writeRow - Writes one row: writeRow(out, row)
+          in: S sendSegment - Receives each [count][rows] block of up to SEGMENT_ROWS
+                              rows, in order: sendSegment(const QByteArray&)
+    */
+    template <class T, class W, class S>
+    static void encodeSegments(const std::vector<T>& rows, W writeRow, S sendSegment) {
+        for (size_t start = 0; start < rows.size(); start += SEGMENT_ROWS) {
+            size_t end = qMin(rows.size(), start + size_t(SEGMENT_ROWS));
+            QByteArray segment;
+            QDataStream out(&segment, QIODevice::WriteOnly);
+            prepareStream(out);
+            out << quint32(end - start);
+            for (size_t i = start; i < end; ++i) writeRow(out, rows[i]);
+            sendSegment(segment);
+        }
+    }
+
+    /*
+        Function: readList
+        Purpose: Appends list rows from a stream. Stops at the terminating 0 segment
+                 (returns true) or at the end of the frame (returns false: more
+                 segments follow in the next frame).
+        Parameters:
+          in/out: QDataStream& in - Source
+          in/out: std::vector<T>& rows - Destination
+          in: R readRow - Reads one row: readRow(in) -> T
+        Return: bool - True once the list is complete
+    */
+    template <class T, class R>
+    static bool readList(QDataStream& in, std::vector<T>& rows, R readRow) {
+        while (!in.atEnd() && in.status() == QDataStream::Ok) {
+            quint32 count = 0;
+            in >> count;
+            if (count == 0) return true;
+            rows.reserve(rows.size() + count);
+            for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+                rows.push_back(readRow(in));
+            }
+        }
+        return false;
+    }
+
+    static void writeSnapshot(QDataStream& out, const IDataRepository::AccountSnapshot& snapshot);
+    static IDataRepository::AccountSnapshot readSnapshot(QDataStream& in);
+
+    static void writeReport(QDataStream& out, const IDataRepository::CirculationReport& report);
+    static IDataRepository::CirculationReport readReport(QDataStream& in);
+
+    static void writeFacets(QDataStream& out, const IDataRepository::FacetResult& result);
+    static IDataRepository::FacetResult readFacets(QDataStream& in);
+
+private:
+    static void writeValue(QDataStream& out, int value) { out << qint32(value); }
+    static void writeValue(QDataStream& out, bool value) { out << value; }
+    static void writeValue(QDataStream& out, const QString& text) { writeText(out, text); }
+    static void writeValue(QDataStream& out, const char* text) { writeText(out, QString(text)); }
+    static void writeValue(QDataStream& out, const LibraryItem* item) { writeItem(out, item); }
+    static void writeValue(QDataStream& out, LibraryItem* item) { writeItem(out, item); }
+};
+
+#endif
@@ -0,0 +1,103 @@
+#include <QDebug>
+#include <QThread>
+#include <functional>
+#include "LoanArchiver.h"
+#include "DatabaseManager.h"
+
+LoanArchiver* LoanArchiver::instance = nullptr;
+
+namespace {
+    // Runs the archiver's compaction loop on its own thread
+    class ArchiverThread : public QThread {
+    public:
+        explicit ArchiverThread(const std::function<void()>& body) : body(body) {}
+
+    protected:
+        void run() override { body(); }
+
+    private:
+        std::function<void()> body;
+    };
+}
+
+LoanArchiver::LoanArchiver()
+    : worker(nullptr), batchSize(1000), pauseMs(50), stopping(false), archived(0) {}
+
+LoanArchiver& LoanArchiver::getInstance() {
+    static QMutex instanceMutex;
+    QMutexLocker locker(&instanceMutex);
+
+    if (!instance) {
+        instance = new LoanArchiver();
+    }
+    return *instance;
+}
+
+void LoanArchiver::start(int batchLimit, int pauseMilliseconds) {
+    // The manager must belong to the calling thread, not to the worker
+    DatabaseManager::getInstance();
+
+    QMutexLocker locker(&mutex);
+    batchSize = qMax(1, batchLimit);
+    pauseMs = qMax(0, pauseMilliseconds);
+
+    if (worker) {
+        if (!worker->isFinished()) return; // Already compacting; only the limits change
+        worker->wait();
+        delete worker;
+    }
+
+    stopping = false;
+    worker = new ArchiverThread([this]() { archiveLoop(); });
+    worker->start(QThread::LowPriority);
+}
+
+void LoanArchiver::stop() {
+    QThread* thread = nullptr;
+    {
+        QMutexLocker locker(&mutex);
+        thread = worker;
+        stopping = true;
+        wake.wakeAll();
+    }
+    if (!thread) return;
+
+    thread->wait();
+    delete thread;
+
+    QMutexLocker locker(&mutex);
+    worker = nullptr;
+}
+
+bool LoanArchiver::isRunning() const {
+    QMutexLocker locker(&mutex);
+    return worker && !worker->isFinished();
+}
+
+void LoanArchiver::archiveLoop() {
+    DatabaseManager& dbm = DatabaseManager::getInstance();
+    QMutexLocker locker(&mutex);
+
+    while (!stopping) {
+        int limit = batchSize;
+        locker.unlock();
+        int moved = dbm.archiveReturnedLoans(limit);
+        locker.relock();
+
+        if (moved < 0) {
+            qDebug() << "Loan archiving stopped after" << archived.load() << "loans";
+            break;
+        }
+        if (moved == 0) break; // Compacted
+        archived += moved;
+
+        // Leave the write lock to the desks for a moment
+        if (pauseMs > 0 && !stopping) wake.wait(&mutex, ulong(pauseMs));
+    }
+
+    locker.unlock();
+    if (archived.load() > 0) qDebug() << "Archived" << archived.load() << "returned loans";
+
+    // Thread connections cannot outlive their thread
+    dbm.releaseThreadConnection();
+}
@@ -0,0 +1,85 @@
+#ifndef LOANARCHIVER_H
+#define LOANARCHIVER_H
+
+#include <QMutex>
+#include <QWaitCondition>
+#include <atomic>
+
+class QThread;
+
+/*
+    LoanArchiver Class:
+    Singleton that compacts the loans table in the background. Returns move their
+    loan to loan_history in the same transaction, so loans holds active loans only
+    and every active-loan query (account panel, borrow limit, due-date scans) stays
+    sized to what is checked out rather than to the library's whole history.
+
+    Databases written before the split still have their returned loans in loans.
+    start() launches a thread that moves them over in batches of batchSize, one
+    short transaction per batch with a pause in between so desk writes are never
+    queued behind a long migration, and exits once none are left. Running it on an
+    already compacted database costs one pass over the (active-only) loans table.
+
+    Data Members:
+      - QThread* worker: Thread running archiveLoop() until done or stopped
+      - int batchSize / int pauseMs: Loans per transaction and wait between batches
+      - bool stopping: Set by stop(); the worker exits after its current batch
+      - QMutex mutex / QWaitCondition wake: Guard the state and cut a pause short
+      - std::atomic<quint64> archived: Loans moved since the archiver was created
+      - static LoanArchiver* instance: Singleton instance pointer
+
+    Member Functions:
+      Public:
+        - getInstance(): Provides global access to singleton instance
+        - start() / stop(): Start the compaction and stop it early
+        - isRunning(): Whether the worker is still compacting
+        - getArchivedCount(): Total for reports
+      Private:
+        - archiveLoop(): Worker thread body
+*/
+class LoanArchiver {
+public:
+    /*
+        Function: getInstance
+        Purpose: Provides global access to the singleton LoanArchiver instance.
+        Return: LoanArchiver& - Reference to the singleton instance
+    */
+    static LoanArchiver& getInstance();
+
+    /*
+        Function: start
+        Purpose: Starts compacting returned loans into loan_history on a background
+                 thread. Call from the thread that owns DatabaseManager, after the
+                 database has been initialized.
+        Parameters:
+          in: int batchLimit - Loans moved per transaction
+          in: int pauseMilliseconds - Wait between batches
+    */
+    void start(int batchLimit = 1000, int pauseMilliseconds = 50);
+
+    /*
+        Function: stop
+        Purpose: Stops the compaction after the current batch and waits for the thread
+                 to exit. Batches already moved stay moved; the next start() continues.
+    */
+    void stop();
+
+    bool isRunning() const;
+    quint64 getArchivedCount() const { return archived.load(); }
+
+private:
+    QThread* worker;
+    int batchSize;
+    int pauseMs;
+    bool stopping;
+    mutable QMutex mutex;
+    QWaitCondition wake;
+    std::atomic<quint64> archived;
+    static LoanArchiver* instance;
+
+    LoanArchiver(); // Private constructor for singleton
+
+    void archiveLoop();
+};
+
+#endif
@@ -1,8 +1,9 @@
 #include <QMessageBox>
 #include "LoginDialog.h"
-#include "DatabaseManager.h"
+#include "IDataRepository.h"
+#include "SessionManager.h"
 
-LoginDialog::LoginDialog(QWidget *parent) : QDialog(parent) {
+LoginDialog::LoginDialog(QWidget *parent) : QDialog(parent), lastAuthenticatedUser(nullptr) {
     setWindowTitle("HinLIBS Login");
     setFixedSize(400, 250);
 
@@ -42,9 +43,9 @@ void LoginDialog::attemptLogin() {
         return;
     }
 
-    // Authenticate against DatabaseManager
-    User* user = DatabaseManager::getInstance().findUser(username);
-
+    // Authenticate through the session layer (cached users skip the database)
+    SessionManager::Session* session = SessionManager::getInstance().login(username);
+    User* user = session ? session->user : nullptr;
 
     if (user) {
         errorLabel->setVisible(false);
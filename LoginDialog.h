@@ -6,7 +6,7 @@
 #include <QPushButton>
 #include <QLabel>
 #include <QVBoxLayout>
-#include "DatabaseManager.h"
+#include "IDataRepository.h"
 
 
 /*
@@ -60,7 +60,7 @@ public:
         Purpose: Provides access to the most recently authenticated user object
         Parameters: None
         Return: User* - Pointer to authenticated user, or nullptr if no successful login
-        Notes: Returns the actual User object from DatabaseManager for role-based access control
+        Notes: The User object is owned by SessionManager; callers must not delete it
     */
     User* getLoggedInUser() { return lastAuthenticatedUser; }
 
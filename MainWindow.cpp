@@ -1,9 +1,18 @@
 #include <QMessageBox>
 #include <QApplication>
 #include <QCloseEvent>
+#include <QDate>
+#include <QGridLayout>
+#include <algorithm>
 #include "MainWindow.h"
+#include "AddItemDialog.h"
+#include "SessionManager.h"
 #include "PatronSelectionDialog.h"
 #include "PatronReturnDialog.h"
+#include "DiagnosticsDialog.h"
+#include "AnalyticsDialog.h"
+#include "ShelfBrowserDialog.h"
+#include "RefreshScheduler.h"
 
 MainWindow::MainWindow(User* user, QWidget *parent)
     : QMainWindow(parent), currentUser(user) {
@@ -11,9 +20,24 @@ MainWindow::MainWindow(User* user, QWidget *parent)
     setWindowTitle("HinLIBS - Hintonville Library System");
     setFixedSize(1200, 800);
 
+    refreshScheduler = new RefreshScheduler(this);
+    connect(refreshScheduler, &RefreshScheduler::refreshDue, this, &MainWindow::applyRefresh);
+
     setupUI();
-    refreshCatalogue();
-    refreshAccountStatus();
+    refreshCatalogue(); // Also refreshes the account panel
+    flushRefresh();     // Filled before the first paint, not a frame after it
+}
+
+MainWindow::~MainWindow() {
+    currentUser->borrowedItems.clear();
+    currentUser->activeHolds.clear();
+    IDataRepository::freeAccountSnapshot(account);
+    qDeleteAll(catalogue);
+}
+
+void MainWindow::paintEvent(QPaintEvent* event) {
+    QMainWindow::paintEvent(event);
+    SessionManager::getInstance().reportFirstPaint();
 }
 
 void MainWindow::setupUI() {
@@ -40,9 +64,48 @@ void MainWindow::setupUI() {
     QLabel *catalogueLabel = new QLabel("Library Catalogue:");
     leftLayout->addWidget(catalogueLabel);
 
+    // Facet filters; each choice shows how many items it would leave
+    QGroupBox *filterBox = new QGroupBox("Filter Catalogue");
+    QGridLayout *filterLayout = new QGridLayout(filterBox);
+    const char* facetNames[IDataRepository::FacetCount] = {"Format:", "Genre:", "Rating:", "Condition:", "Status:"};
+    for (int f = 0; f < IDataRepository::FacetCount; ++f) {
+        facetCombos[f] = new QComboBox();
+        facetCombos[f]->addItem("Any", QString());
+        filterLayout->addWidget(new QLabel(facetNames[f]), f / 3, (f % 3) * 2);
+        filterLayout->addWidget(facetCombos[f], f / 3, (f % 3) * 2 + 1);
+    }
+
+    fromYearSpin = new QSpinBox();
+    toYearSpin = new QSpinBox();
+    for (QSpinBox* spin : {fromYearSpin, toYearSpin}) {
+        spin->setRange(0, 2100);
+        spin->setSpecialValueText("Any"); // Shown for 0
+        spin->setKeyboardTracking(false); // Filter once the year is typed, not per digit
+    }
+    QHBoxLayout *yearLayout = new QHBoxLayout();
+    yearLayout->addWidget(fromYearSpin);
+    yearLayout->addWidget(new QLabel("to"));
+    yearLayout->addWidget(toYearSpin);
+    filterLayout->addWidget(new QLabel("Published:"), 1, 4);
+    filterLayout->addLayout(yearLayout, 1, 5);
+
+    QPushButton *clearFilterButton = new QPushButton("Clear Filters");
+    filterStatusLabel = new QLabel();
+    filterLayout->addWidget(filterStatusLabel, 2, 0, 1, 4);
+    filterLayout->addWidget(clearFilterButton, 2, 5);
+    leftLayout->addWidget(filterBox);
+
     bookListWidget = new QListWidget();
     leftLayout->addWidget(bookListWidget);
 
+    // Scan-to-borrow: a barcode scanner types the code and presses Enter
+    QHBoxLayout *scanLayout = new QHBoxLayout();
+    scanInput = new QLineEdit();
+    scanInput->setPlaceholderText("Scan or type a copy barcode or ISBN, then press Enter");
+    scanLayout->addWidget(new QLabel("Scan to borrow:"));
+    scanLayout->addWidget(scanInput);
+    leftLayout->addLayout(scanLayout);
+
     // Action buttons
     QHBoxLayout *buttonLayout = new QHBoxLayout();
     borrowButton = new QPushButton("Borrow Selected Item");
@@ -54,9 +117,12 @@ void MainWindow::setupUI() {
     holdButton = new QPushButton("Place Hold");
     holdButton->setEnabled(false);
 
+    shelfButton = new QPushButton("Browse Shelves");
+
     buttonLayout->addWidget(borrowButton);
     buttonLayout->addWidget(returnButton);
     buttonLayout->addWidget(holdButton);
+    buttonLayout->addWidget(shelfButton);
     leftLayout->addLayout(buttonLayout);
 
     // Right Panel: Account Status
@@ -87,12 +153,20 @@ void MainWindow::setupUI() {
     // Signal connections
     connect(bookListWidget, &QListWidget::itemSelectionChanged, this, &MainWindow::onBookSelected);
     connect(borrowedItemsList, &QListWidget::itemSelectionChanged, this, &MainWindow::onBookSelected);
-    connect(holdsList, &QListWidget::itemSelectionChanged, this, &MainWindow::updateHoldButtons);
+    connect(holdsList, &QListWidget::itemSelectionChanged, this, &MainWindow::onBookSelected);
 
     connect(borrowButton, &QPushButton::clicked, this, &MainWindow::borrowSelectedBook);
     connect(returnButton, &QPushButton::clicked, this, &MainWindow::returnSelectedBook);
     connect(holdButton, &QPushButton::clicked, this, &MainWindow::placeHoldOnSelected);
     connect(cancelHoldButton, &QPushButton::clicked, this, &MainWindow::cancelSelectedHold);
+    connect(shelfButton, &QPushButton::clicked, this, &MainWindow::showShelfBrowser);
+    connect(scanInput, &QLineEdit::returnPressed, this, &MainWindow::borrowScanned);
+    for (QComboBox* combo : facetCombos) {
+        connect(combo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &MainWindow::refreshCatalogue);
+    }
+    connect(fromYearSpin, QOverload<int>::of(&QSpinBox::valueChanged), this, &MainWindow::refreshCatalogue);
+    connect(toYearSpin, QOverload<int>::of(&QSpinBox::valueChanged), this, &MainWindow::refreshCatalogue);
+    connect(clearFilterButton, &QPushButton::clicked, this, &MainWindow::clearFilters);
     connect(logoutButton, &QPushButton::clicked, this, &MainWindow::logout);
 
     connect(bookListWidget, &QListWidget::itemDoubleClicked, this, &MainWindow::showItemDetails);
@@ -134,15 +208,21 @@ void MainWindow::setupLibrarianUI() {
     addItemButton = new QPushButton("Add New Item to Catalogue");
     removeItemButton = new QPushButton("Remove Selected Item");
     returnForPatronButton = new QPushButton("Return Item for Patron");
+    diagnosticsButton = new QPushButton("View Diagnostics");
+    analyticsButton = new QPushButton("Circulation Analytics");
 
     QString buttonStyle = "QPushButton { padding: 8px; }";
     addItemButton->setStyleSheet(buttonStyle);
     removeItemButton->setStyleSheet(buttonStyle);
     returnForPatronButton->setStyleSheet(buttonStyle);
+    diagnosticsButton->setStyleSheet(buttonStyle);
+    analyticsButton->setStyleSheet(buttonStyle);
 
     librarianLayout->addWidget(addItemButton);
     librarianLayout->addWidget(removeItemButton);
     librarianLayout->addWidget(returnForPatronButton);
+    librarianLayout->addWidget(diagnosticsButton);
+    librarianLayout->addWidget(analyticsButton);
 
     librarianLayout->addStretch(); // Push content to top
 
@@ -156,6 +236,8 @@ void MainWindow::setupLibrarianUI() {
     connect(addItemButton, &QPushButton::clicked, this, &MainWindow::showAddItemDialog);
     connect(removeItemButton, &QPushButton::clicked, this, &MainWindow::removeSelectedItem);
     connect(returnForPatronButton, &QPushButton::clicked, this, &MainWindow::showReturnForPatronDialog);
+    connect(diagnosticsButton, &QPushButton::clicked, this, &MainWindow::showDiagnosticsDialog);
+    connect(analyticsButton, &QPushButton::clicked, this, &MainWindow::showAnalyticsDialog);
 }
 
 
@@ -166,11 +248,11 @@ void MainWindow::showAddItemDialog() {
     AddItemDialog dialog(this);
 
     if (dialog.exec() == QDialog::Accepted) {
-        bool success = DatabaseManager::getInstance().addItemToCatalogue(
+        bool success = IDataRepository::getInstance().addItemToCatalogue(
             dialog.getTitle(), dialog.getAuthor(), dialog.getItemType(),
             dialog.getDeweyDecimal(), dialog.getISBN(), dialog.getGenre(),
             dialog.getRating(), dialog.getIssueNumber(), dialog.getPublicationDate(),
-            dialog.getPublicationYear(), dialog.getCondition()
+            dialog.getPublicationYear(), dialog.getCondition(), dialog.getCopies()
         );
 
         if (success) {
@@ -189,7 +271,7 @@ void MainWindow::removeSelectedItem() {
         return;
     }
 
-    int itemId = DatabaseManager::getInstance().getItemId(selected);
+    int itemId = selected->getId();
     if (itemId == -1) {
         QMessageBox::warning(this, "Error", "Could not find item in database!");
         return;
@@ -202,7 +284,7 @@ void MainWindow::removeSelectedItem() {
         QMessageBox::Yes | QMessageBox::No);
 
     if (reply == QMessageBox::Yes) {
-        bool success = DatabaseManager::getInstance().removeItemFromCatalogue(itemId);
+        bool success = IDataRepository::getInstance().removeItemFromCatalogue(itemId);
         if (success) {
             QMessageBox::information(this, "Success", "Item removed from catalogue!");
             refreshCatalogue();
@@ -223,8 +305,7 @@ void MainWindow::showReturnForPatronDialog() {
             if (returnDialog.exec() == QDialog::Accepted) {
                 LibraryItem* selectedItem = returnDialog.getSelectedItem();
                 if (selectedItem) {
-                    int itemId = DatabaseManager::getInstance().getItemId(selectedItem);
-                    processPatronReturn(selectedPatron->id, itemId);
+                    processPatronReturn(selectedPatron->id, selectedItem->getId()); // Set when the loan was loaded
                 }
             }
         }
@@ -232,10 +313,10 @@ void MainWindow::showReturnForPatronDialog() {
 }
 
 void MainWindow::processPatronReturn(int patronId, int itemId) {
-    bool success = DatabaseManager::getInstance().returnItem(patronId, itemId);
-    if (success) {
+    IDataRepository::WriteResult result = IDataRepository::getInstance().tryReturnItem(patronId, itemId);
+    if (result == IDataRepository::WriteOk) {
         // Find patron name for success message
-        auto allUsers = DatabaseManager::getInstance().getAllUsers();
+        auto allUsers = IDataRepository::getInstance().getAllUsers();
         QString patronName;
         for (auto user : allUsers) {
             if (user->id == patronId) {
@@ -247,6 +328,9 @@ void MainWindow::processPatronReturn(int patronId, int itemId) {
         QMessageBox::information(this, "Success",
             QString("Successfully returned item for patron: %1").arg(patronName));
         refreshCatalogue();
+    } else if (result == IDataRepository::WriteConflict) {
+        QMessageBox::warning(this, "Error", "This item has already been returned.");
+        refreshCatalogue();
     } else {
         QMessageBox::warning(this, "Error", "Failed to return item.");
     }
@@ -254,27 +338,93 @@ void MainWindow::processPatronReturn(int patronId, int itemId) {
 
 
 
+void MainWindow::showDiagnosticsDialog() {
+    DiagnosticsDialog dialog(this, refreshScheduler);
+    dialog.exec();
+}
+
+void MainWindow::showAnalyticsDialog() {
+    AnalyticsDialog dialog(this);
+    dialog.exec();
+}
+
+void MainWindow::showShelfBrowser() {
+    ShelfBrowserDialog dialog(this);
+    dialog.exec();
+}
+
+
+
 // === CORE LIBRARY OPERATIONS ===
 
 void MainWindow::refreshCatalogue() {
+    // The catalogue's tags feed the account panel and both feed the buttons
+    refreshScheduler->invalidate(RefreshScheduler::Catalogue | RefreshScheduler::Account |
+                                 RefreshScheduler::Selection);
+}
+
+void MainWindow::refreshAccountStatus() {
+    refreshScheduler->invalidate(RefreshScheduler::Account | RefreshScheduler::Selection);
+}
+
+void MainWindow::onBookSelected() {
+    refreshScheduler->invalidate(RefreshScheduler::Selection);
+}
+
+void MainWindow::flushRefresh() {
+    refreshScheduler->flush();
+}
+
+void MainWindow::applyRefresh(int panes) {
+    // Old items stay valid until the account panel has dropped its pointers to them
+    std::vector<LibraryItem*> previousCatalogue;
+    if (panes & RefreshScheduler::Catalogue) rebuildCatalogue(previousCatalogue);
+    if (panes & RefreshScheduler::Account) rebuildAccountPanel();
+    if (panes & RefreshScheduler::Selection) updateSelectionState();
+    qDeleteAll(previousCatalogue);
+}
+
+void MainWindow::rebuildCatalogue(std::vector<LibraryItem*>& previousCatalogue) {
     // Preserve selection across refresh for better UX
-    QString previouslySelectedTitle;
     LibraryItem* selected = getSelectedBook();
-    if (selected) {
-        previouslySelectedTitle = QString::fromStdString(selected->getTitle());
-    }
+    int previouslySelectedId = selected ? selected->getId() : -1;
 
+    // Counts for the filter panel, and the matching items when a filter is set
+    IDataRepository::FacetFilter filter = currentFilter();
+    IDataRepository::FacetResult facets = IDataRepository::getInstance().getFacets(filter);
+    populateFacets(facets);
+
+    // Selection signals are held back while rows are replaced; updateSelectionState() follows
+    bookListWidget->blockSignals(true);
     bookListWidget->clear();
-    auto catalogue = DatabaseManager::getInstance().getAllCatalogueItems();
+    previousCatalogue.swap(catalogue);
 
-    for (auto item : catalogue) {
-        QString displayText = QString::fromStdString(item->getDisplayText());
+    // First refresh after startup uses the catalogue prewarmed during login
+    if (!SessionManager::getInstance().takePreloadedCatalogue(catalogue)) {
+        catalogue = IDataRepository::getInstance().getAllCatalogueItems();
+    }
+
+    catalogueById.clear();
+    catalogueById.reserve(int(catalogue.size()));
+    for (LibraryItem* item : catalogue) catalogueById.insert(item->getId(), item);
 
-        // Get real-time availability and hold counts from database
-        int itemId = DatabaseManager::getInstance().getItemId(item);
-        int holdCount = DatabaseManager::getInstance().getHoldCountForItem(itemId);
+    // Availability comes from the index's bitmap; the item's own flag only if the index is unavailable
+    bool indexed = facets.total > 0;
+
+    for (LibraryItem* item : catalogue) {
+        if (filter.isActive() &&
+            !std::binary_search(facets.itemIds.begin(), facets.itemIds.end(), item->getId())) {
+            continue;
+        }
 
-        if (item->getAvailability()) {
+        QString displayText = QString::fromStdString(item->getDisplayText());
+        int holdCount = item->getHoldCount(); // Stored with the item; no per-row query
+        bool available = indexed ? std::binary_search(facets.availableIds.begin(), facets.availableIds.end(), item->getId())
+                                 : item->getAvailability();
+
+        if (item->getTotalCopies() > 1) {
+            displayText += QString(" [%1 of %2 available]").arg(item->getAvailableCopies()).arg(item->getTotalCopies());
+        } else if (available) {
             displayText += " [AVAILABLE]";
         } else {
             displayText += " [CHECKED OUT]";
@@ -285,65 +435,140 @@ void MainWindow::refreshCatalogue() {
         }
 
         QListWidgetItem* listItem = new QListWidgetItem(displayText);
+        listItem->setData(Qt::UserRole, item->getId()); // Resolved through catalogueById
 
         // Visual status indicators
-        if (!item->getAvailability()) {
+        if (!available) {
             listItem->setBackground(QBrush(QColor(255, 200, 200)));
         }
 
         bookListWidget->addItem(listItem);
 
         // Restore previous selection if possible
-        if (!previouslySelectedTitle.isEmpty() &&
-            previouslySelectedTitle == QString::fromStdString(item->getTitle())) {
+        if (item->getId() == previouslySelectedId) {
             listItem->setSelected(true);
         }
     }
 
-    onBookSelected();
-    refreshAccountStatus();
+    if (filter.isActive()) {
+        filterStatusLabel->setText(QString("Showing %1 of %2 items, %3 available")
+                                   .arg(bookListWidget->count()).arg(catalogue.size()).arg(facets.availableIds.size()));
+    } else {
+        filterStatusLabel->setText(QString("%1 items, %2 available").arg(catalogue.size()).arg(facets.availableIds.size()));
+    }
+    bookListWidget->blockSignals(false);
 }
 
-void MainWindow::refreshAccountStatus() {
+IDataRepository::FacetFilter MainWindow::currentFilter() const {
+    IDataRepository::FacetFilter filter;
+    for (int f = 0; f < IDataRepository::FacetCount; ++f) {
+        filter.values[f] = facetCombos[f]->currentData().toString();
+    }
+    filter.fromYear = fromYearSpin->value();
+    filter.toYear = toYearSpin->value();
+    return filter;
+}
+
+void MainWindow::populateFacets(const IDataRepository::FacetResult& facets) {
+    for (int f = 0; f < IDataRepository::FacetCount; ++f) {
+        QComboBox* combo = facetCombos[f];
+        QString chosen = combo->currentData().toString();
+
+        combo->blockSignals(true);
+        combo->clear();
+        combo->addItem("Any", QString());
+        for (const auto& value : facets.counts[f]) {
+            combo->addItem(QString("%1 (%2)").arg(facetLabel(f, value.value)).arg(value.count), value.value);
+        }
+
+        // Keep the choice even if no item has that value any more
+        int index = combo->findData(chosen);
+        if (index < 0) {
+            combo->addItem(QString("%1 (0)").arg(facetLabel(f, chosen)), chosen);
+            index = combo->count() - 1;
+        }
+        combo->setCurrentIndex(index);
+        combo->blockSignals(false);
+    }
+}
+
+QString MainWindow::facetLabel(int facet, const QString& value) {
+    if (facet == IDataRepository::FacetFormat) {
+        if (value == "fiction") return "Fiction Book";
+        if (value == "nonfiction") return "Non-Fiction Book";
+        if (value == "magazine") return "Magazine";
+        if (value == "movie") return "Movie";
+        if (value == "videogame") return "Video Game";
+    } else if (facet == IDataRepository::FacetAvailability) {
+        return value == "available" ? "Available" : "Checked Out";
+    }
+    return value;
+}
+
+void MainWindow::clearFilters() {
+    for (QComboBox* combo : facetCombos) {
+        combo->blockSignals(true);
+        combo->setCurrentIndex(0);
+        combo->blockSignals(false);
+    }
+    fromYearSpin->blockSignals(true);
+    fromYearSpin->setValue(0);
+    fromYearSpin->blockSignals(false);
+    toYearSpin->blockSignals(true);
+    toYearSpin->setValue(0);
+    toYearSpin->blockSignals(false);
+    refreshCatalogue();
+}
+
+void MainWindow::rebuildAccountPanel() {
     // Critical: Sync in-memory state with database to prevent state mismatches
-    auto borrowedItems = DatabaseManager::getInstance().getUserBorrowedItems(currentUser->id);
-    auto userHolds = DatabaseManager::getInstance().getUserHolds(currentUser->id);
+    currentUser->borrowedItems.clear(); // Clear before sync
+    currentUser->activeHolds.clear();
+    IDataRepository::freeAccountSnapshot(account);
+
+    // First refresh after login reuses the session's preloaded snapshot
+    if (!SessionManager::getInstance().takePreloadedAccount(account)) {
+        account = IDataRepository::getInstance().getAccountSnapshot(currentUser->id);
+    }
 
     QString status = QString("Borrowed: %1/3 items | Active Holds: %2")
-        .arg(borrowedItems.size()).arg(userHolds.size());
+        .arg(account.loans.size()).arg(account.holds.size());
     accountStatusLabel->setText(status);
 
-    // Update borrowed items list
+    // Update borrowed items list (selection signals held back as for the catalogue)
+    borrowedItemsList->blockSignals(true);
+    holdsList->blockSignals(true);
     borrowedItemsList->clear();
-    currentUser->borrowedItems.clear(); // Clear before sync
-    for (auto item : borrowedItems) {
-        QString itemText = QString::fromStdString(item->getDisplayText()) + " (Due in 14 days)";
+    for (const auto& loan : account.loans) {
+        QString itemText = QString::fromStdString(loan.item->getDisplayText()) + dueText(loan.dueDate);
         borrowedItemsList->addItem(itemText);
-        currentUser->borrowedItems.push_back(item); // Sync in-memory state
+        currentUser->borrowedItems.push_back(loan.item); // Sync in-memory state
     }
 
-    // Update holds list with real positions from database
+    // Update holds list with real positions from the snapshot
     holdsList->clear();
-    currentUser->activeHolds.clear(); // Clear before sync
-    for (auto item : userHolds) {
-        int itemId = DatabaseManager::getInstance().getItemId(item);
-        int realPosition = DatabaseManager::getInstance().getHoldPosition(currentUser->id, itemId);
-
-        QString holdText = QString::fromStdString(item->getDisplayText()) +
-                          QString(" - Position #%1").arg(realPosition);
+    for (const auto& hold : account.holds) {
+        QString holdText = QString::fromStdString(hold.item->getDisplayText()) +
+                          QString(" - Position #%1").arg(hold.position);
         holdsList->addItem(holdText);
-        currentUser->activeHolds.push_back(item); // Sync in-memory state
+        currentUser->activeHolds.push_back(hold.item); // Sync in-memory state
     }
 
-    onBookSelected();
+    borrowedItemsList->blockSignals(false);
+    holdsList->blockSignals(false);
+
+    // canBorrow() reads the counters; the snapshot is their freshest source here
+    currentUser->activeLoanCount = int(account.loans.size());
+    currentUser->activeHoldCount = int(account.holds.size());
 }
 
 void MainWindow::borrowSelectedBook() {
     LibraryItem* selected = getSelectedBook();
     if (!selected) return;
 
-    // Business rule validation
-    if (!selected->getAvailability()) {
+    // Business rule validation; a patron with a hold may pick up a copy on the hold shelf
+    // even when no copy is on the open shelf
+    if (!selected->getAvailability() && !userHasHoldOn(selected)) {
         QMessageBox::warning(this, "Error", "This book is already checked out!");
         return;
     }
@@ -354,11 +579,19 @@ void MainWindow::borrowSelectedBook() {
     }
 
     // Database operation
-    int itemId = DatabaseManager::getInstance().getItemId(selected);
+    int itemId = selected->getId();
     if (itemId == -1) return;
 
-    bool success = DatabaseManager::getInstance().borrowItem(currentUser->id, itemId);
-    if (!success) {
+    // The check above used the catalogue as last shown; the database has the final say
+    IDataRepository::WriteResult result = IDataRepository::getInstance().tryBorrowItem(currentUser->id, itemId);
+    if (result == IDataRepository::WriteConflict) {
+        QMessageBox::warning(this, "Error", selected->getAvailability()
+                                                ? "This book was just checked out at another desk."
+                                                : "Your hold is not ready for pickup yet.");
+        refreshCatalogue();
+        return;
+    }
+    if (result != IDataRepository::WriteOk) {
         QMessageBox::warning(this, "Error", "Failed to borrow book in database!");
         return;
     }
@@ -374,15 +607,58 @@ void MainWindow::borrowSelectedBook() {
     refreshAccountStatus();
 }
 
+void MainWindow::borrowScanned() {
+    QString code = scanInput->text().trimmed();
+    scanInput->clear(); // Ready for the next scan
+    if (code.isEmpty()) return;
+
+    if (!currentUser->canBorrow()) {
+        QMessageBox::warning(this, "Error",
+            "You have reached the maximum of 3 borrowed books. Please return one first!");
+        return;
+    }
+
+    // Lookup and borrow are one transaction; no catalogue row needs to be selected
+    int itemId = -1;
+    IDataRepository::WriteResult result = IDataRepository::getInstance().tryBorrowScanned(currentUser->id, code, itemId);
+    if (result == IDataRepository::WriteNotFound) {
+        QMessageBox::warning(this, "Error", QString("No item has the barcode or ISBN %1.").arg(code));
+        return;
+    }
+    if (result == IDataRepository::WriteConflict) {
+        QMessageBox::warning(this, "Error", "This copy is checked out or waiting on the hold shelf for another patron.");
+        refreshCatalogue();
+        return;
+    }
+    if (result != IDataRepository::WriteOk) {
+        QMessageBox::warning(this, "Error", "Failed to borrow book in database!");
+        return;
+    }
+
+    LibraryItem* item = IDataRepository::getInstance().getItemById(itemId);
+    QMessageBox::information(this, "Success",
+        QString("You have successfully borrowed: %1").arg(item ? QString::fromStdString(item->getTitle()) : code));
+    delete item;
+
+    refreshCatalogue();
+    refreshAccountStatus(); // Loan counters come from the new account snapshot
+}
+
 void MainWindow::returnSelectedBook() {
     LibraryItem* selected = getSelectedBorrowedItem();
     if (!selected) return;
 
-    int itemId = DatabaseManager::getInstance().getItemId(selected);
+    int itemId = selected->getId();
     if (itemId == -1) return;
 
-    bool success = DatabaseManager::getInstance().returnItem(currentUser->id, itemId);
-    if (!success) {
+    IDataRepository::WriteResult result = IDataRepository::getInstance().tryReturnItem(currentUser->id, itemId);
+    if (result == IDataRepository::WriteConflict) {
+        QMessageBox::warning(this, "Error", "This book has already been returned.");
+        refreshCatalogue();
+        refreshAccountStatus();
+        return;
+    }
+    if (result != IDataRepository::WriteOk) {
         QMessageBox::warning(this, "Error", "Failed to return book in database!");
         return;
     }
@@ -408,23 +684,20 @@ void MainWindow::placeHoldOnSelected() {
         return;
     }
 
-    // Check for duplicate holds
-    auto userHolds = DatabaseManager::getInstance().getUserHolds(currentUser->id);
-    for (auto hold : userHolds) {
-        if (DatabaseManager::getInstance().getItemId(hold) == DatabaseManager::getInstance().getItemId(selected)) {
+    int itemId = selected->getId();
+    if (itemId == -1) return;
+
+    // Check for duplicate holds against the account snapshot already on screen
+    for (const auto& hold : account.holds) {
+        if (hold.itemId == itemId) {
             QMessageBox::information(this, "Info", "You already have a hold on this book!");
             return;
         }
     }
 
-    int itemId = DatabaseManager::getInstance().getItemId(selected);
-    if (itemId == -1) return;
-
-    // Calculate position before placing hold
-    int currentHoldCount = DatabaseManager::getInstance().getHoldCountForItem(itemId);
-    int userPosition = currentHoldCount + 1;
-
-    bool success = DatabaseManager::getInstance().placeHold(currentUser->id, itemId);
+    // Place the hold and read back its position in one step
+    int userPosition = 0;
+    bool success = IDataRepository::getInstance().placeHoldAndGetPosition(currentUser->id, itemId, userPosition);
     if (!success) return;
 
     QMessageBox::information(this, "Hold Placed",
@@ -436,20 +709,16 @@ void MainWindow::placeHoldOnSelected() {
 
 void MainWindow::cancelSelectedHold() {
     int currentRow = holdsList->currentRow();
-    if (currentRow < 0) return;
-
-    auto userHolds = DatabaseManager::getInstance().getUserHolds(currentUser->id);
-    if (currentRow >= userHolds.size()) return;
+    if (currentRow < 0 || currentRow >= int(account.holds.size())) return;
 
-    LibraryItem* holdItem = userHolds[currentRow];
-    int itemId = DatabaseManager::getInstance().getItemId(holdItem);
-    if (itemId == -1) return;
+    // The holds list is built from the snapshot, row for row
+    const auto& hold = account.holds[currentRow];
+    QString title = QString::fromStdString(hold.item->getTitle());
 
-    bool success = DatabaseManager::getInstance().cancelHold(currentUser->id, itemId);
+    bool success = IDataRepository::getInstance().cancelHold(currentUser->id, hold.itemId);
     if (!success) return;
 
-    QMessageBox::information(this, "Hold Cancelled",
-        QString("Hold removed for: %1").arg(QString::fromStdString(holdItem->getTitle())));
+    QMessageBox::information(this, "Hold Cancelled", QString("Hold removed for: %1").arg(title));
 
     refreshCatalogue();
     refreshAccountStatus();
@@ -459,35 +728,25 @@ void MainWindow::cancelSelectedHold() {
 
 // === UI STATE MANAGEMENT ===
 
-void MainWindow::onBookSelected() {
+void MainWindow::updateSelectionState() {
     LibraryItem* selectedBook = getSelectedBook();
     LibraryItem* selectedBorrowed = getSelectedBorrowedItem();
 
-    borrowButton->setEnabled(selectedBook && selectedBook->getAvailability() && currentUser->canBorrow());
+    borrowButton->setEnabled(selectedBook && (selectedBook->getAvailability() || userHasHoldOn(selectedBook)) &&
+                             currentUser->canBorrow());
     returnButton->setEnabled(selectedBorrowed != nullptr);
     updateHoldButtons();
 }
 
 void MainWindow::updateHoldButtons() {
     // Update cancel hold button state
-    auto userHolds = DatabaseManager::getInstance().getUserHolds(currentUser->id);
-    bool holdSelected = (holdsList->currentRow() >= 0 && holdsList->currentRow() < userHolds.size());
+    bool holdSelected = (holdsList->currentRow() >= 0 && holdsList->currentRow() < int(account.holds.size()));
     cancelHoldButton->setEnabled(holdSelected);
 
-    // Update place hold button state
+    // Update place hold button state (holds come from the account snapshot)
     LibraryItem* selectedBook = getSelectedBook();
     if (selectedBook) {
-        int itemId = DatabaseManager::getInstance().getItemId(selectedBook);
-        bool userHasHold = false;
-
-        for (auto hold : userHolds) {
-            if (DatabaseManager::getInstance().getItemId(hold) == itemId) {
-                userHasHold = true;
-                break;
-            }
-        }
-
-        bool canPlaceHold = !selectedBook->getAvailability() && !userHasHold;
+        bool canPlaceHold = !selectedBook->getAvailability() && !userHasHoldOn(selectedBook);
         holdButton->setEnabled(canPlaceHold);
     } else {
         holdButton->setEnabled(false);
@@ -498,6 +757,25 @@ void MainWindow::updateHoldButtons() {
 
 // === UTILITY METHODS ===
 
+QString MainWindow::dueText(const QString& dueDate) {
+    QDate due = QDate::fromString(dueDate, "yyyy-MM-dd");
+    if (!due.isValid()) return QString();
+
+    qint64 days = QDate::currentDate().daysTo(due);
+    if (days < 0) return QString(" (OVERDUE since %1)").arg(dueDate);
+    if (days == 0) return " (Due today)";
+    if (days == 1) return " (Due tomorrow)";
+    return QString(" (Due %1, in %2 days)").arg(dueDate).arg(days);
+}
+
+bool MainWindow::userHasHoldOn(LibraryItem* item) const {
+    // Catalogue items carry their database ID, so no lookup is needed per selection
+    for (const auto& hold : account.holds) {
+        if (hold.itemId == item->getId()) return true;
+    }
+    return false;
+}
+
 void MainWindow::showItemDetails() {
     LibraryItem* item = getSelectedBook();
     if (!item) item = getSelectedBorrowedItem();
@@ -517,14 +795,9 @@ void MainWindow::logout() {
 }
 
 LibraryItem* MainWindow::getSelectedBook() {
-    int currentRow = bookListWidget->currentRow();
-    if (currentRow >= 0) {
-        auto catalogue = DatabaseManager::getInstance().getAllCatalogueItems();
-        if (currentRow < catalogue.size()) {
-            return catalogue[currentRow];
-        }
-    }
-    return nullptr;
+    QListWidgetItem* row = bookListWidget->currentItem();
+    if (!row) return nullptr;
+    return catalogueById.value(row->data(Qt::UserRole).toInt(), nullptr);
 }
 
 LibraryItem* MainWindow::getSelectedBorrowedItem() {
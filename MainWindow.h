@@ -7,9 +7,16 @@
 #include <QHBoxLayout>
 #include <QLabel>
 #include <QPushButton>
+#include <QLineEdit>
 #include <QGroupBox>
+#include <QComboBox>
+#include <QSpinBox>
+#include <QHash>
+#include <vector>
 #include "User.h"
-#include "DatabaseManager.h"
+#include "IDataRepository.h"
+
+class RefreshScheduler;
 
 /*
     MainWindow Class:
@@ -34,11 +41,21 @@
 
     Data Members:
       - User* currentUser: Pointer to the currently authenticated user
+      - AccountSnapshot account: Loans and holds shown in the account panel (owns its items)
       - QListWidget* bookListWidget: Displays the library catalogue
+      - std::vector<LibraryItem*> catalogue: Items loaded by the last refresh (owned)
+      - QHash<int, LibraryItem*> catalogueById: Those items by ID; each list row carries
+        its item's ID (Qt::UserRole), so a selection resolves without a query
+      - RefreshScheduler* refreshScheduler: Merges refresh requests into one update per frame
+      - QComboBox* facetCombos[]: One filter per facet, each value shown with its count
+      - QSpinBox* fromYearSpin / toYearSpin: Publication year range filter (0 = any)
+      - QLabel* filterStatusLabel: How many items the filter shows
       - QPushButton* borrowButton: Initiates book borrowing process
       - QPushButton* returnButton: Handles book returns
       - QPushButton* holdButton: Places holds on unavailable items
       - QPushButton* cancelHoldButton: Removes existing holds
+      - QPushButton* shelfButton: Opens the call number shelf browser
+      - QLineEdit* scanInput: Barcode / ISBN field for scan-to-borrow
       - QListWidget* borrowedItemsList: Shows user's currently borrowed books
       - QListWidget* holdsList: Displays user's active hold requests
       - QLabel* accountStatusLabel: Shows borrowing status and limits
@@ -48,38 +65,59 @@
       - QPushButton* addItemButton: Adds new items to catalogue
       - QPushButton* removeItemButton: Removes items from catalogue
       - QPushButton* returnForPatronButton: Processes returns on behalf of patrons
+      - QPushButton* diagnosticsButton: Opens data layer timing diagnostics
+      - QPushButton* analyticsButton: Opens the circulation analytics dashboard
 
     Member Functions:
       Public:
         - MainWindow(): Constructs the main interface for a specific user
+        - ~MainWindow(): Releases the account snapshot
+
+      Protected:
+        - paintEvent(): Reports login-to-first-paint latency to the session
 
       Private Slots:
-        - refreshCatalogue(): Updates the book display with current status
-        - onBookSelected(): Manages UI state based on user selections
+        - refreshCatalogue(): Schedules the book display for an update with current status
+        - onBookSelected(): Schedules the button states for an update after a selection
+        - flushRefresh(): Runs the scheduled updates now
+        - applyRefresh(): Runs the scheduled updates when their frame is due
         - borrowSelectedBook(): Processes book borrowing with validation
+        - borrowScanned(): Borrows the copy or ISBN typed into the scan field
         - returnSelectedBook(): Handles book returns and status updates
         - placeHoldOnSelected(): Manages hold placement in FIFO queues
         - cancelSelectedHold(): Removes holds from queue system
-        - refreshAccountStatus(): Updates user's account information display
+        - refreshAccountStatus(): Schedules user's account information display for an update
         - logout(): Terminates session and returns to login screen
         - showItemDetails(): Displays comprehensive item information
+        - showShelfBrowser(): Browses the non-fiction shelves in call number order
+        - clearFilters(): Resets every catalogue filter
 
         Librarian-specific slots:
         - showAddItemDialog(): Opens dialog to add new catalogue items
         - removeSelectedItem(): Removes selected item from catalogue
         - showReturnForPatronDialog(): Opens patron selection for returns
         - processPatronReturn(): Processes returns on behalf of patrons
+        - showDiagnosticsDialog(): Opens the performance diagnostics view
+        - showAnalyticsDialog(): Opens the circulation analytics dashboard
 
       Private:
         - setupUI(): Initializes and arranges all interface components
         - setupLibrarianUI(): Creates and configures librarian tools panel
         - getSelectedBook(): Retrieves currently selected catalogue item
+        - currentFilter(): Reads the filter panel
+        - populateFacets(): Refills the filter choices with their counts
+        - facetLabel(): Display text for a stored facet value
         - getSelectedBorrowedItem(): Gets selected borrowed book for return
+        - userHasHoldOn(): Whether the patron holds a catalogue item
+        - dueText(): Due-date suffix for a borrowed item
+        - rebuildCatalogue(): Repopulates the book display (catalogue pane)
+        - rebuildAccountPanel(): Repopulates the account panel (account pane)
+        - updateSelectionState(): Sets the button states for the selections (selection pane)
         - updateHoldButtons(): Manages hold-related button states
         - getActiveList(): Determines which list has user focus
 
     Database Integration:
-      - All operations persist to SQLite database via DatabaseManager
+      - All operations go through IDataRepository: SQLite via DatabaseManager, or a HinLIBS server
       - Real-time synchronization between UI and database state
       - Automatic data persistence between application sessions
 
@@ -105,22 +143,56 @@ public:
     */
     MainWindow(User* user, QWidget *parent = nullptr);
 
+    /*
+        Function: ~MainWindow
+        Purpose: Frees the items held by the account snapshot and detaches them from
+                 the (session-owned) current user.
+    */
+    ~MainWindow();
+
+protected:
+    /*
+        Function: paintEvent
+        Purpose: Forwards to QMainWindow and, on the first paint, reports the
+                 login-to-first-paint latency to SessionManager.
+        Parameters:
+          in: QPaintEvent* event - Paint event from Qt
+    */
+    void paintEvent(QPaintEvent* event) override;
+
 private slots:
     /*
         Function: refreshCatalogue
-        Purpose: Updates the catalogue display with current availability and hold counts from database.
-                 Repopulates book list and updates visual status indicators. Synchronizes in-memory
-                 state with database persistence layer.
+        Purpose: Marks the catalogue, and with it the account panel and button states, for
+                 the next frame's update (see rebuildCatalogue()). Any number of calls
+                 before then cost one update.
     */
     void refreshCatalogue();
 
     /*
         Function: onBookSelected
-        Purpose: Manages UI state when user selects items in any list. Updates button states based
-                 on selection context and clears conflicting selections to prevent invalid operations.
+        Purpose: Marks the button states for the next frame's update when the user selects
+                 items in any list (see updateSelectionState()), so moving through a list
+                 updates them at most once per frame.
     */
     void onBookSelected();
 
+    /*
+        Function: flushRefresh
+        Purpose: Runs the pending updates immediately instead of at the end of the frame
+                 (before the first paint, and in benchmarks)
+    */
+    void flushRefresh();
+
+    /*
+        Function: applyRefresh
+        Purpose: Runs the updates RefreshScheduler found due: catalogue, then account
+                 panel, then button states, each at most once
+        Parameters:
+          in: int panes - RefreshScheduler::Pane flags
+    */
+    void applyRefresh(int panes);
+
     /*
         Function: borrowSelectedBook
         Purpose: Processes book borrowing with full business rule validation. Updates database
@@ -128,6 +200,14 @@ private slots:
     */
     void borrowSelectedBook();
 
+    /*
+        Function: borrowScanned
+        Purpose: Scan-to-borrow. Borrows the copy barcode or ISBN entered in the scan
+                 field in one repository call (see tryBorrowScanned()), without reading
+                 or selecting the catalogue first, then refreshes the panels.
+    */
+    void borrowScanned();
+
     /*
         Function: returnSelectedBook
         Purpose: Handles book returns and triggers hold fulfillment if applicable. Updates database
@@ -137,8 +217,8 @@ private slots:
 
     /*
         Function: refreshAccountStatus
-        Purpose: Updates the account panel with current borrowing and hold status from database.
-                 Synchronizes in-memory user state with persistent database records.
+        Purpose: Marks the account panel and button states for the next frame's update
+                 (see rebuildAccountPanel()).
     */
     void refreshAccountStatus();
 
@@ -171,6 +251,20 @@ private slots:
     */
     void showItemDetails();
 
+    /*
+        Function: showShelfBrowser
+        Purpose: Opens the shelf browser, which lists non-fiction items in Dewey call
+                 number order for a chosen class or range.
+    */
+    void showShelfBrowser();
+
+    /*
+        Function: clearFilters
+        Purpose: Resets every facet and the year range to "any" and shows the whole
+                 catalogue again.
+    */
+    void clearFilters();
+
     // Librarian Administrative Functions
     /*
         Function: showAddItemDialog
@@ -203,17 +297,41 @@ private slots:
     */
     void processPatronReturn(int patronId, int itemId);
 
+    /*
+        Function: showDiagnosticsDialog
+        Purpose: Opens the diagnostics dialog with per-operation and per-statement
+                 latency statistics collected by PerformanceMonitor.
+    */
+    void showDiagnosticsDialog();
+
+    /*
+        Function: showAnalyticsDialog
+        Purpose: Opens the circulation dashboard (most borrowed items, turnover per
+                 format and Dewey class, hold waits and queue depths).
+    */
+    void showAnalyticsDialog();
+
 private:
     User* currentUser;
+    IDataRepository::AccountSnapshot account;
 
     // Core UI Components
     QListWidget *bookListWidget;
+    std::vector<LibraryItem*> catalogue;
+    QHash<int, LibraryItem*> catalogueById;
+    RefreshScheduler *refreshScheduler;
+    QComboBox *facetCombos[IDataRepository::FacetCount];
+    QSpinBox *fromYearSpin;
+    QSpinBox *toYearSpin;
+    QLabel *filterStatusLabel;
     QPushButton *borrowButton;
     QLabel *accountStatusLabel;
     QListWidget *borrowedItemsList;
     QPushButton *returnButton;
     QPushButton *holdButton;
     QPushButton *cancelHoldButton;
+    QPushButton *shelfButton;
+    QLineEdit *scanInput;
     QListWidget *holdsList;
 
     // Librarian UI Components
@@ -221,6 +339,8 @@ private:
     QPushButton* addItemButton;
     QPushButton* removeItemButton;
     QPushButton* returnForPatronButton;
+    QPushButton* diagnosticsButton;
+    QPushButton* analyticsButton;
 
     /*
         Function: setupLibrarianUI
@@ -239,12 +359,42 @@ private:
 
     /*
         Function: getSelectedBook
-        Purpose: Retrieves the LibraryItem pointer for selected catalogue item by querying
-                 database based on list position.
-        Return: LibraryItem* - Selected book or nullptr if no valid selection
+        Purpose: Retrieves the LibraryItem pointer for selected catalogue item: the item
+                 ID stored on the selected row, looked up in catalogueById (O(1), no
+                 database access; a filter hiding rows does not matter).
+        Return: LibraryItem* - Selected book (owned by the window until the next refresh)
+                or nullptr if no valid selection
     */
     LibraryItem* getSelectedBook();
 
+    /*
+        Function: currentFilter
+        Purpose: Reads the facet combo boxes and year range into a filter
+        Return: IDataRepository::FacetFilter - Values chosen in the filter panel
+    */
+    IDataRepository::FacetFilter currentFilter() const;
+
+    /*
+        Function: populateFacets
+        Purpose: Refills each facet combo box with the values and counts from a facet
+                 query, keeping the current choice. Signals are blocked meanwhile so
+                 refilling does not trigger another refresh.
+        Parameters:
+          in: const IDataRepository::FacetResult& facets - Counts under the current filter
+    */
+    void populateFacets(const IDataRepository::FacetResult& facets);
+
+    /*
+        Function: facetLabel
+        Purpose: Maps a stored facet value to its display text ("fiction" is shown as
+                 "Fiction Book", availability as "Available" / "Checked Out")
+        Parameters:
+          in: int facet - IDataRepository::Facet
+          in: const QString& value - Value as stored
+        Return: QString - Display text
+    */
+    static QString facetLabel(int facet, const QString& value);
+
     /*
         Function: getSelectedBorrowedItem
         Purpose: Gets the LibraryItem pointer for selected borrowed book from user's
@@ -253,6 +403,53 @@ private:
     */
     LibraryItem* getSelectedBorrowedItem();
 
+    /*
+        Function: userHasHoldOn
+        Purpose: Checks the account snapshot for a hold on the item, so a patron can
+                 pick up a copy waiting on the hold shelf while none is on the open shelf
+        Parameters:
+          in: LibraryItem* item - Catalogue item
+        Return: bool - True if the current user has a hold on the item
+    */
+    bool userHasHoldOn(LibraryItem* item) const;
+
+    /*
+        Function: dueText
+        Purpose: Formats a loan's due date for the borrowed items list, flagging
+                 overdue loans
+        Parameters:
+          in: const QString& dueDate - Due date as stored (yyyy-MM-dd)
+        Return: QString - Suffix such as " (Due 2024-05-02, in 3 days)"
+    */
+    static QString dueText(const QString& dueDate);
+
+    /*
+        Function: rebuildCatalogue
+        Purpose: Updates the catalogue display with current availability and hold counts from database.
+                 Repopulates book list and updates visual status indicators. Synchronizes in-memory
+                 state with database persistence layer. Shows only the items matching the filter
+                 panel, and refreshes the per-value counts shown in it.
+        Parameters:
+          out: std::vector<LibraryItem*>& previousCatalogue - Items of the last refresh, for the
+               caller to free once the account panel no longer points at them
+    */
+    void rebuildCatalogue(std::vector<LibraryItem*>& previousCatalogue);
+
+    /*
+        Function: rebuildAccountPanel
+        Purpose: Updates the account panel with current borrowing and hold status from database.
+                 Synchronizes in-memory user state with persistent database records. Uses the
+                 snapshot preloaded at login the first time, then one snapshot per refresh.
+    */
+    void rebuildAccountPanel();
+
+    /*
+        Function: updateSelectionState
+        Purpose: Manages UI state for the selections in every list. Updates button states based
+                 on selection context to prevent invalid operations.
+    */
+    void updateSelectionState();
+
     /*
         Function: updateHoldButtons
         Purpose: Manages enable/disable states for hold-related buttons based on current
@@ -1,5 +1,5 @@
 #include "PatronReturnDialog.h"
-#include "DatabaseManager.h"
+#include "IDataRepository.h"
 
 
 PatronReturnDialog::PatronReturnDialog(User* patron, QWidget *parent)
@@ -33,7 +33,7 @@ PatronReturnDialog::~PatronReturnDialog() {
 }
 
 void PatronReturnDialog::loadBorrowedItems() {
-    patronLoans = DatabaseManager::getInstance().getUserLoansWithDates(currentPatron->id);
+    patronLoans = IDataRepository::getInstance().getUserLoansWithDates(currentPatron->id);
 
     for (const auto& loan : patronLoans) {
         QString displayText = QString::fromStdString(loan.item->getDisplayText());
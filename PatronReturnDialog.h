@@ -8,7 +8,7 @@
 #include <QDialogButtonBox>
 #include "User.h"
 #include "LibraryItem.h"
-#include "DatabaseManager.h"
+#include "IDataRepository.h"
 
 /*
     PatronReturnDialog Class:
@@ -64,11 +64,11 @@ public:
 private:
     User* currentPatron;
     QListWidget *itemsList;
-    std::vector<DatabaseManager::LoanInfo> patronLoans;
+    std::vector<IDataRepository::LoanInfo> patronLoans;
 
     /*
         Function: loadBorrowedItems
-        Purpose: Queries the DatabaseManager to load all currently borrowed items
+        Purpose: Queries the data repository to load all currently borrowed items
                  for the current patron. Populates the visual list and internal
                  storage with the retrieved items.
     */
@@ -1,8 +1,9 @@
+#include <QScrollBar>
 #include "PatronSelectionDialog.h"
-#include "DatabaseManager.h"
+#include "IDataRepository.h"
 
 
-PatronSelectionDialog::PatronSelectionDialog(QWidget *parent) : QDialog(parent) {
+PatronSelectionDialog::PatronSelectionDialog(QWidget *parent) : QDialog(parent), allLoaded(false) {
     setWindowTitle("Select Patron");
     setFixedSize(300, 400);
 
@@ -11,7 +12,13 @@ PatronSelectionDialog::PatronSelectionDialog(QWidget *parent) : QDialog(parent)
     QLabel *label = new QLabel("Select a patron:");
     layout->addWidget(label);
 
+    searchInput = new QLineEdit();
+    searchInput->setPlaceholderText("Search username or card number");
+    searchInput->setClearButtonEnabled(true);
+    layout->addWidget(searchInput);
+
     patronList = new QListWidget();
+    patronList->setUniformItemSizes(true);
     layout->addWidget(patronList);
 
     QDialogButtonBox *buttonBox = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel);
@@ -19,22 +26,55 @@ PatronSelectionDialog::PatronSelectionDialog(QWidget *parent) : QDialog(parent)
 
     connect(buttonBox, &QDialogButtonBox::accepted, this, &QDialog::accept);
     connect(buttonBox, &QDialogButtonBox::rejected, this, &QDialog::reject);
+    connect(searchInput, &QLineEdit::textChanged, this, &PatronSelectionDialog::onSearchChanged);
+    connect(patronList->verticalScrollBar(), &QScrollBar::valueChanged, this, &PatronSelectionDialog::onScrolled);
 
     loadPatrons();
 }
 
+PatronSelectionDialog::~PatronSelectionDialog() {
+    clearPatrons();
+}
+
 void PatronSelectionDialog::loadPatrons() {
-    // Get all users and filter for patrons
-    auto allUsers = DatabaseManager::getInstance().getAllUsers();
-
-    for (auto user : allUsers) {
-        if (user->role == "patron") {
-            allPatrons.push_back(user);
-            QString displayText = QString("%1 (ID: %2)").arg(QString::fromStdString(user->name)).arg(user->id);
-            patronList->addItem(displayText);
-        } else {
-            delete user; // Clean up non-patrons
-        }
+    if (allLoaded) return;
+
+    // Keyset pagination: continue after the last username already shown
+    QString afterUsername;
+    if (!allPatrons.isEmpty()) {
+        afterUsername = QString::fromStdString(allPatrons.last()->name);
+    }
+
+    auto page = IDataRepository::getInstance().searchPatrons(
+        searchInput->text().trimmed(), afterUsername, PAGE_SIZE);
+
+    for (auto user : page) {
+        allPatrons.push_back(user);
+        QString displayText = QString("%1 (ID: %2)").arg(QString::fromStdString(user->name)).arg(user->id);
+        patronList->addItem(displayText);
+    }
+
+    // A numeric filter may add one card number match on top of a full page
+    allLoaded = page.size() < PAGE_SIZE;
+}
+
+void PatronSelectionDialog::clearPatrons() {
+    patronList->clear();
+    for (auto user : allPatrons) {
+        delete user;
+    }
+    allPatrons.clear();
+    allLoaded = false;
+}
+
+void PatronSelectionDialog::onSearchChanged() {
+    clearPatrons();
+    loadPatrons();
+}
+
+void PatronSelectionDialog::onScrolled(int value) {
+    if (value == patronList->verticalScrollBar()->maximum()) {
+        loadPatrons();
     }
 }
 
@@ -6,6 +6,7 @@
 #include <QVBoxLayout>
 #include <QLabel>
 #include <QDialogButtonBox>
+#include <QLineEdit>
 #include "User.h"
 
 /*
@@ -21,21 +22,28 @@
     - Filter and display only patron accounts (excludes librarians/admins)
 
     UI Design:
-    - Simple list-based selection interface
+    - Search-as-you-type box matching username prefix or card number
+    - Simple list-based selection interface, loaded one page at a time as the user scrolls
     - Clear labeling and intuitive selection mechanism
     - Standard dialog buttons (OK/Cancel) for user confirmation
 
     Data Members:
-      - QListWidget* patronList: Visual list displaying all patron accounts
-      - QList<User*> allPatrons: Internal collection of patron user objects
+      - QLineEdit* searchInput: Username prefix / card number filter
+      - QListWidget* patronList: Visual list displaying the loaded patron accounts
+      - QList<User*> allPatrons: Internal collection of loaded patron user objects
+      - bool allLoaded: True once the last page for the current filter has been fetched
 
     Member Functions:
       Public:
       - PatronSelectionDialog(): Constructs and initializes the dialog
+      - ~PatronSelectionDialog(): Frees the loaded patron objects
       - getSelectedPatron(): Returns the user-selected patron object
 
       Private:
-        - loadPatrons(): Populates the list with patron accounts from database
+        - loadPatrons(): Appends the next page of matching patrons from the database
+        - clearPatrons(): Drops all loaded patrons before a new search
+        - onSearchChanged(): Restarts the listing for the new filter text
+        - onScrolled(): Fetches the next page when the list is scrolled to the bottom
 */
 class PatronSelectionDialog : public QDialog {
     Q_OBJECT
@@ -52,6 +60,13 @@ public:
     */
     PatronSelectionDialog(QWidget *parent = nullptr);
 
+    /*
+        Function: ~PatronSelectionDialog
+        Purpose: Frees the patron objects loaded from the database. Pointers returned
+                 by getSelectedPatron() are only valid while the dialog exists.
+    */
+    ~PatronSelectionDialog();
+
     /*
         Function: getSelectedPatron
         Purpose: Retrieves the patron selected by the user in the dialog. Returns the
@@ -62,18 +77,45 @@ public:
     */
     User* getSelectedPatron() const;
 
+private slots:
+    /*
+        Function: onSearchChanged
+        Purpose: Clears the current listing and loads the first page matching the new
+                 filter text. Connected to the search box for search-as-you-type.
+    */
+    void onSearchChanged();
+
+    /*
+        Function: onScrolled
+        Purpose: Loads the next page once the list has been scrolled to the bottom.
+        Parameters:
+          in: int value - New vertical scroll bar position
+    */
+    void onScrolled(int value);
+
 private:
+    static const int PAGE_SIZE = 50;
+
+    QLineEdit *searchInput;     // Username prefix / card number filter
     QListWidget *patronList;    // Visual list widget displaying patron accounts
     QList<User*> allPatrons;    // Internal collection of patron user objects
+    bool allLoaded;             // No more pages for the current filter
 
     /*
         Function: loadPatrons
-        Purpose: Internal method that queries the database for all user accounts and
-                 filters them to display only patrons (excluding librarians and admins).
-                 Populates both the visual list and internal collection with appropriate
-                 display formatting that includes patron names and IDs.
+        Purpose: Internal method that fetches the next page of patrons matching the
+                 search filter from the database (role-filtered and indexed, so only
+                 patron accounts are ever loaded). Appends to both the visual list and
+                 internal collection with display formatting that includes patron
+                 names and IDs.
     */
     void loadPatrons();
+
+    /*
+        Function: clearPatrons
+        Purpose: Frees all loaded patrons and empties the visual list.
+    */
+    void clearPatrons();
 };
 
 #endif
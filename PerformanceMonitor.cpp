@@ -0,0 +1,413 @@
+#include <QDebug>
+#include <QDateTime>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QSaveFile>
+#include <QPair>
+#include <QtAlgorithms>
+#include <algorithm>
+#include <cstring>
+#include "PerformanceMonitor.h"
+
+// === LATENCY HISTOGRAM ===
+
+int LatencyHistogram::bucketIndex(quint64 value) {
+    if (value < quint64(SUB_BUCKETS)) {
+        return int(value); // Exact buckets below the first power-of-two split
+    }
+
+    // Keep the top SUB_BUCKET_BITS + 1 bits: exponent picks the row, mantissa the column
+    int msb = 63 - int(qCountLeadingZeroBits(value));
+    int exponent = msb - SUB_BUCKET_BITS;
+    int mantissa = int(value >> exponent);
+    return (exponent + 1) * SUB_BUCKETS + (mantissa - SUB_BUCKETS);
+}
+
+qint64 LatencyHistogram::bucketMidpoint(int index) {
+    if (index < SUB_BUCKETS) {
+        return index;
+    }
+
+    int exponent = index / SUB_BUCKETS - 1;
+    qint64 mantissa = SUB_BUCKETS + index % SUB_BUCKETS;
+    qint64 lower = mantissa << exponent;
+    return lower + ((qint64(1) << exponent) >> 1);
+}
+
+void LatencyHistogram::record(qint64 nanos) {
+    if (nanos < 0) nanos = 0;
+
+    counts[bucketIndex(quint64(nanos))]++;
+    totalCount++;
+    totalNanos += nanos;
+    if (nanos > maxNanos) maxNanos = nanos;
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    for (int i = 0; i < BUCKET_COUNT; ++i) {
+        counts[i] += other.counts[i];
+    }
+    totalCount += other.totalCount;
+    totalNanos += other.totalNanos;
+    if (other.maxNanos > maxNanos) maxNanos = other.maxNanos;
+}
+
+qint64 LatencyHistogram::valueAtPercentile(double percentile) const {
+    if (totalCount == 0) return 0;
+
+    percentile = std::min(100.0, std::max(0.0, percentile));
+    quint64 target = quint64(percentile / 100.0 * double(totalCount) + 0.5);
+    if (target == 0) target = 1;
+
+    quint64 seen = 0;
+    for (int i = 0; i < BUCKET_COUNT; ++i) {
+        seen += counts[i];
+        if (seen >= target) {
+            return std::min(bucketMidpoint(i), maxNanos);
+        }
+    }
+    return maxNanos;
+}
+
+void LatencyHistogram::reset() {
+    std::memset(counts, 0, sizeof(counts));
+    totalCount = 0;
+    totalNanos = 0;
+    maxNanos = 0;
+}
+
+
+// === PERFORMANCE MONITOR ===
+
+PerformanceMonitor* PerformanceMonitor::instance = nullptr;
+
+/*
+    ThreadStatsOwner Struct:
+    Holds the calling thread's statistics; when the thread exits its samples are folded
+    into the monitor's retired statistics so summaries keep them.
+*/
+struct ThreadStatsOwner {
+    PerformanceMonitor::ThreadStats* stats;
+
+    ThreadStatsOwner() : stats(nullptr) {}
+    ~ThreadStatsOwner() {
+        if (stats) PerformanceMonitor::getInstance().retire(stats);
+    }
+};
+
+namespace {
+    thread_local ThreadStatsOwner localOwner;
+}
+
+void PerformanceMonitor::OperationStats::merge(const OperationStats& other) {
+    errors += other.errors;
+    busyErrors += other.busyErrors;
+    histogram.merge(other.histogram);
+}
+
+PerformanceMonitor::PerformanceMonitor() : enabled(true), dirty(false) {
+    connect(&dumpTimer, &QTimer::timeout, this, &PerformanceMonitor::dumpIfChanged);
+}
+
+PerformanceMonitor::~PerformanceMonitor() {
+}
+
+PerformanceMonitor& PerformanceMonitor::getInstance() {
+    // Every ScopedTimer calls this; a function-local static gives thread-safe
+    // initialization without taking a lock on each call
+    static PerformanceMonitor* created = (instance = new PerformanceMonitor());
+    return *created;
+}
+
+PerformanceMonitor::Key PerformanceMonitor::resolve(const QString& operation, const QString& statement) {
+    QString name = operation + QChar('\n') + statement;
+
+    QMutexLocker locker(&mutex);
+    auto found = keys.constFind(name);
+    if (found != keys.constEnd()) return found.value();
+
+    Key key = Key(names.size());
+    KeyName keyName = {operation, statement};
+    names.push_back(keyName);
+    keys.insert(name, key);
+    return key;
+}
+
+PerformanceMonitor::Key PerformanceMonitor::resolve(Key operation, const QString& statement) {
+    QString operationName("query");
+    {
+        QMutexLocker locker(&mutex);
+        if (operation >= 0 && operation < Key(names.size())) operationName = names[operation].operation;
+    }
+    return resolve(operationName, statement);
+}
+
+PerformanceMonitor::ThreadStats& PerformanceMonitor::localStats() {
+    ThreadStats*& local = localOwner.stats;
+    if (!local) {
+        local = new ThreadStats();
+        QMutexLocker locker(&mutex);
+        threads.push_back(local);
+    }
+    return *local;
+}
+
+void PerformanceMonitor::retire(ThreadStats* local) {
+    QMutexLocker locker(&mutex);
+    threads.erase(std::remove(threads.begin(), threads.end(), local), threads.end());
+
+    if (retired.stats.size() < local->stats.size()) retired.stats.resize(local->stats.size(), nullptr);
+    for (size_t key = 0; key < local->stats.size(); ++key) {
+        if (!local->stats[key]) continue;
+        if (!retired.stats[key]) retired.stats[key] = new OperationStats();
+        retired.stats[key]->merge(*local->stats[key]);
+    }
+    delete local;
+}
+
+void PerformanceMonitor::record(Key key, qint64 nanos, bool ok, bool busy) {
+    if (!enabled || key < 0) return;
+
+    ThreadStats& local = localStats();
+    {
+        QMutexLocker locker(&local.mutex);
+        if (key >= Key(local.stats.size())) local.stats.resize(key + 1, nullptr);
+
+        OperationStats*& entry = local.stats[key];
+        if (!entry) entry = new OperationStats();
+        entry->histogram.record(nanos);
+        if (!ok) entry->errors++;
+        if (busy) entry->busyErrors++;
+    }
+
+    // Read first: after the first sample the flag's cache line stays shared
+    if (!dirty.load(std::memory_order_relaxed)) dirty = true;
+}
+
+std::vector<PerformanceMonitor::OperationStats> PerformanceMonitor::merged() {
+    std::vector<OperationStats> all(names.size());
+
+    auto add = [&all](const std::vector<OperationStats*>& stats) {
+        for (size_t key = 0; key < stats.size() && key < all.size(); ++key) {
+            if (stats[key]) all[key].merge(*stats[key]);
+        }
+    };
+    add(retired.stats);
+    for (ThreadStats* local : threads) {
+        QMutexLocker localLocker(&local->mutex);
+        add(local->stats);
+    }
+    return all;
+}
+
+std::vector<PerformanceMonitor::Summary> PerformanceMonitor::getSummaries() {
+    std::vector<Summary> summaries;
+
+    {
+        QMutexLocker locker(&mutex);
+        std::vector<OperationStats> all = merged();
+        for (size_t key = 0; key < all.size(); ++key) {
+            const OperationStats& entry = all[key];
+            const LatencyHistogram& h = entry.histogram;
+            if (h.getCount() == 0) continue;
+
+            Summary summary;
+            summary.operation = names[key].operation;
+            summary.statement = names[key].statement;
+            summary.count = h.getCount();
+            summary.errors = entry.errors;
+            summary.busyErrors = entry.busyErrors;
+            summary.mean = h.getMean();
+            summary.p50 = h.valueAtPercentile(50.0);
+            summary.p90 = h.valueAtPercentile(90.0);
+            summary.p99 = h.valueAtPercentile(99.0);
+            summary.p999 = h.valueAtPercentile(99.9);
+            summary.max = h.getMax();
+            summaries.push_back(summary);
+        }
+    }
+
+    std::sort(summaries.begin(), summaries.end(), [](const Summary& a, const Summary& b) {
+        if (a.operation != b.operation) return a.operation < b.operation;
+        return a.statement < b.statement;
+    });
+    return summaries;
+}
+
+void PerformanceMonitor::reset() {
+    // Keys stay valid (timers cache them); only the samples are dropped
+    QMutexLocker locker(&mutex);
+    for (ThreadStats* local : threads) {
+        QMutexLocker localLocker(&local->mutex);
+        qDeleteAll(local->stats);
+        local->stats.clear();
+    }
+    qDeleteAll(retired.stats);
+    retired.stats.clear();
+    dirty = true;
+}
+
+QJsonObject PerformanceMonitor::toJson() {
+    QJsonArray operations;
+
+    QMutexLocker locker(&mutex);
+    std::vector<OperationStats> all = merged();
+    for (size_t key = 0; key < all.size(); ++key) {
+        const OperationStats& entry = all[key];
+        const LatencyHistogram& h = entry.histogram;
+        if (h.getCount() == 0) continue;
+
+        // Sparse histogram: [bucketMidpointNanos, count] for non-empty buckets only
+        QJsonArray buckets;
+        for (int i = 0; i < LatencyHistogram::BUCKET_COUNT; ++i) {
+            if (h.getBucketCount(i) == 0) continue;
+            QJsonArray bucket;
+            bucket.append(double(LatencyHistogram::bucketMidpoint(i)));
+            bucket.append(double(h.getBucketCount(i)));
+            buckets.append(bucket);
+        }
+
+        QJsonObject op;
+        op["operation"] = names[key].operation;
+        op["statement"] = names[key].statement;
+        op["count"] = double(h.getCount());
+        op["errors"] = double(entry.errors);
+        op["busyErrors"] = double(entry.busyErrors);
+        op["meanNs"] = double(h.getMean());
+        op["p50Ns"] = double(h.valueAtPercentile(50.0));
+        op["p90Ns"] = double(h.valueAtPercentile(90.0));
+        op["p99Ns"] = double(h.valueAtPercentile(99.0));
+        op["p999Ns"] = double(h.valueAtPercentile(99.9));
+        op["maxNs"] = double(h.getMax());
+        op["histogram"] = buckets;
+        operations.append(op);
+    }
+
+    QJsonObject root;
+    root["generatedAt"] = QDateTime::currentDateTime().toString(Qt::ISODate);
+    root["enabled"] = enabled.load();
+    root["operations"] = operations;
+    return root;
+}
+
+bool PerformanceMonitor::writeJson(const QString& path) {
+    QByteArray json = QJsonDocument(toJson()).toJson(QJsonDocument::Indented);
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qDebug() << "Error opening metrics dump file:" << file.errorString();
+        return false;
+    }
+    file.write(json);
+    if (!file.commit()) {
+        qDebug() << "Error writing metrics dump file:" << file.errorString();
+        return false;
+    }
+    return true;
+}
+
+void PerformanceMonitor::startPeriodicDump(const QString& path, int intervalMs) {
+    dumpPath = path;
+    dumpTimer.start(intervalMs);
+}
+
+void PerformanceMonitor::stopPeriodicDump() {
+    dumpTimer.stop();
+    dumpIfChanged();
+}
+
+void PerformanceMonitor::dumpIfChanged() {
+    if (dumpPath.isEmpty()) return;
+    if (!dirty.exchange(false)) return;
+    writeJson(dumpPath);
+}
+
+
+// === SCOPED TIMER ===
+
+namespace {
+    thread_local ScopedTimer* innermostTimer = nullptr;
+
+    // Keys cached per thread: operation timers by the addresses of their literals,
+    // statement timers by enclosing operation and the address of their SQL literal
+    typedef QPair<const void*, const void*> TimerSite;
+    typedef QPair<int, const void*> StatementSite;
+    thread_local QHash<TimerSite, PerformanceMonitor::Key> siteKeys;
+    thread_local QHash<StatementSite, PerformanceMonitor::Key> statementKeys;
+
+    // SQL built at run time, by text; cleared when full so varying IN lists stay bounded
+    const int MAX_BUILT_STATEMENTS = 1024;
+    thread_local QHash<QPair<int, QString>, PerformanceMonitor::Key> builtStatementKeys;
+}
+
+ScopedTimer::ScopedTimer(const char* operation, const char* statement)
+    : key(-1), active(false), ok(true), busy(false), parent(innermostTimer) {
+    innermostTimer = this;
+
+    TimerSite site(operation, statement);
+    auto found = siteKeys.constFind(site);
+    if (found != siteKeys.constEnd()) {
+        key = found.value();
+    } else {
+        key = PerformanceMonitor::getInstance().resolve(QString(operation), QString(statement));
+        siteKeys.insert(site, key);
+    }
+
+    if (PerformanceMonitor::getInstance().isEnabled()) {
+        active = true;
+        timer.start();
+    }
+}
+
+ScopedTimer::ScopedTimer(PerformanceMonitor::Key key)
+    : key(key), active(false), ok(true), busy(false), parent(innermostTimer) {
+    innermostTimer = this;
+
+    if (PerformanceMonitor::getInstance().isEnabled()) {
+        active = true;
+        timer.start();
+    }
+}
+
+ScopedTimer::~ScopedTimer() {
+    if (active) {
+        PerformanceMonitor::getInstance().record(key, timer.nsecsElapsed(), ok, busy);
+    }
+    innermostTimer = parent;
+}
+
+PerformanceMonitor::Key ScopedTimer::statementKey(const char* sql) {
+    PerformanceMonitor::Key operation = innermostTimer ? innermostTimer->key : -1;
+
+    StatementSite site(operation, sql);
+    auto found = statementKeys.constFind(site);
+    if (found != statementKeys.constEnd()) return found.value();
+
+    PerformanceMonitor::Key key = PerformanceMonitor::getInstance().resolve(operation, QString(sql));
+    statementKeys.insert(site, key);
+    return key;
+}
+
+PerformanceMonitor::Key ScopedTimer::statementKey(const QString& sql) {
+    PerformanceMonitor::Key operation = innermostTimer ? innermostTimer->key : -1;
+
+    QPair<int, QString> built(operation, sql);
+    auto found = builtStatementKeys.constFind(built);
+    if (found != builtStatementKeys.constEnd()) return found.value();
+
+    if (builtStatementKeys.size() >= MAX_BUILT_STATEMENTS) builtStatementKeys.clear();
+    PerformanceMonitor::Key key = PerformanceMonitor::getInstance().resolve(operation, sql);
+    builtStatementKeys.insert(built, key);
+    return key;
+}
+
+void ScopedTimer::fail(bool isBusy) {
+    for (ScopedTimer* t = this; t; t = t->parent) {
+        t->ok = false;
+        t->busy = t->busy || isBusy;
+    }
+}
+
+ScopedTimer* ScopedTimer::current() {
+    return innermostTimer;
+}
@@ -0,0 +1,376 @@
+#ifndef PERFORMANCEMONITOR_H
+#define PERFORMANCEMONITOR_H
+
+#include <QObject>
+#include <QString>
+#include <QHash>
+#include <QMutex>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <vector>
+#include <atomic>
+
+/*
+    LatencyHistogram Class:
+    Fixed-size, HDR-style latency histogram. Values (nanoseconds) are bucketed
+    log-linearly: each power of two is split into SUB_BUCKETS equal sub-buckets, so
+    every recorded value is kept to within ~6% relative precision with a constant
+    8 KB footprint and O(1) recording (no allocation, no sorting).
+
+    Data Members:
+      - quint64 counts[BUCKET_COUNT]: Number of samples per bucket
+      - quint64 totalCount: Number of samples recorded
+      - qint64 totalNanos: Sum of all samples (for the mean)
+      - qint64 maxNanos: Largest sample recorded
+
+    Member Functions:
+      - record(): Adds one sample
+      - merge(): Adds every sample of another histogram
+      - valueAtPercentile(): Estimates the value at a percentile (0-100)
+      - getCount() / getMean() / getMax() / getBucketCount(): Summary accessors
+      - reset(): Clears all samples
+*/
+class LatencyHistogram {
+public:
+    static const int SUB_BUCKET_BITS = 4;
+    static const int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static const int BUCKET_COUNT = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+    LatencyHistogram() { reset(); }
+
+    /*
+        Function: record
+        Purpose: Adds one latency sample to its log-linear bucket
+        Parameters:
+          in: qint64 nanos - Sample in nanoseconds (negative values count as 0)
+    */
+    void record(qint64 nanos);
+
+    /*
+        Function: merge
+        Purpose: Adds all samples of another histogram (e.g. combining per-thread results)
+        Parameters:
+          in: const LatencyHistogram& other - Histogram to add
+    */
+    void merge(const LatencyHistogram& other);
+
+    /*
+        Function: valueAtPercentile
+        Purpose: Estimates the latency at or below which the given share of samples fall
+        Parameters:
+          in: double percentile - Percentile in the range 0-100
+        Return: qint64 - Estimated latency in nanoseconds (0 if empty)
+    */
+    qint64 valueAtPercentile(double percentile) const;
+
+    quint64 getCount() const { return totalCount; }
+    qint64 getMean() const { return totalCount ? totalNanos / qint64(totalCount) : 0; }
+    qint64 getMax() const { return maxNanos; }
+    quint64 getBucketCount(int index) const { return counts[index]; }
+
+    /*
+        Function: reset
+        Purpose: Discards every recorded sample
+    */
+    void reset();
+
+    /*
+        Function: bucketIndex / bucketMidpoint
+        Purpose: Map a value to its bucket and a bucket back to a representative value
+    */
+    static int bucketIndex(quint64 value);
+    static qint64 bucketMidpoint(int index);
+
+private:
+    quint64 counts[BUCKET_COUNT];
+    quint64 totalCount;
+    qint64 totalNanos;
+    qint64 maxNanos;
+};
+
+/*
+    PerformanceMonitor Class:
+    Singleton that collects hot-path timing for the data layer. Every DatabaseManager
+    operation and every SQL statement it executes is timed by a ScopedTimer and
+    recorded here, keyed by (operation, statement), with call count, error count,
+    SQLITE_BUSY/LOCKED contention count and a LatencyHistogram.
+
+    Each (operation, statement) pair is resolved to a small integer Key once, under
+    the mutex; a sample is then recorded by Key into statistics owned by the recording
+    thread. A sample so costs two monotonic clock reads, an array index and a lock on
+    the thread's own statistics, which no other thread takes except while a summary
+    or dump is being built. Summaries merge every thread's statistics (and those of
+    threads that have exited). When disabled the timers skip recording entirely.
+
+    Data Members:
+      - QHash<QString, Key> keys: Resolved keys by operation and statement
+      - std::vector<KeyName> names: Operation and statement of each key
+      - std::vector<ThreadStats*> threads: Statistics of every live recording thread
+      - ThreadStats retired: Statistics left by threads that have exited
+      - QMutex mutex: Guards keys, names, threads and retired
+      - bool enabled: Whether timers record anything
+      - bool dirty: True if anything was recorded since the last dump
+      - QTimer dumpTimer: Drives the periodic JSON dump
+      - QString dumpPath: File the periodic dump is written to
+      - static PerformanceMonitor* instance: Singleton instance pointer
+
+    Member Functions:
+      Public:
+        - getInstance(): Provides global access to singleton instance
+        - setEnabled() / isEnabled(): Turn recording on or off
+        - resolve(): Key of an operation/statement pair
+        - record(): Adds one timed sample
+        - getSummaries(): Copies out per-key summaries for display
+        - reset(): Clears all statistics
+        - toJson(): Serializes all statistics including histogram buckets
+        - writeJson(): Writes toJson() to a file atomically
+        - startPeriodicDump() / stopPeriodicDump(): Control the JSON dump timer
+        - getDumpPath(): File used by the periodic dump
+
+      Private:
+        - localStats(): The calling thread's statistics, registered on first use
+        - retire(): Folds an exiting thread's statistics into retired
+        - merged(): Every thread's statistics added together, by key (mutex held)
+
+      Private Slots:
+        - dumpIfChanged(): Timer callback that writes the dump when data changed
+*/
+class PerformanceMonitor : public QObject {
+    Q_OBJECT
+
+public:
+    /*
+        Summary Struct:
+        Point-in-time copy of the statistics for one (operation, statement) key.
+        Latencies are in nanoseconds.
+    */
+    struct Summary {
+        QString operation;
+        QString statement;
+        quint64 count;
+        quint64 errors;
+        quint64 busyErrors;
+        qint64 mean;
+        qint64 p50;
+        qint64 p90;
+        qint64 p99;
+        qint64 p999;
+        qint64 max;
+    };
+
+    /*
+        Function: getInstance
+        Purpose: Provides global access to the singleton PerformanceMonitor instance.
+        Return: PerformanceMonitor& - Reference to the singleton instance
+    */
+    static PerformanceMonitor& getInstance();
+
+    typedef int Key; // Index of a resolved operation/statement pair
+
+    void setEnabled(bool on) { enabled = on; }
+    bool isEnabled() const { return enabled; }
+
+    /*
+        Function: resolve
+        Purpose: Looks up (or assigns) the key of an operation/statement pair. Takes the
+                 mutex and hashes both strings, so callers resolve once and keep the key
+                 (ScopedTimer caches it per call site).
+        Parameters:
+          in: const QString& operation - Logical operation (e.g. "borrowItem")
+          in: const QString& statement - SQL text, or empty for the whole operation
+        Return: Key - Key to pass to record()
+    */
+    Key resolve(const QString& operation, const QString& statement);
+
+    /*
+        Function: resolve
+        Purpose: Key of a statement run under an already resolved operation
+        Parameters:
+          in: Key operation - Key of the enclosing operation, or -1 for none ("query")
+          in: const QString& statement - SQL text
+        Return: Key - Key to pass to record()
+    */
+    Key resolve(Key operation, const QString& statement);
+
+    /*
+        Function: record
+        Purpose: Adds one timed sample to the calling thread's statistics for a key
+        Parameters:
+          in: Key key - Key from resolve()
+          in: qint64 nanos - Elapsed time in nanoseconds
+          in: bool ok - False if the operation or statement failed
+          in: bool busy - True if the failure was SQLite lock contention
+    */
+    void record(Key key, qint64 nanos, bool ok, bool busy = false);
+
+    /*
+        Function: record
+        Purpose: Resolves an operation/statement pair and adds one sample; for one-off
+                 measurements (startup, first paint), not hot paths
+    */
+    void record(const QString& operation, const QString& statement, qint64 nanos, bool ok, bool busy = false) {
+        record(resolve(operation, statement), nanos, ok, busy);
+    }
+
+    /*
+        Function: getSummaries
+        Purpose: Copies out a summary of every key, sorted by operation then statement
+        Return: std::vector<Summary> - One entry per (operation, statement) key
+    */
+    std::vector<Summary> getSummaries();
+
+    /*
+        Function: reset
+        Purpose: Clears all collected statistics
+    */
+    void reset();
+
+    /*
+        Function: toJson
+        Purpose: Serializes all statistics, including non-empty histogram buckets
+        Return: QJsonObject - Machine-readable statistics document
+    */
+    QJsonObject toJson();
+
+    /*
+        Function: writeJson
+        Purpose: Writes toJson() to a file, replacing it atomically
+        Parameters:
+          in: const QString& path - Destination file
+        Return: bool - True if the file was written
+    */
+    bool writeJson(const QString& path);
+
+    /*
+        Function: startPeriodicDump
+        Purpose: Writes the JSON dump every intervalMs milliseconds while data changes
+        Parameters:
+          in: const QString& path - Destination file
+          in: int intervalMs - Dump interval in milliseconds
+    */
+    void startPeriodicDump(const QString& path, int intervalMs);
+
+    /*
+        Function: stopPeriodicDump
+        Purpose: Stops the periodic dump after writing any pending data
+    */
+    void stopPeriodicDump();
+
+    QString getDumpPath() const { return dumpPath; }
+
+private slots:
+    /*
+        Function: dumpIfChanged
+        Purpose: Periodic timer callback; writes the dump only if new samples arrived
+    */
+    void dumpIfChanged();
+
+private:
+    struct OperationStats {
+        quint64 errors;
+        quint64 busyErrors;
+        LatencyHistogram histogram;
+
+        OperationStats() : errors(0), busyErrors(0) {}
+        void merge(const OperationStats& other);
+    };
+
+    struct KeyName {
+        QString operation;
+        QString statement;
+    };
+
+    // One thread's statistics, indexed by key (null until the key is first recorded).
+    // The lock is the recording thread's own; others take it only to merge or reset.
+    struct ThreadStats {
+        QMutex mutex;
+        std::vector<OperationStats*> stats;
+
+        ~ThreadStats() { qDeleteAll(stats); }
+    };
+
+    QHash<QString, Key> keys;
+    std::vector<KeyName> names;
+    std::vector<ThreadStats*> threads;
+    ThreadStats retired;
+    QMutex mutex;
+    std::atomic<bool> enabled;
+    std::atomic<bool> dirty;
+    QTimer dumpTimer;
+    QString dumpPath;
+    static PerformanceMonitor* instance;
+
+    PerformanceMonitor(); // Private constructor for singleton
+    ~PerformanceMonitor();
+
+    ThreadStats& localStats();
+    void retire(ThreadStats* local);
+    std::vector<OperationStats> merged();
+
+    friend struct ThreadStatsOwner;
+};
+
+/*
+    ScopedTimer Class:
+    RAII timer that records the lifetime of a scope into PerformanceMonitor. Timers
+    nest per thread: a statement timer marks its enclosing operation timer failed when
+    the statement fails, so operation-level error counts need no manual bookkeeping.
+
+    Operation names are string literals; the key of each (operation, statement) pair
+    is cached per thread by the literals' addresses, so starting a timer does no string
+    work after the first time a thread uses a call site. Statement timers (see
+    DatabaseManager::execQuery()) are cached the same way when the caller passes the
+    string literal the statement was prepared from; SQL built at run time is looked
+    up by text in a bounded per-thread cache.
+
+    Member Functions:
+      - ScopedTimer(): Starts timing (no-op when the monitor is disabled)
+      - ~ScopedTimer(): Records the elapsed time and restores the enclosing timer
+      - fail(): Marks this scope (and its enclosing scopes) failed
+      - statementKey(): Key of a SQL statement under the innermost operation timer
+      - getKey(): Key this timer records under
+      - current(): Innermost active timer on this thread, or nullptr
+*/
+class ScopedTimer {
+public:
+    ScopedTimer(const char* operation, const char* statement = "");
+    explicit ScopedTimer(PerformanceMonitor::Key key);
+    ~ScopedTimer();
+
+    /*
+        Function: fail
+        Purpose: Marks the timed scope as failed; propagates to enclosing timers
+        Parameters:
+          in: bool busy - True if the failure was SQLITE_BUSY / SQLITE_LOCKED
+    */
+    void fail(bool busy = false);
+
+    /*
+        Function: statementKey
+        Purpose: Key for a SQL statement run under the innermost operation timer (or
+                 under "query" outside any operation)
+        Parameters:
+          in: const char* sql - String literal of a fixed statement (cached by address)
+          in: const QString& sql - Text of a statement built at run time
+        Return: PerformanceMonitor::Key - Key to time the statement under
+    */
+    static PerformanceMonitor::Key statementKey(const char* sql);
+    static PerformanceMonitor::Key statementKey(const QString& sql);
+
+    PerformanceMonitor::Key getKey() const { return key; }
+    static ScopedTimer* current();
+
+private:
+    PerformanceMonitor::Key key;
+    QElapsedTimer timer;
+    bool active;
+    bool ok;
+    bool busy;
+    ScopedTimer* parent;
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+};
+
+#endif
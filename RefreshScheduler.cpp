@@ -0,0 +1,35 @@
+#include "RefreshScheduler.h"
+
+RefreshScheduler::RefreshScheduler(QObject* parent)
+    : QObject(parent), dirty(0), frames(0) {
+    for (int i = 0; i < PANE_COUNT; ++i) {
+        requests[i] = 0;
+        refreshes[i] = 0;
+    }
+    timer.setSingleShot(true);
+    timer.setInterval(FRAME_MS);
+    connect(&timer, &QTimer::timeout, this, &RefreshScheduler::flush);
+}
+
+void RefreshScheduler::invalidate(int panes) {
+    for (int i = 0; i < PANE_COUNT; ++i) {
+        if (panes & (1 << i)) requests[i]++;
+    }
+
+    dirty |= panes;
+    if (dirty && !timer.isActive()) timer.start(); // Later requests join this frame
+}
+
+void RefreshScheduler::flush() {
+    timer.stop();
+    int panes = dirty;
+    if (!panes) return;
+
+    // Cleared first, so requests made by the refresh itself wait for the next frame
+    dirty = 0;
+    frames++;
+    for (int i = 0; i < PANE_COUNT; ++i) {
+        if (panes & (1 << i)) refreshes[i]++;
+    }
+    emit refreshDue(panes);
+}
@@ -0,0 +1,105 @@
+#ifndef REFRESHSCHEDULER_H
+#define REFRESHSCHEDULER_H
+
+#include <QObject>
+#include <QTimer>
+
+/*
+    RefreshScheduler Class:
+    Coalesces the main window's refresh requests. A handler marks the panes it made
+    stale with invalidate() instead of redrawing them; the first mark starts a timer
+    one frame long, and when it fires every pane marked meanwhile is refreshed once
+    (refreshDue()). A click that asks for the catalogue and then the account panel,
+    or a patron arrowing through the catalogue list, so costs at most one update per
+    pane per frame, however many times it was asked for.
+
+    Which panes a request implies (a new catalogue also redraws the account panel)
+    is up to the caller; the scheduler only merges flags. Requests made while a
+    refresh is running are kept for the next frame.
+
+    Counters record, per pane, how often it was requested and how often it was
+    actually refreshed; the difference is the work saved. DiagnosticsDialog shows them.
+
+    Data Members:
+      - QTimer timer: Single-shot frame timer, running while a refresh is pending
+      - int dirty: Panes marked since the last refresh
+      - quint64 requests[] / refreshes[]: Counters per pane
+      - quint64 frames: Refreshes run (each covering one or more panes)
+
+    Member Functions:
+      Public:
+        - RefreshScheduler(): Creates an idle scheduler
+        - invalidate(): Marks panes stale and schedules a refresh
+        - flush(): Refreshes the pending panes now
+        - getRequestCount() / getRefreshCount() / getSavedCount() / getFrameCount(): Counters
+      Signals:
+        - refreshDue(): The panes to refresh now
+*/
+class RefreshScheduler : public QObject {
+    Q_OBJECT
+
+public:
+    enum Pane {
+        Catalogue = 1,
+        Account = 2,
+        Selection = 4  // Button states for the current selections
+    };
+    static const int PANE_COUNT = 3;
+    static const int FRAME_MS = 16; // About one frame at 60 Hz
+
+    /*
+        Function: RefreshScheduler
+        Purpose: Creates an idle scheduler
+        Parameters:
+          in: QObject* parent - Owner (optional)
+    */
+    explicit RefreshScheduler(QObject* parent = nullptr);
+
+    /*
+        Function: invalidate
+        Purpose: Marks panes stale; starts the frame timer unless a refresh is pending
+        Parameters:
+          in: int panes - Pane flags
+    */
+    void invalidate(int panes);
+
+    /*
+        Function: flush
+        Purpose: Refreshes the pending panes immediately (e.g. before the first paint)
+                 instead of at the end of the frame. Does nothing if none are pending.
+    */
+    void flush();
+
+    /*
+        Function: getRequestCount / getRefreshCount / getSavedCount
+        Purpose: Counters for one pane since the scheduler was created
+        Parameters:
+          in: Pane pane - Pane to report
+        Return: quint64 - Times the pane was marked / refreshed / marked without a
+                refresh of its own
+    */
+    quint64 getRequestCount(Pane pane) const { return requests[index(pane)]; }
+    quint64 getRefreshCount(Pane pane) const { return refreshes[index(pane)]; }
+    quint64 getSavedCount(Pane pane) const { return requests[index(pane)] - refreshes[index(pane)]; }
+    quint64 getFrameCount() const { return frames; }
+
+signals:
+    /*
+        Function: refreshDue
+        Purpose: Emitted once per frame with every pane marked since the last one
+        Parameters:
+          out: int panes - Pane flags
+    */
+    void refreshDue(int panes);
+
+private:
+    QTimer timer;
+    int dirty;
+    quint64 requests[PANE_COUNT];
+    quint64 refreshes[PANE_COUNT];
+    quint64 frames;
+
+    static int index(Pane pane) { return pane == Catalogue ? 0 : pane == Account ? 1 : 2; }
+};
+
+#endif
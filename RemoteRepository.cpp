@@ -0,0 +1,317 @@
+#include <QDebug>
+#include <algorithm>
+#include "RemoteRepository.h"
+#include "LibraryProtocol.h"
+
+namespace {
+    // Operations per batch frame; keeps frames well under the protocol limit
+    const size_t MAX_BATCH_ENTRIES = 4096;
+
+    // Result decoders shared by the operations below
+    LibraryClient::ResultReader readBool(bool& value) {
+        return [&value](QDataStream& in) { in >> value; };
+    }
+
+    LibraryClient::ResultReader readInt(int& value) {
+        return [&value](QDataStream& in) {
+            qint32 decoded = 0;
+            in >> decoded;
+            value = decoded;
+        };
+    }
+
+    LibraryClient::ResultReader readWriteResult(IDataRepository::WriteResult& value) {
+        return [&value](QDataStream& in) {
+            quint8 decoded = IDataRepository::WriteFailed;
+            in >> decoded;
+            value = decoded <= IDataRepository::WriteNotFound ? IDataRepository::WriteResult(decoded)
+                                                              : IDataRepository::WriteFailed;
+        };
+    }
+
+    LibraryClient::ResultReader readItems(std::vector<LibraryItem*>& items) {
+        return [&items](QDataStream& in) { LibraryProtocol::readList(in, items, LibraryProtocol::readItem); };
+    }
+
+    LibraryClient::ResultReader readUsers(std::vector<User*>& users) {
+        return [&users](QDataStream& in) { LibraryProtocol::readList(in, users, LibraryProtocol::readUser); };
+    }
+
+    template <class T>
+    void dropNulls(std::vector<T*>& rows) {
+        rows.erase(std::remove(rows.begin(), rows.end(), nullptr), rows.end());
+    }
+}
+
+bool RemoteRepository::connectTo(const QString& serverAddress) {
+    address = serverAddress;
+    if (!client.connectTo(address)) {
+        qDebug() << "Could not connect to server" << address << ":" << client.getLastError();
+        return false;
+    }
+    return true;
+}
+
+bool RemoteRepository::ensureConnected() {
+    if (!client.isConnected() && !client.connectTo(address)) {
+        qDebug() << "Server unavailable:" << client.getLastError();
+        return false;
+    }
+    return true;
+}
+
+bool RemoteRepository::request(quint8 opcode, const QByteArray& args, const LibraryClient::ResultReader& read) {
+    return ensureConnected() && client.call(opcode, args, read);
+}
+
+bool RemoteRepository::batch(const std::vector<LibraryClient::BatchEntry>& entries, bool atomic,
+                             const LibraryClient::ResultReader& read) {
+    return ensureConnected() && client.callBatch(entries, atomic, read);
+}
+
+// === USER OPERATIONS ===
+
+User* RemoteRepository::findUser(const QString& username) {
+    User* user = nullptr;
+    request(LibraryProtocol::FindUser, LibraryProtocol::encodeArgs(username),
+            [&user](QDataStream& in) { user = LibraryProtocol::readUser(in); });
+    return user;
+}
+
+std::vector<User*> RemoteRepository::getAllUsers() {
+    std::vector<User*> users;
+    request(LibraryProtocol::GetAllUsers, QByteArray(), readUsers(users));
+    dropNulls(users);
+    return users;
+}
+
+std::vector<User*> RemoteRepository::searchPatrons(const QString& filter, const QString& afterUsername, int limit) {
+    std::vector<User*> users;
+    request(LibraryProtocol::SearchPatrons, LibraryProtocol::encodeArgs(filter, afterUsername, limit), readUsers(users));
+    dropNulls(users);
+    return users;
+}
+
+// === CATALOGUE OPERATIONS ===
+
+std::vector<LibraryItem*> RemoteRepository::getAllCatalogueItems() {
+    std::vector<LibraryItem*> items;
+    request(LibraryProtocol::GetAllCatalogueItems, QByteArray(), readItems(items)); // Streamed in segments
+    dropNulls(items);
+    return items;
+}
+
+std::vector<IDataRepository::ShelfEntry> RemoteRepository::browseShelf(int fromKey, int toKey, int afterKey,
+                                                                      int afterId, int limit) {
+    std::vector<ShelfEntry> shelf;
+    request(LibraryProtocol::BrowseShelf, LibraryProtocol::encodeArgs(fromKey, toKey, afterKey, afterId, limit),
+            [&shelf](QDataStream& in) { LibraryProtocol::readList(in, shelf, LibraryProtocol::readShelfEntry); });
+    return shelf;
+}
+
+int RemoteRepository::findByIsbn(const QString& isbn) {
+    int id = -1;
+    request(LibraryProtocol::FindByIsbn, LibraryProtocol::encodeArgs(isbn), readInt(id));
+    return id;
+}
+
+int RemoteRepository::findByBarcode(const QString& barcode) {
+    int id = -1;
+    request(LibraryProtocol::FindByBarcode, LibraryProtocol::encodeArgs(barcode), readInt(id));
+    return id;
+}
+
+IDataRepository::FacetResult RemoteRepository::getFacets(const FacetFilter& filter) {
+    FacetResult result;
+    request(LibraryProtocol::GetFacets,
+            LibraryProtocol::encodeArgs(filter.values[FacetFormat], filter.values[FacetGenre],
+                                        filter.values[FacetRating], filter.values[FacetCondition],
+                                        filter.values[FacetAvailability], filter.fromYear, filter.toYear),
+            [&result](QDataStream& in) { result = LibraryProtocol::readFacets(in); });
+    return result;
+}
+
+LibraryItem* RemoteRepository::getItemById(int id) {
+    LibraryItem* item = nullptr;
+    request(LibraryProtocol::GetItemById, LibraryProtocol::encodeArgs(id),
+            [&item](QDataStream& in) { item = LibraryProtocol::readItem(in); });
+    return item;
+}
+
+int RemoteRepository::getItemId(LibraryItem* item) {
+    int id = -1;
+    if (!item) return id;
+    request(LibraryProtocol::GetItemId, LibraryProtocol::encodeArgs(item), readInt(id));
+    return id;
+}
+
+bool RemoteRepository::addItemToCatalogue(const QString& title, const QString& author, const QString& itemType,
+                                          const QString& deweyDecimal, const QString& isbn, const QString& genre,
+                                          const QString& rating, int issueNumber, const QString& publicationDate,
+                                          int publicationYear, const QString& condition, int copies) {
+    bool added = false;
+    QByteArray args = LibraryProtocol::encodeArgs(title, author, itemType, deweyDecimal, isbn, genre, rating,
+                                                  issueNumber, publicationDate, publicationYear, condition, copies);
+    return request(LibraryProtocol::AddItemToCatalogue, args, readBool(added)) && added;
+}
+
+bool RemoteRepository::removeItemFromCatalogue(int itemId) {
+    bool removed = false;
+    return request(LibraryProtocol::RemoveItemFromCatalogue, LibraryProtocol::encodeArgs(itemId), readBool(removed))
+           && removed;
+}
+
+bool RemoteRepository::addCopies(int itemId, int count) {
+    bool added = false;
+    return request(LibraryProtocol::AddCopies, LibraryProtocol::encodeArgs(itemId, count), readBool(added)) && added;
+}
+
+// === LOAN OPERATIONS ===
+
+bool RemoteRepository::borrowItem(int userId, int itemId) {
+    return tryBorrowItem(userId, itemId) == WriteOk;
+}
+
+bool RemoteRepository::returnItem(int userId, int itemId) {
+    return tryReturnItem(userId, itemId) == WriteOk;
+}
+
+IDataRepository::WriteResult RemoteRepository::tryBorrowItem(int userId, int itemId) {
+    WriteResult result = WriteFailed;
+    request(LibraryProtocol::TryBorrowItem, LibraryProtocol::encodeArgs(userId, itemId), readWriteResult(result));
+    return result;
+}
+
+IDataRepository::WriteResult RemoteRepository::tryBorrowScanned(int userId, const QString& code, int& itemId) {
+    WriteResult result = WriteFailed;
+    itemId = -1;
+    request(LibraryProtocol::TryBorrowScanned, LibraryProtocol::encodeArgs(userId, code), [&](QDataStream& in) {
+        readWriteResult(result)(in);
+        readInt(itemId)(in);
+    });
+    return result;
+}
+
+IDataRepository::WriteResult RemoteRepository::tryReturnItem(int userId, int itemId) {
+    WriteResult result = WriteFailed;
+    request(LibraryProtocol::TryReturnItem, LibraryProtocol::encodeArgs(userId, itemId), readWriteResult(result));
+    return result;
+}
+
+std::vector<LibraryItem*> RemoteRepository::getUserBorrowedItems(int userId) {
+    std::vector<LibraryItem*> items;
+    request(LibraryProtocol::GetUserBorrowedItems, LibraryProtocol::encodeArgs(userId), readItems(items));
+    dropNulls(items);
+    return items;
+}
+
+std::vector<IDataRepository::LoanInfo> RemoteRepository::getUserLoansWithDates(int userId) {
+    std::vector<LoanInfo> loans;
+    request(LibraryProtocol::GetUserLoansWithDates, LibraryProtocol::encodeArgs(userId),
+            [&loans](QDataStream& in) { LibraryProtocol::readList(in, loans, LibraryProtocol::readLoan); });
+    return loans;
+}
+
+// === HOLD OPERATIONS ===
+
+bool RemoteRepository::placeHold(int userId, int itemId) {
+    bool placed = false;
+    return request(LibraryProtocol::PlaceHold, LibraryProtocol::encodeArgs(userId, itemId), readBool(placed))
+           && placed;
+}
+
+bool RemoteRepository::cancelHold(int userId, int itemId) {
+    bool cancelled = false;
+    return request(LibraryProtocol::CancelHold, LibraryProtocol::encodeArgs(userId, itemId), readBool(cancelled))
+           && cancelled;
+}
+
+std::vector<LibraryItem*> RemoteRepository::getUserHolds(int userId) {
+    std::vector<LibraryItem*> items;
+    request(LibraryProtocol::GetUserHolds, LibraryProtocol::encodeArgs(userId), readItems(items));
+    dropNulls(items);
+    return items;
+}
+
+int RemoteRepository::getHoldCountForItem(int itemId) {
+    int count = 0;
+    request(LibraryProtocol::GetHoldCountForItem, LibraryProtocol::encodeArgs(itemId), readInt(count));
+    return count;
+}
+
+int RemoteRepository::getHoldPosition(int userId, int itemId) {
+    int position = -1;
+    request(LibraryProtocol::GetHoldPosition, LibraryProtocol::encodeArgs(userId, itemId), readInt(position));
+    return position;
+}
+
+IDataRepository::AccountSnapshot RemoteRepository::getAccountSnapshot(int userId) {
+    AccountSnapshot snapshot;
+    request(LibraryProtocol::GetAccountSnapshot, LibraryProtocol::encodeArgs(userId),
+            [&snapshot](QDataStream& in) { snapshot = LibraryProtocol::readSnapshot(in); });
+    return snapshot;
+}
+
+// === REPORTS ===
+
+IDataRepository::CirculationReport RemoteRepository::getCirculationReport(int topN) {
+    CirculationReport report;
+    request(LibraryProtocol::GetCirculationReport, LibraryProtocol::encodeArgs(topN),
+            [&report](QDataStream& in) { report = LibraryProtocol::readReport(in); });
+    return report;
+}
+
+// === BATCHED OPERATIONS ===
+
+std::vector<int> RemoteRepository::getItemIds(const std::vector<LibraryItem*>& items) {
+    std::vector<int> ids(items.size(), -1);
+
+    for (size_t start = 0; start < items.size(); start += MAX_BATCH_ENTRIES) {
+        size_t end = qMin(items.size(), start + MAX_BATCH_ENTRIES);
+        std::vector<LibraryClient::BatchEntry> entries;
+        entries.reserve(end - start);
+        for (size_t i = start; i < end; ++i) {
+            entries.push_back({LibraryProtocol::GetItemId, LibraryProtocol::encodeArgs(items[i])});
+        }
+
+        bool ok = batch(entries, false, [&](QDataStream& in) {
+            for (size_t i = start; i < end; ++i) readInt(ids[i])(in);
+        });
+        if (!ok) break; // Remaining ids stay -1
+    }
+    return ids;
+}
+
+std::vector<int> RemoteRepository::getHoldCountsForItems(const std::vector<int>& itemIds) {
+    std::vector<int> counts(itemIds.size(), 0);
+
+    for (size_t start = 0; start < itemIds.size(); start += MAX_BATCH_ENTRIES) {
+        size_t end = qMin(itemIds.size(), start + MAX_BATCH_ENTRIES);
+        std::vector<LibraryClient::BatchEntry> entries;
+        entries.reserve(end - start);
+        for (size_t i = start; i < end; ++i) {
+            entries.push_back({LibraryProtocol::GetHoldCountForItem, LibraryProtocol::encodeArgs(itemIds[i])});
+        }
+
+        bool ok = batch(entries, false, [&](QDataStream& in) {
+            for (size_t i = start; i < end; ++i) readInt(counts[i])(in);
+        });
+        if (!ok) break;
+    }
+    return counts;
+}
+
+bool RemoteRepository::placeHoldAndGetPosition(int userId, int itemId, int& position) {
+    // Both run in one server-side transaction, so the position is the one this hold got
+    std::vector<LibraryClient::BatchEntry> entries = {
+        {LibraryProtocol::PlaceHold, LibraryProtocol::encodeArgs(userId, itemId)},
+        {LibraryProtocol::GetHoldPosition, LibraryProtocol::encodeArgs(userId, itemId)}
+    };
+
+    bool placed = false;
+    bool ok = batch(entries, true, [&](QDataStream& in) {
+        readBool(placed)(in);
+        readInt(position)(in);
+    });
+    return ok && placed;
+}
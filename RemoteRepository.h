@@ -0,0 +1,120 @@
+#ifndef REMOTEREPOSITORY_H
+#define REMOTEREPOSITORY_H
+
+#include "IDataRepository.h"
+#include "LibraryClient.h"
+
+/*
+    RemoteRepository Class:
+    IDataRepository that forwards every call to a HinLIBS server, turning the
+    desktop application into a thin client: no local database is opened and every
+    desk connected to the same server sees the same library.
+
+    Failures (server unreachable, connection dropped) are reported with qDebug and
+    surface as the same "nothing found / operation failed" results DatabaseManager
+    returns when its database is unavailable.
+
+    Data Members:
+      - LibraryClient client: Connection to the server
+      - QString address: Server address, kept for reconnecting
+
+    Member Functions:
+      - connectTo(): Opens the connection
+      - getLastError(): Description of the last failure
+      - getRoundTrips(): Server round trips made so far
+      - IDataRepository operations: one request per call; the bulk forms and
+        placeHoldAndGetPosition() one batch per call
+*/
+class RemoteRepository : public IDataRepository {
+public:
+    /*
+        Function: connectTo
+        Purpose: Connects to the server at the given address
+        Parameters:
+          in: const QString& address - "tcp:host:port" or "local:name"
+        Return: bool - True if connected
+    */
+    bool connectTo(const QString& address);
+
+    QString getLastError() const { return client.getLastError(); }
+
+    User* findUser(const QString& username) override;
+    std::vector<User*> getAllUsers() override;
+    std::vector<User*> searchPatrons(const QString& filter, const QString& afterUsername, int limit) override;
+
+    std::vector<LibraryItem*> getAllCatalogueItems() override;
+    LibraryItem* getItemById(int id) override;
+    std::vector<ShelfEntry> browseShelf(int fromKey, int toKey, int afterKey, int afterId, int limit) override;
+    int findByIsbn(const QString& isbn) override;
+    int findByBarcode(const QString& barcode) override;
+    int getItemId(LibraryItem* item) override;
+    bool addItemToCatalogue(const QString& title, const QString& author, const QString& itemType,
+                            const QString& deweyDecimal, const QString& isbn, const QString& genre,
+                            const QString& rating, int issueNumber, const QString& publicationDate,
+                            int publicationYear, const QString& condition, int copies) override;
+    bool removeItemFromCatalogue(int itemId) override;
+    bool addCopies(int itemId, int count) override;
+
+    bool borrowItem(int userId, int itemId) override;
+    bool returnItem(int userId, int itemId) override;
+    WriteResult tryBorrowItem(int userId, int itemId) override;
+    WriteResult tryReturnItem(int userId, int itemId) override;
+    WriteResult tryBorrowScanned(int userId, const QString& code, int& itemId) override;
+    std::vector<LibraryItem*> getUserBorrowedItems(int userId) override;
+    std::vector<LoanInfo> getUserLoansWithDates(int userId) override;
+
+    bool placeHold(int userId, int itemId) override;
+    bool cancelHold(int userId, int itemId) override;
+    std::vector<LibraryItem*> getUserHolds(int userId) override;
+    int getHoldCountForItem(int itemId) override;
+    int getHoldPosition(int userId, int itemId) override;
+
+    AccountSnapshot getAccountSnapshot(int userId) override;
+    CirculationReport getCirculationReport(int topN) override;
+    FacetResult getFacets(const FacetFilter& filter) override;
+
+    // One batch (one round trip) each instead of one request per element
+    std::vector<int> getItemIds(const std::vector<LibraryItem*>& items) override;
+    std::vector<int> getHoldCountsForItems(const std::vector<int>& itemIds) override;
+    bool placeHoldAndGetPosition(int userId, int itemId, int& position) override;
+
+    quint64 getRoundTrips() const { return client.getRoundTrips(); }
+
+private:
+    LibraryClient client;
+    QString address;
+
+    /*
+        Function: ensureConnected
+        Purpose: Reconnects once if the connection was lost (e.g. a restarted server).
+                 Requests are not retried after they reach the server, so a mutation is
+                 never applied twice.
+        Return: bool - True if connected
+    */
+    bool ensureConnected();
+
+    /*
+        Function: request
+        Purpose: Sends one operation and decodes its result
+        Parameters:
+          in: quint8 opcode - LibraryProtocol::Opcode
+          in: const QByteArray& args - Encoded arguments
+          in: const LibraryClient::ResultReader& read - Result decoder
+        Return: bool - True if the server executed the request
+    */
+    bool request(quint8 opcode, const QByteArray& args, const LibraryClient::ResultReader& read);
+
+    /*
+        Function: batch
+        Purpose: Sends several operations in one round trip
+        Parameters:
+          in: const std::vector<LibraryClient::BatchEntry>& entries - Operations
+          in: bool atomic - Run in one server-side transaction
+          in: const LibraryClient::ResultReader& read - Decodes all results in order
+        Return: bool - True if the server executed the batch
+    */
+    bool batch(const std::vector<LibraryClient::BatchEntry>& entries, bool atomic,
+               const LibraryClient::ResultReader& read);
+};
+
+#endif
@@ -0,0 +1,171 @@
+#include <QThread>
+#include <functional>
+#include "SessionManager.h"
+#include "DatabaseManager.h"
+#include "PerformanceMonitor.h"
+
+SessionManager* SessionManager::instance = nullptr;
+
+namespace {
+    // Runs the prewarm on its own thread while the login screen waits for input
+    class PrewarmThread : public QThread {
+    public:
+        explicit PrewarmThread(const std::function<void()>& body) : body(body) {}
+
+    protected:
+        void run() override { body(); }
+
+    private:
+        std::function<void()> body;
+    };
+}
+
+SessionManager::SessionManager()
+    : current(nullptr), cacheTtlSeconds(300), lastLoginToFirstPaintMs(-1),
+      startupToLoginNanos(-1), startupToInteractiveMs(-1), prewarmer(nullptr) {}
+
+SessionManager& SessionManager::getInstance() {
+    if (!instance) {
+        instance = new SessionManager();
+    }
+    return *instance;
+}
+
+SessionManager::~SessionManager() {
+    waitForPrewarm();
+    endSession();
+    for (auto it = userCache.begin(); it != userCache.end(); ++it) {
+        delete it.value().user;
+    }
+}
+
+User* SessionManager::lookupUser(const QString& username) {
+    auto it = userCache.find(username);
+    if (it != userCache.end()) {
+        if (it.value().age.elapsed() < cacheTtlSeconds * 1000LL) {
+            return it.value().user;
+        }
+
+        // Expired - never hand out a stale role; the active session may still hold it
+        if (!current || current->user != it.value().user) {
+            delete it.value().user;
+        }
+        userCache.erase(it);
+    }
+
+    User* user = IDataRepository::getInstance().findUser(username);
+    if (user && cacheTtlSeconds > 0) {
+        CachedUser entry;
+        entry.user = user;
+        entry.age.start();
+        userCache.insert(username, entry);
+    }
+    return user;
+}
+
+SessionManager::Session* SessionManager::login(const QString& username) {
+    User* user = lookupUser(username);
+    if (!user) return nullptr;
+
+    endSession();
+
+    current = new Session();
+    current->user = user;
+    current->sinceLogin.start();
+    current->firstPaintReported = false;
+
+    // Warm the account panel: loans and holds in one round trip
+    current->account = IDataRepository::getInstance().getAccountSnapshot(user->id);
+    current->accountPreloaded = true;
+
+    return current;
+}
+
+bool SessionManager::takePreloadedAccount(IDataRepository::AccountSnapshot& out) {
+    if (!current || !current->accountPreloaded) return false;
+
+    out = current->account;
+    current->account = IDataRepository::AccountSnapshot();
+    current->accountPreloaded = false;
+    return true;
+}
+
+void SessionManager::reportFirstPaint() {
+    if (!current || current->firstPaintReported) return;
+
+    current->firstPaintReported = true;
+    qint64 nanos = current->sinceLogin.nsecsElapsed();
+    lastLoginToFirstPaintMs = nanos / 1000000;
+    PerformanceMonitor::getInstance().record("session", "loginToFirstPaint", nanos, true);
+
+    // First window of the process: startup is complete
+    if (startupToLoginNanos >= 0 && startupToInteractiveMs < 0) {
+        qint64 startupNanos = startupToLoginNanos + nanos;
+        startupToInteractiveMs = startupNanos / 1000000;
+        PerformanceMonitor::getInstance().record("startup", "toInteractive", startupNanos, true);
+    }
+}
+
+void SessionManager::reportLoginShown() {
+    if (!sinceStartup.isValid() || startupToLoginNanos >= 0) return;
+
+    startupToLoginNanos = sinceStartup.nsecsElapsed();
+    PerformanceMonitor::getInstance().record("startup", "toLoginScreen", startupToLoginNanos, true);
+}
+
+void SessionManager::startPrewarm() {
+    if (prewarmer) return;
+
+    // The manager must belong to the calling thread, not to the worker
+    DatabaseManager::getInstance();
+
+    prewarmer = new PrewarmThread([this]() { prewarm(); });
+    prewarmer->start(QThread::LowPriority);
+}
+
+void SessionManager::prewarm() {
+    ScopedTimer timer("prewarm");
+    DatabaseManager& dbm = DatabaseManager::getInstance();
+
+    // Rewrites the snapshot only if the catalogue changed since the last exit; the
+    // catalogue is then built from the mapped file
+    dbm.saveCatalogueSnapshot();
+    prewarmedCatalogue = dbm.getAllCatalogueItems();
+    dbm.getFacets(IDataRepository::FacetFilter()); // Builds the index for the first refresh
+
+    // Thread connections cannot outlive their thread
+    dbm.releaseThreadConnection();
+}
+
+bool SessionManager::takePreloadedCatalogue(std::vector<LibraryItem*>& out) {
+    if (!prewarmer) return false;
+
+    prewarmer->wait();
+    delete prewarmer;
+    prewarmer = nullptr;
+
+    out.swap(prewarmedCatalogue);
+    prewarmedCatalogue.clear();
+    return !out.empty(); // Empty: the read failed, or there is nothing to show
+}
+
+void SessionManager::waitForPrewarm() {
+    std::vector<LibraryItem*> unused;
+    takePreloadedCatalogue(unused);
+    for (LibraryItem* item : unused) delete item;
+}
+
+void SessionManager::endSession() {
+    if (!current) return;
+
+    IDataRepository::freeAccountSnapshot(current->account);
+
+    // A user loaded while caching was disabled is owned by the session alone
+    auto it = userCache.find(QString::fromStdString(current->user->name));
+    if (it == userCache.end() || it.value().user != current->user) {
+        delete current->user;
+    }
+
+    delete current;
+    current = nullptr;
+}
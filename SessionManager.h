@@ -0,0 +1,226 @@
+#ifndef SESSIONMANAGER_H
+#define SESSIONMANAGER_H
+
+#include <QString>
+#include <QHash>
+#include <QElapsedTimer>
+#include <vector>
+#include "User.h"
+#include "IDataRepository.h"
+
+class QThread;
+
+/*
+    SessionManager Class:
+    Singleton that owns the login session for the HinLIBS system. Sits between the
+    login screen and the data repository so that repeated logins (e.g. shift changes at
+    a kiosk) do not hit the database for the same account over and over.
+
+    Key Responsibilities:
+    - Cache authenticated User objects by username with time-to-live invalidation
+    - Own the cached User objects (callers never delete them)
+    - Preload the user's loans and holds in one query when a session starts
+    - Measure login-to-first-paint latency of the main window
+    - Prewarm the catalogue on a background thread while the login screen is up
+    - Measure startup-to-interactive time: process start to login screen, plus login
+      to first paint (the time spent typing at the login screen is not counted)
+
+    Data Members:
+      - QHash<QString, CachedUser> userCache: Authenticated users keyed by username
+      - Session* current: The active session, or nullptr when logged out
+      - int cacheTtlSeconds: How long a cached user stays valid
+      - qint64 lastLoginToFirstPaintMs: Latest login-to-first-paint measurement
+      - QElapsedTimer sinceStartup: Started by markStartup()
+      - qint64 startupToLoginNanos: Process start to login screen, -1 until shown
+      - qint64 startupToInteractiveMs: Startup-to-interactive, -1 until the first paint
+      - QThread* prewarmer: Background prewarm thread, until its result is taken
+      - std::vector<LibraryItem*> prewarmedCatalogue: Catalogue read by the prewarm thread
+      - static SessionManager* instance: Singleton instance pointer
+
+    Member Functions:
+      Public:
+        - getInstance(): Provides global access to singleton instance
+        - login(): Authenticates a username and starts a new session
+        - currentSession(): Returns the active session
+        - takePreloadedAccount(): Hands the login-time account snapshot to the main window
+        - reportFirstPaint(): Records login-to-first-paint latency once per session
+                              (also fed to PerformanceMonitor as session/loginToFirstPaint)
+        - endSession(): Closes the active session
+        - setCacheTtl(): Changes the user cache time-to-live
+        - getLastLoginToFirstPaintMs(): Returns the latest latency measurement
+        - markStartup() / reportLoginShown(): Startup timing (startup/toLoginScreen,
+          startup/toInteractive in PerformanceMonitor)
+        - getStartupToInteractiveMs(): Returns the startup measurement
+        - startPrewarm(): Reads the catalogue and builds FacetIndex in the background
+        - takePreloadedCatalogue(): Hands the prewarmed catalogue to the main window
+        - waitForPrewarm(): Joins the prewarm thread and frees what was not taken
+
+      Private:
+        - SessionManager(): Private constructor for singleton pattern
+        - lookupUser(): Returns a cached user or loads it from the database
+        - prewarm(): Prewarm thread body
+*/
+class SessionManager {
+public:
+    /*
+        Session Struct:
+        State for one logged-in user, from login until the main window closes.
+          - User* user: Authenticated user (owned by the SessionManager cache)
+          - AccountSnapshot account: Loans and holds preloaded at login
+          - bool accountPreloaded: True until the snapshot is taken by the main window
+          - QElapsedTimer sinceLogin: Started when authentication succeeds
+          - bool firstPaintReported: True once the latency metric has been recorded
+    */
+    struct Session {
+        User* user;
+        IDataRepository::AccountSnapshot account;
+        bool accountPreloaded;
+        QElapsedTimer sinceLogin;
+        bool firstPaintReported;
+    };
+
+    /*
+        Function: getInstance
+        Purpose: Provides global access to the singleton SessionManager instance.
+        Return: SessionManager& - Reference to the singleton instance
+    */
+    static SessionManager& getInstance();
+
+    ~SessionManager();
+
+    /*
+        Function: login
+        Purpose: Authenticates a username (from cache when fresh, otherwise through
+                 the data repository) and starts a session with the account preloaded.
+        Parameters:
+          in: const QString& username - Username entered at the login screen
+        Return: Session* - The new active session, or nullptr if the user does not exist
+    */
+    Session* login(const QString& username);
+
+    /*
+        Function: currentSession
+        Purpose: Retrieves the active session.
+        Return: Session* - Active session, or nullptr if nobody is logged in
+    */
+    Session* currentSession() const { return current; }
+
+    /*
+        Function: takePreloadedAccount
+        Purpose: Transfers the account snapshot loaded at login to the caller, so the
+                 first account panel paint needs no extra query. Only succeeds once.
+        Parameters:
+          out: IDataRepository::AccountSnapshot& out - Receives the snapshot (caller-owned)
+        Return: bool - True if a preloaded snapshot was available
+    */
+    bool takePreloadedAccount(IDataRepository::AccountSnapshot& out);
+
+    /*
+        Function: reportFirstPaint
+        Purpose: Records the time from successful login to the first paint of the main
+                 window. Only the first call per session is recorded.
+    */
+    void reportFirstPaint();
+
+    /*
+        Function: endSession
+        Purpose: Closes the active session and releases any unused preloaded data.
+                 The cached User object stays in the cache for the next login.
+    */
+    void endSession();
+
+    /*
+        Function: setCacheTtl
+        Purpose: Sets how long an authenticated user stays cached.
+        Parameters:
+          in: int seconds - Time-to-live in seconds (0 disables caching)
+    */
+    void setCacheTtl(int seconds) { cacheTtlSeconds = seconds; }
+
+    /*
+        Function: getLastLoginToFirstPaintMs
+        Purpose: Retrieves the most recent login-to-first-paint latency.
+        Return: qint64 - Latency in milliseconds, or -1 if not yet measured
+    */
+    qint64 getLastLoginToFirstPaintMs() const { return lastLoginToFirstPaintMs; }
+
+    /*
+        Function: markStartup
+        Purpose: Starts the startup clock; called first thing in main()
+    */
+    void markStartup() { sinceStartup.start(); }
+
+    /*
+        Function: reportLoginShown
+        Purpose: Records the time from markStartup() to the first login screen. Later
+                 calls (logins after a logout) are ignored.
+    */
+    void reportLoginShown();
+
+    /*
+        Function: getStartupToInteractiveMs
+        Purpose: Retrieves the startup-to-interactive time of this process.
+        Return: qint64 - Milliseconds, or -1 if the first main window has not painted yet
+    */
+    qint64 getStartupToInteractiveMs() const { return startupToInteractiveMs; }
+
+    /*
+        Function: startPrewarm
+        Purpose: Starts a low-priority thread that reads the whole catalogue (from the
+                 mapped CatalogueSnapshot, rewritten first if the catalogue changed since
+                 it was saved) and builds FacetIndex, so the first
+                 catalogue refresh after login finds both ready. Local database only:
+                 the thread uses DatabaseManager directly, with its own connection.
+    */
+    void startPrewarm();
+
+    /*
+        Function: takePreloadedCatalogue
+        Purpose: Transfers the prewarmed catalogue to the caller, waiting for the prewarm
+                 thread if it is still running. Only succeeds once.
+        Parameters:
+          out: std::vector<LibraryItem*>& out - Receives the items (caller-owned)
+        Return: bool - True if a prewarmed catalogue was available
+    */
+    bool takePreloadedCatalogue(std::vector<LibraryItem*>& out);
+
+    /*
+        Function: waitForPrewarm
+        Purpose: Waits for the prewarm thread to finish and frees a catalogue nobody
+                 took. Called before the application exits.
+    */
+    void waitForPrewarm();
+
+private:
+    struct CachedUser {
+        User* user;
+        QElapsedTimer age;
+    };
+
+    QHash<QString, CachedUser> userCache;
+    Session* current;
+    int cacheTtlSeconds;
+    qint64 lastLoginToFirstPaintMs;
+    QElapsedTimer sinceStartup;
+    qint64 startupToLoginNanos;
+    qint64 startupToInteractiveMs;
+    QThread* prewarmer;
+    std::vector<LibraryItem*> prewarmedCatalogue;
+    static SessionManager* instance;
+
+    SessionManager(); // Private constructor for singleton
+
+    /*
+        Function: lookupUser
+        Purpose: Returns the cached user if still within its time-to-live, otherwise
+                 loads it with IDataRepository::findUser and caches the result.
+        Parameters:
+          in: const QString& username - Username to resolve
+        Return: User* - Cached user, or nullptr if the user does not exist
+    */
+    User* lookupUser(const QString& username);
+
+    void prewarm();
+};
+
+#endif
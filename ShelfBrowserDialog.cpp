@@ -0,0 +1,137 @@
+#include <QScrollBar>
+#include "ShelfBrowserDialog.h"
+#include "CatalogueKeys.h"
+
+namespace {
+    const char* MAIN_CLASSES[] = {
+        "000 Computer science, information & general works",
+        "100 Philosophy & psychology",
+        "200 Religion",
+        "300 Social sciences",
+        "400 Language",
+        "500 Science",
+        "600 Technology",
+        "700 Arts & recreation",
+        "800 Literature",
+        "900 History & geography"
+    };
+}
+
+ShelfBrowserDialog::ShelfBrowserDialog(QWidget *parent)
+    : QDialog(parent), fromKey(0), toKey(-1), allLoaded(true) {
+    setWindowTitle("Browse Shelves");
+    resize(600, 500);
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+
+    classCombo = new QComboBox();
+    for (const char* name : MAIN_CLASSES) {
+        classCombo->addItem(name);
+    }
+    layout->addWidget(classCombo);
+
+    QHBoxLayout *rangeLayout = new QHBoxLayout();
+    fromInput = new QLineEdit();
+    fromInput->setPlaceholderText("From (e.g. 510)");
+    toInput = new QLineEdit();
+    toInput->setPlaceholderText("To (e.g. 519.9)");
+    rangeLayout->addWidget(new QLabel("Call numbers from"));
+    rangeLayout->addWidget(fromInput);
+    rangeLayout->addWidget(new QLabel("to"));
+    rangeLayout->addWidget(toInput);
+    layout->addLayout(rangeLayout);
+
+    shelfList = new QListWidget();
+    shelfList->setUniformItemSizes(true);
+    layout->addWidget(shelfList);
+
+    statusLabel = new QLabel();
+    layout->addWidget(statusLabel);
+
+    QDialogButtonBox *buttonBox = new QDialogButtonBox(QDialogButtonBox::Close);
+    layout->addWidget(buttonBox);
+
+    connect(buttonBox, &QDialogButtonBox::rejected, this, &QDialog::reject);
+    connect(classCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &ShelfBrowserDialog::onClassChosen);
+    connect(fromInput, &QLineEdit::editingFinished, this, &ShelfBrowserDialog::onRangeChanged);
+    connect(toInput, &QLineEdit::editingFinished, this, &ShelfBrowserDialog::onRangeChanged);
+    connect(shelfList->verticalScrollBar(), &QScrollBar::valueChanged, this, &ShelfBrowserDialog::onScrolled);
+
+    onClassChosen(0);
+}
+
+ShelfBrowserDialog::~ShelfBrowserDialog() {
+    clearShelf();
+}
+
+void ShelfBrowserDialog::onClassChosen(int index) {
+    QString start = QString("%1").arg(index * 100, 3, 10, QChar('0'));
+    QString end = QString("%1").arg(index * 100 + 99, 3, 10, QChar('0'));
+    fromInput->setText(start);
+    toInput->setText(end);
+    onRangeChanged();
+}
+
+void ShelfBrowserDialog::onRangeChanged() {
+    int from = CatalogueKeys::deweyKey(fromInput->text());
+    QString toText = toInput->text().trimmed().isEmpty() ? fromInput->text() : toInput->text();
+    int to = CatalogueKeys::deweyUpperKey(toText);
+
+    // Nothing to reload when only focus moved
+    if (from == fromKey && to == toKey) return;
+
+    clearShelf();
+    fromKey = from;
+    toKey = to;
+    if (fromKey < 0 || toKey < fromKey) {
+        statusLabel->setText("Enter call numbers such as 510 or 823.914.");
+        return;
+    }
+
+    allLoaded = false;
+    loadPage();
+}
+
+void ShelfBrowserDialog::onScrolled(int value) {
+    if (value == shelfList->verticalScrollBar()->maximum()) {
+        loadPage();
+    }
+}
+
+void ShelfBrowserDialog::loadPage() {
+    if (allLoaded) return;
+
+    // Keyset pagination: continue after the last call number already listed
+    int afterKey = -1;
+    int afterId = 0;
+    if (!entries.empty()) {
+        afterKey = entries.back().deweyKey;
+        afterId = entries.back().itemId;
+    }
+
+    std::vector<IDataRepository::ShelfEntry> page =
+        IDataRepository::getInstance().browseShelf(fromKey, toKey, afterKey, afterId, PAGE_SIZE);
+
+    for (const auto& entry : page) {
+        QString text = QString("%1    %2").arg(CatalogueKeys::deweyText(entry.deweyKey),
+                                               QString::fromStdString(entry.item->getDisplayText()));
+        if (!entry.item->getAvailability()) text += " [Checked Out]";
+        shelfList->addItem(text);
+        entries.push_back(entry);
+    }
+    allLoaded = int(page.size()) < PAGE_SIZE;
+
+    statusLabel->setText(QString("%1 to %2: %3%4 items")
+                             .arg(CatalogueKeys::deweyText(fromKey), CatalogueKeys::deweyText(toKey))
+                             .arg(entries.size())
+                             .arg(allLoaded ? "" : "+"));
+}
+
+void ShelfBrowserDialog::clearShelf() {
+    shelfList->clear();
+    for (auto& entry : entries) {
+        delete entry.item;
+    }
+    entries.clear();
+    allLoaded = true;
+}
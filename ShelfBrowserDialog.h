@@ -0,0 +1,87 @@
+#ifndef SHELFBROWSERDIALOG_H
+#define SHELFBROWSERDIALOG_H
+
+#include <QDialog>
+#include <QListWidget>
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QLineEdit>
+#include <QComboBox>
+#include <QPushButton>
+#include <QDialogButtonBox>
+#include <vector>
+#include "IDataRepository.h"
+
+/*
+    ShelfBrowserDialog Class:
+    Walks the non-fiction collection in call number order, the way a patron walks
+    the shelves: pick a Dewey class (or type a range such as 510 to 519.9) and the
+    items are listed in shelf order, one page at a time as the list is scrolled.
+    Each page is one keyset query over the Dewey index (see browseShelf()).
+
+    UI Design:
+    - Class picker with the ten Dewey main classes, plus From / To fields
+    - List of "call number  title - author [format]" with availability, loaded as the
+      user scrolls
+    - Close button
+
+    Data Members:
+      - QComboBox* classCombo: Main class shortcuts
+      - QLineEdit* fromInput / toInput: Range being browsed
+      - QListWidget* shelfList: Items loaded so far
+      - QLabel* statusLabel: Range and item count, or why the range is invalid
+      - std::vector<IDataRepository::ShelfEntry> entries: Loaded items, in list order
+      - int fromKey / toKey: Current range as Dewey keys
+      - bool allLoaded: True once the last page of the range has been fetched
+
+    Member Functions:
+      Public:
+        - ShelfBrowserDialog(): Builds the dialog and shows the first class
+        - ~ShelfBrowserDialog(): Frees the loaded items
+
+      Private Slots:
+        - onClassChosen(): Fills the range from the chosen main class
+        - onRangeChanged(): Restarts the listing for the typed range
+        - onScrolled(): Fetches the next page at the bottom of the list
+
+      Private:
+        - loadPage(): Appends the next page of the range
+        - clearShelf(): Drops the loaded items
+*/
+class ShelfBrowserDialog : public QDialog {
+    Q_OBJECT
+
+public:
+    /*
+        Function: ShelfBrowserDialog
+        Purpose: Constructs the dialog and lists the first page of class 000
+        Parameters:
+          in: QWidget* parent - Parent widget for modal behavior (optional)
+    */
+    ShelfBrowserDialog(QWidget *parent = nullptr);
+    ~ShelfBrowserDialog();
+
+private slots:
+    void onClassChosen(int index);
+    void onRangeChanged();
+    void onScrolled(int value);
+
+private:
+    static const int PAGE_SIZE = 50;
+
+    QComboBox *classCombo;
+    QLineEdit *fromInput;
+    QLineEdit *toInput;
+    QListWidget *shelfList;
+    QLabel *statusLabel;
+    std::vector<IDataRepository::ShelfEntry> entries;
+    int fromKey;
+    int toKey;
+    bool allLoaded;
+
+    void loadPage();
+    void clearShelf();
+};
+
+#endif
@@ -0,0 +1,78 @@
+#include <QDebug>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include "TraceRecorder.h"
+
+TraceRecorder* TraceRecorder::instance = nullptr;
+std::atomic<bool> TraceRecorder::recording(false);
+
+TraceRecorder& TraceRecorder::getInstance() {
+    static QMutex instanceMutex;
+    QMutexLocker locker(&instanceMutex);
+
+    if (!instance) {
+        instance = new TraceRecorder();
+    }
+    return *instance;
+}
+
+bool TraceRecorder::start(const QString& path) {
+    QMutexLocker locker(&mutex);
+
+    if (file.isOpen()) {
+        file.close();
+    }
+    file.setFileName(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        qDebug() << "Error opening trace file:" << file.errorString();
+        return false;
+    }
+
+    clock.start();
+    recording = true;
+    qDebug() << "Recording data layer trace to" << path;
+    return true;
+}
+
+void TraceRecorder::stop() {
+    recording = false;
+
+    QMutexLocker locker(&mutex);
+    if (file.isOpen()) {
+        file.close();
+    }
+}
+
+void TraceRecorder::record(const QString& operation, const QVariantList& args) {
+    QJsonObject entry;
+    entry["op"] = operation;
+    entry["args"] = QJsonArray::fromVariantList(args);
+
+    QMutexLocker locker(&mutex);
+    if (!file.isOpen()) return;
+
+    entry["t"] = double(clock.nsecsElapsed() / 1000);
+    file.write(QJsonDocument(entry).toJson(QJsonDocument::Compact));
+    file.write("\n");
+}
+
+bool TraceRecorder::load(const QString& path, std::vector<Entry>& entries) {
+    QFile in(path);
+    if (!in.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        qDebug() << "Error opening trace file:" << in.errorString();
+        return false;
+    }
+
+    while (!in.atEnd()) {
+        QJsonObject object = QJsonDocument::fromJson(in.readLine()).object();
+        if (!object.contains("op")) continue; // Blank or truncated line
+
+        Entry entry;
+        entry.micros = qint64(object["t"].toDouble());
+        entry.operation = object["op"].toString();
+        entry.args = object["args"].toArray().toVariantList();
+        entries.push_back(entry);
+    }
+    return true;
+}
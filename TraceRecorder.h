@@ -0,0 +1,102 @@
+#ifndef TRACERECORDER_H
+#define TRACERECORDER_H
+
+#include <QString>
+#include <QVariantList>
+#include <QFile>
+#include <QMutex>
+#include <QElapsedTimer>
+#include <vector>
+#include <atomic>
+
+/*
+    TraceRecorder Class:
+    Singleton that records DatabaseManager calls from real sessions to a trace file,
+    so the load generator can replay them later. Each call is written as one JSON
+    line: {"t": microseconds since recording started, "op": operation, "args": [...]}.
+
+    Recording is off unless start() is called (the application does this when the
+    HINLIBS_TRACE_FILE environment variable is set). When off, call sites only pay
+    for one relaxed atomic load.
+
+    Data Members:
+      - QFile file: Trace file being written
+      - QMutex mutex: Serializes writes from several threads
+      - QElapsedTimer clock: Time since recording started
+      - static std::atomic<bool> recording: Whether calls are being recorded
+      - static TraceRecorder* instance: Singleton instance pointer
+
+    Member Functions:
+      Public:
+        - getInstance(): Provides global access to singleton instance
+        - start() / stop(): Open and close the trace file
+        - isRecording(): Cheap check used at every call site
+        - record(): Appends one call to the trace
+        - load(): Reads a trace file back for replay
+*/
+class TraceRecorder {
+public:
+    /*
+        Entry Struct:
+        One recorded call, as read back by load()
+    */
+    struct Entry {
+        qint64 micros;
+        QString operation;
+        QVariantList args;
+    };
+
+    /*
+        Function: getInstance
+        Purpose: Provides global access to the singleton TraceRecorder instance.
+        Return: TraceRecorder& - Reference to the singleton instance
+    */
+    static TraceRecorder& getInstance();
+
+    /*
+        Function: start
+        Purpose: Starts recording to a trace file, replacing any previous contents
+        Parameters:
+          in: const QString& path - Trace file to write
+        Return: bool - True if the file was opened
+    */
+    bool start(const QString& path);
+
+    /*
+        Function: stop
+        Purpose: Stops recording and closes the trace file
+    */
+    void stop();
+
+    static bool isRecording() { return recording.load(std::memory_order_relaxed); }
+
+    /*
+        Function: record
+        Purpose: Appends one DatabaseManager call to the trace
+        Parameters:
+          in: const QString& operation - DatabaseManager method name
+          in: const QVariantList& args - Call arguments, in declaration order
+    */
+    void record(const QString& operation, const QVariantList& args);
+
+    /*
+        Function: load
+        Purpose: Reads a trace file written by this class
+        Parameters:
+          in: const QString& path - Trace file to read
+          out: std::vector<Entry>& entries - Recorded calls, in file order
+        Return: bool - True if the file was read (malformed lines are skipped)
+    */
+    static bool load(const QString& path, std::vector<Entry>& entries);
+
+private:
+    QFile file;
+    QMutex mutex;
+    QElapsedTimer clock;
+    static std::atomic<bool> recording;
+    static TraceRecorder* instance;
+
+    TraceRecorder() {} // Private constructor for singleton
+};
+
+#endif
@@ -16,6 +16,8 @@
       - string role: User type classification ("patron", "librarian", or "admin")
       - vector<LibraryItem*> borrowedItems: Collection of items currently checked out by the user
       - vector<LibraryItem*> activeHolds: Collection of items the user has placed holds on
+      - int activeLoanCount / activeHoldCount: Loan and hold totals, as stored with the
+        user in the database and kept in step by borrowItem() / returnItem() etc.
 
     Member Functions:
       - User(): Constructor that initializes user with name and role
@@ -38,6 +40,8 @@ public:
     string role;
     vector<LibraryItem*> borrowedItems;
     vector<LibraryItem*> activeHolds;
+    int activeLoanCount;
+    int activeHoldCount;
 
     /*
         Function: User (Constructor)
@@ -48,7 +52,7 @@ public:
           in: string r - Role classification ("patron", "librarian", "admin")
         Return: User object instance
     */
-    User(int i, string n, string r) : id(i), name(n), role(r) {}
+    User(int i, string n, string r) : id(i), name(n), role(r), activeLoanCount(0), activeHoldCount(0) {}
 
     /*
         Function: canBorrow
@@ -56,7 +60,7 @@ public:
         Return: bool - True if user has fewer than 3 borrowed items, False otherwise
     */
     bool canBorrow() const {
-        return borrowedItems.size() < 3;  // Max 3 books
+        return activeLoanCount < 3;  // Max 3 books
     }
 
     /*
@@ -67,6 +71,7 @@ public:
     */
     void borrowItem(LibraryItem* item) {
         borrowedItems.push_back(item);
+        activeLoanCount++;
     }
 
     /*
@@ -79,6 +84,7 @@ public:
         for (auto it = borrowedItems.begin(); it != borrowedItems.end(); ++it) {
             if (*it == item) {
                 borrowedItems.erase(it);
+                activeLoanCount--;
                 break;
             }
         }
@@ -92,6 +98,7 @@ public:
     */
     void addHold(LibraryItem* item) {
         activeHolds.push_back(item);
+        activeHoldCount++;
     }
 
     /*
@@ -104,6 +111,7 @@ public:
         for (auto it = activeHolds.begin(); it != activeHolds.end(); ++it) {
             if (*it == item) {
                 activeHolds.erase(it);
+                activeHoldCount--;
                 break;
             }
         }
@@ -0,0 +1,178 @@
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QThread>
+#include <functional>
+#include "WriteCoalescer.h"
+#include "DatabaseManager.h"
+#include "PerformanceMonitor.h"
+
+WriteCoalescer* WriteCoalescer::instance = nullptr;
+std::atomic<bool> WriteCoalescer::enabled(false);
+
+namespace {
+    // Runs the coalescer's commit loop on its own thread
+    class CommitterThread : public QThread {
+    public:
+        explicit CommitterThread(const std::function<void()>& body) : body(body) {}
+
+    protected:
+        void run() override { body(); }
+
+    private:
+        std::function<void()> body;
+    };
+}
+
+WriteCoalescer::WriteCoalescer()
+    : committer(nullptr), maxBatch(64), maxDelayMs(2), stopping(false), commits(0), writes(0) {}
+
+WriteCoalescer& WriteCoalescer::getInstance() {
+    static QMutex instanceMutex;
+    QMutexLocker locker(&instanceMutex);
+
+    if (!instance) {
+        instance = new WriteCoalescer();
+    }
+    return *instance;
+}
+
+void WriteCoalescer::start(int batchLimit, int delayMs) {
+    QMutexLocker locker(&mutex);
+    maxBatch = qMax(1, batchLimit);
+    maxDelayMs = qMax(0, delayMs);
+    if (committer) return; // Already running; only the limits change
+
+    stopping = false;
+    committer = new CommitterThread([this]() { commitLoop(); });
+    committer->start();
+    enabled = true;
+}
+
+void WriteCoalescer::stop() {
+    enabled = false;
+
+    QThread* thread = nullptr;
+    {
+        QMutexLocker locker(&mutex);
+        thread = committer;
+        stopping = true;
+        wake.wakeAll();
+    }
+    if (!thread) return;
+
+    thread->wait(); // Drains the queue before exiting
+    delete thread;
+
+    QMutexLocker locker(&mutex);
+    committer = nullptr;
+}
+
+std::future<IDataRepository::WriteResult> WriteCoalescer::submit(Operation operation, int userId, int itemId) {
+    PendingWrite write = {operation, userId, itemId, std::promise<IDataRepository::WriteResult>()};
+    std::future<IDataRepository::WriteResult> result = write.result.get_future();
+
+    QMutexLocker locker(&mutex);
+    if (!committer || stopping) {
+        // Not coalescing (or shutting down): run it now as its own transaction
+        locker.unlock();
+        write.result.set_value(apply(write));
+        return result;
+    }
+
+    queue.push_back(std::move(write));
+    if (queue.size() == 1 || int(queue.size()) >= maxBatch) {
+        wake.wakeOne(); // First write starts the delay; a full batch ends it
+    }
+    return result;
+}
+
+void WriteCoalescer::commitLoop() {
+    QMutexLocker locker(&mutex);
+
+    for (;;) {
+        while (queue.empty() && !stopping) {
+            wake.wait(&mutex);
+        }
+        if (queue.empty()) break; // Stopping and drained
+
+        // Give other writers until the deadline to join this batch
+        QElapsedTimer waited;
+        waited.start();
+        while (int(queue.size()) < maxBatch && !stopping) {
+            qint64 remaining = maxDelayMs - waited.elapsed();
+            if (remaining <= 0) break;
+            wake.wait(&mutex, ulong(remaining));
+        }
+
+        std::vector<PendingWrite> batch;
+        size_t count = qMin(queue.size(), size_t(maxBatch));
+        batch.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            batch.push_back(std::move(queue.front()));
+            queue.pop_front();
+        }
+
+        locker.unlock();
+        commitBatch(batch);
+        locker.relock();
+    }
+
+    locker.unlock();
+
+    // Thread connections cannot outlive their thread
+    DatabaseManager::getInstance().releaseThreadConnection();
+}
+
+void WriteCoalescer::commitBatch(std::vector<PendingWrite>& batch) {
+    ScopedTimer timer("groupCommit");
+    DatabaseManager& dbm = DatabaseManager::getInstance();
+    std::vector<IDataRepository::WriteResult> results(batch.size(), IDataRepository::WriteFailed);
+
+    bool committed = dbm.beginTransaction();
+    if (committed) {
+        for (size_t i = 0; i < batch.size(); ++i) {
+            // A savepoint per write, so a refused write leaves no partial changes behind
+            if (!dbm.setSavepoint("write")) {
+                committed = false;
+                break;
+            }
+            results[i] = apply(batch[i]);
+            bool closed = results[i] == IDataRepository::WriteOk ? dbm.releaseSavepoint("write")
+                                                                 : dbm.rollbackToSavepoint("write");
+            if (!closed) {
+                committed = false;
+                break;
+            }
+        }
+
+        if (committed && !dbm.commitTransaction()) committed = false;
+        if (!committed) dbm.rollbackTransaction();
+    }
+
+    if (!committed) {
+        qDebug() << "Group commit of" << batch.size() << "writes failed";
+        timer.fail();
+    }
+
+    commits++;
+    writes += batch.size();
+    for (size_t i = 0; i < batch.size(); ++i) {
+        batch[i].result.set_value(committed ? results[i] : IDataRepository::WriteFailed);
+    }
+}
+
+IDataRepository::WriteResult WriteCoalescer::apply(const PendingWrite& write) {
+    DatabaseManager& dbm = DatabaseManager::getInstance();
+
+    switch (write.operation) {
+    case Borrow:
+        return dbm.tryBorrowItem(write.userId, write.itemId);
+    case Return:
+        return dbm.tryReturnItem(write.userId, write.itemId);
+    case PlaceHold:
+        return dbm.placeHold(write.userId, write.itemId) ? IDataRepository::WriteOk : IDataRepository::WriteFailed;
+    case CancelHold:
+        return dbm.cancelHold(write.userId, write.itemId) ? IDataRepository::WriteOk : IDataRepository::WriteFailed;
+    }
+    return IDataRepository::WriteFailed;
+}
@@ -0,0 +1,160 @@
+#ifndef WRITECOALESCER_H
+#define WRITECOALESCER_H
+
+#include <QMutex>
+#include <QWaitCondition>
+#include <deque>
+#include <future>
+#include <vector>
+#include <atomic>
+#include "IDataRepository.h"
+
+class QThread;
+
+/*
+    WriteCoalescer Class:
+    Singleton that group-commits circulation writes (borrow, return, place and
+    cancel hold) submitted from many threads. Every DatabaseManager write on its own
+    is a separate SQLite transaction and therefore a separate journal sync; under
+    concurrent desk traffic the syncs, not the statements, limit throughput.
+
+    While enabled, a committer thread collects queued writes until maxBatch are
+    waiting or maxDelayMs has passed since the first one, runs them in order inside
+    one BEGIN IMMEDIATE ... COMMIT and then completes each caller's future with that
+    operation's own result.
+
+    Per-operation semantics:
+      - Each write runs under its own savepoint. A write that does not succeed
+        (WriteConflict: item already checked out, loan already returned; or
+        WriteFailed) is rolled back to its savepoint alone; the other writes in the
+        batch still commit.
+      - Writes see the effects of earlier writes in the same batch, so a borrow of
+        an item taken earlier in the batch fails exactly as it would have if the
+        two had committed separately: with WriteConflict.
+      - If the batch cannot begin or commit, every write in it reports WriteFailed
+        and nothing is applied.
+
+    Disabled unless start() is called (the server and the load generator do this on
+    request). When off, call sites only pay for one relaxed atomic load, like
+    TraceRecorder.
+
+    Data Members:
+      - std::deque<PendingWrite> queue: Writes waiting for the next commit
+      - QMutex mutex / QWaitCondition wake: Guard the queue and signal the committer
+      - QThread* committer: Thread running commitLoop() while enabled
+      - int maxBatch / int maxDelayMs: Commit triggers
+      - bool stopping: Set by stop(); the committer drains the queue and exits
+      - std::atomic<quint64> commits / writes: Totals since the coalescer was created
+      - static std::atomic<bool> enabled: Whether call sites should submit here
+      - static WriteCoalescer* instance: Singleton instance pointer
+
+    Member Functions:
+      Public:
+        - getInstance(): Provides global access to singleton instance
+        - start() / stop(): Start and stop the committer thread
+        - isEnabled(): Cheap check used at every call site
+        - submit(): Queues one write and returns a future for its result
+        - execute(): submit() and wait for the result
+        - getCommitCount() / getWriteCount(): Totals for reports
+      Private:
+        - commitLoop(): Committer thread body
+        - commitBatch(): Runs and commits one batch
+        - apply(): Runs one write through DatabaseManager
+*/
+class WriteCoalescer {
+public:
+    enum Operation {
+        Borrow,
+        Return,
+        PlaceHold,
+        CancelHold
+    };
+
+    /*
+        Function: getInstance
+        Purpose: Provides global access to the singleton WriteCoalescer instance.
+        Return: WriteCoalescer& - Reference to the singleton instance
+    */
+    static WriteCoalescer& getInstance();
+
+    /*
+        Function: start
+        Purpose: Starts the committer thread and enables coalescing
+        Parameters:
+          in: int batchLimit - Commit as soon as this many writes are queued
+          in: int delayMs - Commit at the latest this long after the first queued
+                            write (0 = commit whatever is queued immediately; writes
+                            arriving during a commit still share the next one)
+    */
+    void start(int batchLimit, int delayMs);
+
+    /*
+        Function: stop
+        Purpose: Disables coalescing, commits the writes still queued and waits for
+                 the committer thread to exit
+    */
+    void stop();
+
+    static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+
+    /*
+        Function: submit
+        Purpose: Queues one write for the next group commit
+        Parameters:
+          in: Operation operation - Write to perform
+          in: int userId - Database ID of the patron
+          in: int itemId - Database ID of the item
+        Return: std::future<IDataRepository::WriteResult> - Completed with the write's
+                result once its batch has committed (hold operations report only
+                WriteOk or WriteFailed)
+    */
+    std::future<IDataRepository::WriteResult> submit(Operation operation, int userId, int itemId);
+
+    /*
+        Function: execute
+        Purpose: Queues one write and blocks until its batch has committed
+        Parameters:
+          in: Operation operation - Write to perform
+          in: int userId - Database ID of the patron
+          in: int itemId - Database ID of the item
+        Return: IDataRepository::WriteResult - The write's result
+    */
+    IDataRepository::WriteResult execute(Operation operation, int userId, int itemId) {
+        return submit(operation, userId, itemId).get();
+    }
+
+    quint64 getCommitCount() const { return commits.load(); }
+    quint64 getWriteCount() const { return writes.load(); }
+
+private:
+    /*
+        PendingWrite Struct:
+        One queued write and the promise its caller is waiting on
+    */
+    struct PendingWrite {
+        Operation operation;
+        int userId;
+        int itemId;
+        std::promise<IDataRepository::WriteResult> result;
+    };
+
+    std::deque<PendingWrite> queue;
+    QMutex mutex;
+    QWaitCondition wake;
+    QThread* committer;
+    int maxBatch;
+    int maxDelayMs;
+    bool stopping;
+    std::atomic<quint64> commits;
+    std::atomic<quint64> writes;
+    static std::atomic<bool> enabled;
+    static WriteCoalescer* instance;
+
+    WriteCoalescer(); // Private constructor for singleton
+
+    void commitLoop();
+    void commitBatch(std::vector<PendingWrite>& batch);
+    static IDataRepository::WriteResult apply(const PendingWrite& write);
+};
+
+#endif
@@ -0,0 +1,445 @@
+#include <QtTest>
+#include <QSqlQuery>
+#include <QSqlDatabase>
+#include <QThread>
+#include <atomic>
+#include <functional>
+#include "SyntheticLibrary.h"
+#include "DatabaseManager.h"
+#include "AccountCache.h"
+#include "CatalogueSnapshot.h"
+#include "CatalogueVersion.h"
+#include "PerformanceMonitor.h"
+#include "MainWindow.h"
+#include "User.h"
+#include "LibraryItem.h"
+
+namespace {
+    // Runs one reader or writer of the catalogue version benchmark
+    class BodyThread : public QThread {
+    public:
+        explicit BodyThread(const std::function<void()>& body) : body(body) {}
+
+    protected:
+        void run() override { body(); }
+
+    private:
+        std::function<void()> body;
+    };
+}
+
+/*
+    DatabaseBenchmark Class:
+    QtTest benchmark suite for the HinLIBS data layer. Every public DatabaseManager
+    method (and the MainWindow catalogue refresh) is timed against generated
+    libraries of 10k, 100k and 1M items. Each benchmark is data-driven by library
+    size, so one run produces a comparable row per (method, size).
+
+    Mutating methods are benchmarked as reverting pairs (borrow + return,
+    placeHold + cancelHold, add + remove) so the database is unchanged between
+    iterations and between runs.
+
+    Environment:
+      - HINLIBS_BENCH_MAX_ITEMS: Skip libraries larger than this (default: all sizes)
+
+    Data Members:
+      - int currentSize: Library size the DatabaseManager is currently pointed at
+      - int patronId / itemId / heldItemId / availableItemId: Fixture ids for the current library
+      - QString patronName: Username of the fixture patron
+*/
+class DatabaseBenchmark : public QObject {
+    Q_OBJECT
+
+private:
+    int currentSize = 0;
+    int patronId = 0;
+    int itemId = 0;
+    int heldItemId = 0;
+    int availableItemId = 0;
+    QString patronName;
+
+    /*
+        Function: addSizes
+        Purpose: Adds one data row per library size, honouring HINLIBS_BENCH_MAX_ITEMS
+    */
+    void addSizes() {
+        QTest::addColumn<int>("items");
+
+        int maxItems = qEnvironmentVariableIsSet("HINLIBS_BENCH_MAX_ITEMS")
+                       ? qEnvironmentVariableIntValue("HINLIBS_BENCH_MAX_ITEMS")
+                       : 1000000;
+        for (int items : {10000, 100000, 1000000}) {
+            if (items <= maxItems) {
+                QTest::newRow(qPrintable(QString("%1k").arg(items / 1000))) << items;
+            }
+        }
+    }
+
+    /*
+        Function: useLibrary
+        Purpose: Points DatabaseManager at the generated library of the given size,
+                 generating it on first use, and loads the fixture ids.
+        Parameters:
+          in: int items - Library size
+        Return: bool - True if the library is ready
+    */
+    bool useLibrary(int items) {
+        if (items == currentSize) return true;
+
+        QString path = SyntheticLibrary::databasePath(items);
+        SyntheticLibrary library(items);
+        if (!library.ensureDatabase(path)) return false;
+
+        // Every size starts without a catalogue snapshot, so reads measure SQL unless a
+        // benchmark writes one
+        QFile::remove(CatalogueSnapshot::pathFor(path));
+        if (!DatabaseManager::getInstance().openDatabase(path)) return false;
+
+        QSqlQuery query(QSqlDatabase::database("library_connection"));
+
+        // Busiest patron: has active loans and holds, the worst case for account queries
+        query.exec("SELECT u.id, u.username FROM users u "
+                   "JOIN loans l ON l.user_id = u.id AND l.return_date IS NULL "
+                   "WHERE u.role = 'patron' AND u.id IN (SELECT user_id FROM holds) "
+                   "GROUP BY u.id ORDER BY COUNT(*) DESC, u.id LIMIT 1");
+        if (!query.next()) return false;
+        patronId = query.value(0).toInt();
+        patronName = query.value(1).toString();
+
+        query.exec(QString("SELECT item_id FROM loans WHERE user_id = %1 AND return_date IS NULL LIMIT 1").arg(patronId));
+        itemId = query.next() ? query.value(0).toInt() : 0;
+
+        // Hottest title: longest hold queue
+        query.exec("SELECT item_id FROM holds GROUP BY item_id ORDER BY COUNT(*) DESC, item_id LIMIT 1");
+        heldItemId = query.next() ? query.value(0).toInt() : 0;
+
+        query.exec("SELECT MAX(id) FROM catalogue_items WHERE is_available = 1");
+        availableItemId = query.next() ? query.value(0).toInt() : 0;
+
+        currentSize = items;
+        return true;
+    }
+
+private slots:
+    void initTestCase() {
+        // Timer bookkeeping is measured separately; keep it out of these numbers
+        PerformanceMonitor::getInstance().setEnabled(false);
+    }
+
+    // === USER OPERATIONS ===
+
+    void findUser_data() { addSizes(); }
+    void findUser() {
+        QFETCH(int, items);
+        QVERIFY(useLibrary(items));
+        QBENCHMARK {
+            delete DatabaseManager::getInstance().findUser(patronName);
+        }
+    }
+
+    void getAllUsers_data() { addSizes(); }
+    void getAllUsers() {
+        QFETCH(int, items);
+        QVERIFY(useLibrary(items));
+        QBENCHMARK {
+            qDeleteAll(DatabaseManager::getInstance().getAllUsers());
+        }
+    }
+
+    void searchPatrons_data() { addSizes(); }
+    void searchPatrons() {
+        QFETCH(int, items);
+        QVERIFY(useLibrary(items));
+        QBENCHMARK {
+            qDeleteAll(DatabaseManager::getInstance().searchPatrons("patron_00012", QString(), 50));
+        }
+    }
+
+    // === CATALOGUE OPERATIONS ===
+
+    void getAllCatalogueItems_data() { addSizes(); }
+    void getAllCatalogueItems() {
+        QFETCH(int, items);
+        QVERIFY(useLibrary(items));
+        QBENCHMARK {
+            qDeleteAll(DatabaseManager::getInstance().getAllCatalogueItems());
+        }
+    }
+
+    void saveCatalogueSnapshot_data() { addSizes(); }
+    void saveCatalogueSnapshot() {
+        QFETCH(int, items);
+        QVERIFY(useLibrary(items));
+        // No snapshot file yet (see useLibrary()): one full write per size
+        QBENCHMARK_ONCE {
+            QVERIFY(DatabaseManager::getInstance().saveCatalogueSnapshot());
+        }
+    }
+
+    void getAllCatalogueItemsMapped_data() { addSizes(); }
+    void getAllCatalogueItemsMapped() {
+        QFETCH(int, items);
+        QVERIFY(useLibrary(items));
+        QVERIFY(DatabaseManager::getInstance().saveCatalogueSnapshot());
+        QBENCHMARK {
+            qDeleteAll(DatabaseManager::getInstance().getAllCatalogueItems());
+        }
+    }
+
+    void readCatalogueVersion_data() {
+        QTest::addColumn<int>("items");
+        QTest::addColumn<int>("readers");
+
+        int maxItems = qEnvironmentVariableIsSet("HINLIBS_BENCH_MAX_ITEMS")
+                       ? qEnvironmentVariableIntValue("HINLIBS_BENCH_MAX_ITEMS")
+                       : 1000000;
+        for (int items : {10000, 100000, 1000000}) {
+            if (items > maxItems) continue;
+            for (int readers : {1, 2, 4, 8}) {
+                QTest::newRow(qPrintable(QString("%1k/%2 readers").arg(items / 1000).arg(readers)))
+                    << items << readers;
+            }
+        }
+    }
+    void readCatalogueVersion() {
+        QFETCH(int, items);
+        QFETCH(int, readers);
+        QVERIFY(useLibrary(items));
+        QVERIFY(availableItemId > 0);
+        DatabaseManager& dbm = DatabaseManager::getInstance();
+        QVERIFY(dbm.getCatalogueVersion()); // First build outside the measurement
+
+        // Each reader looks up a fixed number of items, taking the published version
+        // for every lookup, while one writer borrows, returns and publishes the result.
+        // Flat times across reader counts mean readers scale with cores.
+        const int lookups = 200000;
+        const int patron = patronId;
+        const int writerItem = availableItemId;
+        std::atomic<int> found(0);
+        QBENCHMARK_ONCE {
+            std::atomic<bool> readersDone(false);
+            BodyThread writer([&dbm, &readersDone, patron, writerItem]() {
+                while (!readersDone.load()) {
+                    dbm.borrowItem(patron, writerItem);
+                    dbm.returnItem(patron, writerItem);
+                    dbm.getCatalogueVersion();
+                }
+                dbm.releaseThreadConnection();
+            });
+            writer.start();
+
+            std::vector<BodyThread*> threads;
+            for (int r = 0; r < readers; ++r) {
+                threads.push_back(new BodyThread([&dbm, &found, r, items, lookups]() {
+                    quint32 state = quint32(r) * 2654435761u + 1;
+                    int hits = 0;
+                    for (int i = 0; i < lookups; ++i) {
+                        state = state * 1664525u + 1013904223u;
+                        std::shared_ptr<const CatalogueVersion> version = dbm.getPublishedCatalogueVersion();
+                        if (version->find(int(state % quint32(items)) + 1)) hits++;
+                    }
+                    found += hits;
+                }));
+            }
+            for (BodyThread* thread : threads) thread->start();
+            for (BodyThread* thread : threads) thread->wait();
+            qDeleteAll(threads);
+
+            readersDone = true;
+            writer.wait();
+        }
+        QVERIFY(found.load() > 0);
+    }
+
+    void getItemById_data() { addSizes(); }
+    void getItemById() {
+        QFETCH(int, items);
+        QVERIFY(useLibrary(items));
+        QBENCHMARK {
+            delete DatabaseManager::getInstance().getItemById(itemId);
+        }
+    }
+
+    void getItemId_data() { addSizes(); }
+    void getItemId() {
+        QFETCH(int, items);
+        QVERIFY(useLibrary(items));
+        LibraryItem* item = DatabaseManager::getInstance().getItemById(itemId);
+        QVERIFY(item);
+        QBENCHMARK {
+            DatabaseManager::getInstance().getItemId(item);
+        }
+        delete item;
+    }
+
+    void getFacets_data() { addSizes(); }
+    void getFacets() {
+        QFETCH(int, items);
+        QVERIFY(useLibrary(items));
+        DatabaseManager& dbm = DatabaseManager::getInstance();
+
+        // "available AND movie AND published 1990-2009", with every facet's counts
+        IDataRepository::FacetFilter filter;
+        filter.values[IDataRepository::FacetFormat] = "movie";
+        filter.values[IDataRepository::FacetAvailability] = "available";
+        filter.fromYear = 1990;
+        filter.toYear = 2009;
+        dbm.getFacets(filter); // Builds the index outside the measurement
+        QBENCHMARK {
+            dbm.getFacets(filter);
+        }
+    }
+
+    void addAndRemoveItem_data() { addSizes(); }
+    void addAndRemoveItem() {
+        QFETCH(int, items);
+        QVERIFY(useLibrary(items));
+        DatabaseManager& dbm = DatabaseManager::getInstance();
+        QSqlQuery query(QSqlDatabase::database("library_connection"));
+        QBENCHMARK {
+            dbm.addItemToCatalogue("Benchmark Title", "Benchmark Author", "fiction", "",
+                                   "978-0-00000-000-0", "", "", 0, "", 2024, "Good", 1);
+            query.exec("SELECT MAX(id) FROM catalogue_items");
+            query.next();
+            dbm.removeItemFromCatalogue(query.value(0).toInt());
+        }
+    }
+
+    // === LOAN OPERATIONS ===
+
+    void borrowAndReturn_data() { addSizes(); }
+    void borrowAndReturn() {
+        QFETCH(int, items);
+        QVERIFY(useLibrary(items));
+        QVERIFY(availableItemId > 0);
+        DatabaseManager& dbm = DatabaseManager::getInstance();
+        QBENCHMARK {
+            dbm.borrowItem(patronId, availableItemId);
+            dbm.returnItem(patronId, availableItemId);
+        }
+    }
+
+    void getUserBorrowedItems_data() { addSizes(); }
+    void getUserBorrowedItems() {
+        QFETCH(int, items);
+        QVERIFY(useLibrary(items));
+        QBENCHMARK {
+            qDeleteAll(DatabaseManager::getInstance().getUserBorrowedItems(patronId));
+        }
+    }
+
+    void getUserLoansWithDates_data() { addSizes(); }
+    void getUserLoansWithDates() {
+        QFETCH(int, items);
+        QVERIFY(useLibrary(items));
+        QBENCHMARK {
+            auto loans = DatabaseManager::getInstance().getUserLoansWithDates(patronId);
+            for (auto& loan : loans) delete loan.item;
+        }
+    }
+
+    // === HOLD OPERATIONS ===
+
+    void placeAndCancelHold_data() { addSizes(); }
+    void placeAndCancelHold() {
+        QFETCH(int, items);
+        QVERIFY(useLibrary(items));
+        DatabaseManager& dbm = DatabaseManager::getInstance();
+
+        // A patron without a hold on the hottest title joins the back of its queue
+        QSqlQuery query(QSqlDatabase::database("library_connection"));
+        query.prepare("SELECT id FROM users WHERE role = 'patron' AND id NOT IN "
+                      "(SELECT user_id FROM holds WHERE item_id = ?) ORDER BY id LIMIT 1");
+        query.addBindValue(heldItemId);
+        QVERIFY(query.exec() && query.next());
+        int waitingPatron = query.value(0).toInt();
+
+        QBENCHMARK {
+            dbm.placeHold(waitingPatron, heldItemId);
+            dbm.cancelHold(waitingPatron, heldItemId);
+        }
+    }
+
+    void getUserHolds_data() { addSizes(); }
+    void getUserHolds() {
+        QFETCH(int, items);
+        QVERIFY(useLibrary(items));
+        QBENCHMARK {
+            qDeleteAll(DatabaseManager::getInstance().getUserHolds(patronId));
+        }
+    }
+
+    void getHoldCountForItem_data() { addSizes(); }
+    void getHoldCountForItem() {
+        QFETCH(int, items);
+        QVERIFY(useLibrary(items));
+        QBENCHMARK {
+            DatabaseManager::getInstance().getHoldCountForItem(heldItemId);
+        }
+    }
+
+    void getHoldPosition_data() { addSizes(); }
+    void getHoldPosition() {
+        QFETCH(int, items);
+        QVERIFY(useLibrary(items));
+        QBENCHMARK {
+            DatabaseManager::getInstance().getHoldPosition(patronId, heldItemId);
+        }
+    }
+
+    void getHoldQueue_data() { addSizes(); }
+    void getHoldQueue() {
+        QFETCH(int, items);
+        QVERIFY(useLibrary(items));
+        QBENCHMARK {
+            std::vector<int> userIds;
+            DatabaseManager::getInstance().getHoldQueue(heldItemId, userIds);
+        }
+    }
+
+    void getAccountSnapshot_data() { addSizes(); }
+    void getAccountSnapshot() {
+        QFETCH(int, items);
+        QVERIFY(useLibrary(items));
+        QBENCHMARK {
+            auto snapshot = DatabaseManager::getInstance().getAccountSnapshot(patronId);
+            DatabaseManager::freeAccountSnapshot(snapshot);
+        }
+    }
+
+    void getAccountSnapshotUncached_data() { addSizes(); }
+    void getAccountSnapshotUncached() {
+        QFETCH(int, items);
+        QVERIFY(useLibrary(items));
+        QBENCHMARK {
+            // As after a commit touching the account: the query runs every time
+            AccountCache::getInstance().invalidate();
+            auto snapshot = DatabaseManager::getInstance().getAccountSnapshot(patronId);
+            DatabaseManager::freeAccountSnapshot(snapshot);
+        }
+    }
+
+    // === UI FLOW ===
+
+    void refreshCatalogue_data() { addSizes(); }
+    void refreshCatalogue() {
+        QFETCH(int, items);
+        QVERIFY(useLibrary(items));
+
+        User* user = DatabaseManager::getInstance().findUser(patronName);
+        QVERIFY(user);
+        {
+            MainWindow window(user);
+            // Full list rebuild is slow at 1M items; a single timed pass per size is enough
+            QBENCHMARK_ONCE {
+                // Scheduled for the next frame; flushed so the update itself is timed
+                QVERIFY(QMetaObject::invokeMethod(&window, "refreshCatalogue", Qt::DirectConnection));
+                QVERIFY(QMetaObject::invokeMethod(&window, "flushRefresh", Qt::DirectConnection));
+            }
+        }
+        delete user;
+    }
+};
+
+QTEST_MAIN(DatabaseBenchmark)
+#include "DatabaseBenchmark.moc"
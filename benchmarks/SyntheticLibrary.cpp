@@ -0,0 +1,267 @@
+#include <QDebug>
+#include <QDate>
+#include <QFileInfo>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QVariantList>
+#include <cmath>
+#include "SyntheticLibrary.h"
+#include "DatabaseInitializer.h"
+
+namespace {
+    const char* FORMATS[] = {"fiction", "nonfiction", "magazine", "movie", "videogame"};
+    const char* CONDITIONS[] = {"Excellent", "Good", "Good", "Fair", "Poor"};
+    const char* GENRES[] = {"Drama", "Sci-Fi", "Comedy", "Documentary", "Puzzle", "Action-Adventure"};
+    const char* RATINGS[] = {"G", "PG", "PG-13", "R", "E", "E10+", "T"};
+    const int BATCH_SIZE = 10000;
+
+    // Hyphenated ISBN-13 with a correct check digit, so generated books index like real ones
+    QString syntheticIsbn(int publisher, int title) {
+        QString digits = QString("9780%1%2").arg(publisher, 5, 10, QChar('0')).arg(title, 3, 10, QChar('0'));
+        int sum = 0;
+        for (int i = 0; i < 12; ++i) {
+            sum += digits[i].digitValue() * (i % 2 == 0 ? 1 : 3);
+        }
+        return QString("978-0-%1-%2-%3").arg(digits.mid(4, 5), digits.mid(9, 3)).arg((10 - sum % 10) % 10);
+    }
+
+    // Runs a batched insert and reports failures
+    bool execBatch(QSqlQuery& query, const char* what) {
+        if (!query.execBatch()) {
+            qDebug() << "Error generating" << what << ":" << query.lastError().text();
+            return false;
+        }
+        return true;
+    }
+}
+
+SyntheticLibrary::SyntheticLibrary(int itemCount, quint32 seed)
+    : itemCount(itemCount), seed(seed), rng(seed) {}
+
+QString SyntheticLibrary::databasePath(int itemCount) {
+    return QString("bench_%1.db").arg(itemCount);
+}
+
+int SyntheticLibrary::popularIndex(int range) {
+    // Zipf-like skew (s ~ 1): rank = range^u, so low ranks (popular titles) dominate
+    double u = rng.generateDouble();
+    int rank = int(std::pow(double(range), u)) - 1;
+    return qMin(qMax(rank, 0), range - 1);
+}
+
+bool SyntheticLibrary::ensureDatabase(const QString& path) {
+    bool exists = QFileInfo(path).exists();
+
+    // Schema and the seven default accounts come from the normal initializer
+    if (!DatabaseInitializer::initializeDatabase(path)) {
+        return false;
+    }
+
+    QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", "synthetic_library");
+    db.setDatabaseName(path);
+    if (!db.open()) {
+        qDebug() << "Error opening synthetic library:" << db.lastError().text();
+        return false;
+    }
+
+    bool ok = true;
+    QSqlQuery query(db);
+    query.exec("SELECT COUNT(*) FROM catalogue_items WHERE title LIKE 'Synthetic %'");
+    int existing = query.next() ? query.value(0).toInt() : 0;
+
+    if (!exists || existing != itemCount) {
+        qDebug() << "Generating synthetic library with" << itemCount << "items at" << path;
+        ok = generate(db);
+    }
+
+    query.clear();
+    db.close();
+    db = QSqlDatabase();
+    QSqlDatabase::removeDatabase("synthetic_library");
+    return ok;
+}
+
+bool SyntheticLibrary::generate(QSqlDatabase& db) {
+    rng.seed(seed);
+    QSqlQuery query(db);
+
+    // Bulk load settings: this is a throwaway file, durability does not matter
+    query.exec("PRAGMA journal_mode = OFF");
+    query.exec("PRAGMA synchronous = OFF");
+
+    db.transaction();
+    query.exec("DELETE FROM holds");
+    query.exec("DELETE FROM loans");
+    query.exec("DELETE FROM loan_history");
+    query.exec("DELETE FROM item_stats");
+    query.exec("DELETE FROM item_copies"); // Rebuilt from is_available below
+    query.exec("DELETE FROM catalogue_items WHERE title LIKE 'Synthetic %'");
+    query.exec("DELETE FROM users WHERE username LIKE 'patron_%'");
+
+    // --- Patrons ---
+    int patronCount = qMax(100, itemCount / 10);
+    query.prepare("INSERT INTO users (username, role) VALUES (?, 'patron')");
+    for (int start = 0; start < patronCount; start += BATCH_SIZE) {
+        QVariantList names;
+        for (int i = start; i < qMin(patronCount, start + BATCH_SIZE); ++i) {
+            names << QString("patron_%1").arg(i, 7, 10, QChar('0'));
+        }
+        query.addBindValue(names);
+        if (!execBatch(query, "patrons")) { db.rollback(); return false; }
+    }
+
+    query.exec("SELECT MIN(id) FROM users WHERE username LIKE 'patron_%'");
+    int firstPatronId = query.next() ? query.value(0).toInt() : 1;
+
+    // --- Catalogue items ---
+    query.prepare(
+        "INSERT INTO catalogue_items "
+        "(title, author, item_type, dewey_decimal, isbn, genre, rating, "
+        "issue_number, publication_date, publication_year, condition, is_available) "
+        "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, 1)"
+    );
+    for (int start = 0; start < itemCount; start += BATCH_SIZE) {
+        QVariantList titles, authors, types, deweys, isbns, genres, ratings, issues, pubDates, years, conditions;
+        for (int i = start; i < qMin(itemCount, start + BATCH_SIZE); ++i) {
+            QString type = FORMATS[i % 5];
+            bool isBook = (type == "fiction" || type == "nonfiction");
+            bool isMedia = (type == "movie" || type == "videogame");
+
+            titles << QString("Synthetic %1 %2").arg(type).arg(i);
+            authors << QString("Author %1").arg(rng.bounded(itemCount / 20 + 1));
+            types << type;
+            deweys << (type == "nonfiction"
+                       ? QVariant(QString("%1.%2").arg(rng.bounded(1000), 3, 10, QChar('0'))
+                                                  .arg(rng.bounded(100), 2, 10, QChar('0')))
+                       : QVariant());
+            isbns << (isBook ? QVariant(syntheticIsbn(rng.bounded(100000), i % 1000)) : QVariant());
+            genres << (isMedia ? QVariant(QString(GENRES[rng.bounded(6)])) : QVariant());
+            ratings << (isMedia ? QVariant(QString(RATINGS[rng.bounded(7)])) : QVariant());
+            issues << (type == "magazine" ? QVariant(rng.bounded(1, 500)) : QVariant());
+            pubDates << (type == "magazine" ? QVariant(QString("Issue %1").arg(i)) : QVariant());
+            years << rng.bounded(1900, 2025);
+            conditions << QString(CONDITIONS[rng.bounded(5)]);
+        }
+        query.addBindValue(titles);
+        query.addBindValue(authors);
+        query.addBindValue(types);
+        query.addBindValue(deweys);
+        query.addBindValue(isbns);
+        query.addBindValue(genres);
+        query.addBindValue(ratings);
+        query.addBindValue(issues);
+        query.addBindValue(pubDates);
+        query.addBindValue(years);
+        query.addBindValue(conditions);
+        if (!execBatch(query, "catalogue items")) { db.rollback(); return false; }
+    }
+
+    query.exec("SELECT MIN(id) FROM catalogue_items WHERE title LIKE 'Synthetic %'");
+    int firstItemId = query.next() ? query.value(0).toInt() : 1;
+
+    QDate today = QDate::currentDate();
+
+    // --- Loan history: returned loans skewed towards popular titles ---
+    query.prepare("INSERT INTO loans (user_id, item_id, checkout_date, due_date, return_date) "
+                  "VALUES (?, ?, ?, ?, ?)");
+    for (int start = 0; start < itemCount; start += BATCH_SIZE) {
+        QVariantList users, items, checkouts, dues, returns;
+        for (int i = start; i < qMin(itemCount, start + BATCH_SIZE); ++i) {
+            QDate checkout = today.addDays(-rng.bounded(30, 3 * 365));
+            users << firstPatronId + rng.bounded(patronCount);
+            items << firstItemId + popularIndex(itemCount);
+            checkouts << checkout.toString("yyyy-MM-dd");
+            dues << checkout.addDays(14).toString("yyyy-MM-dd");
+            returns << checkout.addDays(rng.bounded(1, 21)).toString("yyyy-MM-dd");
+        }
+        query.addBindValue(users);
+        query.addBindValue(items);
+        query.addBindValue(checkouts);
+        query.addBindValue(dues);
+        query.addBindValue(returns);
+        if (!execBatch(query, "loan history")) { db.rollback(); return false; }
+    }
+
+    // Returned loans live in loan_history; going through loans keeps one id sequence for both
+    if (!query.exec("INSERT INTO loan_history (id, user_id, item_id, copy_id, checkout_date, due_date, return_date) "
+                    "SELECT id, user_id, item_id, copy_id, checkout_date, due_date, return_date FROM loans "
+                    "WHERE return_date IS NOT NULL") ||
+        !query.exec("DELETE FROM loans WHERE return_date IS NOT NULL")) {
+        qDebug() << "Error moving loan history:" << query.lastError().text();
+        db.rollback();
+        return false;
+    }
+
+    // --- Active loans: ~8% of items, popular first, max 3 per patron ---
+    int activeTarget = itemCount * 8 / 100;
+    std::vector<char> onLoan(itemCount, 0);
+    std::vector<char> loansPerPatron(patronCount, 0);
+    std::vector<int> checkedOut;
+    QVariantList loanUsers, loanItems, loanCheckouts, loanDues;
+
+    for (int attempts = 0; int(checkedOut.size()) < activeTarget && attempts < activeTarget * 4; ++attempts) {
+        int item = popularIndex(itemCount);
+        int patron = rng.bounded(patronCount);
+        if (onLoan[item] || loansPerPatron[patron] >= 3) continue;
+
+        onLoan[item] = 1;
+        loansPerPatron[patron]++;
+        checkedOut.push_back(item);
+
+        QDate checkout = today.addDays(-rng.bounded(0, 28)); // Some are already overdue
+        loanUsers << firstPatronId + patron;
+        loanItems << firstItemId + item;
+        loanCheckouts << checkout.toString("yyyy-MM-dd");
+        loanDues << checkout.addDays(14).toString("yyyy-MM-dd");
+    }
+
+    query.prepare("INSERT INTO loans (user_id, item_id, checkout_date, due_date) VALUES (?, ?, ?, ?)");
+    query.addBindValue(loanUsers);
+    query.addBindValue(loanItems);
+    query.addBindValue(loanCheckouts);
+    query.addBindValue(loanDues);
+    if (!execBatch(query, "active loans")) { db.rollback(); return false; }
+
+    QVariantList unavailable;
+    for (int item : checkedOut) unavailable << firstItemId + item;
+    query.prepare("UPDATE catalogue_items SET is_available = 0 WHERE id = ?");
+    query.addBindValue(unavailable);
+    if (!execBatch(query, "availability")) { db.rollback(); return false; }
+
+    // --- Holds: queues on the most popular checked-out titles (checkedOut is popularity-biased) ---
+    QVariantList holdUsers, holdItems, holdPositions;
+    int hotTitles = qMin(int(checkedOut.size()), qMax(10, itemCount / 100));
+    for (int h = 0; h < hotTitles; ++h) {
+        int queueLength = 1 + int(20.0 * std::pow(rng.generateDouble(), 2.0)); // Mostly short queues
+        int patron = rng.bounded(patronCount);
+        for (int position = 1; position <= queueLength; ++position) {
+            holdUsers << firstPatronId + (patron + position * 7919) % patronCount;
+            holdItems << firstItemId + checkedOut[h];
+            holdPositions << position;
+        }
+    }
+
+    query.prepare("INSERT INTO holds (user_id, item_id, position) VALUES (?, ?, ?)");
+    query.addBindValue(holdUsers);
+    query.addBindValue(holdItems);
+    query.addBindValue(holdPositions);
+    if (!execBatch(query, "holds")) { db.rollback(); return false; }
+
+    if (!db.commit()) {
+        qDebug() << "Error committing synthetic library:" << db.lastError().text();
+        return false;
+    }
+
+    // One copy per generated title, on loan where a loan was generated
+    if (!DatabaseInitializer::createMissingCopies(db) || !DatabaseInitializer::createMissingKeys(db)) {
+        return false;
+    }
+
+    // Loans and holds were bulk-inserted around DatabaseManager
+    if (DatabaseInitializer::checkCounters(db, true) < 0 || DatabaseInitializer::checkItemStats(db, true) < 0) {
+        return false;
+    }
+
+    query.exec("ANALYZE");
+    return true;
+}
@@ -0,0 +1,79 @@
+#ifndef SYNTHETICLIBRARY_H
+#define SYNTHETICLIBRARY_H
+
+#include <QString>
+#include <QSqlDatabase>
+#include <QRandomGenerator>
+#include <vector>
+
+/*
+    SyntheticLibrary Class:
+    Generates reproducible, realistically skewed HinLIBS databases for benchmarking.
+    A library of N catalogue items gets N/10 patrons, a Zipf-like popularity curve
+    over titles, active loans concentrated on popular titles, a returned-loan history
+    and hold queues on the hottest checked-out titles. The same seed always produces
+    the same database.
+
+    Distribution (defaults):
+      - Items: even mix of the five LibraryItem formats
+      - Patrons: N / 10 (at least 100), each with at most 3 active loans
+      - Active loans: ~8% of items, drawn by popularity rank
+      - Loan history: one returned loan per item on average, drawn by popularity rank,
+        stored in loan_history
+      - Holds: queues of 1-20 patrons on the most popular checked-out titles
+
+    Data Members:
+      - int itemCount: Number of catalogue items to generate
+      - quint32 seed: Random seed for reproducible output
+      - QRandomGenerator rng: Seeded generator
+
+    Member Functions:
+      Public:
+        - SyntheticLibrary(): Configures size and seed
+        - ensureDatabase(): Creates (or reuses) the generated database file
+        - databasePath(): Default file name for a given size
+
+      Private:
+        - generate(): Writes schema and synthetic data into an open connection
+        - popularIndex(): Draws an item index from the popularity curve
+*/
+class SyntheticLibrary {
+public:
+    /*
+        Function: SyntheticLibrary
+        Purpose: Configures a generator for a library of the given size
+        Parameters:
+          in: int itemCount - Number of catalogue items
+          in: quint32 seed - Random seed (same seed, same database)
+    */
+    SyntheticLibrary(int itemCount, quint32 seed = 20240101);
+
+    /*
+        Function: ensureDatabase
+        Purpose: Returns a database file populated for this size and seed, generating
+                 it on first use and reusing it afterwards.
+        Parameters:
+          in: const QString& path - Database file to create or reuse
+        Return: bool - True if the file is ready to use
+    */
+    bool ensureDatabase(const QString& path);
+
+    /*
+        Function: databasePath
+        Purpose: Conventional file name for a generated library of a given size
+        Parameters:
+          in: int itemCount - Number of catalogue items
+        Return: QString - e.g. "bench_100000.db"
+    */
+    static QString databasePath(int itemCount);
+
+private:
+    int itemCount;
+    quint32 seed;
+    QRandomGenerator rng;
+
+    bool generate(QSqlDatabase& db);
+    int popularIndex(int range);
+};
+
+#endif
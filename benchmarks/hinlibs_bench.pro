@@ -0,0 +1,19 @@
+QT       += core gui widgets sql testlib
+
+CONFIG += c++17 console testcase
+CONFIG -= app_bundle
+
+TARGET = hinlibs_bench
+
+# Data layer shared with the application
+include(../hinlibs_data.pri)
+
+# GUI sources needed to benchmark the MainWindow refresh flow
+include(../hinlibs_gui.pri)
+
+SOURCES += \
+    DatabaseBenchmark.cpp \
+    SyntheticLibrary.cpp
+
+HEADERS += \
+    SyntheticLibrary.h
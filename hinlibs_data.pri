@@ -0,0 +1,44 @@
+# Data layer shared by the GUI application and the headless tools (benchmarks, load generator).
+# Depends only on QtCore and QtSql, so it can be linked without QtWidgets.
+
+QT += sql
+
+INCLUDEPATH += $$PWD
+
+SOURCES += \
+    $$PWD/AccountCache.cpp \
+    $$PWD/CatalogueKeys.cpp \
+    $$PWD/CatalogueSnapshot.cpp \
+    $$PWD/CatalogueVersion.cpp \
+    $$PWD/DatabaseInitializer.cpp \
+    $$PWD/DatabaseManager.cpp \
+    $$PWD/DueDateScanner.cpp \
+    $$PWD/FacetIndex.cpp \
+    $$PWD/HoldQueueIndex.cpp \
+    $$PWD/IDataRepository.cpp \
+    $$PWD/ItemBitmap.cpp \
+    $$PWD/LoanArchiver.cpp \
+    $$PWD/PerformanceMonitor.cpp \
+    $$PWD/SessionManager.cpp \
+    $$PWD/TraceRecorder.cpp \
+    $$PWD/WriteCoalescer.cpp
+
+HEADERS += \
+    $$PWD/AccountCache.h \
+    $$PWD/CatalogueKeys.h \
+    $$PWD/CatalogueSnapshot.h \
+    $$PWD/CatalogueVersion.h \
+    $$PWD/DatabaseInitializer.h \
+    $$PWD/DatabaseManager.h \
+    $$PWD/DueDateScanner.h \
+    $$PWD/FacetIndex.h \
+    $$PWD/HoldQueueIndex.h \
+    $$PWD/IDataRepository.h \
+    $$PWD/ItemBitmap.h \
+    $$PWD/LibraryItem.h \
+    $$PWD/LoanArchiver.h \
+    $$PWD/PerformanceMonitor.h \
+    $$PWD/SessionManager.h \
+    $$PWD/TraceRecorder.h \
+    $$PWD/User.h \
+    $$PWD/WriteCoalescer.h
@@ -0,0 +1,28 @@
+# Main window and dialogs shared by the GUI application and the benchmarks that drive
+# the MainWindow refresh flow. Requires hinlibs_data.pri; main.cpp stays with the application.
+
+QT += widgets
+
+INCLUDEPATH += $$PWD
+
+SOURCES += \
+    $$PWD/AddItemDialog.cpp \
+    $$PWD/AnalyticsDialog.cpp \
+    $$PWD/DiagnosticsDialog.cpp \
+    $$PWD/LoginDialog.cpp \
+    $$PWD/MainWindow.cpp \
+    $$PWD/PatronReturnDialog.cpp \
+    $$PWD/PatronSelectionDialog.cpp \
+    $$PWD/RefreshScheduler.cpp \
+    $$PWD/ShelfBrowserDialog.cpp
+
+HEADERS += \
+    $$PWD/AddItemDialog.h \
+    $$PWD/AnalyticsDialog.h \
+    $$PWD/DiagnosticsDialog.h \
+    $$PWD/LoginDialog.h \
+    $$PWD/MainWindow.h \
+    $$PWD/PatronReturnDialog.h \
+    $$PWD/PatronSelectionDialog.h \
+    $$PWD/RefreshScheduler.h \
+    $$PWD/ShelfBrowserDialog.h
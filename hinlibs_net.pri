@@ -0,0 +1,16 @@
+# Client/server protocol shared by the GUI application (thin-client mode),
+# the server and the server benchmark. Requires hinlibs_data.pri.
+
+QT += network
+
+INCLUDEPATH += $$PWD
+
+SOURCES += \
+    $$PWD/LibraryClient.cpp \
+    $$PWD/LibraryProtocol.cpp \
+    $$PWD/RemoteRepository.cpp
+
+HEADERS += \
+    $$PWD/LibraryClient.h \
+    $$PWD/LibraryProtocol.h \
+    $$PWD/RemoteRepository.h
@@ -1,30 +1,76 @@
 #include <QApplication>
+#include <QMessageBox>
 #include "LoginDialog.h"
 #include "MainWindow.h"
 #include "DatabaseManager.h"
-#include "DatabaseInitializer.h"
+#include "SessionManager.h"
+#include "LoanArchiver.h"
+#include "PerformanceMonitor.h"
+#include "TraceRecorder.h"
+#include "RemoteRepository.h"
+#include "LibraryProtocol.h"
 #include "QDir"
 #include "QFile"
 
 
 int main(int argc, char *argv[]) {
+    SessionManager::getInstance().markStartup();
     QApplication app(argc, argv);
 
-    // Initialize database
-    DatabaseInitializer::initializeDatabase("hinlibs.db");
+    // Thin-client mode: "--server <address>" uses a HinLIBS server instead of a local database
+    QStringList arguments = app.arguments();
+    int serverIndex = arguments.indexOf("--server");
+    RemoteRepository remote;
+
+    if (serverIndex >= 0) {
+        QString address = arguments.value(serverIndex + 1, LibraryProtocol::defaultAddress());
+        if (!remote.connectTo(address)) {
+            QMessageBox::critical(nullptr, "HinLIBS", "Could not connect to server " + address +
+                                  ":\n" + remote.getLastError());
+            return 1;
+        }
+        IDataRepository::setInstance(&remote);
+    } else {
+        // Initialize database on the manager's own connection; one PRAGMA when it is current.
+        // "--check-database" runs the migrations and counter checks regardless
+        if (!DatabaseManager::getInstance().prepareDatabase(arguments.contains("--check-database"))) {
+            QMessageBox::critical(nullptr, "HinLIBS", "Could not open or initialize hinlibs.db");
+            return 1;
+        }
+
+        // Move loans returned before loan_history existed out of the active table
+        LoanArchiver::getInstance().start();
+
+        // Catalogue and facet index load while the login screen waits for input
+        SessionManager::getInstance().startPrewarm();
+    }
+
+    // Data layer timings: dumped to JSON once a minute while anything changes
+    PerformanceMonitor::getInstance().startPeriodicDump("hinlibs_metrics.json", 60000);
+
+    // Optional session trace for replay by the load generator (tools/loadgen)
+    QString tracePath = qEnvironmentVariable("HINLIBS_TRACE_FILE");
+    if (!tracePath.isEmpty()) {
+        TraceRecorder::getInstance().start(tracePath);
+    }
 
     while (true) {
         LoginDialog loginDialog;
+        SessionManager::getInstance().reportLoginShown(); // First time only
 
         // Attempt user authentication
         if (loginDialog.exec() == QDialog::Accepted) {
             User* loggedInUser = loginDialog.getLoggedInUser();
 
             // Launch main application window with authenticated user
-            MainWindow mainWindow(loggedInUser);
-            mainWindow.show();
-            app.exec();
+            {
+                MainWindow mainWindow(loggedInUser);
+                mainWindow.show();
+                app.exec();
+            }
 
+            // Window is gone; release the session (the user stays cached for the next login)
+            SessionManager::getInstance().endSession();
 
             // main loop will run until Login Dialog gets closed: to support mutliple user per session
         } else {
@@ -32,5 +78,14 @@ int main(int argc, char *argv[]) {
         }
     }
 
+    SessionManager::getInstance().waitForPrewarm();
+    if (serverIndex < 0) {
+        // Leave a current catalogue snapshot for the next launch
+        DatabaseManager::getInstance().saveCatalogueSnapshot();
+    }
+    LoanArchiver::getInstance().stop();
+    TraceRecorder::getInstance().stop();
+    PerformanceMonitor::getInstance().stopPeriodicDump();
+    IDataRepository::setInstance(nullptr);
     return 0;
 }
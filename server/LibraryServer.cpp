@@ -0,0 +1,163 @@
+#include <QDebug>
+#include <QHostAddress>
+#include <QLocalSocket>
+#include <QTcpSocket>
+#include <QRunnable>
+#include "LibraryServer.h"
+#include "LibraryProtocol.h"
+
+namespace {
+    // Streamed output is handed to the connection's thread in pieces of about this size
+    const int FLUSH_BYTES = 256 * 1024;
+
+    // Executes one batch of a connection's requests on a pool thread
+    class BatchTask : public QRunnable {
+    public:
+        BatchTask(QObject* connection, RequestHandler& handler, std::deque<LibraryProtocol::Frame> requests)
+            : connection(connection), handler(handler), requests(std::move(requests)) {}
+
+        void run() override {
+            QByteArray responses;
+            auto send = [this, &responses](const QByteArray& frame) {
+                responses.append(frame);
+                if (responses.size() >= FLUSH_BYTES) {
+                    // Large result: start writing while the rest is still being encoded
+                    QMetaObject::invokeMethod(connection, "writeResponses", Qt::QueuedConnection,
+                                              Q_ARG(QByteArray, responses));
+                    responses.clear();
+                }
+            };
+
+            for (const LibraryProtocol::Frame& request : requests) {
+                handler.handle(request, send);
+            }
+            // Connection objects are only deleted once their batch finished, so this is safe
+            QMetaObject::invokeMethod(connection, "finishBatch", Qt::QueuedConnection,
+                                      Q_ARG(QByteArray, responses));
+        }
+
+    private:
+        QObject* connection;
+        RequestHandler& handler;
+        std::deque<LibraryProtocol::Frame> requests;
+    };
+}
+
+// === SERVER CONNECTION ===
+
+ServerConnection::ServerConnection(QIODevice* socket, RequestHandler& handler, QThreadPool& pool, QObject* parent)
+    : QObject(parent), socket(socket), handler(handler), pool(pool), busy(false), closing(false) {
+    socket->setParent(this);
+    connect(socket, &QIODevice::readyRead, this, &ServerConnection::onReadyRead);
+
+    if (auto tcp = qobject_cast<QTcpSocket*>(socket)) {
+        tcp->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+        connect(tcp, &QTcpSocket::disconnected, this, &ServerConnection::onDisconnected);
+    } else if (auto local = qobject_cast<QLocalSocket*>(socket)) {
+        connect(local, &QLocalSocket::disconnected, this, &ServerConnection::onDisconnected);
+    }
+}
+
+ServerConnection::~ServerConnection() {}
+
+void ServerConnection::onReadyRead() {
+    buffer.append(socket->readAll());
+
+    LibraryProtocol::Frame request;
+    bool corrupt = false;
+    while (LibraryProtocol::takeFrame(buffer, request, corrupt)) {
+        pending.push_back(request);
+    }
+    if (corrupt) {
+        qDebug() << "Dropping client: corrupt request stream";
+        socket->close();
+        onDisconnected();
+        return;
+    }
+
+    scheduleBatch();
+}
+
+void ServerConnection::scheduleBatch() {
+    if (busy || closing || pending.empty()) return;
+
+    busy = true;
+    std::deque<LibraryProtocol::Frame> batch;
+    batch.swap(pending);
+    pool.start(new BatchTask(this, handler, std::move(batch)));
+}
+
+void ServerConnection::writeResponses(const QByteArray& responses) {
+    if (!closing) {
+        socket->write(responses);
+    }
+}
+
+void ServerConnection::finishBatch(const QByteArray& responses) {
+    busy = false;
+
+    if (closing) {
+        deleteLater();
+        return;
+    }
+
+    socket->write(responses);
+    scheduleBatch(); // Requests that arrived while the batch ran
+}
+
+void ServerConnection::onDisconnected() {
+    closing = true;
+    pending.clear();
+    if (!busy) {
+        deleteLater();
+    }
+}
+
+
+// === LIBRARY SERVER ===
+
+LibraryServer::LibraryServer(QObject* parent) : QObject(parent) {
+    // Workers keep their database connection for life; never retire idle threads
+    pool.setExpiryTimeout(-1);
+
+    connect(&tcpServer, &QTcpServer::newConnection, this, &LibraryServer::acceptTcp);
+    connect(&localServer, &QLocalServer::newConnection, this, &LibraryServer::acceptLocal);
+}
+
+bool LibraryServer::listen(const QString& address) {
+    bool tcp = false;
+    QString host;
+    quint16 port = 0;
+    if (!LibraryProtocol::parseAddress(address, tcp, host, port)) {
+        qDebug() << "Invalid listen address:" << address;
+        return false;
+    }
+
+    if (tcp) {
+        if (!tcpServer.listen(QHostAddress(host), port)) {
+            qDebug() << "Could not listen on" << address << ":" << tcpServer.errorString();
+            return false;
+        }
+    } else {
+        QLocalServer::removeServer(host); // Stale socket file from a crashed server
+        if (!localServer.listen(host)) {
+            qDebug() << "Could not listen on" << address << ":" << localServer.errorString();
+            return false;
+        }
+    }
+
+    qDebug() << "HinLIBS server listening on" << address;
+    return true;
+}
+
+void LibraryServer::acceptTcp() {
+    while (QTcpSocket* socket = tcpServer.nextPendingConnection()) {
+        new ServerConnection(socket, handler, pool, this);
+    }
+}
+
+void LibraryServer::acceptLocal() {
+    while (QLocalSocket* socket = localServer.nextPendingConnection()) {
+        new ServerConnection(socket, handler, pool, this);
+    }
+}
@@ -0,0 +1,108 @@
+#ifndef LIBRARYSERVER_H
+#define LIBRARYSERVER_H
+
+#include <QObject>
+#include <QTcpServer>
+#include <QLocalServer>
+#include <QThreadPool>
+#include <QIODevice>
+#include <QByteArray>
+#include <deque>
+#include "LibraryProtocol.h"
+#include "RequestHandler.h"
+
+/*
+    ServerConnection Class:
+    One client connection. Incoming frames are queued; whenever the connection is
+    idle, every queued frame is handed to a worker thread as one task, executed in
+    order, and the answers are written back together. Pipelined clients therefore
+    cost one thread hand-off per task rather than per request, while each client
+    still sees its requests applied in the order it sent them. Large streamed
+    results are written out in pieces while the task is still encoding them.
+    Different connections run in parallel on the worker pool.
+
+    Data Members:
+      - QIODevice* socket: QTcpSocket or QLocalSocket (owned)
+      - RequestHandler& handler: Shared request executor
+      - QThreadPool& pool: Shared worker pool
+      - QByteArray buffer: Received bytes not yet decoded
+      - std::deque<LibraryProtocol::Frame> pending: Decoded requests waiting to run
+      - bool busy: True while a batch is running on the pool
+      - bool closing: True once the client disconnected
+
+    Member Functions:
+      - ServerConnection(): Takes ownership of an accepted socket
+      - onReadyRead(): Decodes frames and schedules work
+      - onDisconnected(): Cleans up once no batch is running
+      - writeResponses(): Writes streamed answers of a running task
+      - finishBatch(): Writes a task's remaining answers (runs on the connection's thread)
+*/
+class ServerConnection : public QObject {
+    Q_OBJECT
+
+public:
+    ServerConnection(QIODevice* socket, RequestHandler& handler, QThreadPool& pool, QObject* parent = nullptr);
+    ~ServerConnection();
+
+private slots:
+    void onReadyRead();
+    void onDisconnected();
+    void writeResponses(const QByteArray& responses);
+    void finishBatch(const QByteArray& responses);
+
+private:
+    QIODevice* socket;
+    RequestHandler& handler;
+    QThreadPool& pool;
+    QByteArray buffer;
+    std::deque<LibraryProtocol::Frame> pending;
+    bool busy;
+    bool closing;
+
+    void scheduleBatch();
+};
+
+/*
+    LibraryServer Class:
+    Headless HinLIBS daemon front end. Listens on TCP and/or a local socket and
+    creates a ServerConnection for each client.
+
+    Data Members:
+      - QTcpServer tcpServer / QLocalServer localServer: Listeners
+      - QThreadPool pool: Worker threads that execute requests
+      - RequestHandler handler: Executes requests against DatabaseManager, with cache
+
+    Member Functions:
+      - listen(): Starts listening on an address ("tcp:host:port" or "local:name")
+      - setWorkerThreads(): Sizes the worker pool
+*/
+class LibraryServer : public QObject {
+    Q_OBJECT
+
+public:
+    explicit LibraryServer(QObject* parent = nullptr);
+
+    /*
+        Function: listen
+        Purpose: Starts accepting clients on an address. May be called once for TCP
+                 and once for a local socket to serve both.
+        Parameters:
+          in: const QString& address - "tcp:host:port" or "local:name"
+        Return: bool - True if listening
+    */
+    bool listen(const QString& address);
+
+    void setWorkerThreads(int threads) { pool.setMaxThreadCount(threads); }
+
+private slots:
+    void acceptTcp();
+    void acceptLocal();
+
+private:
+    QTcpServer tcpServer;
+    QLocalServer localServer;
+    RequestHandler handler;
+    QThreadPool pool; // Declared last: destroyed first, waiting for tasks that use handler
+};
+
+#endif
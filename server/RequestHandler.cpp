@@ -0,0 +1,409 @@
+#include <QJsonDocument>
+#include <QtAlgorithms>
+#include "RequestHandler.h"
+#include "DatabaseManager.h"
+#include "PerformanceMonitor.h"
+#include "WriteCoalescer.h"
+
+RequestHandler::RequestHandler() : catalogueGeneration(1), cachedGeneration(0), cachedUsersGeneration(0) {}
+
+void RequestHandler::handle(const LibraryProtocol::Frame& frame, const FrameSink& send) {
+    QDataStream in(frame.payload);
+    LibraryProtocol::prepareStream(in);
+
+    QByteArray result;
+    QDataStream out(&result, QIODevice::WriteOnly);
+    LibraryProtocol::prepareStream(out);
+    out << quint8(LibraryProtocol::Ok);
+
+    QString error;
+    bool catalogueChanged = false;
+
+    if (frame.type == LibraryProtocol::Request) {
+        quint8 opcode = 0;
+        in >> opcode;
+        Stream stream = {frame.id, send};
+        if (!execute(opcode, in, out, &stream, true, catalogueChanged)) {
+            error = QString("Bad request: %1").arg(LibraryProtocol::opcodeName(opcode));
+        }
+    } else if (frame.type == LibraryProtocol::Batch) {
+        quint8 flags = 0;
+        quint16 count = 0;
+        in >> flags >> count;
+        bool atomic = flags & LibraryProtocol::Atomic;
+
+        ScopedTimer timer(atomic ? "atomicBatch" : "batch", "server");
+        DatabaseManager& dbm = DatabaseManager::getInstance();
+
+        bool inTransaction = false;
+        if (atomic) {
+            inTransaction = dbm.beginTransaction();
+            if (!inTransaction) error = "Could not start transaction";
+        }
+        for (quint16 i = 0; i < count && error.isEmpty(); ++i) {
+            quint8 opcode = 0;
+            in >> opcode;
+            // Writes inside this batch's own transaction must not go to the coalescer's connection
+            if (!execute(opcode, in, out, nullptr, !inTransaction, catalogueChanged)) {
+                error = QString("Bad request in batch: %1").arg(LibraryProtocol::opcodeName(opcode));
+            }
+        }
+        if (inTransaction) {
+            if (error.isEmpty() && !dbm.commitTransaction()) error = "Could not commit transaction";
+            if (!error.isEmpty()) dbm.rollbackTransaction();
+        }
+        if (!error.isEmpty()) timer.fail();
+    } else {
+        error = QString("Unexpected frame type %1").arg(frame.type);
+    }
+
+    // Invalidate only after the change is visible to other connections
+    if (catalogueChanged) catalogueGeneration++;
+
+    if (!error.isEmpty()) {
+        QByteArray failure;
+        QDataStream failed(&failure, QIODevice::WriteOnly);
+        LibraryProtocol::prepareStream(failed);
+        failed << quint8(LibraryProtocol::Failed);
+        LibraryProtocol::writeText(failed, error);
+        result = failure;
+    }
+    send(LibraryProtocol::encodeFrame(LibraryProtocol::Response, frame.id, result));
+}
+
+void RequestHandler::writeSegment(const QByteArray& segment, QDataStream& out, const Stream* stream) {
+    if (stream) {
+        stream->send(LibraryProtocol::encodeFrame(LibraryProtocol::ResponseChunk, stream->id, segment));
+    } else {
+        out.writeRawData(segment.constData(), segment.size());
+    }
+}
+
+void RequestHandler::writeCatalogue(bool useCache, QDataStream& out, const Stream* stream) {
+    quint64 generation = catalogueGeneration.load();
+    if (useCache) {
+        bool hit = false;
+        std::vector<QByteArray> cached;
+        {
+            QReadLocker locker(&cacheLock);
+            if (cachedGeneration == generation) {
+                cached = cachedCatalogue;
+                hit = true;
+            }
+        }
+        if (hit) {
+            for (const QByteArray& segment : cached) writeSegment(segment, out, stream);
+            out << quint32(0); // End of list
+            return;
+        }
+    }
+
+    // Re-encoded from the shared catalogue version, which re-reads only the items changed
+    // since it was last refreshed. A batch that changed the catalogue reads its own rows.
+    std::shared_ptr<const CatalogueVersion> version;
+    if (useCache) version = DatabaseManager::getInstance().getCatalogueVersion();
+
+    // Each segment goes out as soon as it is encoded and is kept for the cache
+    std::vector<QByteArray> encoded;
+    auto send = [&](const QByteArray& segment) {
+        writeSegment(segment, out, stream);
+        encoded.push_back(segment);
+    };
+    if (version) {
+        std::vector<const LibraryItem*> items;
+        items.reserve(version->count());
+        version->forEach([&items](const LibraryItem* item) { items.push_back(item); });
+        LibraryProtocol::encodeSegments(items, LibraryProtocol::writeItem, send);
+    } else {
+        std::vector<LibraryItem*> items = DatabaseManager::getInstance().getAllCatalogueItems();
+        LibraryProtocol::encodeSegments(items, LibraryProtocol::writeItem, send);
+        qDeleteAll(items);
+    }
+    out << quint32(0); // End of list
+
+    // Only publish if nothing changed while we were reading
+    if (useCache) {
+        QWriteLocker locker(&cacheLock);
+        if (catalogueGeneration.load() == generation) {
+            cachedCatalogue = encoded;
+            cachedGeneration = generation;
+        }
+    }
+}
+
+QByteArray RequestHandler::user(const QString& username, bool useCache) {
+    // Users carry loan and hold counters, so they go stale with the same writes as the catalogue
+    quint64 generation = catalogueGeneration.load();
+    if (useCache) {
+        QReadLocker locker(&cacheLock);
+        auto it = cachedUsers.constFind(username);
+        if (cachedUsersGeneration == generation && it != cachedUsers.constEnd()) {
+            return it.value();
+        }
+    }
+
+    User* found = DatabaseManager::getInstance().findUser(username);
+
+    QByteArray encoded;
+    QDataStream out(&encoded, QIODevice::WriteOnly);
+    LibraryProtocol::prepareStream(out);
+    LibraryProtocol::writeUser(out, found);
+
+    if (found && useCache) { // Unknown names are not cached
+        delete found;
+        QWriteLocker locker(&cacheLock);
+        if (catalogueGeneration.load() == generation) {
+            if (cachedUsersGeneration != generation) {
+                cachedUsers.clear();
+                cachedUsersGeneration = generation;
+            }
+            cachedUsers.insert(username, encoded);
+        }
+    }
+    return encoded;
+}
+
+bool RequestHandler::execute(quint8 opcode, QDataStream& in, QDataStream& out, const Stream* stream,
+                             bool groupCommit, bool& catalogueChanged) {
+    ScopedTimer timer(LibraryProtocol::opcodeLabel(opcode), "server");
+    DatabaseManager& dbm = DatabaseManager::getInstance();
+
+    // Argument readers; each call consumes the next argument, so read into locals in order
+    auto number = [&in]() {
+        qint32 value = 0;
+        in >> value;
+        return int(value);
+    };
+    auto text = [&in]() { return LibraryProtocol::readText(in); };
+    auto malformed = [&in, &timer]() {
+        if (in.status() == QDataStream::Ok) return false;
+        timer.fail();
+        return true;
+    };
+
+    // Circulation writes share a group commit with other workers' writes when enabled
+    auto write = [&dbm, groupCommit](WriteCoalescer::Operation operation, int userId, int itemId) {
+        if (groupCommit && WriteCoalescer::isEnabled()) {
+            return WriteCoalescer::getInstance().execute(operation, userId, itemId);
+        }
+        bool done = false;
+        switch (operation) {
+        case WriteCoalescer::Borrow: return dbm.tryBorrowItem(userId, itemId);
+        case WriteCoalescer::Return: return dbm.tryReturnItem(userId, itemId);
+        case WriteCoalescer::PlaceHold: done = dbm.placeHold(userId, itemId); break;
+        case WriteCoalescer::CancelHold: done = dbm.cancelHold(userId, itemId); break;
+        }
+        return done ? IDataRepository::WriteOk : IDataRepository::WriteFailed;
+    };
+
+    switch (opcode) {
+    // Mutations
+    case LibraryProtocol::BorrowItem:
+    case LibraryProtocol::ReturnItem:
+    case LibraryProtocol::TryBorrowItem:
+    case LibraryProtocol::TryReturnItem: {
+        int userId = number();
+        int itemId = number();
+        if (malformed()) return false;
+        bool borrow = opcode == LibraryProtocol::BorrowItem || opcode == LibraryProtocol::TryBorrowItem;
+        IDataRepository::WriteResult result = write(borrow ? WriteCoalescer::Borrow : WriteCoalescer::Return,
+                                                    userId, itemId);
+        if (opcode == LibraryProtocol::TryBorrowItem || opcode == LibraryProtocol::TryReturnItem) {
+            out << quint8(result);
+        } else {
+            out << (result == IDataRepository::WriteOk); // Original bool result
+        }
+        if (result == IDataRepository::WriteOk) {
+            catalogueChanged = true; // Availability and loan counters changed
+        }
+        return true;
+    }
+    case LibraryProtocol::TryBorrowScanned: {
+        int userId = number();
+        QString code = text();
+        if (malformed()) return false;
+        // Runs directly: the code is resolved inside the borrow's own transaction
+        int itemId = -1;
+        IDataRepository::WriteResult result = dbm.tryBorrowScanned(userId, code, itemId);
+        out << quint8(result) << qint32(itemId);
+        if (result == IDataRepository::WriteOk) {
+            catalogueChanged = true;
+        }
+        return true;
+    }
+    case LibraryProtocol::AddItemToCatalogue: {
+        QString title = text(), author = text(), itemType = text(), dewey = text(), isbn = text();
+        QString genre = text(), rating = text();
+        int issue = number();
+        QString publicationDate = text();
+        int year = number();
+        QString condition = text();
+        int copies = number();
+        if (malformed()) return false;
+        out << dbm.addItemToCatalogue(title, author, itemType, dewey, isbn, genre, rating,
+                                      issue, publicationDate, year, condition, copies);
+        catalogueChanged = true;
+        return true;
+    }
+    case LibraryProtocol::RemoveItemFromCatalogue: {
+        int itemId = number();
+        if (malformed()) return false;
+        out << dbm.removeItemFromCatalogue(itemId);
+        catalogueChanged = true;
+        return true;
+    }
+    case LibraryProtocol::AddCopies: {
+        int itemId = number();
+        int count = number();
+        if (malformed()) return false;
+        out << dbm.addCopies(itemId, count);
+        catalogueChanged = true;
+        return true;
+    }
+    case LibraryProtocol::PlaceHold:
+    case LibraryProtocol::CancelHold: {
+        int userId = number();
+        int itemId = number();
+        if (malformed()) return false;
+        bool done = write(opcode == LibraryProtocol::PlaceHold ? WriteCoalescer::PlaceHold : WriteCoalescer::CancelHold,
+                          userId, itemId) == IDataRepository::WriteOk;
+        out << done;
+        if (done) {
+            // Hold counters changed; a cancelled hold's copy may also have gone back to the shelf
+            catalogueChanged = true;
+        }
+        return true;
+    }
+
+    // Reads
+    case LibraryProtocol::FindUser: {
+        QString username = text();
+        if (malformed()) return false;
+        QByteArray encoded = user(username, !catalogueChanged); // As for the catalogue below
+        out.writeRawData(encoded.constData(), encoded.size());
+        return true;
+    }
+    case LibraryProtocol::GetAllCatalogueItems:
+        // A batch that already changed the catalogue must see its own uncommitted rows
+        writeCatalogue(!catalogueChanged, out, stream);
+        return true;
+    case LibraryProtocol::GetAllUsers:
+    case LibraryProtocol::SearchPatrons: {
+        std::vector<User*> users;
+        if (opcode == LibraryProtocol::SearchPatrons) {
+            QString filter = text();
+            QString afterUsername = text();
+            int limit = number();
+            if (malformed()) return false;
+            users = dbm.searchPatrons(filter, afterUsername, limit);
+        } else {
+            users = dbm.getAllUsers();
+        }
+        writeList(users, LibraryProtocol::writeUser, out, stream);
+        qDeleteAll(users);
+        return true;
+    }
+    case LibraryProtocol::GetItemById: {
+        int itemId = number();
+        if (malformed()) return false;
+        LibraryItem* item = dbm.getItemById(itemId);
+        LibraryProtocol::writeItem(out, item);
+        delete item;
+        return true;
+    }
+    case LibraryProtocol::BrowseShelf: {
+        int fromKey = number();
+        int toKey = number();
+        int afterKey = number();
+        int afterId = number();
+        int limit = number();
+        if (malformed()) return false;
+        std::vector<IDataRepository::ShelfEntry> shelf = dbm.browseShelf(fromKey, toKey, afterKey, afterId, limit);
+        LibraryProtocol::writeList(out, shelf, LibraryProtocol::writeShelfEntry);
+        for (auto& entry : shelf) delete entry.item;
+        return true;
+    }
+    case LibraryProtocol::FindByIsbn:
+    case LibraryProtocol::FindByBarcode: {
+        QString code = text();
+        if (malformed()) return false;
+        out << qint32(opcode == LibraryProtocol::FindByIsbn ? dbm.findByIsbn(code) : dbm.findByBarcode(code));
+        return true;
+    }
+    case LibraryProtocol::GetFacets: {
+        IDataRepository::FacetFilter filter;
+        for (int f = 0; f < IDataRepository::FacetCount; ++f) filter.values[f] = text();
+        filter.fromYear = number();
+        filter.toYear = number();
+        if (malformed()) return false;
+        LibraryProtocol::writeFacets(out, dbm.getFacets(filter));
+        return true;
+    }
+    case LibraryProtocol::GetItemId: {
+        LibraryItem* item = LibraryProtocol::readItem(in);
+        if (malformed()) {
+            delete item;
+            return false;
+        }
+        out << qint32(item ? dbm.getItemId(item) : -1);
+        delete item;
+        return true;
+    }
+    case LibraryProtocol::GetUserBorrowedItems:
+    case LibraryProtocol::GetUserHolds: {
+        int userId = number();
+        if (malformed()) return false;
+        std::vector<LibraryItem*> items = opcode == LibraryProtocol::GetUserHolds ? dbm.getUserHolds(userId)
+                                                                                 : dbm.getUserBorrowedItems(userId);
+        writeList(items, LibraryProtocol::writeItem, out, stream);
+        qDeleteAll(items);
+        return true;
+    }
+    case LibraryProtocol::GetUserLoansWithDates: {
+        int userId = number();
+        if (malformed()) return false;
+        std::vector<IDataRepository::LoanInfo> loans = dbm.getUserLoansWithDates(userId);
+        writeList(loans, LibraryProtocol::writeLoan, out, stream);
+        for (auto& loan : loans) delete loan.item;
+        return true;
+    }
+    case LibraryProtocol::GetHoldCountForItem: {
+        int itemId = number();
+        if (malformed()) return false;
+        out << qint32(dbm.getHoldCountForItem(itemId));
+        return true;
+    }
+    case LibraryProtocol::GetHoldPosition: {
+        int userId = number();
+        int itemId = number();
+        if (malformed()) return false;
+        out << qint32(dbm.getHoldPosition(userId, itemId));
+        return true;
+    }
+    case LibraryProtocol::GetAccountSnapshot: {
+        int userId = number();
+        if (malformed()) return false;
+        IDataRepository::AccountSnapshot snapshot = dbm.getAccountSnapshot(userId);
+        LibraryProtocol::writeSnapshot(out, snapshot);
+        IDataRepository::freeAccountSnapshot(snapshot);
+        return true;
+    }
+    case LibraryProtocol::GetCirculationReport: {
+        int topN = number();
+        if (malformed()) return false;
+        LibraryProtocol::writeReport(out, dbm.getCirculationReport(topN));
+        return true;
+    }
+
+    // Server utilities
+    case LibraryProtocol::Ping:
+        out << true;
+        return true;
+    case LibraryProtocol::Stats:
+        out << QJsonDocument(PerformanceMonitor::getInstance().toJson()).toJson(QJsonDocument::Compact);
+        return true;
+    }
+
+    timer.fail();
+    return false;
+}
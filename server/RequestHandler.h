@@ -0,0 +1,126 @@
+#ifndef REQUESTHANDLER_H
+#define REQUESTHANDLER_H
+
+#include <QByteArray>
+#include <QDataStream>
+#include <QHash>
+#include <QReadWriteLock>
+#include <atomic>
+#include <functional>
+#include <vector>
+#include "LibraryProtocol.h"
+
+/*
+    RequestHandler Class:
+    Executes decoded protocol frames against DatabaseManager and produces the
+    response frames. Safe to call from several worker threads at once:
+    DatabaseManager gives each thread its own connection, and the cache below is
+    lock-protected.
+
+    Requests and batches:
+      - A Request frame runs one operation. Large list results are streamed: each
+        full segment goes out as a ResponseChunk frame as soon as it is encoded.
+      - A Batch frame runs its operations in order and answers with one Response
+        holding every result. With the Atomic flag the batch runs inside one
+        transaction (BEGIN IMMEDIATE ... COMMIT); a malformed operation rolls the
+        whole batch back. An operation that merely reports false (e.g. a refused
+        borrow) is a result, not an error, and does not roll back.
+      - With group commit enabled (WriteCoalescer), borrow, return and hold writes
+        outside atomic batches are committed together with other workers' writes.
+
+    Cache:
+      - The encoded catalogue segments (the largest and most requested response) are
+        kept together with the catalogue generation they were built at. Every
+        operation that changes catalogue rows or the counters stored with items and
+        users (a successful borrow, return, hold or cancel, add, remove) bumps the
+        generation once its change is committed, so a stale copy is never served.
+        Segments are re-encoded from DatabaseManager's shared CatalogueVersion, so a
+        rebuild after a borrow reads the changed rows, not the whole catalogue.
+      - Encoded users are cached by username for one generation: accounts are never
+        renamed or deleted, but their loan and hold counters change with circulation.
+
+    Data Members:
+      - std::atomic<quint64> catalogueGeneration: Bumped by catalogue mutations
+      - std::vector<QByteArray> cachedCatalogue / quint64 cachedGeneration: Cached catalogue
+      - QHash<QString, QByteArray> cachedUsers / quint64 cachedUsersGeneration: Encoded
+        findUser results by username, and the generation they were read at
+      - QReadWriteLock cacheLock: Guards the cached values
+
+    Member Functions:
+      - handle(): Executes one frame and emits its response frames
+*/
+class RequestHandler {
+public:
+    typedef std::function<void(const QByteArray&)> FrameSink;
+
+    RequestHandler();
+
+    /*
+        Function: handle
+        Purpose: Executes one Request or Batch frame
+        Parameters:
+          in: const LibraryProtocol::Frame& frame - Decoded request frame
+          in: const FrameSink& send - Receives the encoded response frames, in order
+                                      (any ResponseChunk frames, then the Response)
+    */
+    void handle(const LibraryProtocol::Frame& frame, const FrameSink& send);
+
+private:
+    /*
+        Stream Struct:
+        Where a single request's list segments are sent ahead of its Response
+    */
+    struct Stream {
+        quint32 id;
+        const FrameSink& send;
+    };
+
+    std::atomic<quint64> catalogueGeneration;
+    std::vector<QByteArray> cachedCatalogue;
+    quint64 cachedGeneration;
+    QHash<QString, QByteArray> cachedUsers;
+    quint64 cachedUsersGeneration;
+    QReadWriteLock cacheLock;
+
+    /*
+        Function: execute
+        Purpose: Decodes one operation's arguments, runs it and writes its result
+        Parameters:
+          in: quint8 opcode - Operation
+          in/out: QDataStream& in - Arguments
+          in/out: QDataStream& out - Result
+          in: const Stream* stream - Streams list results when set; inline when nullptr
+          in: bool groupCommit - Circulation writes may go through WriteCoalescer (false
+                                 inside an atomic batch, which has its own transaction)
+          out: bool& catalogueChanged - Set if the operation changed catalogue rows or
+                                        item / user counters
+        Return: bool - False for unknown operations or malformed arguments
+    */
+    bool execute(quint8 opcode, QDataStream& in, QDataStream& out, const Stream* stream, bool groupCommit,
+                 bool& catalogueChanged);
+
+    /*
+        Function: writeList
+        Purpose: Encodes a list result segment by segment, streaming each segment as a
+                 ResponseChunk before the next is encoded (inline when not streaming),
+                 then writes the terminator into the result
+        Parameters:
+          in: const std::vector<T>& rows - Rows to write
+          in: W writeRow - Writes one row: writeRow(out, row)
+          in/out: QDataStream& out - Result
+          in: const Stream* stream - Streams the segments when set; inline when nullptr
+    */
+    template <class T, class W>
+    void writeList(const std::vector<T>& rows, W writeRow, QDataStream& out, const Stream* stream) {
+        LibraryProtocol::encodeSegments(rows, writeRow, [&](const QByteArray& segment) {
+            writeSegment(segment, out, stream);
+        });
+        out << quint32(0); // End of list
+    }
+
+    void writeSegment(const QByteArray& segment, QDataStream& out, const Stream* stream);
+    void writeCatalogue(bool useCache, QDataStream& out, const Stream* stream);
+    QByteArray user(const QString& username, bool useCache);
+};
+
+#endif
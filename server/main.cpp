@@ -0,0 +1,96 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDebug>
+#include <QTextStream>
+#include <QThread>
+#include <QTimer>
+#include <QDate>
+#include "DatabaseInitializer.h"
+#include "DatabaseManager.h"
+#include "DueDateScanner.h"
+#include "PerformanceMonitor.h"
+#include "LibraryProtocol.h"
+#include "LibraryServer.h"
+#include "LoanArchiver.h"
+#include "WriteCoalescer.h"
+
+/*
+    HinLIBS server:
+    Headless daemon that hosts one library (DatabaseManager plus a response cache)
+    for any number of desks. Desktop clients connect with --server; see README.txt.
+*/
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("hinlibs_server");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("HinLIBS library server");
+    parser.addHelpOption();
+
+    QCommandLineOption dbOption("db", "SQLite database to serve.", "path", "hinlibs.db");
+    QCommandLineOption listenOption("listen", "Address to listen on; repeat for TCP and local "
+                                    "(default: local:hinlibs).", "address");
+    QCommandLineOption threadsOption("threads", "Worker threads executing requests.", "N",
+                                     QString::number(qMax(2, QThread::idealThreadCount())));
+    QCommandLineOption groupCommitOption("group-commit", "Group-commit circulation writes, waiting up to "
+                                         "this long for others to join each commit (0 = no wait).", "ms");
+    QCommandLineOption groupSizeOption("group-size", "Commit a group as soon as it has N writes.", "N", "64");
+    QCommandLineOption noticesOption("notices", "Generate overdue and due-soon notices every N minutes.",
+                                     "minutes");
+    parser.addOptions({dbOption, listenOption, threadsOption, groupCommitOption, groupSizeOption, noticesOption});
+    parser.process(app);
+
+    QString path = parser.value(dbOption);
+    if (!DatabaseInitializer::initializeDatabase(path)) {
+        return 1;
+    }
+
+    // Create the singletons on this thread before any worker touches them
+    PerformanceMonitor::getInstance().startPeriodicDump("hinlibs_server_metrics.json", 60000);
+    if (!DatabaseManager::getInstance().openDatabase(path)) {
+        return 1;
+    }
+
+    if (parser.isSet(groupCommitOption)) {
+        WriteCoalescer::getInstance().start(parser.value(groupSizeOption).toInt(),
+                                            parser.value(groupCommitOption).toInt());
+    }
+
+    // Legacy returned loans move to loan_history in the background while desks are served
+    LoanArchiver::getInstance().start();
+
+    // Incremental from each kind's checkpoint, so frequent runs only see newly due loans
+    QTimer noticeTimer;
+    auto generateNotices = []() {
+        QDate today = QDate::currentDate();
+        int overdue = DueDateScanner::generateNotices(DueDateScanner::Overdue, today);
+        int dueSoon = DueDateScanner::generateNotices(DueDateScanner::DueSoon, today);
+        if (overdue > 0 || dueSoon > 0) {
+            qDebug() << "Notices:" << overdue << "overdue," << dueSoon << "due soon";
+        }
+    };
+    if (parser.isSet(noticesOption)) {
+        QObject::connect(&noticeTimer, &QTimer::timeout, generateNotices);
+        noticeTimer.start(qMax(1, parser.value(noticesOption).toInt()) * 60000);
+        generateNotices();
+    }
+
+    LibraryServer server;
+    server.setWorkerThreads(parser.value(threadsOption).toInt());
+
+    QStringList addresses = parser.values(listenOption);
+    if (addresses.isEmpty()) {
+        addresses << LibraryProtocol::defaultAddress();
+    }
+    for (const QString& address : addresses) {
+        if (!server.listen(address)) {
+            return 1;
+        }
+    }
+
+    int result = app.exec();
+    LoanArchiver::getInstance().stop();
+    WriteCoalescer::getInstance().stop();
+    PerformanceMonitor::getInstance().stopPeriodicDump();
+    return result;
+}
@@ -0,0 +1,19 @@
+QT       += core network sql
+QT       -= gui
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = hinlibs_server
+
+include(../hinlibs_data.pri)
+include(../hinlibs_net.pri)
+
+SOURCES += \
+    main.cpp \
+    LibraryServer.cpp \
+    RequestHandler.cpp
+
+HEADERS += \
+    LibraryServer.h \
+    RequestHandler.h
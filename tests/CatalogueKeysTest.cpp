@@ -0,0 +1,95 @@
+#include <QtTest>
+#include "CatalogueKeysTest.h"
+#include "CatalogueKeys.h"
+
+void CatalogueKeysTest::isbnKey_data() {
+    QTest::addColumn<QString>("isbn");
+    QTest::addColumn<qint64>("key");
+
+    // One book, every way it is typed or scanned
+    QTest::newRow("isbn13 hyphenated") << "978-0-7432-7356-5" << Q_INT64_C(9780743273565);
+    QTest::newRow("isbn13 digits") << "9780743273565" << Q_INT64_C(9780743273565);
+    QTest::newRow("isbn13 spaced") << " 978 0 7432 7356 5 " << Q_INT64_C(9780743273565);
+    QTest::newRow("isbn10 hyphenated") << "0-7432-7356-7" << Q_INT64_C(9780743273565);
+    QTest::newRow("isbn10 digits") << "0743273567" << Q_INT64_C(9780743273565);
+
+    // ISBN-10 check digit ten is written X, in either case
+    QTest::newRow("isbn10 check X") << "0-8044-2957-X" << Q_INT64_C(9780804429573);
+    QTest::newRow("isbn10 check x") << "080442957x" << Q_INT64_C(9780804429573);
+    QTest::newRow("isbn13 of X book") << "978-0-8044-2957-3" << Q_INT64_C(9780804429573);
+    QTest::newRow("979 prefix") << "979-10-90636-07-1" << Q_INT64_C(9791090636071);
+
+    // Wrong check digits have no key, not the key of another book
+    QTest::newRow("isbn13 bad check") << "978-0-7432-7356-4" << Q_INT64_C(-1);
+    QTest::newRow("isbn10 bad check") << "0-7432-7356-8" << Q_INT64_C(-1);
+    QTest::newRow("isbn10 X not last") << "08044X9573" << Q_INT64_C(-1);
+    QTest::newRow("isbn13 with X") << "978080442957X" << Q_INT64_C(-1);
+    QTest::newRow("non-book EAN") << "5012345678900" << Q_INT64_C(-1);
+
+    QTest::newRow("too short") << "978-0-7432" << Q_INT64_C(-1);
+    QTest::newRow("too long") << "97807432735650" << Q_INT64_C(-1);
+    QTest::newRow("letters") << "ISBN 0743273567" << Q_INT64_C(-1);
+    QTest::newRow("empty") << "" << Q_INT64_C(-1);
+}
+
+void CatalogueKeysTest::isbnKey() {
+    QFETCH(QString, isbn);
+    QFETCH(qint64, key);
+    QCOMPARE(CatalogueKeys::isbnKey(isbn), key);
+}
+
+void CatalogueKeysTest::deweyKey_data() {
+    QTest::addColumn<QString>("dewey");
+    QTest::addColumn<int>("key");
+
+    QTest::newRow("class") << "500" << 500000000;
+    QTest::newRow("leading zeros") << "005" << 5000000;
+    QTest::newRow("one decimal") << "510.5" << 510500000;
+    QTest::newRow("two decimals") << "510.52" << 510520000;
+    QTest::newRow("three decimals") << "599.999" << 599999000;
+    QTest::newRow("trailing point") << "510." << 510000000;
+    QTest::newRow("past six decimals") << "001.1234567" << 1123456;
+    QTest::newRow("padded") << "  510.5  " << 510500000;
+
+    // Cutter numbers and other text after a space do not change the key
+    QTest::newRow("cutter") << "823.914 FIT" << 823914000;
+    QTest::newRow("cutter with digits") << "510.5 B123a" << 510500000;
+
+    // Segmentation marks are dropped
+    QTest::newRow("slash") << "641.5/973" << 641597300;
+    QTest::newRow("prime") << "641.5'973" << 641597300;
+    QTest::newRow("both marks") << "338.47'6/1" << 338476100;
+
+    QTest::newRow("four digit class") << "1234" << -1;
+    QTest::newRow("no class") << ".5" << -1;
+    QTest::newRow("letters") << "abc" << -1;
+    QTest::newRow("joined suffix") << "510.5x" << -1;
+    QTest::newRow("empty") << "" << -1;
+}
+
+void CatalogueKeysTest::deweyKey() {
+    QFETCH(QString, dewey);
+    QFETCH(int, key);
+    QCOMPARE(CatalogueKeys::deweyKey(dewey), key);
+
+    // A valid key reads back as the number it was parsed from, without marks or Cutter
+    if (key >= 0) QCOMPARE(CatalogueKeys::deweyKey(CatalogueKeys::deweyText(key)), key);
+}
+
+void CatalogueKeysTest::deweyUpperKey_data() {
+    QTest::addColumn<QString>("dewey");
+    QTest::addColumn<int>("key");
+
+    QTest::newRow("class") << "599" << 599999999;
+    QTest::newRow("one decimal") << "599.9" << 599999999;
+    QTest::newRow("two decimals") << "510.52" << 510529999;
+    QTest::newRow("six decimals") << "510.123456" << 510123456;
+    QTest::newRow("segmented") << "641.5/9" << 641599999;
+    QTest::newRow("invalid") << "x" << -1;
+}
+
+void CatalogueKeysTest::deweyUpperKey() {
+    QFETCH(QString, dewey);
+    QFETCH(int, key);
+    QCOMPARE(CatalogueKeys::deweyUpperKey(dewey), key);
+}
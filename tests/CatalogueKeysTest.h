@@ -0,0 +1,29 @@
+#ifndef CATALOGUEKEYSTEST_H
+#define CATALOGUEKEYSTEST_H
+
+#include <QObject>
+
+/*
+    CatalogueKeysTest Class:
+    Data-driven QtTest cases for the ISBN and Dewey keys in CatalogueKeys: every
+    written form of an ISBN maps to one key and bad check digits to none, and Dewey
+    class numbers sort as on the shelf whatever follows them.
+*/
+class CatalogueKeysTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    // ISBN-10 and ISBN-13 forms, check digits, X, prefixes and malformed text
+    void isbnKey_data();
+    void isbnKey();
+
+    // Class numbers with Cutter numbers, segmentation marks and extra decimals
+    void deweyKey_data();
+    void deweyKey();
+
+    // Range ends of typed class numbers
+    void deweyUpperKey_data();
+    void deweyUpperKey();
+};
+
+#endif
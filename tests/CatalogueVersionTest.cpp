@@ -0,0 +1,149 @@
+#include <QtTest>
+#include <algorithm>
+#include "CatalogueVersionTest.h"
+#include "LibraryItem.h"
+
+namespace {
+    const int CHUNK = CatalogueVersion::CHUNK_ITEMS;
+}
+
+CatalogueVersion::Item CatalogueVersionTest::item(int itemId) {
+    FictionBook* book = new FictionBook("Title " + std::to_string(itemId), "Author", 2000, "Good", "");
+    book->setId(itemId);
+    return CatalogueVersion::Item(book);
+}
+
+std::vector<CatalogueVersion::Item> CatalogueVersionTest::items(int first, int n, int step) {
+    std::vector<CatalogueVersion::Item> result;
+    for (int i = 0; i < n; ++i) result.push_back(item(first + i * step));
+    return result;
+}
+
+CatalogueVersionTest::Version CatalogueVersionTest::version(int first, int n, int step) {
+    std::vector<CatalogueVersion::Item> all = items(first, n, step);
+    return CatalogueVersion::build(all, 1, 0);
+}
+
+std::vector<size_t> CatalogueVersionTest::chunkSizes(const Version& version) {
+    std::vector<size_t> sizes;
+    for (const auto& chunk : version->chunks) sizes.push_back(chunk->size());
+    return sizes;
+}
+
+std::vector<int> CatalogueVersionTest::ids(const Version& version) {
+    std::vector<int> result;
+    version->forEach([&result](const LibraryItem* visited) { result.push_back(visited->getId()); });
+    return result;
+}
+
+void CatalogueVersionTest::chunkSplit() {
+    // Even IDs 2 .. 4096: two full chunks
+    Version base = version(2, 2 * CHUNK, 2);
+    QCOMPARE(chunkSizes(base), std::vector<size_t>({size_t(CHUNK), size_t(CHUNK)}));
+
+    // Odd IDs inside the first chunk's range bring it to exactly twice the size
+    Version full = base->withChanges(items(3, CHUNK - 1, 2), {}, 2, 0);
+    QCOMPARE(chunkSizes(full), std::vector<size_t>({size_t(2 * CHUNK - 1), size_t(CHUNK)}));
+    full = full->withChanges({item(1)}, {}, 3, 0);
+    QCOMPARE(chunkSizes(full), std::vector<size_t>({size_t(2 * CHUNK), size_t(CHUNK)}));
+
+    // One more and it is cut into CHUNK_ITEMS pieces
+    Version split = full->withChanges({item(0)}, {}, 4, 0);
+    QCOMPARE(chunkSizes(split), std::vector<size_t>({size_t(CHUNK), size_t(CHUNK), size_t(1), size_t(CHUNK)}));
+    QCOMPARE(split->count(), 3 * CHUNK + 1);
+    QCOMPARE(split->getGeneration(), qint64(4));
+
+    // Still every ID once, in order, and each found through the new boundaries
+    std::vector<int> expected;
+    for (int id = 0; id <= 2 * CHUNK; ++id) expected.push_back(id);
+    for (int id = 2 * CHUNK + 2; id <= 4 * CHUNK; id += 2) expected.push_back(id);
+    QCOMPARE(ids(split), expected);
+    for (int id : expected) {
+        CatalogueVersion::Item found = split->find(id);
+        QVERIFY(found);
+        QCOMPARE(found->getId(), id);
+    }
+    QVERIFY(!split->find(2 * CHUNK + 1));
+    QVERIFY(!split->find(4 * CHUNK + 1));
+}
+
+void CatalogueVersionTest::removal() {
+    Version base = version(1, 3 * CHUNK);
+
+    // Part of the first chunk, the whole second chunk, and an ID that is not there
+    std::vector<int> removed = {1, 2, 3};
+    for (int id = CHUNK + 1; id <= 2 * CHUNK; ++id) removed.push_back(id);
+    removed.push_back(3 * CHUNK + 50);
+
+    Version next = base->withChanges({}, removed, 2, 0);
+    QCOMPARE(chunkSizes(next), std::vector<size_t>({size_t(CHUNK - 3), size_t(CHUNK)}));
+    QCOMPARE(next->count(), 2 * CHUNK - 3);
+
+    QVERIFY(!next->find(1));
+    QVERIFY(!next->find(3));
+    QVERIFY(next->find(4));
+    QVERIFY(!next->find(CHUNK + 1));
+    QVERIFY(!next->find(2 * CHUNK));
+    QVERIFY(next->find(2 * CHUNK + 1));
+    QVERIFY(next->find(3 * CHUNK));
+
+    // Removing and re-adding an ID in one change leaves the new row
+    CatalogueVersion::Item readded = item(4);
+    Version again = next->withChanges({readded}, {4}, 3, 0);
+    QCOMPARE(again->find(4), readded);
+    QCOMPARE(again->count(), next->count());
+
+    // Removing everything leaves an empty version that new items can go into
+    std::vector<int> rest = ids(next);
+    Version empty = next->withChanges({}, rest, 4, 0);
+    QCOMPARE(empty->count(), 0);
+    QVERIFY(chunkSizes(empty).empty());
+    QVERIFY(!empty->find(4));
+
+    Version refilled = empty->withChanges({item(7), item(9)}, {}, 5, 0);
+    QCOMPARE(ids(refilled), std::vector<int>({7, 9}));
+}
+
+void CatalogueVersionTest::replaceAndAppend() {
+    Version base = version(10, 2 * CHUNK, 10);
+
+    CatalogueVersion::Item replacement = item(20);
+    CatalogueVersion::Item inserted = item(15);
+    CatalogueVersion::Item appended = item(100 * CHUNK);
+    Version next = base->withChanges({inserted, replacement, appended}, {}, 2, 0);
+
+    QCOMPARE(next->count(), 2 * CHUNK + 2);
+    QCOMPARE(next->find(20), replacement);
+    QCOMPARE(next->find(15), inserted);
+    QCOMPARE(next->find(100 * CHUNK), appended);
+    QCOMPARE(chunkSizes(next), std::vector<size_t>({size_t(CHUNK + 1), size_t(CHUNK + 1)}));
+
+    std::vector<int> visited = ids(next);
+    QVERIFY(std::is_sorted(visited.begin(), visited.end()));
+    QCOMPARE(visited.front(), 10);
+    QCOMPARE(visited.back(), 100 * CHUNK);
+}
+
+void CatalogueVersionTest::sharing() {
+    Version base = version(1, 3 * CHUNK);
+    CatalogueVersion::Item before = base->find(CHUNK + 5);
+
+    Version next = base->withChanges({item(CHUNK + 5)}, {2 * CHUNK + 1}, 2, 1);
+
+    // Only the middle and last chunks were copied
+    QCOMPARE(next->chunks[0], base->chunks[0]);
+    QVERIFY(next->chunks[1] != base->chunks[1]);
+    QVERIFY(next->chunks[2] != base->chunks[2]);
+
+    // Unchanged items in a copied chunk are the same objects
+    QCOMPARE(next->find(CHUNK + 6), base->find(CHUNK + 6));
+
+    // The older version still reads as it did
+    QCOMPARE(base->count(), 3 * CHUNK);
+    QCOMPARE(base->getGeneration(), qint64(1));
+    QCOMPARE(base->getCirculation(), qint64(0));
+    QCOMPARE(base->find(CHUNK + 5), before);
+    QVERIFY(next->find(CHUNK + 5) != before);
+    QVERIFY(base->find(2 * CHUNK + 1));
+    QVERIFY(!next->find(2 * CHUNK + 1));
+}
@@ -0,0 +1,50 @@
+#ifndef CATALOGUEVERSIONTEST_H
+#define CATALOGUEVERSIONTEST_H
+
+#include <QObject>
+#include <memory>
+#include <vector>
+#include "CatalogueVersion.h"
+
+/*
+    CatalogueVersionTest Class:
+    QtTest cases for CatalogueVersion::withChanges(): a chunk that grows past twice
+    CHUNK_ITEMS is split, emptied chunks are dropped, items are replaced, added and
+    removed in ID order, chunks no change falls into are shared with the older
+    version, and the older version itself never changes.
+
+    Member Functions:
+      Private:
+        - item(): A catalogue item with a given ID
+        - items(): Items for a range of IDs
+        - version(): Version built from a range of IDs
+        - chunkSizes(): Items per chunk of a version
+        - ids(): Every ID of a version, in the order forEach() visits them
+*/
+class CatalogueVersionTest : public QObject {
+    Q_OBJECT
+
+private:
+    typedef std::shared_ptr<const CatalogueVersion> Version;
+
+    static CatalogueVersion::Item item(int itemId);
+    static std::vector<CatalogueVersion::Item> items(int first, int n, int step = 1);
+    static Version version(int first, int n, int step = 1);
+    static std::vector<size_t> chunkSizes(const Version& version);
+    static std::vector<int> ids(const Version& version);
+
+private slots:
+    // A chunk at twice CHUNK_ITEMS is kept whole; one more item splits it
+    void chunkSplit();
+
+    // Removed items are gone; a chunk emptied by removals is dropped
+    void removal();
+
+    // A changed item replaces the one with its ID; IDs past the end join the last chunk
+    void replaceAndAppend();
+
+    // Untouched chunks are shared and the older version is unchanged
+    void sharing();
+};
+
+#endif
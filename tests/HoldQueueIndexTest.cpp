@@ -0,0 +1,140 @@
+#include <QtTest>
+#include <algorithm>
+#include "HoldQueueIndexTest.h"
+#include "HoldQueueIndex.h"
+
+std::vector<int> HoldQueueIndexTest::users(int first, int n) {
+    std::vector<int> ids;
+    for (int i = 0; i < n; ++i) ids.push_back(first + i);
+    return ids;
+}
+
+void HoldQueueIndexTest::removeHead() {
+    HoldQueueIndex::Queue queue(users(1, 10));
+    QCOMPARE(queue.position(1), 1);
+    QCOMPARE(queue.position(10), 10);
+
+    queue.remove(1);
+    queue.remove(2);
+    queue.remove(3);
+    QCOMPARE(queue.head, 3);
+    QCOMPARE(queue.size(), 7);
+    QCOMPARE(queue.position(1), -1);
+    QCOMPARE(queue.position(3), -1);
+    QCOMPARE(queue.position(4), 1);
+    QCOMPARE(queue.position(10), 7);
+
+    // Removing a patron with no hold changes nothing
+    queue.remove(2);
+    queue.remove(99);
+    QCOMPARE(queue.size(), 7);
+    QCOMPARE(queue.position(4), 1);
+}
+
+void HoldQueueIndexTest::removeMiddle() {
+    HoldQueueIndex::Queue queue(users(1, 10));
+    queue.remove(5);
+    queue.remove(7);
+    QCOMPARE(queue.head, 0);
+    QCOMPARE(queue.position(4), 4);
+    QCOMPARE(queue.position(6), 5);
+    QCOMPARE(queue.position(8), 6);
+    QCOMPARE(queue.position(10), 8);
+
+    // The head moves up to the first removed slot, then past it
+    queue.remove(1);
+    QCOMPARE(queue.position(6), 4);
+    QCOMPARE(queue.position(10), 7);
+    queue.remove(2);
+    queue.remove(3);
+    queue.remove(4);
+    QCOMPARE(queue.head, 5);
+    QCOMPARE(queue.position(6), 1);
+    QCOMPARE(queue.position(8), 2);
+    QCOMPARE(queue.position(10), 4);
+    QCOMPARE(queue.size(), 4);
+
+    // A patron who left can queue again, at the back
+    queue.enqueue(5);
+    QCOMPARE(queue.position(5), 5);
+}
+
+void HoldQueueIndexTest::compactAtHead() {
+    HoldQueueIndex::Queue queue(users(1, 200));
+    queue.remove(150); // Counted in the tree, and dropped by the compaction
+
+    for (int user = 1; user <= 130; ++user) queue.remove(user);
+
+    // Compacted when the head passed 100; the rest moved the head again from 0
+    QCOMPARE(queue.head, 29);
+    QCOMPARE(int(queue.slotUsers.size()), 98);
+    QCOMPARE(queue.size(), 69);
+    QCOMPARE(queue.position(131), 1);
+    QCOMPARE(queue.position(149), 19);
+    QCOMPARE(queue.position(150), -1);
+    QCOMPARE(queue.position(151), 20);
+    QCOMPARE(queue.position(200), 69);
+}
+
+void HoldQueueIndexTest::compactOnEnqueue() {
+    HoldQueueIndex::Queue queue(std::vector<int>{});
+    int capacity = int(queue.slotUsers.capacity());
+    for (int user = 1; user <= capacity; ++user) queue.enqueue(user);
+    queue.remove(5);
+    queue.remove(9);
+    QCOMPARE(queue.position(10), 8);
+
+    // No free slot left: the removed ones are dropped and the tree starts over
+    queue.enqueue(capacity + 1);
+    QCOMPARE(int(std::count(queue.slotUsers.begin(), queue.slotUsers.end(), -1)), 0);
+    QVERIFY(int(queue.slotUsers.capacity()) > capacity);
+    QCOMPARE(queue.size(), capacity - 1);
+    QCOMPARE(queue.position(4), 4);
+    QCOMPARE(queue.position(10), 8);
+    QCOMPARE(queue.position(capacity + 1), capacity - 1);
+
+    // The rebuilt tree counts removals again
+    queue.remove(2);
+    queue.remove(10);
+    QCOMPARE(queue.position(3), 2);
+    QCOMPARE(queue.position(11), 7);
+    QCOMPARE(queue.position(capacity + 1), capacity - 3);
+}
+
+void HoldQueueIndexTest::againstList() {
+    HoldQueueIndex::Queue queue(users(1, 50));
+    std::vector<int> expected = users(1, 50);
+    int nextUser = 51;
+
+    // Deterministic mix: enqueue, remove at the head, remove anywhere
+    quint32 seed = 12345;
+    auto random = [&seed](int n) {
+        seed = seed * 1103515245u + 12345u;
+        return int((seed >> 16) % quint32(n));
+    };
+
+    for (int step = 0; step < 5000; ++step) {
+        int kind = random(10);
+        if (kind < 4 || expected.empty()) {
+            queue.enqueue(nextUser);
+            expected.push_back(nextUser++);
+        } else if (kind < 7) {
+            queue.remove(expected.front());
+            expected.erase(expected.begin());
+        } else {
+            int index = random(int(expected.size()));
+            queue.remove(expected[index]);
+            expected.erase(expected.begin() + index);
+        }
+
+        if (step % 50 == 0) {
+            QCOMPARE(queue.size(), int(expected.size()));
+            for (size_t i = 0; i < expected.size(); ++i) {
+                QCOMPARE(queue.position(expected[i]), int(i) + 1);
+            }
+        }
+    }
+    for (size_t i = 0; i < expected.size(); ++i) {
+        QCOMPARE(queue.position(expected[i]), int(i) + 1);
+    }
+}
@@ -0,0 +1,40 @@
+#ifndef HOLDQUEUEINDEXTEST_H
+#define HOLDQUEUEINDEXTEST_H
+
+#include <QObject>
+#include <vector>
+
+/*
+    HoldQueueIndexTest Class:
+    QtTest cases for HoldQueueIndex::Queue: a patron's place in line stays right
+    after holds leave from the head and from the middle (the Fenwick tree of
+    removed slots), and after either kind of compaction rebuilds the slots.
+
+    Member Functions:
+      Private:
+        - users(): Patron IDs first .. first + n - 1
+*/
+class HoldQueueIndexTest : public QObject {
+    Q_OBJECT
+
+private:
+    static std::vector<int> users(int first, int n);
+
+private slots:
+    // Removals at the front only move the head
+    void removeHead();
+
+    // Removals further back, and the head moving past them later
+    void removeMiddle();
+
+    // Enough removals at the front compact the slots
+    void compactAtHead();
+
+    // Enqueueing into full slots compacts them and rebuilds the tree
+    void compactOnEnqueue();
+
+    // A long run of enqueues and removals checked against a plain list
+    void againstList();
+};
+
+#endif
@@ -0,0 +1,180 @@
+#include <QtTest>
+#include <algorithm>
+#include <iterator>
+#include "ItemBitmapTest.h"
+#include "ItemBitmap.h"
+
+namespace {
+    const int CHUNK = 65536; // Items per chunk key
+
+    // IDs first, first + step, ... below first + step * n
+    std::vector<int> range(int first, int n, int step = 1) {
+        std::vector<int> ids;
+        for (int i = 0; i < n; ++i) ids.push_back(first + i * step);
+        return ids;
+    }
+
+    std::vector<int> join(std::vector<int> a, const std::vector<int>& b) {
+        a.insert(a.end(), b.begin(), b.end());
+        std::sort(a.begin(), a.end());
+        return a;
+    }
+}
+
+bool ItemBitmapTest::isDense(const ItemBitmap& bitmap, int itemId) {
+    const ItemBitmap::Chunk* chunk = bitmap.find(quint16(itemId >> 16));
+    return chunk && chunk->isDense();
+}
+
+void ItemBitmapTest::fill(ItemBitmap& bitmap, const std::vector<int>& itemIds) {
+    for (int itemId : itemIds) bitmap.set(itemId);
+}
+
+std::vector<int> ItemBitmapTest::expected(const std::vector<int>& a, const std::vector<int>& b, bool intersect) {
+    std::vector<int> result;
+    if (intersect) {
+        std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(result));
+    } else {
+        std::set_union(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(result));
+    }
+    return result;
+}
+
+void ItemBitmapTest::sparseToDense() {
+    ItemBitmap bitmap;
+    std::vector<int> ids = range(CHUNK, 4096, 3);
+    fill(bitmap, ids);
+    QVERIFY(!isDense(bitmap, CHUNK));
+    QCOMPARE(bitmap.count(), 4096);
+
+    // Setting an item already there does not count towards the limit
+    bitmap.set(CHUNK);
+    QVERIFY(!isDense(bitmap, CHUNK));
+
+    bitmap.set(CHUNK + 1);
+    QVERIFY(isDense(bitmap, CHUNK));
+    QCOMPARE(bitmap.count(), 4097);
+    QCOMPARE(bitmap.ids(), join(ids, {CHUNK + 1}));
+    QVERIFY(bitmap.test(CHUNK + 1));
+    QVERIFY(!bitmap.test(CHUNK + 2));
+
+    // Other chunks keep their own form
+    bitmap.set(2 * CHUNK);
+    QVERIFY(!isDense(bitmap, 2 * CHUNK));
+}
+
+void ItemBitmapTest::denseToSparse() {
+    ItemBitmap bitmap;
+    std::vector<int> ids = range(0, 4097, 2);
+    fill(bitmap, ids);
+    QVERIFY(isDense(bitmap, 0));
+
+    // One item below the limit is not enough to convert back
+    bitmap.reset(ids.back());
+    ids.pop_back();
+    QVERIFY(isDense(bitmap, 0));
+    bitmap.set(ids.back() + 2);
+    ids.push_back(ids.back() + 2);
+    QVERIFY(isDense(bitmap, 0));
+
+    // Resetting an item that is not there changes nothing
+    bitmap.reset(1);
+    QCOMPARE(bitmap.count(), 4097);
+
+    while (ids.size() > 2049) {
+        bitmap.reset(ids.back());
+        ids.pop_back();
+    }
+    QVERIFY(isDense(bitmap, 0));
+    QCOMPARE(bitmap.count(), 2049);
+
+    bitmap.reset(ids.back());
+    ids.pop_back();
+    QVERIFY(!isDense(bitmap, 0));
+    QCOMPARE(bitmap.count(), 2048);
+    QCOMPARE(bitmap.ids(), ids);
+
+    // Emptied chunks are dropped
+    for (int itemId : ids) bitmap.reset(itemId);
+    QVERIFY(bitmap.isEmpty());
+}
+
+void ItemBitmapTest::mixedForms() {
+    // Chunk 0 dense against sparse, chunk 1 sparse against dense, chunk 2 dense on
+    // both sides, chunks 3 and 4 on one side only
+    std::vector<int> a = join(join(range(0, 10000, 2), range(CHUNK, 1000, 7)),
+                              join(range(2 * CHUNK, 5000), range(4 * CHUNK + 5, 3, 11)));
+    std::vector<int> b = join(join(range(0, 3000, 3), range(CHUNK, 6000)),
+                              join(range(2 * CHUNK + 2500, 7500), range(3 * CHUNK + 1, 3)));
+
+    ItemBitmap left, right;
+    fill(left, a);
+    fill(right, b);
+    QVERIFY(isDense(left, 0) && !isDense(right, 0));
+    QVERIFY(!isDense(left, CHUNK) && isDense(right, CHUNK));
+    QVERIFY(isDense(left, 2 * CHUNK) && isDense(right, 2 * CHUNK));
+
+    std::vector<int> both = expected(a, b, true);
+    std::vector<int> either = expected(a, b, false);
+    QCOMPARE(ItemBitmap::andCount(left, right), int(both.size()));
+    QCOMPARE(ItemBitmap::andCount(right, left), int(both.size()));
+
+    ItemBitmap intersection = left;
+    intersection &= right;
+    QCOMPARE(intersection.ids(), both);
+    QCOMPARE(intersection.count(), int(both.size()));
+
+    ItemBitmap reversed = right;
+    reversed &= left;
+    QCOMPARE(reversed.ids(), both);
+
+    ItemBitmap united = left;
+    united |= right;
+    QCOMPARE(united.ids(), either);
+    QCOMPARE(united.count(), int(either.size()));
+
+    united = right;
+    united |= left;
+    QCOMPARE(united.ids(), either);
+
+    // The operands are unchanged
+    QCOMPARE(left.ids(), a);
+    QCOMPARE(right.ids(), b);
+}
+
+void ItemBitmapTest::resultForms() {
+    ItemBitmap left, right;
+    fill(left, range(0, 5000));
+    fill(right, range(2500, 7500));
+
+    ItemBitmap small = left;
+    small &= right;
+    QVERIFY(!isDense(small, 0));
+    QCOMPARE(small.ids(), range(2500, 2500));
+
+    ItemBitmap large = left;
+    large &= right;
+    large |= left;
+    QVERIFY(isDense(large, 0));
+    QCOMPARE(large.count(), 5000);
+
+    // Two sparse chunks whose union is past the limit
+    ItemBitmap evens, odds;
+    fill(evens, range(0, 3000, 2));
+    fill(odds, range(1, 3000, 2));
+    QVERIFY(!isDense(evens, 0) && !isDense(odds, 0));
+    evens |= odds;
+    QVERIFY(isDense(evens, 0));
+    QCOMPARE(evens.ids(), range(0, 6000));
+
+    // Disjoint sets leave nothing, not an empty chunk
+    ItemBitmap none = evens;
+    none &= ItemBitmap();
+    QVERIFY(none.isEmpty());
+    fill(odds, range(CHUNK, 10));
+    ItemBitmap apart;
+    apart.set(2 * CHUNK);
+    apart &= odds;
+    QVERIFY(apart.isEmpty());
+    QCOMPARE(ItemBitmap::andCount(apart, odds), 0);
+}
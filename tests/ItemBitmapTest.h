@@ -0,0 +1,43 @@
+#ifndef ITEMBITMAPTEST_H
+#define ITEMBITMAPTEST_H
+
+#include <QObject>
+#include <vector>
+
+class ItemBitmap;
+
+/*
+    ItemBitmapTest Class:
+    QtTest cases for ItemBitmap: chunks change form at the ARRAY_LIMIT boundaries
+    (sparse past 4096 items, dense again only at 2048), and AND, OR and andCount
+    agree with a plain sorted list whatever forms the two sides' chunks are in.
+
+    Member Functions:
+      Private:
+        - isDense(): Form of the chunk holding an item
+        - fill(): Sets a list of items
+        - expected(): Reference intersection or union of two sorted lists
+*/
+class ItemBitmapTest : public QObject {
+    Q_OBJECT
+
+private:
+    static bool isDense(const ItemBitmap& bitmap, int itemId);
+    static void fill(ItemBitmap& bitmap, const std::vector<int>& itemIds);
+    static std::vector<int> expected(const std::vector<int>& a, const std::vector<int>& b, bool intersect);
+
+private slots:
+    // A sparse chunk turns dense at its 4097th item, not before
+    void sparseToDense();
+
+    // A dense chunk stays dense down to 2049 items and turns sparse at 2048
+    void denseToSparse();
+
+    // AND, OR and andCount over chunks that are dense on one side and sparse on the other
+    void mixedForms();
+
+    // Results change form: a small AND of dense chunks is sparse, a large OR of sparse ones dense
+    void resultForms();
+};
+
+#endif
@@ -0,0 +1,69 @@
+#include <QtTest>
+#include "WriteCoalescerTest.h"
+#include "WriteCoalescer.h"
+#include "DatabaseManager.h"
+#include "LibraryItem.h"
+#include "User.h"
+
+void WriteCoalescerTest::initTestCase() {
+    QVERIFY(directory.isValid());
+
+    DatabaseManager& dbm = DatabaseManager::getInstance();
+    QVERIFY(dbm.openDatabase(directory.filePath("coalescer.db")));
+    QVERIFY(dbm.prepareDatabase());
+}
+
+void WriteCoalescerTest::cleanupTestCase() {
+    WriteCoalescer::getInstance().stop();
+}
+
+void WriteCoalescerTest::groupCommitLastCopy() {
+    DatabaseManager& dbm = DatabaseManager::getInstance();
+
+    User* alice = dbm.findUser("alice_p");
+    User* bob = dbm.findUser("bob_p");
+    QVERIFY(alice && bob);
+    int aliceId = alice->id;
+    int bobId = bob->id;
+    delete alice;
+    delete bob;
+
+    // Default catalogue item with a single copy
+    int itemId = dbm.findByIsbn("978-0-7432-7356-5");
+    QVERIFY(itemId > 0);
+    LibraryItem* item = dbm.getItemById(itemId);
+    QVERIFY(item);
+    QCOMPARE(item->getTotalCopies(), 1);
+    QCOMPARE(item->getAvailableCopies(), 1);
+    delete item;
+
+    // The batch fills at two writes, long before the delay runs out, so both share one commit
+    WriteCoalescer& coalescer = WriteCoalescer::getInstance();
+    coalescer.start(2, 10000);
+    quint64 commitsBefore = coalescer.getCommitCount();
+
+    std::future<IDataRepository::WriteResult> first = coalescer.submit(WriteCoalescer::Borrow, aliceId, itemId);
+    std::future<IDataRepository::WriteResult> second = coalescer.submit(WriteCoalescer::Borrow, bobId, itemId);
+    IDataRepository::WriteResult firstResult = first.get();
+    IDataRepository::WriteResult secondResult = second.get();
+    coalescer.stop();
+
+    QCOMPARE(coalescer.getCommitCount(), commitsBefore + 1);
+    QCOMPARE(firstResult, IDataRepository::WriteOk);         // Runs first in the batch
+    QCOMPARE(secondResult, IDataRepository::WriteConflict);  // Sees the first borrow
+
+    // The refused borrow was rolled back alone; the other one committed
+    item = dbm.getItemById(itemId);
+    QVERIFY(item);
+    QCOMPARE(item->getAvailableCopies(), 0);
+    QVERIFY(!item->getAvailability());
+    delete item;
+
+    std::vector<LibraryItem*> aliceLoans = dbm.getUserBorrowedItems(aliceId);
+    std::vector<LibraryItem*> bobLoans = dbm.getUserBorrowedItems(bobId);
+    QCOMPARE(int(aliceLoans.size()), 1);
+    QCOMPARE(aliceLoans.front()->getId(), itemId);
+    QCOMPARE(int(bobLoans.size()), 0);
+    qDeleteAll(aliceLoans);
+    qDeleteAll(bobLoans);
+}
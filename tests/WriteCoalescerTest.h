@@ -0,0 +1,29 @@
+#ifndef WRITECOALESCERTEST_H
+#define WRITECOALESCERTEST_H
+
+#include <QObject>
+#include <QTemporaryDir>
+
+/*
+    WriteCoalescerTest Class:
+    QtTest cases for WriteCoalescer group commit, run against a fresh default
+    database in a temporary directory.
+
+    Data Members:
+      - QTemporaryDir directory: Holds the test database
+*/
+class WriteCoalescerTest : public QObject {
+    Q_OBJECT
+
+private:
+    QTemporaryDir directory;
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    // Two borrows of an item's last copy committed together: one wins, one conflicts
+    void groupCommitLastCopy();
+};
+
+#endif
@@ -0,0 +1,25 @@
+QT       += core sql testlib
+QT       -= gui
+
+CONFIG += c++17 console testcase
+CONFIG -= app_bundle
+
+TARGET = hinlibs_tests
+
+# Data layer under test
+include(../hinlibs_data.pri)
+
+SOURCES += \
+    main.cpp \
+    CatalogueKeysTest.cpp \
+    CatalogueVersionTest.cpp \
+    HoldQueueIndexTest.cpp \
+    ItemBitmapTest.cpp \
+    WriteCoalescerTest.cpp
+
+HEADERS += \
+    CatalogueKeysTest.h \
+    CatalogueVersionTest.h \
+    HoldQueueIndexTest.h \
+    ItemBitmapTest.h \
+    WriteCoalescerTest.h
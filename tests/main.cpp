@@ -0,0 +1,40 @@
+#include <QCoreApplication>
+#include <QtTest>
+#include "CatalogueKeysTest.h"
+#include "CatalogueVersionTest.h"
+#include "HoldQueueIndexTest.h"
+#include "ItemBitmapTest.h"
+#include "WriteCoalescerTest.h"
+
+/*
+    Function: main
+    Purpose: Runs every test class in turn; the exit code is the number of classes
+             with failures, so "make check" fails if any of them did
+*/
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    int failed = 0;
+
+    {
+        CatalogueKeysTest test;
+        failed += QTest::qExec(&test, argc, argv) != 0;
+    }
+    {
+        CatalogueVersionTest test;
+        failed += QTest::qExec(&test, argc, argv) != 0;
+    }
+    {
+        HoldQueueIndexTest test;
+        failed += QTest::qExec(&test, argc, argv) != 0;
+    }
+    {
+        ItemBitmapTest test;
+        failed += QTest::qExec(&test, argc, argv) != 0;
+    }
+    {
+        WriteCoalescerTest test;
+        failed += QTest::qExec(&test, argc, argv) != 0;
+    }
+
+    return failed;
+}
@@ -0,0 +1,222 @@
+#include <QJsonArray>
+#include <QTextStream>
+#include <QtAlgorithms>
+#include "LoadDriver.h"
+#include "DatabaseManager.h"
+#include "WriteCoalescer.h"
+
+// === LOAD WORKER ===
+
+LoadWorker::LoadWorker(WorkloadGenerator* generator, qint64 intervalNanos, qint64 durationNanos,
+                       const QElapsedTimer& clock)
+    : generator(generator), intervalNanos(intervalNanos), durationNanos(durationNanos),
+      speed(1.0), clock(clock) {}
+
+LoadWorker::LoadWorker(const std::vector<const TraceRecorder::Entry*>& trace, double speed,
+                       const QElapsedTimer& clock)
+    : generator(nullptr), trace(trace), intervalNanos(0), durationNanos(0),
+      speed(speed), clock(clock) {}
+
+LoadWorker::~LoadWorker() {
+    delete generator;
+}
+
+void LoadWorker::waitUntil(qint64 dueNanos) {
+    qint64 remaining = dueNanos - clock.nsecsElapsed();
+    if (remaining > 1000) {
+        QThread::usleep(quint64(remaining / 1000));
+    }
+}
+
+void LoadWorker::recordResult(const QString& operation, bool ok, qint64 startNanos) {
+    OperationResult& result = results[operation];
+    result.latency.record(clock.nsecsElapsed() - startNanos);
+    if (ok) {
+        result.ok++;
+    } else {
+        result.rejected++;
+    }
+}
+
+void LoadWorker::run() {
+    if (generator) {
+        qint64 due = clock.nsecsElapsed();
+        while (clock.nsecsElapsed() < durationNanos) {
+            qint64 start;
+            if (intervalNanos > 0) {
+                due += intervalNanos;
+                waitUntil(due);
+                start = due; // Scheduled start: late starts count against latency
+            } else {
+                start = clock.nsecsElapsed();
+            }
+
+            QString operation = generator->next();
+            if (operation.isEmpty()) break;
+            recordResult(operation, generator->execute(operation), start);
+        }
+    } else {
+        for (const TraceRecorder::Entry* entry : trace) {
+            qint64 start;
+            if (speed > 0) {
+                start = qint64(double(entry->micros) * 1000.0 / speed);
+                waitUntil(start);
+            } else {
+                start = clock.nsecsElapsed();
+            }
+            recordResult(entry->operation, WorkloadGenerator::executeTraced(*entry), start);
+        }
+    }
+
+    // Thread connections cannot outlive their thread
+    DatabaseManager::getInstance().releaseThreadConnection();
+}
+
+
+// === LOAD DRIVER ===
+
+void LoadDriver::runGenerated(const WorkloadConfig& config, const LibraryState& library) {
+    int threads = qMax(1, config.threads);
+    qint64 interval = config.rate > 0 ? qint64(1e9 * threads / config.rate) : 0;
+    qint64 duration = qint64(config.durationSeconds * 1e9);
+
+    PerformanceMonitor::getInstance().reset();
+
+    QElapsedTimer clock;
+    std::vector<LoadWorker*> workers;
+    for (int i = 0; i < threads; ++i) {
+        WorkloadGenerator* generator = new WorkloadGenerator(config, library, i, threads);
+        workers.push_back(new LoadWorker(generator, interval, duration, clock));
+    }
+
+    clock.start();
+    for (LoadWorker* worker : workers) worker->start();
+    collect(workers, clock);
+}
+
+void LoadDriver::runReplay(const std::vector<TraceRecorder::Entry>& entries, int threads, double speed) {
+    threads = qMax(1, threads);
+    std::vector<std::vector<const TraceRecorder::Entry*>> slices(threads);
+
+    // Keep each user's calls on one thread, in order; calls with no user go by first argument
+    for (const TraceRecorder::Entry& entry : entries) {
+        QVariant key = entry.args.value(0);
+        bool numeric = false;
+        int id = key.toInt(&numeric);
+        uint slot = numeric ? uint(id) : qHash(key.toString());
+        slices[slot % uint(threads)].push_back(&entry);
+    }
+
+    PerformanceMonitor::getInstance().reset();
+
+    QElapsedTimer clock;
+    std::vector<LoadWorker*> workers;
+    for (int i = 0; i < threads; ++i) {
+        workers.push_back(new LoadWorker(slices[i], speed, clock));
+    }
+
+    clock.start();
+    for (LoadWorker* worker : workers) worker->start();
+    collect(workers, clock);
+}
+
+void LoadDriver::collect(const std::vector<LoadWorker*>& workers, const QElapsedTimer& clock) {
+    for (LoadWorker* worker : workers) {
+        worker->wait();
+    }
+    elapsedSeconds = double(clock.nsecsElapsed()) / 1e9;
+
+    results.clear();
+    for (LoadWorker* worker : workers) {
+        const QMap<QString, OperationResult>& partial = worker->getResults();
+        for (auto it = partial.constBegin(); it != partial.constEnd(); ++it) {
+            OperationResult& merged = results[it.key()];
+            merged.ok += it.value().ok;
+            merged.rejected += it.value().rejected;
+            merged.latency.merge(it.value().latency);
+        }
+    }
+    qDeleteAll(workers);
+
+    // Operation-level rows (empty statement) carry the per-call error counts
+    groupCommits = WriteCoalescer::getInstance().getCommitCount();
+    groupWrites = WriteCoalescer::getInstance().getWriteCount();
+
+    busyErrors = 0;
+    sqlErrors = 0;
+    for (const PerformanceMonitor::Summary& summary : PerformanceMonitor::getInstance().getSummaries()) {
+        if (!summary.statement.isEmpty()) continue;
+        busyErrors += summary.busyErrors;
+        sqlErrors += summary.errors;
+    }
+}
+
+void LoadDriver::printReport() const {
+    QTextStream out(stdout);
+    auto ms = [](qint64 nanos) { return QString::number(double(nanos) / 1e6, 'f', 3); };
+
+    out << QString("%1 %2 %3 %4 %5 %6 %7 %8\n")
+           .arg("operation", -12).arg("ok", 9).arg("rejected", 9).arg("ops/s", 9)
+           .arg("p50 ms", 9).arg("p99 ms", 9).arg("p99.9 ms", 9).arg("max ms", 9);
+
+    quint64 total = 0;
+    LatencyHistogram overall;
+    for (auto it = results.constBegin(); it != results.constEnd(); ++it) {
+        const OperationResult& r = it.value();
+        quint64 count = r.ok + r.rejected;
+        total += count;
+        overall.merge(r.latency);
+
+        out << QString("%1 %2 %3 %4 %5 %6 %7 %8\n")
+               .arg(it.key(), -12).arg(r.ok, 9).arg(r.rejected, 9)
+               .arg(QString::number(double(count) / elapsedSeconds, 'f', 1), 9)
+               .arg(ms(r.latency.valueAtPercentile(50.0)), 9)
+               .arg(ms(r.latency.valueAtPercentile(99.0)), 9)
+               .arg(ms(r.latency.valueAtPercentile(99.9)), 9)
+               .arg(ms(r.latency.getMax()), 9);
+    }
+
+    out << "\n"
+        << "Total operations: " << total << " in " << QString::number(elapsedSeconds, 'f', 2) << " s"
+        << " (" << QString::number(double(total) / elapsedSeconds, 'f', 1) << " ops/s)\n"
+        << "Overall latency: p50 " << ms(overall.valueAtPercentile(50.0))
+        << " ms, p99 " << ms(overall.valueAtPercentile(99.0))
+        << " ms, p99.9 " << ms(overall.valueAtPercentile(99.9)) << " ms\n"
+        << "Database errors: " << sqlErrors << " (SQLITE_BUSY/LOCKED contention: " << busyErrors << ")\n";
+
+    if (groupCommits > 0) {
+        out << "Group commit: " << groupWrites << " writes in " << groupCommits << " transactions ("
+            << QString::number(double(groupWrites) / groupCommits, 'f', 1) << " per commit)\n";
+    }
+}
+
+QJsonObject LoadDriver::toJson() const {
+    QJsonArray operations;
+    quint64 total = 0;
+    for (auto it = results.constBegin(); it != results.constEnd(); ++it) {
+        const OperationResult& r = it.value();
+        total += r.ok + r.rejected;
+
+        QJsonObject op;
+        op["operation"] = it.key();
+        op["ok"] = double(r.ok);
+        op["rejected"] = double(r.rejected);
+        op["throughput"] = double(r.ok + r.rejected) / elapsedSeconds;
+        op["p50Ns"] = double(r.latency.valueAtPercentile(50.0));
+        op["p99Ns"] = double(r.latency.valueAtPercentile(99.0));
+        op["p999Ns"] = double(r.latency.valueAtPercentile(99.9));
+        op["maxNs"] = double(r.latency.getMax());
+        operations.append(op);
+    }
+
+    QJsonObject root;
+    root["elapsedSeconds"] = elapsedSeconds;
+    root["totalOperations"] = double(total);
+    root["throughput"] = double(total) / elapsedSeconds;
+    root["databaseErrors"] = double(sqlErrors);
+    root["busyErrors"] = double(busyErrors);
+    root["groupCommits"] = double(groupCommits);
+    root["groupCommitWrites"] = double(groupWrites);
+    root["operations"] = operations;
+    return root;
+}
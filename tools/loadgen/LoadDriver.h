@@ -0,0 +1,132 @@
+#ifndef LOADDRIVER_H
+#define LOADDRIVER_H
+
+#include <QThread>
+#include <QMap>
+#include <QString>
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <vector>
+#include "Workload.h"
+#include "PerformanceMonitor.h"
+
+/*
+    OperationResult Struct:
+    Outcome counts and latency distribution for one operation name
+*/
+struct OperationResult {
+    quint64 ok = 0;
+    quint64 rejected = 0;
+    LatencyHistogram latency;
+};
+
+/*
+    LoadWorker Class:
+    One driver thread. Runs either a generated workload (open loop at a fixed rate,
+    for a fixed duration) or a slice of a recorded trace (at the recorded offsets,
+    scaled by a speed factor).
+
+    Latency is measured from when an operation was scheduled to start, not from
+    when it actually started, so a worker that falls behind reports the queueing
+    delay its users would have seen instead of hiding it (no coordinated omission).
+    With no target rate the worker runs closed loop and latency is service time.
+
+    Data Members:
+      - WorkloadGenerator* generator: Generated mode source (nullptr when replaying)
+      - std::vector<const TraceRecorder::Entry*> trace: Replay mode source
+      - qint64 intervalNanos: Spacing between scheduled starts (0 = closed loop)
+      - qint64 durationNanos: Generated mode run time
+      - double speed: Replay time compression factor
+      - const QElapsedTimer& clock: Shared start time of the run
+      - QMap<QString, OperationResult> results: Per-operation outcomes
+
+    Member Functions:
+      - LoadWorker(): Generated-mode and replay-mode constructors
+      - getResults(): Results after the thread has finished
+      - run(): Thread body
+*/
+class LoadWorker : public QThread {
+public:
+    LoadWorker(WorkloadGenerator* generator, qint64 intervalNanos, qint64 durationNanos,
+               const QElapsedTimer& clock);
+    LoadWorker(const std::vector<const TraceRecorder::Entry*>& trace, double speed,
+               const QElapsedTimer& clock);
+    ~LoadWorker();
+
+    const QMap<QString, OperationResult>& getResults() const { return results; }
+
+protected:
+    void run() override;
+
+private:
+    WorkloadGenerator* generator;
+    std::vector<const TraceRecorder::Entry*> trace;
+    qint64 intervalNanos;
+    qint64 durationNanos;
+    double speed;
+    const QElapsedTimer& clock;
+    QMap<QString, OperationResult> results;
+
+    void waitUntil(qint64 dueNanos);
+    void recordResult(const QString& operation, bool ok, qint64 startNanos);
+};
+
+/*
+    LoadDriver Class:
+    Runs a workload across several LoadWorker threads and reports throughput,
+    latency percentiles and SQLite contention.
+
+    Contention comes from PerformanceMonitor: every DatabaseManager operation that
+    failed with SQLITE_BUSY or SQLITE_LOCKED is counted there, so the report needs
+    no extra instrumentation in the data layer.
+
+    Data Members:
+      - QMap<QString, OperationResult> results: Merged per-operation outcomes
+      - double elapsedSeconds: Wall-clock length of the run
+      - quint64 busyErrors / sqlErrors: Contention and total failures seen by DatabaseManager
+      - quint64 groupCommits / groupWrites: WriteCoalescer transactions and the writes they
+        carried (zero unless --group-commit is on)
+
+    Member Functions:
+      - runGenerated(): Runs a seeded synthetic workload
+      - runReplay(): Replays a recorded trace
+      - printReport(): Writes the human-readable summary to stdout
+      - toJson(): Machine-readable summary
+*/
+class LoadDriver {
+public:
+    /*
+        Function: runGenerated
+        Purpose: Runs config.threads workers over the library for config.durationSeconds
+        Parameters:
+          in: const WorkloadConfig& config - Mix, rate, duration and seed
+          in: const LibraryState& library - Ids to draw from
+    */
+    void runGenerated(const WorkloadConfig& config, const LibraryState& library);
+
+    /*
+        Function: runReplay
+        Purpose: Replays a trace across worker threads. Calls are partitioned by user
+                 (or username) so each user's calls stay in their recorded order.
+        Parameters:
+          in: const std::vector<TraceRecorder::Entry>& entries - Recorded calls
+          in: int threads - Number of worker threads
+          in: double speed - Replay speed (2.0 = twice as fast as recorded; 0 = as fast as possible)
+    */
+    void runReplay(const std::vector<TraceRecorder::Entry>& entries, int threads, double speed);
+
+    void printReport() const;
+    QJsonObject toJson() const;
+
+private:
+    QMap<QString, OperationResult> results;
+    double elapsedSeconds = 0;
+    quint64 busyErrors = 0;
+    quint64 sqlErrors = 0;
+    quint64 groupCommits = 0;
+    quint64 groupWrites = 0;
+
+    void collect(const std::vector<LoadWorker*>& workers, const QElapsedTimer& clock);
+};
+
+#endif
@@ -0,0 +1,284 @@
+#include <QDebug>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QtAlgorithms>
+#include <algorithm>
+#include <cmath>
+#include "Workload.h"
+#include "DatabaseManager.h"
+#include "WriteCoalescer.h"
+
+namespace {
+    // Circulation writes share group commits when the run enables them (--group-commit)
+    bool write(WriteCoalescer::Operation operation, int userId, int itemId) {
+        if (WriteCoalescer::isEnabled()) {
+            return WriteCoalescer::getInstance().execute(operation, userId, itemId) == IDataRepository::WriteOk;
+        }
+        DatabaseManager& dbm = DatabaseManager::getInstance();
+        switch (operation) {
+        case WriteCoalescer::Borrow: return dbm.borrowItem(userId, itemId);
+        case WriteCoalescer::Return: return dbm.returnItem(userId, itemId);
+        case WriteCoalescer::PlaceHold: return dbm.placeHold(userId, itemId);
+        case WriteCoalescer::CancelHold: return dbm.cancelHold(userId, itemId);
+        }
+        return false;
+    }
+}
+
+// === WORKLOAD CONFIG ===
+
+WorkloadConfig::WorkloadConfig() {
+    // A day at the circulation desk: mostly reads, steady borrow/return churn
+    weights["login"] = 10;
+    weights["search"] = 10;
+    weights["browse"] = 35;
+    weights["borrow"] = 12;
+    weights["return"] = 12;
+    weights["placeHold"] = 6;
+    weights["cancelHold"] = 5;
+    weights["account"] = 10;
+    weights["catalogue"] = 0;
+}
+
+QStringList WorkloadConfig::operationNames() {
+    return {"login", "search", "browse", "borrow", "return",
+            "placeHold", "cancelHold", "account", "catalogue"};
+}
+
+bool WorkloadConfig::parseMix(const QString& mix, QString& error) {
+    for (const QString& part : mix.split(',')) {
+        if (part.trimmed().isEmpty()) continue;
+
+        QStringList pair = part.split('=');
+        bool ok = false;
+        int weight = pair.size() == 2 ? pair[1].trimmed().toInt(&ok) : 0;
+        QString name = pair[0].trimmed();
+
+        if (!ok || weight < 0 || !operationNames().contains(name)) {
+            error = QString("Invalid mix entry '%1' (expected name=weight; names: %2)")
+                    .arg(part, operationNames().join(", "));
+            return false;
+        }
+        weights[name] = weight;
+    }
+    return true;
+}
+
+
+// === LIBRARY STATE ===
+
+bool LibraryState::load() {
+    QSqlQuery query(QSqlDatabase::database("library_connection"));
+    query.setForwardOnly(true);
+
+    query.exec("SELECT id FROM catalogue_items ORDER BY id");
+    while (query.next()) itemIds.push_back(query.value(0).toInt());
+
+    query.exec("SELECT id, username FROM users WHERE role = 'patron' ORDER BY id");
+    while (query.next()) {
+        patronIds.push_back(query.value(0).toInt());
+        patronNames.push_back(query.value(1).toString());
+    }
+
+    query.exec("SELECT user_id, item_id FROM loans WHERE return_date IS NULL");
+    while (query.next()) loans[query.value(0).toInt()].push_back(query.value(1).toInt());
+
+    query.exec("SELECT user_id, item_id FROM holds");
+    while (query.next()) holds[query.value(0).toInt()].push_back(query.value(1).toInt());
+
+    return !itemIds.empty() && !patronIds.empty();
+}
+
+
+// === WORKLOAD GENERATOR ===
+
+WorkloadGenerator::WorkloadGenerator(const WorkloadConfig& config, const LibraryState& library,
+                                     int workerIndex, int workerCount)
+    : config(config), library(library), rng(config.seed + quint32(workerIndex)) {
+    for (int i = workerIndex; i < int(library.patronIds.size()); i += workerCount) {
+        int patronId = library.patronIds[i];
+        patrons.push_back(i);
+        if (library.loans.contains(patronId)) loans[patronId] = library.loans.value(patronId);
+        if (library.holds.contains(patronId)) holds[patronId] = library.holds.value(patronId);
+    }
+
+    int total = 0;
+    for (const QString& name : WorkloadConfig::operationNames()) {
+        int weight = config.weights.value(name, 0);
+        if (weight <= 0) continue;
+        total += weight;
+        names.push_back(name);
+        cumulative.push_back(total);
+    }
+}
+
+int WorkloadGenerator::popularItem(int range) {
+    // Same Zipf-like skew the synthetic libraries are generated with
+    int rank = int(std::pow(double(range), rng.generateDouble())) - 1;
+    return library.itemIds[qMin(qMax(rank, 0), range - 1)];
+}
+
+int WorkloadGenerator::pickPatron() {
+    return patrons[rng.bounded(int(patrons.size()))];
+}
+
+QString WorkloadGenerator::next() {
+    if (cumulative.empty()) return QString();
+
+    int draw = rng.bounded(cumulative.back());
+    for (size_t i = 0; i < cumulative.size(); ++i) {
+        if (draw < cumulative[i]) return names[i];
+    }
+    return names.back();
+}
+
+bool WorkloadGenerator::execute(const QString& operation) {
+    DatabaseManager& dbm = DatabaseManager::getInstance();
+    if (patrons.empty()) return false;
+
+    int index = pickPatron();
+    int patronId = library.patronIds[index];
+    int itemCount = int(library.itemIds.size());
+
+    if (operation == "login") {
+        User* user = dbm.findUser(library.patronNames[index]);
+        if (!user) return false;
+        DatabaseManager::AccountSnapshot snapshot = dbm.getAccountSnapshot(user->id);
+        DatabaseManager::freeAccountSnapshot(snapshot);
+        delete user;
+        return true;
+    }
+
+    if (operation == "search") {
+        // Desk lookups type the first few characters of a username
+        QString prefix = library.patronNames[index].left(2 + rng.bounded(6));
+        std::vector<User*> results = dbm.searchPatrons(prefix, QString(), 50);
+        qDeleteAll(results);
+        return true;
+    }
+
+    if (operation == "browse") {
+        delete dbm.getItemById(popularItem(itemCount));
+        return true;
+    }
+
+    if (operation == "borrow") {
+        std::vector<int>& patronLoans = loans[patronId];
+        if (patronLoans.size() >= 3) return false; // Same limit as User::canBorrow
+
+        int itemId = popularItem(itemCount);
+        LibraryItem* item = dbm.getItemById(itemId);
+        bool available = item && item->getAvailability();
+        delete item;
+
+        if (!available || !write(WriteCoalescer::Borrow, patronId, itemId)) return false;
+        patronLoans.push_back(itemId);
+        return true;
+    }
+
+    if (operation == "return") {
+        std::vector<int>& patronLoans = loans[patronId];
+        if (patronLoans.empty()) return false;
+
+        int slot = rng.bounded(int(patronLoans.size()));
+        int itemId = patronLoans[slot];
+        if (!write(WriteCoalescer::Return, patronId, itemId)) return false;
+        patronLoans.erase(patronLoans.begin() + slot);
+        return true;
+    }
+
+    if (operation == "placeHold") {
+        std::vector<int>& patronHolds = holds[patronId];
+        int hotRange = qMax(1, int(itemCount * config.hotFraction));
+        int itemId = popularItem(hotRange);
+
+        if (std::find(patronHolds.begin(), patronHolds.end(), itemId) != patronHolds.end()) return false;
+        if (!write(WriteCoalescer::PlaceHold, patronId, itemId)) return false;
+        patronHolds.push_back(itemId);
+        return true;
+    }
+
+    if (operation == "cancelHold") {
+        std::vector<int>& patronHolds = holds[patronId];
+        if (patronHolds.empty()) return false;
+
+        int slot = rng.bounded(int(patronHolds.size()));
+        if (!write(WriteCoalescer::CancelHold, patronId, patronHolds[slot])) return false;
+        patronHolds.erase(patronHolds.begin() + slot);
+        return true;
+    }
+
+    if (operation == "account") {
+        DatabaseManager::AccountSnapshot snapshot = dbm.getAccountSnapshot(patronId);
+        DatabaseManager::freeAccountSnapshot(snapshot);
+        return true;
+    }
+
+    if (operation == "catalogue") {
+        std::vector<LibraryItem*> items = dbm.getAllCatalogueItems();
+        qDeleteAll(items);
+        return true;
+    }
+
+    qDebug() << "Unknown workload operation:" << operation;
+    return false;
+}
+
+bool WorkloadGenerator::executeTraced(const TraceRecorder::Entry& entry) {
+    DatabaseManager& dbm = DatabaseManager::getInstance();
+    const QString& op = entry.operation;
+    const QVariantList& a = entry.args;
+    auto arg = [&a](int i) { return i < a.size() ? a[i].toInt() : 0; };
+
+    if (op == "borrowItem") return write(WriteCoalescer::Borrow, arg(0), arg(1));
+    if (op == "returnItem") return write(WriteCoalescer::Return, arg(0), arg(1));
+    if (op == "placeHold") return write(WriteCoalescer::PlaceHold, arg(0), arg(1));
+    if (op == "cancelHold") return write(WriteCoalescer::CancelHold, arg(0), arg(1));
+
+    if (op == "findUser") {
+        User* user = dbm.findUser(a.value(0).toString());
+        delete user;
+        return user != nullptr;
+    }
+    if (op == "searchPatrons") {
+        qDeleteAll(dbm.searchPatrons(a.value(0).toString(), a.value(1).toString(), arg(2)));
+        return true;
+    }
+    if (op == "getAllCatalogueItems") {
+        qDeleteAll(dbm.getAllCatalogueItems());
+        return true;
+    }
+    if (op == "getItemById") {
+        LibraryItem* item = dbm.getItemById(arg(0));
+        delete item;
+        return item != nullptr;
+    }
+    if (op == "getUserBorrowedItems") {
+        qDeleteAll(dbm.getUserBorrowedItems(arg(0)));
+        return true;
+    }
+    if (op == "getUserHolds") {
+        qDeleteAll(dbm.getUserHolds(arg(0)));
+        return true;
+    }
+    if (op == "getUserLoansWithDates") {
+        for (auto& loan : dbm.getUserLoansWithDates(arg(0))) delete loan.item;
+        return true;
+    }
+    if (op == "getAccountSnapshot") {
+        DatabaseManager::AccountSnapshot snapshot = dbm.getAccountSnapshot(arg(0));
+        DatabaseManager::freeAccountSnapshot(snapshot);
+        return true;
+    }
+    if (op == "getHoldCountForItem") {
+        dbm.getHoldCountForItem(arg(0));
+        return true;
+    }
+    if (op == "getHoldPosition") {
+        dbm.getHoldPosition(arg(0), arg(1));
+        return true;
+    }
+
+    qDebug() << "Skipping unknown trace operation:" << op;
+    return false;
+}
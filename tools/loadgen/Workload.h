@@ -0,0 +1,128 @@
+#ifndef WORKLOAD_H
+#define WORKLOAD_H
+
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QRandomGenerator>
+#include <vector>
+#include "TraceRecorder.h"
+
+/*
+    WorkloadConfig Struct:
+    Parameters for a synthetic circulation workload. Operation weights are relative;
+    an operation with weight 0 never runs.
+
+    Operations (what one kiosk interaction does against DatabaseManager):
+      - login: findUser + getAccountSnapshot
+      - search: searchPatrons on a username prefix (librarian desk lookup)
+      - browse: getItemById on a popularity-weighted title
+      - borrow: getItemById availability check, then borrowItem if available
+      - return: returnItem on one of the patron's loans
+      - placeHold: placeHold on a hot (checked-out, popular) title
+      - cancelHold: cancelHold on one of the patron's holds
+      - account: getAccountSnapshot
+      - catalogue: getAllCatalogueItems (full catalogue load; expensive on large libraries)
+*/
+struct WorkloadConfig {
+    quint32 seed = 1;
+    int threads = 4;
+    double rate = 200.0;        // Target operations per second across all threads (0 = unthrottled)
+    double durationSeconds = 30.0;
+    double hotFraction = 0.01;  // Share of titles that receive hold churn
+    QHash<QString, int> weights;
+
+    WorkloadConfig();
+
+    /*
+        Function: parseMix
+        Purpose: Overrides weights from a "name=weight,name=weight" string
+        Parameters:
+          in: const QString& mix - Mix specification
+          out: QString& error - Description of the first invalid entry
+        Return: bool - True if every entry named a known operation
+    */
+    bool parseMix(const QString& mix, QString& error);
+
+    static QStringList operationNames();
+};
+
+/*
+    LibraryState Struct:
+    Snapshot of the ids a workload draws from, loaded once before the run. Item ids
+    are kept in id order, which is also popularity order for generated libraries.
+*/
+struct LibraryState {
+    std::vector<int> itemIds;
+    std::vector<int> patronIds;
+    std::vector<QString> patronNames;
+    QHash<int, std::vector<int>> loans;  // patron id -> items on loan
+    QHash<int, std::vector<int>> holds;  // patron id -> items on hold
+
+    /*
+        Function: load
+        Purpose: Reads item ids, patrons, active loans and holds from the open database
+        Return: bool - True if the library has at least one item and one patron
+    */
+    bool load();
+};
+
+/*
+    WorkloadGenerator Class:
+    Draws and executes operations for one worker thread. Each worker owns a disjoint
+    slice of the patrons (and their loans and holds), so its bookkeeping of who has
+    what stays correct without locking.
+
+    Data Members:
+      - const WorkloadConfig& config: Mix and sizing parameters
+      - const LibraryState& library: Shared, read-only id lists
+      - QRandomGenerator rng: Per-worker generator (seed + worker index)
+      - std::vector<int> patrons: Indexes into library.patronIds owned by this worker
+      - QHash<int, std::vector<int>> loans / holds: This worker's patrons' loans and holds
+      - std::vector<QString> names / std::vector<int> cumulative: Weighted operation table
+
+    Member Functions:
+      - WorkloadGenerator(): Takes this worker's slice of the library
+      - next(): Picks the next operation name
+      - execute(): Runs one operation; returns false if the library rejected it
+*/
+class WorkloadGenerator {
+public:
+    WorkloadGenerator(const WorkloadConfig& config, const LibraryState& library,
+                      int workerIndex, int workerCount);
+
+    QString next();
+
+    /*
+        Function: execute
+        Purpose: Runs one operation against DatabaseManager
+        Parameters:
+          in: const QString& operation - Operation name from WorkloadConfig
+        Return: bool - False if the operation was rejected (e.g. item not available)
+    */
+    bool execute(const QString& operation);
+
+    /*
+        Function: executeTraced
+        Purpose: Replays one recorded DatabaseManager call
+        Parameters:
+          in: const TraceRecorder::Entry& entry - Recorded call
+        Return: bool - Result of the call (reads count as successful)
+    */
+    static bool executeTraced(const TraceRecorder::Entry& entry);
+
+private:
+    const WorkloadConfig& config;
+    const LibraryState& library;
+    QRandomGenerator rng;
+    std::vector<int> patrons;
+    QHash<int, std::vector<int>> loans;
+    QHash<int, std::vector<int>> holds;
+    std::vector<QString> names;
+    std::vector<int> cumulative;
+
+    int popularItem(int range);
+    int pickPatron();
+};
+
+#endif
@@ -0,0 +1,24 @@
+QT       += core sql
+QT       -= gui
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = hinlibs_loadgen
+
+# Data layer shared with the application
+include(../../hinlibs_data.pri)
+
+# Synthetic library generator shared with the benchmarks
+INCLUDEPATH += ../../benchmarks
+
+SOURCES += \
+    main.cpp \
+    LoadDriver.cpp \
+    Workload.cpp \
+    ../../benchmarks/SyntheticLibrary.cpp
+
+HEADERS += \
+    LoadDriver.h \
+    Workload.h \
+    ../../benchmarks/SyntheticLibrary.h
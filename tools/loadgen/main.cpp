@@ -0,0 +1,137 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QJsonDocument>
+#include <QSaveFile>
+#include <QTextStream>
+#include "DatabaseInitializer.h"
+#include "DatabaseManager.h"
+#include "PerformanceMonitor.h"
+#include "TraceRecorder.h"
+#include "SyntheticLibrary.h"
+#include "Workload.h"
+#include "LoadDriver.h"
+#include "WriteCoalescer.h"
+
+/*
+    HinLIBS load generator:
+    Headless driver that simulates circulation traffic on top of DatabaseManager.
+    Either generates a seeded workload mix at a target rate from several threads,
+    or replays a trace recorded from real sessions (HINLIBS_TRACE_FILE), then
+    reports throughput, latency percentiles and SQLITE_BUSY contention.
+*/
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("hinlibs_loadgen");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Synthetic workload generator and trace replayer for the HinLIBS data layer");
+    parser.addHelpOption();
+
+    QCommandLineOption dbOption("db", "SQLite database to run against.", "path", "hinlibs.db");
+    QCommandLineOption itemsOption("items", "Generate (or reuse) a synthetic library of N items instead of --db.", "N");
+    QCommandLineOption threadsOption("threads", "Worker threads.", "N", "4");
+    QCommandLineOption rateOption("rate", "Target operations per second across all threads (0 = unthrottled).", "ops", "200");
+    QCommandLineOption durationOption("duration", "Run time in seconds (generated workloads).", "seconds", "30");
+    QCommandLineOption seedOption("seed", "Random seed for the workload.", "N", "1");
+    QCommandLineOption mixOption("mix", "Operation weights, e.g. browse=50,borrow=10,catalogue=1.", "spec");
+    QCommandLineOption hotOption("hot", "Share of titles that receive hold churn.", "fraction", "0.01");
+    QCommandLineOption replayOption("replay", "Replay a recorded trace instead of generating a workload.", "trace");
+    QCommandLineOption speedOption("speed", "Replay speed factor (0 = as fast as possible).", "factor", "1");
+    QCommandLineOption recordOption("record", "Record this run's DatabaseManager calls to a trace file.", "trace");
+    QCommandLineOption jsonOption("json", "Also write the report as JSON.", "path");
+    QCommandLineOption groupCommitOption("group-commit", "Group-commit circulation writes, waiting up to "
+                                         "this long for others to join each commit (0 = no wait).", "ms");
+    QCommandLineOption groupSizeOption("group-size", "Commit a group as soon as it has N writes.", "N", "64");
+
+    parser.addOptions({dbOption, itemsOption, threadsOption, rateOption, durationOption, seedOption,
+                       mixOption, hotOption, replayOption, speedOption, recordOption, jsonOption,
+                       groupCommitOption, groupSizeOption});
+    parser.process(app);
+
+    QTextStream err(stderr);
+
+    // Database: an existing file, or a generated library of the requested size
+    QString path = parser.value(dbOption);
+    if (parser.isSet(itemsOption)) {
+        int items = parser.value(itemsOption).toInt();
+        path = SyntheticLibrary::databasePath(items);
+        SyntheticLibrary library(items);
+        if (!library.ensureDatabase(path)) {
+            err << "Could not generate synthetic library\n";
+            return 1;
+        }
+    } else if (!DatabaseInitializer::initializeDatabase(path)) {
+        err << "Could not initialize " << path << "\n";
+        return 1;
+    }
+
+    // Create the singletons on this thread before any worker touches them
+    PerformanceMonitor::getInstance();
+    if (!DatabaseManager::getInstance().openDatabase(path)) {
+        return 1;
+    }
+
+    if (parser.isSet(recordOption) && !TraceRecorder::getInstance().start(parser.value(recordOption))) {
+        return 1;
+    }
+
+    // Without --group-commit every write is its own transaction; compare the two reports
+    if (parser.isSet(groupCommitOption)) {
+        WriteCoalescer::getInstance().start(parser.value(groupSizeOption).toInt(),
+                                            parser.value(groupCommitOption).toInt());
+    }
+
+    LoadDriver driver;
+    int threads = parser.value(threadsOption).toInt();
+
+    if (parser.isSet(replayOption)) {
+        std::vector<TraceRecorder::Entry> entries;
+        if (!TraceRecorder::load(parser.value(replayOption), entries)) {
+            return 1;
+        }
+        err << "Replaying " << entries.size() << " calls on " << threads << " threads\n";
+        err.flush();
+        driver.runReplay(entries, threads, parser.value(speedOption).toDouble());
+    } else {
+        WorkloadConfig config;
+        config.seed = parser.value(seedOption).toUInt();
+        config.threads = threads;
+        config.rate = parser.value(rateOption).toDouble();
+        config.durationSeconds = parser.value(durationOption).toDouble();
+        config.hotFraction = parser.value(hotOption).toDouble();
+
+        QString mixError;
+        if (parser.isSet(mixOption) && !config.parseMix(parser.value(mixOption), mixError)) {
+            err << mixError << "\n";
+            return 1;
+        }
+
+        LibraryState library;
+        if (!library.load()) {
+            err << "Library has no items or no patrons\n";
+            return 1;
+        }
+
+        err << "Running " << config.durationSeconds << " s at " << config.rate << " ops/s on "
+            << config.threads << " threads (" << library.itemIds.size() << " items, "
+            << library.patronIds.size() << " patrons)\n";
+        err.flush();
+        driver.runGenerated(config, library);
+    }
+
+    WriteCoalescer::getInstance().stop();
+    TraceRecorder::getInstance().stop();
+    driver.printReport();
+
+    if (parser.isSet(jsonOption)) {
+        QSaveFile file(parser.value(jsonOption));
+        if (!file.open(QIODevice::WriteOnly)) {
+            err << "Could not write " << parser.value(jsonOption) << "\n";
+            return 1;
+        }
+        file.write(QJsonDocument(driver.toJson()).toJson(QJsonDocument::Indented));
+        file.commit();
+    }
+
+    return 0;
+}
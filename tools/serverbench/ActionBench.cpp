@@ -0,0 +1,172 @@
+#include <QElapsedTimer>
+#include <QtAlgorithms>
+#include "ActionBench.h"
+
+ActionBench::ActionBench(RemoteRepository& repository, int userId)
+    : repository(repository), userId(userId), selected(nullptr) {
+    // The first catalogue row stands in for the patron's selection
+    std::vector<LibraryItem*> catalogue = repository.getAllCatalogueItems();
+    if (!catalogue.empty()) {
+        selected = catalogue.front();
+        catalogue.erase(catalogue.begin());
+    }
+    qDeleteAll(catalogue);
+}
+
+ActionBench::~ActionBench() {
+    delete selected;
+    IDataRepository::freeAccountSnapshot(account);
+}
+
+LibraryItem* ActionBench::getSelectedBook(bool batched) {
+    // MainWindow re-read the catalogue to map the selected row to an item; it now
+    // resolves the row's item ID in memory
+    if (!batched) {
+        std::vector<LibraryItem*> catalogue = repository.getAllCatalogueItems();
+        qDeleteAll(catalogue);
+    }
+    return selected;
+}
+
+// === SCRIPTED HANDLERS ===
+
+void ActionBench::refreshCatalogue(bool batched) {
+    getSelectedBook(batched); // Selection preserved across refresh
+    std::vector<LibraryItem*> catalogue = repository.getAllCatalogueItems();
+
+    if (!batched) { // Hold counts now arrive with the items
+        for (LibraryItem* item : catalogue) {
+            int itemId = repository.getItemId(item);
+            repository.getHoldCountForItem(itemId);
+        }
+    }
+    qDeleteAll(catalogue);
+
+    onBookSelected(batched);
+    refreshAccountStatus(batched);
+}
+
+void ActionBench::refreshAccountStatus(bool batched) {
+    IDataRepository::freeAccountSnapshot(account);
+    account = repository.getAccountSnapshot(userId);
+    onBookSelected(batched);
+}
+
+void ActionBench::onBookSelected(bool batched) {
+    getSelectedBook(batched);
+
+    // updateHoldButtons(); holds are matched by item ID against the account snapshot
+    if (batched) return;
+
+    std::vector<LibraryItem*> holds = repository.getUserHolds(userId);
+    getSelectedBook(batched);
+    repository.getItemId(selected);
+    for (LibraryItem* hold : holds) {
+        repository.getItemId(hold);
+    }
+    qDeleteAll(holds);
+}
+
+void ActionBench::placeHold(bool batched) {
+    LibraryItem* book = getSelectedBook(batched);
+
+    if (batched) {
+        int itemId = book->getId(); // Carried by the catalogue item
+        int position = 0;
+        repository.placeHoldAndGetPosition(userId, itemId, position);
+    } else {
+        std::vector<LibraryItem*> holds = repository.getUserHolds(userId);
+        for (LibraryItem* hold : holds) {
+            repository.getItemId(hold);
+            repository.getItemId(book);
+        }
+        qDeleteAll(holds);
+
+        int itemId = repository.getItemId(book);
+        repository.getHoldCountForItem(itemId);
+        repository.placeHold(userId, itemId);
+    }
+
+    refreshCatalogue(batched);
+    if (!batched) refreshAccountStatus(batched); // Now merged into the catalogue refresh's update
+}
+
+void ActionBench::cancelHold(bool batched) {
+    int itemId = -1;
+    if (batched) {
+        // Row of the account snapshot refreshed after the hold was placed
+        for (const auto& hold : account.holds) {
+            if (hold.itemId == selected->getId()) itemId = hold.itemId;
+        }
+    } else {
+        std::vector<LibraryItem*> holds = repository.getUserHolds(userId);
+        for (LibraryItem* hold : holds) {
+            if (hold->getTitle() == selected->getTitle()) itemId = repository.getItemId(hold);
+        }
+        qDeleteAll(holds);
+    }
+    repository.cancelHold(userId, itemId);
+
+    refreshCatalogue(batched);
+    if (!batched) refreshAccountStatus(batched); // Now merged into the catalogue refresh's update
+}
+
+// === MEASUREMENT ===
+
+ActionBench::ActionResult ActionBench::measure(const QString& action, int repetitions,
+                                               const std::function<void(bool)>& script,
+                                               const std::function<void(bool)>& undo) {
+    ActionResult result = {action, 0, 0, 0, 0};
+    QElapsedTimer timer;
+
+    for (int form = 0; form < 2; ++form) {
+        bool batched = form == 1;
+        quint64 roundTrips = 0;
+        qint64 nanos = 0;
+
+        for (int i = 0; i < repetitions; ++i) {
+            quint64 startTrips = repository.getRoundTrips();
+            timer.start();
+            script(batched);
+            nanos += timer.nsecsElapsed();
+            roundTrips += repository.getRoundTrips() - startTrips;
+
+            if (undo) undo(batched);
+        }
+
+        double trips = double(roundTrips) / repetitions;
+        double ms = double(nanos) / 1e6 / repetitions;
+        if (batched) {
+            result.roundTripsAfter = trips;
+            result.msAfter = ms;
+        } else {
+            result.roundTripsBefore = trips;
+            result.msBefore = ms;
+        }
+    }
+    return result;
+}
+
+std::vector<ActionBench::ActionResult> ActionBench::run(int repetitions) {
+    std::vector<ActionResult> results;
+    if (!selected) return results; // Empty catalogue
+
+    repetitions = qMax(1, repetitions);
+    refreshAccountStatus(true); // Initial account panel
+
+    results.push_back(measure("refreshCatalogue", repetitions,
+                              [this](bool batched) { refreshCatalogue(batched); }, nullptr));
+    results.push_back(measure("selectItem", repetitions,
+                              [this](bool batched) { onBookSelected(batched); }, nullptr));
+    results.push_back(measure("placeHold", repetitions,
+                              [this](bool batched) { placeHold(batched); },
+                              [this](bool batched) { cancelHold(batched); }));
+
+    // Cancelling needs a hold to cancel: place one first and remove the last re-placed one after
+    placeHold(true);
+    results.push_back(measure("cancelHold", repetitions,
+                              [this](bool batched) { cancelHold(batched); },
+                              [this](bool batched) { placeHold(batched); }));
+    cancelHold(true);
+    return results;
+}
@@ -0,0 +1,78 @@
+#ifndef ACTIONBENCH_H
+#define ACTIONBENCH_H
+
+#include <QString>
+#include <functional>
+#include <vector>
+#include "RemoteRepository.h"
+
+/*
+    ActionBench Class:
+    Measures server round trips and latency per user action in thin-client mode.
+    Each action replays the repository calls MainWindow makes for one button click
+    (including the catalogue and account refresh that follows it), in two forms:
+      - "before": one request per call, as the screens issued them before the
+        bulk operations existed (two requests per catalogue row on refresh, a
+        getItemId per hold and a catalogue re-read on every selection change)
+      - "after": the current call sequence: hold counts carried by the catalogue
+        items, placeHoldAndGetPosition(), the account snapshot, and one account
+        refresh per click (MainWindow's RefreshScheduler merges the second)
+    Mutating actions are undone after each repetition, so runs can be repeated
+    against the same database.
+
+    Data Members:
+      - RemoteRepository& repository: Connection under test
+      - int userId: Patron performing the actions
+      - LibraryItem* selected: Catalogue row the patron has selected
+      - IDataRepository::AccountSnapshot account: Account panel contents (after-form state)
+
+    Member Functions:
+      - ActionBench(): Picks the patron and the selected item
+      - run(): Runs every action in both forms
+*/
+class ActionBench {
+public:
+    /*
+        ActionResult Struct:
+        Averages for one action in both forms
+    */
+    struct ActionResult {
+        QString action;
+        double roundTripsBefore;
+        double roundTripsAfter;
+        double msBefore;
+        double msAfter;
+    };
+
+    ActionBench(RemoteRepository& repository, int userId);
+    ~ActionBench();
+
+    /*
+        Function: run
+        Purpose: Runs every scripted action in both forms
+        Parameters:
+          in: int repetitions - Times each action is repeated
+        Return: std::vector<ActionResult> - One row per action
+    */
+    std::vector<ActionResult> run(int repetitions);
+
+private:
+    RemoteRepository& repository;
+    int userId;
+    LibraryItem* selected;
+    IDataRepository::AccountSnapshot account;
+
+    // MainWindow's handlers in both forms
+    void refreshCatalogue(bool batched);
+    void refreshAccountStatus(bool batched);
+    void onBookSelected(bool batched);
+    void placeHold(bool batched);
+    void cancelHold(bool batched);
+
+    LibraryItem* getSelectedBook(bool batched);
+
+    ActionResult measure(const QString& action, int repetitions,
+                         const std::function<void(bool)>& script, const std::function<void(bool)>& undo);
+};
+
+#endif
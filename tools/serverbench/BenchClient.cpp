@@ -0,0 +1,90 @@
+#include <QRandomGenerator>
+#include <deque>
+#include "BenchClient.h"
+#include "LibraryClient.h"
+#include "LibraryProtocol.h"
+
+BenchClient::BenchClient(const QString& address, const QStringList& operations, int pipeline,
+                         qint64 durationNanos, int maxItemId, const std::vector<int>& patronIds,
+                         quint32 seed, const QElapsedTimer& clock)
+    : address(address), operations(operations), pipeline(qMax(1, pipeline)),
+      durationNanos(durationNanos), maxItemId(qMax(1, maxItemId)), patronIds(patronIds),
+      seed(seed), clock(clock) {}
+
+void BenchClient::run() {
+    LibraryClient client;
+    if (!client.connectTo(address)) {
+        error = client.getLastError();
+        return;
+    }
+
+    QRandomGenerator rng(seed);
+    struct InFlight {
+        QString operation;
+        qint64 sentNanos;
+    };
+    std::deque<InFlight> inFlight;
+
+    std::vector<quint8> opcodes;
+    for (const QString& operation : operations) {
+        opcodes.push_back(LibraryProtocol::opcodeFromName(operation));
+    }
+
+    auto patron = [&]() { return patronIds.empty() ? 1 : patronIds[rng.bounded(int(patronIds.size()))]; };
+
+    while (true) {
+        bool running = clock.nsecsElapsed() < durationNanos;
+
+        // Top up the pipeline
+        while (running && int(inFlight.size()) < pipeline) {
+            int pick = rng.bounded(int(opcodes.size()));
+            quint8 opcode = opcodes[pick];
+
+            QByteArray args;
+            switch (opcode) {
+            case LibraryProtocol::GetItemById:
+            case LibraryProtocol::GetHoldCountForItem:
+                args = LibraryProtocol::encodeArgs(int(rng.bounded(1, maxItemId + 1)));
+                break;
+            case LibraryProtocol::GetAccountSnapshot:
+            case LibraryProtocol::GetUserHolds:
+            case LibraryProtocol::GetUserBorrowedItems:
+                args = LibraryProtocol::encodeArgs(patron());
+                break;
+            case LibraryProtocol::SearchPatrons:
+                args = LibraryProtocol::encodeArgs("patron_0" + QString::number(rng.bounded(10)), QString(), 50);
+                break;
+            case LibraryProtocol::FindUser:
+                args = LibraryProtocol::encodeArgs(QString("patron_%1").arg(
+                    rng.bounded(qMax(1, int(patronIds.size()))), 7, 10, QChar('0')));
+                break;
+            default:
+                break; // Operations without arguments (ping, catalogue, stats)
+            }
+
+            if (client.send(opcode, args) == 0) {
+                error = client.getLastError();
+                return;
+            }
+            inFlight.push_back({operations[pick], clock.nsecsElapsed()});
+        }
+
+        if (inFlight.empty()) break; // Duration over and pipeline drained
+
+        // Answers come back in request order; streamed chunks precede their answer
+        LibraryProtocol::Frame frame;
+        if (!client.receive(frame)) {
+            error = client.getLastError();
+            return;
+        }
+        if (frame.type == LibraryProtocol::ResponseChunk) continue;
+
+        InFlight request = inFlight.front();
+        inFlight.pop_front();
+
+        RequestStats& stats = results[request.operation];
+        stats.count++;
+        if (frame.payload.isEmpty() || quint8(frame.payload.at(0)) != LibraryProtocol::Ok) stats.failed++;
+        stats.latency.record(clock.nsecsElapsed() - request.sentNanos);
+    }
+}
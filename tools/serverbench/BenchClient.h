@@ -0,0 +1,71 @@
+#ifndef BENCHCLIENT_H
+#define BENCHCLIENT_H
+
+#include <QThread>
+#include <QMap>
+#include <QString>
+#include <QStringList>
+#include <QElapsedTimer>
+#include <vector>
+#include "PerformanceMonitor.h"
+
+/*
+    RequestStats Struct:
+    Answer counts and round-trip latency for one request type
+*/
+struct RequestStats {
+    quint64 count = 0;
+    quint64 failed = 0;
+    LatencyHistogram latency;
+};
+
+/*
+    BenchClient Class:
+    One simulated desk: a thread with its own server connection that keeps up to
+    `pipeline` requests in flight for the duration of the run. Latency is measured
+    per request from the moment it was written to the moment its answer was read,
+    so with pipelining it includes time spent queued behind earlier requests.
+
+    Data Members:
+      - QString address: Server address
+      - QStringList operations: Weighted request types (repeated names = more weight)
+      - int pipeline: Maximum requests in flight on this connection
+      - qint64 durationNanos: Run time
+      - int maxItemId: Item ids are drawn from 1..maxItemId
+      - std::vector<int> patronIds: Patron ids to draw from
+      - quint32 seed: Per-client random seed
+      - const QElapsedTimer& clock: Shared start time
+      - QMap<QString, RequestStats> results: Per-request-type outcome
+      - QString error: Connection failure, if any
+
+    Member Functions:
+      - BenchClient(): Configures the client
+      - getResults() / getError(): Outcome after the thread finished
+      - run(): Thread body
+*/
+class BenchClient : public QThread {
+public:
+    BenchClient(const QString& address, const QStringList& operations, int pipeline,
+                qint64 durationNanos, int maxItemId, const std::vector<int>& patronIds,
+                quint32 seed, const QElapsedTimer& clock);
+
+    const QMap<QString, RequestStats>& getResults() const { return results; }
+    QString getError() const { return error; }
+
+protected:
+    void run() override;
+
+private:
+    QString address;
+    QStringList operations;
+    int pipeline;
+    qint64 durationNanos;
+    int maxItemId;
+    std::vector<int> patronIds;
+    quint32 seed;
+    const QElapsedTimer& clock;
+    QMap<QString, RequestStats> results;
+    QString error;
+};
+
+#endif
@@ -0,0 +1,244 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QTextStream>
+#include <QtAlgorithms>
+#include "DatabaseInitializer.h"
+#include "DatabaseManager.h"
+#include "PerformanceMonitor.h"
+#include "LibraryProtocol.h"
+#include "LibraryServer.h"
+#include "RemoteRepository.h"
+#include "ActionBench.h"
+#include "BenchClient.h"
+
+namespace {
+    // Runs the per-action benchmark off the main thread, which may be serving the embedded server
+    class ActionThread : public QThread {
+    public:
+        ActionThread(const QString& address, int repetitions) : address(address), repetitions(repetitions) {}
+
+        std::vector<ActionBench::ActionResult> results;
+        QString error;
+
+    protected:
+        void run() override {
+            RemoteRepository remote;
+            if (!remote.connectTo(address)) {
+                error = remote.getLastError();
+                return;
+            }
+
+            std::vector<User*> patrons = remote.searchPatrons("", "", 1);
+            if (patrons.empty()) {
+                error = "No patrons in the library";
+                return;
+            }
+            int patronId = patrons.front()->id;
+            qDeleteAll(patrons);
+
+            ActionBench bench(remote, patronId);
+            results = bench.run(repetitions);
+        }
+
+    private:
+        QString address;
+        int repetitions;
+    };
+}
+
+/*
+    HinLIBS server benchmark:
+    Opens N concurrent client connections to a HinLIBS server (a running one, or an
+    embedded one started in this process) and measures requests/s and round-trip
+    latency percentiles per request type. With --actions it instead measures round
+    trips and latency per user action, before and after request batching.
+*/
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("hinlibs_serverbench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Throughput and latency benchmark for the HinLIBS server");
+    parser.addHelpOption();
+
+    QCommandLineOption serverOption("server", "Address of a running server.", "address", LibraryProtocol::defaultAddress());
+    QCommandLineOption embeddedOption("embedded", "Start a server in this process on the given database instead.", "db");
+    QCommandLineOption clientsOption("clients", "Concurrent client connections.", "N", "8");
+    QCommandLineOption pipelineOption("pipeline", "Requests in flight per connection.", "N", "1");
+    QCommandLineOption durationOption("duration", "Run time in seconds.", "seconds", "10");
+    QCommandLineOption opsOption("ops", "Request types, comma-separated; repeat a name to weight it.", "list",
+                                 "ping,getItemById,getItemById,getAccountSnapshot,findUser,searchPatrons");
+    QCommandLineOption itemsOption("max-item", "Highest item id to request.", "N", "10000");
+    QCommandLineOption jsonOption("json", "Also write the report as JSON.", "path");
+    QCommandLineOption actionsOption("actions", "Measure round trips per user action instead, repeating each N times.", "N");
+    parser.addOptions({serverOption, embeddedOption, clientsOption, pipelineOption, durationOption,
+                       opsOption, itemsOption, jsonOption, actionsOption});
+    parser.process(app);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+    QString address = parser.value(serverOption);
+
+    // Optional in-process server: its event loop runs on this thread while clients run on theirs
+    LibraryServer* embedded = nullptr;
+    if (parser.isSet(embeddedOption)) {
+        QString path = parser.value(embeddedOption);
+        if (!DatabaseInitializer::initializeDatabase(path)) return 1;
+        PerformanceMonitor::getInstance();
+        if (!DatabaseManager::getInstance().openDatabase(path)) return 1;
+
+        address = QString("local:hinlibs_bench_%1").arg(QCoreApplication::applicationPid());
+        embedded = new LibraryServer();
+        if (!embedded->listen(address)) return 1;
+    }
+
+    if (parser.isSet(actionsOption)) {
+        ActionThread actions(address, parser.value(actionsOption).toInt());
+        QObject::connect(&actions, &QThread::finished, &app, &QCoreApplication::quit);
+        actions.start();
+        app.exec(); // Serves the embedded server (if any) until the actions finished
+        delete embedded;
+
+        if (!actions.error.isEmpty()) {
+            err << "Action benchmark failed: " << actions.error << "\n";
+            return 1;
+        }
+
+        out << QString("%1 %2 %3 %4 %5\n").arg("action", -18).arg("trips before", 13).arg("trips after", 12)
+               .arg("ms before", 10).arg("ms after", 10);
+        for (const ActionBench::ActionResult& r : actions.results) {
+            out << QString("%1 %2 %3 %4 %5\n").arg(r.action, -18)
+                   .arg(QString::number(r.roundTripsBefore, 'f', 1), 13)
+                   .arg(QString::number(r.roundTripsAfter, 'f', 1), 12)
+                   .arg(QString::number(r.msBefore, 'f', 2), 10)
+                   .arg(QString::number(r.msAfter, 'f', 2), 10);
+        }
+        return 0;
+    }
+
+    QStringList operations = parser.value(opsOption).split(',');
+    operations.removeAll(QString());
+    for (const QString& operation : operations) {
+        if (LibraryProtocol::opcodeFromName(operation) == 0) {
+            err << "Unknown request type: " << operation << "\n";
+            return 1;
+        }
+    }
+    int clients = qMax(1, parser.value(clientsOption).toInt());
+    qint64 duration = qint64(parser.value(durationOption).toDouble() * 1e9);
+
+    // Patron ids for account requests; fetched once, outside the timed run
+    std::vector<int> patronIds;
+    if (embedded) {
+        // Same process: read them directly rather than through the not-yet-running event loop
+        for (User* user : DatabaseManager::getInstance().searchPatrons("patron_", "", 1000)) {
+            patronIds.push_back(user->id);
+            delete user;
+        }
+    } else {
+        RemoteRepository setup;
+        if (!setup.connectTo(address)) {
+            err << "Could not reach " << address << ": " << setup.getLastError() << "\n";
+            return 1;
+        }
+        for (User* user : setup.searchPatrons("patron_", "", 1000)) {
+            patronIds.push_back(user->id);
+            delete user;
+        }
+    }
+
+    err << "Benchmarking " << address << " with " << clients << " clients, pipeline "
+        << parser.value(pipelineOption) << ", " << parser.value(durationOption) << " s\n";
+    err.flush();
+
+    QElapsedTimer clock;
+    std::vector<BenchClient*> workers;
+    int finished = 0;
+    for (int i = 0; i < clients; ++i) {
+        BenchClient* worker = new BenchClient(address, operations, parser.value(pipelineOption).toInt(),
+                                              duration, parser.value(itemsOption).toInt(), patronIds,
+                                              quint32(i + 1), clock);
+        QObject::connect(worker, &QThread::finished, &app, [&]() {
+            if (++finished == clients) app.quit();
+        });
+        workers.push_back(worker);
+    }
+
+    clock.start();
+    for (BenchClient* worker : workers) worker->start();
+    app.exec(); // Serves the embedded server (if any) until every client finished
+    double elapsed = double(clock.nsecsElapsed()) / 1e9;
+
+    // Merge per-client results
+    QMap<QString, RequestStats> results;
+    for (BenchClient* worker : workers) {
+        if (!worker->getError().isEmpty()) {
+            err << "Client error: " << worker->getError() << "\n";
+        }
+        for (auto it = worker->getResults().constBegin(); it != worker->getResults().constEnd(); ++it) {
+            RequestStats& merged = results[it.key()];
+            merged.count += it.value().count;
+            merged.failed += it.value().failed;
+            merged.latency.merge(it.value().latency);
+        }
+    }
+    qDeleteAll(workers);
+    delete embedded;
+
+    auto ms = [](qint64 nanos) { return QString::number(double(nanos) / 1e6, 'f', 3); };
+    out << QString("%1 %2 %3 %4 %5 %6 %7\n").arg("request", -22).arg("count", 9).arg("failed", 7)
+           .arg("req/s", 10).arg("p50 ms", 9).arg("p99 ms", 9).arg("p99.9 ms", 9);
+
+    QJsonArray requests;
+    LatencyHistogram overall;
+    quint64 total = 0;
+    for (auto it = results.constBegin(); it != results.constEnd(); ++it) {
+        const RequestStats& r = it.value();
+        total += r.count;
+        overall.merge(r.latency);
+
+        out << QString("%1 %2 %3 %4 %5 %6 %7\n").arg(it.key(), -22).arg(r.count, 9).arg(r.failed, 7)
+               .arg(QString::number(double(r.count) / elapsed, 'f', 1), 10)
+               .arg(ms(r.latency.valueAtPercentile(50.0)), 9)
+               .arg(ms(r.latency.valueAtPercentile(99.0)), 9)
+               .arg(ms(r.latency.valueAtPercentile(99.9)), 9);
+
+        QJsonObject request;
+        request["request"] = it.key();
+        request["count"] = double(r.count);
+        request["failed"] = double(r.failed);
+        request["throughput"] = double(r.count) / elapsed;
+        request["p50Ns"] = double(r.latency.valueAtPercentile(50.0));
+        request["p99Ns"] = double(r.latency.valueAtPercentile(99.0));
+        request["p999Ns"] = double(r.latency.valueAtPercentile(99.9));
+        requests.append(request);
+    }
+
+    out << "\nTotal: " << total << " requests in " << QString::number(elapsed, 'f', 2) << " s ("
+        << QString::number(double(total) / elapsed, 'f', 1) << " req/s); p50 "
+        << ms(overall.valueAtPercentile(50.0)) << " ms, p99 " << ms(overall.valueAtPercentile(99.0))
+        << " ms, p99.9 " << ms(overall.valueAtPercentile(99.9)) << " ms\n";
+
+    if (parser.isSet(jsonOption)) {
+        QJsonObject root;
+        root["clients"] = clients;
+        root["pipeline"] = parser.value(pipelineOption).toInt();
+        root["elapsedSeconds"] = elapsed;
+        root["throughput"] = double(total) / elapsed;
+        root["p50Ns"] = double(overall.valueAtPercentile(50.0));
+        root["p99Ns"] = double(overall.valueAtPercentile(99.0));
+        root["p999Ns"] = double(overall.valueAtPercentile(99.9));
+        root["requests"] = requests;
+
+        QSaveFile file(parser.value(jsonOption));
+        if (file.open(QIODevice::WriteOnly)) {
+            file.write(QJsonDocument(root).toJson(QJsonDocument::Indented));
+            file.commit();
+        }
+    }
+    return 0;
+}
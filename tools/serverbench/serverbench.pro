@@ -0,0 +1,26 @@
+QT       += core network sql
+QT       -= gui
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = hinlibs_serverbench
+
+include(../../hinlibs_data.pri)
+include(../../hinlibs_net.pri)
+
+# Server sources, for --embedded runs
+INCLUDEPATH += ../../server
+
+SOURCES += \
+    main.cpp \
+    ActionBench.cpp \
+    BenchClient.cpp \
+    ../../server/LibraryServer.cpp \
+    ../../server/RequestHandler.cpp
+
+HEADERS += \
+    ActionBench.h \
+    BenchClient.h \
+    ../../server/LibraryServer.h \
+    ../../server/RequestHandler.h